@@ -0,0 +1,30 @@
+#include "parallel.hpp"
+
+#include <algorithm>
+
+namespace vcl
+{
+	size_t parallel_thread_count()
+	{
+#ifdef VCL_NO_THREAD
+		return 1;
+#else
+		static size_t const N_thread = std::max(size_t(1), size_t(std::thread::hardware_concurrency()));
+		return N_thread;
+#endif
+	}
+
+	size_t parallel_range_count(size_t N, size_t grain_size)
+	{
+		if(grain_size==0)
+			grain_size = 1;
+		size_t const N_range_max = (N+grain_size-1)/grain_size;
+		return std::max(size_t(1), std::min(parallel_thread_count(), N_range_max));
+	}
+
+	void parallel_range_bounds(size_t N, size_t range_count, size_t k, size_t& k_begin, size_t& k_end)
+	{
+		k_begin = (N*k)/range_count;
+		k_end = (N*(k+1))/range_count;
+	}
+}
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <cstddef>
+#include <exception>
+#include <thread>
+#include <vector>
+
+// Minimal helper to split independent loops over several threads
+//
+// - parallel_for_range( N, f(k_begin,k_end) ) : call f on disjoint consecutive sub-ranges covering [0,N)
+// - parallel_for( N, f(k) ) : call f(k) for all k in [0,N)
+//
+// Small loops (N<grain_size) are run directly on the calling thread.
+// Define VCL_NO_THREAD to force a sequential execution of all the parallel loops.
+// An exception thrown by f (ex. error_vcl with VCL_ERROR_EXCEPTION) is rethrown by the calling thread once all the sub-ranges are finished.
+
+namespace vcl
+{
+	/** Number of threads used by VCL parallel loops (at least 1) */
+	size_t parallel_thread_count();
+
+	/** Call f(k_begin,k_end) on consecutive sub-ranges of [0,N) from several threads.
+	* The sub-range [k_begin,k_end) given to the t-th thread is always before the one given to thread t+1. */
+	template <typename F> void parallel_for_range(size_t N, F const& f, size_t grain_size=1024);
+
+	/** Call f(k) for all k in [0,N) from several threads */
+	template <typename F> void parallel_for(size_t N, F const& f, size_t grain_size=1024);
+
+	/** Number of sub-ranges used by parallel_for_range for a loop of size N
+	* (allows to pre-allocate per-range data before the loop) */
+	size_t parallel_range_count(size_t N, size_t grain_size=1024);
+	/** Bounds [k_begin,k_end) of the k-th sub-range used by parallel_for_range */
+	void parallel_range_bounds(size_t N, size_t range_count, size_t k, size_t& k_begin, size_t& k_end);
+}
+
+
+namespace vcl
+{
+	template <typename F> void parallel_for_range(size_t N, F const& f, size_t grain_size)
+	{
+		size_t const N_range = parallel_range_count(N, grain_size);
+		if(N_range<=1) {
+			if(N>0)
+				f(size_t(0), N);
+			return;
+		}
+
+		// Each sub-range stores its exception: a thread must not let it escape, and all the threads are joined before rethrowing
+		std::vector<std::exception_ptr> errors(N_range);
+		auto run_range = [&f,&errors,N,N_range](size_t k) {
+			try {
+				size_t k_begin=0, k_end=0;
+				parallel_range_bounds(N, N_range, k, k_begin, k_end);
+				f(k_begin, k_end);
+			}
+			catch(...) {
+				errors[k] = std::current_exception();
+			}
+		};
+
+		std::vector<std::thread> threads;
+		threads.reserve(N_range-1);
+		size_t k_thread = 1;
+		try {
+			for(; k_thread<N_range; ++k_thread)
+				threads.push_back(std::thread(run_range, k_thread));
+		}
+		catch(...) {
+			// No more thread available: the remaining sub-ranges are computed by the calling thread
+			for(size_t k=k_thread; k<N_range; ++k)
+				run_range(k);
+		}
+
+		// The first range is computed by the calling thread
+		run_range(0);
+
+		for(auto& t : threads)
+			t.join();
+
+		for(std::exception_ptr const& error : errors)
+			if(error)
+				std::rethrow_exception(error);
+	}
+
+	template <typename F> void parallel_for(size_t N, F const& f, size_t grain_size)
+	{
+		parallel_for_range(N, [&f](size_t k_begin, size_t k_end){
+			for(size_t k=k_begin; k<k_end; ++k)
+				f(k);
+		}, grain_size);
+	}
+}
@@ -0,0 +1,246 @@
+#include "asset_manager.hpp"
+
+#include "vcl/files/files.hpp"
+#include "vcl/shape/mesh/loader/loader.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <fstream>
+
+namespace vcl
+{
+	namespace
+	{
+		std::string lowercase_extension(std::string const& filename)
+		{
+			size_t const dot = filename.find_last_of('.');
+			if(dot==std::string::npos)
+				return "";
+			std::string extension = filename.substr(dot);
+			std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c){ return char(std::tolower(c)); });
+			return extension;
+		}
+
+		mesh load_mesh_file(std::string const& filename)
+		{
+			std::string const extension = lowercase_extension(filename);
+			if(extension==".ply")
+				return mesh_load_file_ply(filename);
+			if(extension==".stl")
+				return mesh_load_file_stl(filename);
+			assert_vcl(extension==".obj", "Unknown mesh format "+filename);
+			return mesh_load_file_obj(filename);
+		}
+
+		std::string load_text_file(std::string const& filename)
+		{
+			assert_file_exist(filename);
+			std::ifstream stream(filename, std::ios::binary);
+			return read_stream_content(stream);
+		}
+
+		template <typename T> bool is_decoded(std::shared_future<T> const& future)
+		{
+			return future.wait_for(std::chrono::seconds(0))==std::future_status::ready;
+		}
+	}
+
+
+	asset_manager::asset_manager(size_t thread_count)
+	{
+#ifndef VCL_NO_THREAD
+		if(thread_count==0)
+			thread_count = std::max(size_t(1), parallel_thread_count()-1);
+		for(size_t k=0; k<thread_count; ++k)
+			workers.push_back(std::thread([this](){ worker_loop(); }));
+#else
+		(void)thread_count;
+#endif
+	}
+
+	asset_manager::~asset_manager()
+	{
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			stop = true;
+			tasks.clear();
+		}
+		task_available.notify_all();
+		for(std::thread& worker : workers)
+			worker.join();
+	}
+
+	void asset_manager::worker_loop()
+	{
+		while(true) {
+			std::function<void()> task;
+			{
+				std::unique_lock<std::mutex> lock(mutex);
+				task_available.wait(lock, [this](){ return stop || !tasks.empty(); });
+				if(stop)
+					return;
+				task = std::move(tasks.front());
+				tasks.pop_front();
+				running_tasks++;
+			}
+
+			task();
+
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				running_tasks--;
+			}
+			tasks_done.notify_all();
+		}
+	}
+
+	void asset_manager::push_task(std::function<void()> const& task)
+	{
+		// Without worker the task is run directly
+		if(workers.empty()) {
+			task();
+			return;
+		}
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			tasks.push_back(task);
+		}
+		task_available.notify_one();
+	}
+
+	// The errors of the decoding are stored in the future (and raised by get()) when VCL_ERROR_EXCEPTION is defined
+	template <typename T>
+	std::shared_future<T> asset_manager::request(std::map<std::string, std::shared_future<T>>& requests, std::string const& key, std::function<T()> const& decode)
+	{
+		std::shared_ptr<std::packaged_task<T()>> task;
+		std::shared_future<T> future;
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			auto const it = requests.find(key);
+			if(it!=requests.end())
+				return it->second;
+			task = std::make_shared<std::packaged_task<T()>>(decode);
+			future = task->get_future().share();
+			requests[key] = future;
+		}
+		push_task([task](){ (*task)(); });
+		return future;
+	}
+
+	std::shared_future<mesh> asset_manager::load_mesh(std::string const& filename)
+	{
+		return request<mesh>(meshes, filename, [filename](){ return load_mesh_file(filename); });
+	}
+
+	std::shared_future<image_raw> asset_manager::load_image(std::string const& filename)
+	{
+		return request<image_raw>(images, filename, [filename](){ return image_load_png(filename); });
+	}
+
+	std::shared_future<std::string> asset_manager::load_text(std::string const& filename)
+	{
+		return request<std::string>(texts, filename, [filename](){ return load_text_file(filename); });
+	}
+
+	asset_handle<mesh_drawable> asset_manager::load_mesh_drawable(std::string const& filename)
+	{
+		auto const it = drawables.find(filename);
+		if(it!=drawables.end())
+			return it->second;
+
+		asset_handle<mesh_drawable> handle;
+		handle.state = std::make_shared<asset_handle<mesh_drawable>::asset_state>();
+		drawables[filename] = handle;
+
+		std::shared_future<mesh> const data = load_mesh(filename);
+		uploads.push_back({ [data](){ return is_decoded(data); },
+			[data, handle](){
+				handle.state->value = mesh_drawable(data.get());
+				handle.state->ready = true;
+			}});
+		return handle;
+	}
+
+	asset_handle<GLuint> asset_manager::load_texture(std::string const& filename, GLint wrap_s, GLint wrap_t)
+	{
+		std::string const key = filename+" "+str(wrap_s)+" "+str(wrap_t);
+		auto const it = textures.find(key);
+		if(it!=textures.end())
+			return it->second;
+
+		asset_handle<GLuint> handle;
+		handle.state = std::make_shared<asset_handle<GLuint>::asset_state>();
+		textures[key] = handle;
+
+		std::shared_future<image_raw> const data = load_image(filename);
+		uploads.push_back({ [data](){ return is_decoded(data); },
+			[data, handle, wrap_s, wrap_t](){
+				handle.state->value = opengl_texture_to_gpu(data.get(), wrap_s, wrap_t);
+				handle.state->ready = true;
+			}});
+		return handle;
+	}
+
+	asset_handle<GLuint> asset_manager::load_shader(std::string const& vertex_filename, std::string const& fragment_filename)
+	{
+		std::string const key = vertex_filename+"\n"+fragment_filename;
+		auto const it = shaders.find(key);
+		if(it!=shaders.end())
+			return it->second;
+
+		asset_handle<GLuint> handle;
+		handle.state = std::make_shared<asset_handle<GLuint>::asset_state>();
+		shaders[key] = handle;
+
+		std::shared_future<std::string> const vertex = load_text(vertex_filename);
+		std::shared_future<std::string> const fragment = load_text(fragment_filename);
+		uploads.push_back({ [vertex, fragment](){ return is_decoded(vertex) && is_decoded(fragment); },
+			[vertex, fragment, handle](){
+				handle.state->value = opengl_create_shader_program(vertex.get(), fragment.get());
+				handle.state->ready = true;
+			}});
+		return handle;
+	}
+
+	size_t asset_manager::upload(double time_budget_ms)
+	{
+		auto const start = std::chrono::steady_clock::now();
+		size_t N_created = 0;
+		auto it = uploads.begin();
+		while(it!=uploads.end())
+		{
+			if(N_created>0) {
+				double const elapsed_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now()-start).count();
+				if(elapsed_ms>=time_budget_ms)
+					break;
+			}
+			if(!it->decoded()) {
+				++it;
+				continue;
+			}
+
+			// Removed before the creation: an error is raised only once
+			std::function<void()> const create = std::move(it->create);
+			it = uploads.erase(it);
+			create();
+			N_created++;
+		}
+		return N_created;
+	}
+
+	size_t asset_manager::pending_upload() const
+	{
+		return uploads.size();
+	}
+
+	void asset_manager::finish()
+	{
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			tasks_done.wait(lock, [this](){ return tasks.empty() && running_tasks==0; });
+		}
+		while(!uploads.empty())
+			upload(1e30);
+	}
+}
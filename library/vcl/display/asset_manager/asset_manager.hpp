@@ -0,0 +1,106 @@
+#pragma once
+
+#include "vcl/base/base.hpp"
+#include "vcl/display/opengl/opengl.hpp"
+#include "vcl/display/image/image.hpp"
+#include "vcl/display/drawable/mesh_drawable/mesh_drawable.hpp"
+#include "vcl/shape/mesh/mesh.hpp"
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace vcl
+{
+	/** GPU object created by asset_manager::upload on the main thread
+	* The handles of the same asset share their value, which is valid once ready() is true. */
+	template <typename T>
+	struct asset_handle
+	{
+		struct asset_state
+		{
+			T value;
+			bool ready = false;
+		};
+		std::shared_ptr<asset_state> state;
+
+		bool ready() const { return state!=nullptr && state->ready; }
+		T const& get() const { assert_vcl(ready(), "Asset is not uploaded yet"); return state->value; }
+		T& get() { assert_vcl(ready(), "Asset is not uploaded yet"); return state->value; }
+	};
+
+	/** Asynchronous loading of the assets of a scene
+	* The files are decoded by worker threads, while the OpenGL objects are created on the main thread by upload(), called once per frame
+	*  with a time budget: the first frames can be displayed while the assets are streamed in.
+	* Requests for the same file (even while it is being decoded) return the same future or handle.
+	* ex.
+	*   asset_manager assets;
+	*   asset_handle<mesh_drawable> dragon = assets.load_mesh_drawable("assets/dragon.obj");
+	*   asset_handle<GLuint> texture = assets.load_texture("assets/dragon.png");
+	*   // animation loop
+	*   assets.upload();
+	*   if(dragon.ready() && texture.ready()) { dragon.get().texture = texture.get(); draw(dragon.get(), scene); } */
+	struct asset_manager
+	{
+		/** Start the worker threads (thread_count=0: one less than the number of threads of the parallel loops, at least one) */
+		explicit asset_manager(size_t thread_count=0);
+		/** Stop the workers once their current decoding is done (the requests not started yet are dropped) */
+		~asset_manager();
+
+		asset_manager(asset_manager const&) = delete;
+		asset_manager& operator=(asset_manager const&) = delete;
+
+		/** CPU data decoded on the worker threads (can be called from any thread) */
+		std::shared_future<mesh> load_mesh(std::string const& filename);       // obj, ply or stl file
+		std::shared_future<image_raw> load_image(std::string const& filename); // png file
+		std::shared_future<std::string> load_text(std::string const& filename); // ex. shader source
+
+		/** GPU objects: the files are decoded on the worker threads, then the objects are created by upload() (main thread only) */
+		asset_handle<mesh_drawable> load_mesh_drawable(std::string const& filename);
+		asset_handle<GLuint> load_texture(std::string const& filename, GLint wrap_s=GL_CLAMP_TO_EDGE, GLint wrap_t=GL_CLAMP_TO_EDGE);
+		asset_handle<GLuint> load_shader(std::string const& vertex_filename, std::string const& fragment_filename);
+
+		/** Create the GPU objects of the decoded assets, in the order of the requests, until the time budget (in milliseconds) is spent
+		* At least one object is created per call if one is ready. Returns the number of created objects. */
+		size_t upload(double time_budget_ms=2.0);
+		/** Number of GPU objects not created yet */
+		size_t pending_upload() const;
+		/** Wait for the decoding of all the requests and create all the GPU objects (synchronous loading) */
+		void finish();
+
+	private:
+		struct upload_task
+		{
+			std::function<bool()> decoded;
+			std::function<void()> create;
+		};
+
+		template <typename T> std::shared_future<T> request(std::map<std::string, std::shared_future<T>>& requests, std::string const& key, std::function<T()> const& decode);
+		void push_task(std::function<void()> const& task);
+		void worker_loop();
+
+		std::vector<std::thread> workers;
+		std::deque<std::function<void()>> tasks;
+		size_t running_tasks = 0;
+		bool stop = false;
+		std::mutex mutex;
+		std::condition_variable task_available;
+		std::condition_variable tasks_done;
+
+		std::map<std::string, std::shared_future<mesh>> meshes;
+		std::map<std::string, std::shared_future<image_raw>> images;
+		std::map<std::string, std::shared_future<std::string>> texts;
+
+		std::map<std::string, asset_handle<mesh_drawable>> drawables;
+		std::map<std::string, asset_handle<GLuint>> textures;
+		std::map<std::string, asset_handle<GLuint>> shaders;
+		std::deque<upload_task> uploads;
+	};
+}
@@ -3,4 +3,10 @@
 #include "opengl/opengl.hpp"
 #include "window/window.hpp"
 #include "drawable/drawable.hpp"
-#include "image/image.hpp"
\ No newline at end of file
+#include "render_queue/render_queue.hpp"
+#include "image/image.hpp"
+#include "image/cache/image_cache.hpp"
+#include "image/convert/image_convert.hpp"
+#include "image/resample/image_resample.hpp"
+#include "image/compress/image_compress.hpp"
+#include "asset_manager/asset_manager.hpp"
\ No newline at end of file
@@ -16,9 +16,9 @@ namespace vcl
 		number_position = static_cast<GLuint>(position.size());
 
 		glGenVertexArrays(1,&vao); opengl_check
-		glBindVertexArray(vao);    opengl_check
+		opengl_bind_vertex_array(vao);
 		opengl_set_vertex_attribute(vbo_position, 0, 3, GL_FLOAT);
-		glBindVertexArray(0);      opengl_check
+		opengl_bind_vertex_array(0);
 	}
 	void curve_drawable::update(buffer<vec3> const& new_position)
 	{
@@ -30,7 +30,7 @@ namespace vcl
 		glDeleteBuffers(1, &vbo_position ); 
 		vbo_position = 0;
 
-		glDeleteVertexArrays(1, &vao);
+		opengl_delete_vertex_array(vao);
 		vao = 0;
 		opengl_check;
 		
@@ -37,7 +37,7 @@ namespace vcl
 	{
 		// Setup shader
 		assert_vcl(drawable.shader!=0, "Try to draw curve_drawable without shader");
-		glUseProgram(drawable.shader); opengl_check;
+		opengl_use_program(drawable.shader);
 
 		// Send uniforms for this shader
 		opengl_uniform(drawable.shader, scene);
@@ -46,10 +46,7 @@ namespace vcl
 
 		// Call draw function
 		assert_vcl(drawable.number_position>0, "Try to draw mesh_wireframe_drawable with 0 position"); opengl_check;
-		glBindVertexArray(drawable.vao); opengl_check;
+		opengl_bind_vertex_array(drawable.vao);
 		glDrawArrays(GL_LINE_STRIP, 0, drawable.number_position); opengl_check;
-
-		// Clean buffers
-		glBindVertexArray(0);
 	}
 }
\ No newline at end of file
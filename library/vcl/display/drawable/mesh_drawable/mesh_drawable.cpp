@@ -2,68 +2,214 @@
 
 #include "vcl/base/base.hpp"
 
+#include <cstddef>
+
 namespace vcl
 {
 	GLuint mesh_drawable::default_shader = 0;
 	GLuint mesh_drawable::default_texture = 0;
 
 
+	buffer<mesh_vertex_interleaved> mesh_vertex_interleaved_data(mesh const& data)
+	{
+		size_t const N = data.position.size();
+		buffer<mesh_vertex_interleaved> vertices(N);
+		for(size_t k=0; k<N; ++k) {
+			mesh_vertex_interleaved& v = vertices[k];
+			v.position = data.position[k];
+			v.normal = k<data.normal.size()? data.normal[k] : vec3(0,0,1);
+			v.color = k<data.color.size()? data.color[k] : vec3(1,1,1);
+			v.uv = k<data.uv.size()? data.uv[k] : vec2(0,0);
+		}
+		return vertices;
+	}
+
+
+	mesh_drawable_shared_buffer::mesh_drawable_shared_buffer()
+		:vbo_vertex(0), vbo_index(0), vertex_capacity(0), index_capacity(0), vertex_used(0), index_used(0)
+	{}
+
+	void mesh_drawable_shared_buffer::initialize(size_t vertex_capacity_arg, size_t index_capacity_arg, GLenum draw_type)
+	{
+		assert_vcl(vertex_capacity_arg>0 && index_capacity_arg>0, "Empty mesh_drawable_shared_buffer");
+		clear();
+
+		// The element buffer binding is part of the VAO: don't modify the last one bound
+		opengl_bind_vertex_array(0);
+		glGenBuffers(1, &vbo_vertex); opengl_check;
+		glBindBuffer(GL_ARRAY_BUFFER, vbo_vertex); opengl_check;
+		glBufferData(GL_ARRAY_BUFFER, GLsizeiptr(vertex_capacity_arg), nullptr, draw_type); opengl_check;
+		glBindBuffer(GL_ARRAY_BUFFER, 0); opengl_check;
+		glGenBuffers(1, &vbo_index); opengl_check;
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, vbo_index); opengl_check;
+		glBufferData(GL_ELEMENT_ARRAY_BUFFER, GLsizeiptr(index_capacity_arg), nullptr, draw_type); opengl_check;
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0); opengl_check;
+
+		vertex_capacity = vertex_capacity_arg;
+		index_capacity = index_capacity_arg;
+	}
+
+	void mesh_drawable_shared_buffer::clear()
+	{
+		opengl_delete_buffer(vbo_vertex);
+		opengl_delete_buffer(vbo_index);
+		vertex_capacity = 0;
+		index_capacity = 0;
+		vertex_used = 0;
+		index_used = 0;
+	}
+
+	size_t mesh_drawable_shared_buffer::push_vertex(void const* data, size_t size)
+	{
+		assert_vcl(vbo_vertex!=0, "mesh_drawable_shared_buffer is not initialized");
+		if(vertex_used+size>vertex_capacity)
+			error_vcl("mesh_drawable_shared_buffer is full ("+str(vertex_capacity)+" Bytes of vertices): increase vertex_capacity");
+		size_t const offset = vertex_used;
+		glBindBuffer(GL_ARRAY_BUFFER, vbo_vertex); opengl_check;
+		glBufferSubData(GL_ARRAY_BUFFER, GLintptr(offset), GLsizeiptr(size), data); opengl_check;
+		glBindBuffer(GL_ARRAY_BUFFER, 0); opengl_check;
+		vertex_used += size;
+		return offset;
+	}
+
+	size_t mesh_drawable_shared_buffer::push_index(void const* data, size_t size)
+	{
+		assert_vcl(vbo_index!=0, "mesh_drawable_shared_buffer is not initialized");
+		if(index_used+size>index_capacity)
+			error_vcl("mesh_drawable_shared_buffer is full ("+str(index_capacity)+" Bytes of indices): increase index_capacity");
+		size_t const offset = index_used;
+		opengl_bind_vertex_array(0);
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, vbo_index); opengl_check;
+		glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, GLintptr(offset), GLsizeiptr(size), data); opengl_check;
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0); opengl_check;
+		index_used += size;
+		return offset;
+	}
+
+
 	mesh_drawable::mesh_drawable()
-		:vbo(), vao(0), shader(0), texture(0), transform(), shading()
+		:vbo_dynamic(0), vbo_vertex(0), vbo_index(0), vao(0), layout(mesh_drawable_layout::dynamic_position), shared_buffer(false), index_offset(0),
+		 number_vertices(0), number_triangles(0), shader(0), texture(0), transform(), shading()
 	{}
 
-	mesh_drawable::mesh_drawable(mesh const& data_to_send, GLuint shader_arg, GLuint texture_arg, GLuint draw_type)
-		:vbo(), vao(0), shader(shader_arg), texture(texture_arg), transform(), shading()
+	mesh_drawable::mesh_drawable(mesh const& data_to_send, GLuint shader_arg, GLuint texture_arg, GLuint draw_type, mesh_drawable_layout layout_arg)
+		:vbo_dynamic(0), vbo_vertex(0), vbo_index(0), vao(0), layout(layout_arg), shared_buffer(false), index_offset(0),
+		 number_vertices(0), number_triangles(0), shader(shader_arg), texture(texture_arg), transform(), shading()
 	{
 		// Sanity check OpenGL
 		opengl_check;
 		// Sanity check before sending mesh data to GPU
 		assert_vcl(mesh_check(data_to_send), "Cannot send this mesh data to GPU");
 
-		// Fill vbo for position
-		opengl_create_gl_buffer_data(GL_ARRAY_BUFFER, vbo["position"], data_to_send.position, draw_type);
-		opengl_create_gl_buffer_data(GL_ARRAY_BUFFER, vbo["normal"], data_to_send.normal, draw_type);
-		opengl_create_gl_buffer_data(GL_ARRAY_BUFFER, vbo["color"], data_to_send.color, draw_type);
-		opengl_create_gl_buffer_data(GL_ARRAY_BUFFER, vbo["uv"], data_to_send.uv, draw_type);
-		opengl_create_gl_buffer_data(GL_ELEMENT_ARRAY_BUFFER, vbo["index"], data_to_send.connectivity, draw_type);
+		buffer<mesh_vertex_interleaved> const vertices = mesh_vertex_interleaved_data(data_to_send);
+		size_t const N = vertices.size();
+		number_vertices = static_cast<GLuint>(N);
+		number_triangles = static_cast<GLuint>(data_to_send.connectivity.size());
+		opengl_create_gl_buffer_data(GL_ELEMENT_ARRAY_BUFFER, vbo_index, data_to_send.connectivity, draw_type);
+
+		glGenVertexArrays(1,&vao); opengl_check
+		if(layout==mesh_drawable_layout::interleaved)
+		{
+			glGenBuffers(1, &vbo_vertex); opengl_check;
+			glBindBuffer(GL_ARRAY_BUFFER, vbo_vertex); opengl_check;
+			glBufferData(GL_ARRAY_BUFFER, GLsizeiptr(N*sizeof(mesh_vertex_interleaved)), vertices.data.data(), draw_type); opengl_check;
+			glBindBuffer(GL_ARRAY_BUFFER, 0); opengl_check;
+
+			GLsizei const stride = sizeof(mesh_vertex_interleaved);
+			opengl_bind_vertex_array(vao);
+			opengl_set_vertex_attribute(vbo_vertex, 0, 3, GL_FLOAT, GL_FALSE, stride, offsetof(mesh_vertex_interleaved, position));
+			opengl_set_vertex_attribute(vbo_vertex, 1, 3, GL_FLOAT, GL_FALSE, stride, offsetof(mesh_vertex_interleaved, normal));
+			opengl_set_vertex_attribute(vbo_vertex, 2, 3, GL_FLOAT, GL_FALSE, stride, offsetof(mesh_vertex_interleaved, color));
+			opengl_set_vertex_attribute(vbo_vertex, 3, 2, GL_FLOAT, GL_FALSE, stride, offsetof(mesh_vertex_interleaved, uv));
+		}
+		else
+		{
+			// Positions in [0,N[ and normals in [N,2N[ of the dynamic buffer
+			buffer<vec3> dynamic(2*N);
+			buffer<mesh_vertex_static> static_vertices(N);
+			for(size_t k=0; k<N; ++k) {
+				dynamic[k] = vertices[k].position;
+				dynamic[N+k] = vertices[k].normal;
+				static_vertices[k].color = vertices[k].color;
+				static_vertices[k].uv = vertices[k].uv;
+			}
+			opengl_create_gl_buffer_data(GL_ARRAY_BUFFER, vbo_dynamic, dynamic, draw_type);
+			glGenBuffers(1, &vbo_vertex); opengl_check;
+			glBindBuffer(GL_ARRAY_BUFFER, vbo_vertex); opengl_check;
+			glBufferData(GL_ARRAY_BUFFER, GLsizeiptr(N*sizeof(mesh_vertex_static)), static_vertices.data.data(), GL_STATIC_DRAW); opengl_check;
+			glBindBuffer(GL_ARRAY_BUFFER, 0); opengl_check;
+
+			GLsizei const stride = sizeof(mesh_vertex_static);
+			opengl_bind_vertex_array(vao);
+			opengl_set_vertex_attribute(vbo_dynamic, 0, 3, GL_FLOAT, GL_FALSE, 0, 0);
+			opengl_set_vertex_attribute(vbo_dynamic, 1, 3, GL_FLOAT, GL_FALSE, 0, N*sizeof(vec3));
+			opengl_set_vertex_attribute(vbo_vertex, 2, 3, GL_FLOAT, GL_FALSE, stride, offsetof(mesh_vertex_static, color));
+			opengl_set_vertex_attribute(vbo_vertex, 3, 2, GL_FLOAT, GL_FALSE, stride, offsetof(mesh_vertex_static, uv));
+		}
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, vbo_index); opengl_check; // stored in the VAO
+		opengl_bind_vertex_array(0);
+	}
+
+	mesh_drawable::mesh_drawable(mesh const& data_to_send, mesh_drawable_shared_buffer& shared, GLuint shader_arg, GLuint texture_arg)
+		:vbo_dynamic(0), vbo_vertex(shared.vbo_vertex), vbo_index(shared.vbo_index), vao(0), layout(mesh_drawable_layout::interleaved), shared_buffer(true), index_offset(0),
+		 number_vertices(0), number_triangles(0), shader(shader_arg), texture(texture_arg), transform(), shading()
+	{
+		opengl_check;
+		assert_vcl(mesh_check(data_to_send), "Cannot send this mesh data to GPU");
 
-		// Store number of triangles
+		buffer<mesh_vertex_interleaved> const vertices = mesh_vertex_interleaved_data(data_to_send);
+		number_vertices = static_cast<GLuint>(vertices.size());
 		number_triangles = static_cast<GLuint>(data_to_send.connectivity.size());
+		size_t const vertex_offset = shared.push_vertex(vertices.data.data(), vertices.size()*sizeof(mesh_vertex_interleaved));
+		index_offset = shared.push_index(data_to_send.connectivity.data.data(), data_to_send.connectivity.size()*sizeof(uint3));
 
-		// Generate VAO
+		// The attributes start at the first vertex of the mesh: the indices are kept relative to the mesh
+		GLsizei const stride = sizeof(mesh_vertex_interleaved);
 		glGenVertexArrays(1,&vao); opengl_check
-		glBindVertexArray(vao);    opengl_check
-		opengl_set_vertex_attribute(vbo["position"], 0, 3, GL_FLOAT);
-		opengl_set_vertex_attribute(vbo["normal"],   1, 3, GL_FLOAT);
-		opengl_set_vertex_attribute(vbo["color"],    2, 3, GL_FLOAT);
-		opengl_set_vertex_attribute(vbo["uv"],       3, 2, GL_FLOAT);
-		glBindVertexArray(0);      opengl_check
+		opengl_bind_vertex_array(vao);
+		opengl_set_vertex_attribute(vbo_vertex, 0, 3, GL_FLOAT, GL_FALSE, stride, vertex_offset+offsetof(mesh_vertex_interleaved, position));
+		opengl_set_vertex_attribute(vbo_vertex, 1, 3, GL_FLOAT, GL_FALSE, stride, vertex_offset+offsetof(mesh_vertex_interleaved, normal));
+		opengl_set_vertex_attribute(vbo_vertex, 2, 3, GL_FLOAT, GL_FALSE, stride, vertex_offset+offsetof(mesh_vertex_interleaved, color));
+		opengl_set_vertex_attribute(vbo_vertex, 3, 2, GL_FLOAT, GL_FALSE, stride, vertex_offset+offsetof(mesh_vertex_interleaved, uv));
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, vbo_index); opengl_check; // stored in the VAO
+		opengl_bind_vertex_array(0);
 	}
 
 
 	mesh_drawable& mesh_drawable::update_position(buffer<vec3> const& new_position)
 	{
-		glBindBuffer(GL_ARRAY_BUFFER,vbo["position"]); opengl_check;
+		assert_vcl(layout==mesh_drawable_layout::dynamic_position, "update_position requires a mesh_drawable with the layout dynamic_position");
+		assert_vcl(new_position.size()==number_vertices, "Incorrect number of positions in update_position");
+		glBindBuffer(GL_ARRAY_BUFFER,vbo_dynamic); opengl_check;
 		glBufferSubData(GL_ARRAY_BUFFER,0,size_in_memory(new_position),ptr(new_position));  opengl_check;
 		return *this;
 	}
 	mesh_drawable& mesh_drawable::update_normal(buffer<vec3> const& new_normals)
 	{
-		glBindBuffer(GL_ARRAY_BUFFER,vbo["normal"]); opengl_check;
-		glBufferSubData(GL_ARRAY_BUFFER,0,size_in_memory(new_normals),ptr(new_normals));  opengl_check;
+		assert_vcl(layout==mesh_drawable_layout::dynamic_position, "update_normal requires a mesh_drawable with the layout dynamic_position");
+		assert_vcl(new_normals.size()==number_vertices, "Incorrect number of normals in update_normal");
+		glBindBuffer(GL_ARRAY_BUFFER,vbo_dynamic); opengl_check;
+		glBufferSubData(GL_ARRAY_BUFFER,GLintptr(number_vertices*sizeof(vec3)),size_in_memory(new_normals),ptr(new_normals));  opengl_check;
 		return *this;
 	}
 
 	void mesh_drawable::clear()
 	{
-		for(auto& buffer : vbo)
-			glDeleteBuffers(1, &(buffer.second) ); 
-		vbo.clear();
+		if(!shared_buffer) {
+			opengl_delete_buffer(vbo_dynamic);
+			opengl_delete_buffer(vbo_vertex);
+			opengl_delete_buffer(vbo_index);
+		}
+		vbo_dynamic = 0;
+		vbo_vertex = 0;
+		vbo_index = 0;
+		shared_buffer = false;
+		index_offset = 0;
 
-		glDeleteVertexArrays(1, &vao);
-		vao = 0;
+		opengl_delete_vertex_array(vao);
 		opengl_check;
 		
+		number_vertices = 0;
 		number_triangles = 0;
 		shader = 0;
 		texture = 0;
@@ -71,4 +217,32 @@ namespace vcl
 		shading = shading_parameters_phong();
 	}
 
+	uniform_block_object opengl_uniform_block(mesh_drawable const& drawable)
+	{
+		uniform_block_object block;
+		block.model = drawable.transform.matrix();
+		block.color = vec4(drawable.shading.color, drawable.shading.alpha);
+		block.phong = vec4(drawable.shading.phong.ambient, drawable.shading.phong.diffuse, drawable.shading.phong.specular, drawable.shading.phong.specular_exponent);
+		block.use_texture = drawable.shading.use_texture? 1 : 0;
+		block.texture_inverse_y = drawable.shading.texture_inverse_y? 1 : 0;
+		block.padding[0] = 0;
+		block.padding[1] = 0;
+		return block;
+	}
+
+	void draw(mesh_drawable const& drawable, uniform_buffer_range const& object)
+	{
+		assert_vcl(drawable.shader!=0, "Try to draw mesh_drawable without shader");
+		assert_vcl(drawable.texture!=0, "Try to draw mesh_drawable without texture");
+		assert_vcl(drawable.number_triangles>0, "Try to draw mesh_drawable with 0 triangles");
+		opengl_use_program(drawable.shader);
+		opengl_bind_uniform_block(opengl_uniform_block_object, object);
+
+		// The sampler image_texture uses the default texture unit 0
+		opengl_bind_texture(drawable.texture);
+
+		opengl_bind_vertex_array(drawable.vao);
+		glDrawElements(GL_TRIANGLES, GLsizei(drawable.number_triangles*3), GL_UNSIGNED_INT, reinterpret_cast<void const*>(drawable.index_offset)); opengl_check;
+	}
+
 }
\ No newline at end of file
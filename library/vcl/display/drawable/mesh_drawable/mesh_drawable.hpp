@@ -1,23 +1,82 @@
 #pragma once
 
-#include <map>
-#include <string>
 #include "vcl/display/opengl/opengl.hpp"
 #include "vcl/shape/mesh/mesh.hpp"
 #include "vcl/display/drawable/shading_parameters/shading_parameters.hpp"
 
 namespace vcl
 {
+	/** Organization of the vertex attributes of a mesh_drawable in the GPU buffers */
+	enum class mesh_drawable_layout
+	{
+		/** Position and normal in a buffer that can be updated (update_position, update_normal), color and uv interleaved in a second buffer */
+		dynamic_position,
+		/** All the attributes interleaved in a single buffer (static geometry) */
+		interleaved
+	};
+
+	/** Vertex of the interleaved layout (44 Bytes) */
+	struct mesh_vertex_interleaved
+	{
+		vec3 position;
+		vec3 normal;
+		vec3 color;
+		vec2 uv;
+	};
+	/** Static attributes of the dynamic_position layout (20 Bytes) */
+	struct mesh_vertex_static
+	{
+		vec3 color;
+		vec2 uv;
+	};
+
+	/** Vertex and index buffers shared by several small static meshes
+	* Each mesh_drawable created with the shared buffer takes a consecutive range (interleaved layout), the ranges are released all together by clear().
+	* ex.
+	*   mesh_drawable_shared_buffer rocks_buffer; rocks_buffer.initialize(4<<20, 1<<20);
+	*   for(auto const& m : rock_meshes) rocks.push_back(mesh_drawable(m, rocks_buffer)); */
+	struct mesh_drawable_shared_buffer
+	{
+		mesh_drawable_shared_buffer();
+
+		/** Allocate the buffers (capacities in Bytes) */
+		void initialize(size_t vertex_capacity, size_t index_capacity, GLenum draw_type=GL_STATIC_DRAW);
+		/** Delete the buffers: the mesh_drawable using them must not be drawn anymore */
+		void clear();
+
+		/** Copy data at the end of the used part of the buffer and return its offset in Bytes */
+		size_t push_vertex(void const* data, size_t size);
+		size_t push_index(void const* data, size_t size);
+
+		GLuint vbo_vertex;
+		GLuint vbo_index;
+		size_t vertex_capacity;
+		size_t index_capacity;
+		size_t vertex_used;
+		size_t index_used;
+	};
+
 	struct mesh_drawable
 	{
 		mesh_drawable();
-		// Send mesh data to GPU and store IDs into vbo. Set also shader and texture.
-		explicit mesh_drawable(mesh const& data_to_send, GLuint shader=default_shader, GLuint texture=default_texture, GLuint draw_type=GL_DYNAMIC_DRAW);
-
-		// Stores VBO ID in GPU_elements_id
-		std::map<std::string, GLuint> vbo;
+		// Send mesh data to GPU with the given layout. Set also shader and texture.
+		explicit mesh_drawable(mesh const& data_to_send, GLuint shader=default_shader, GLuint texture=default_texture, GLuint draw_type=GL_DYNAMIC_DRAW, mesh_drawable_layout layout=mesh_drawable_layout::dynamic_position);
+		// Copy the mesh data in a shared buffer (interleaved layout)
+		mesh_drawable(mesh const& data_to_send, mesh_drawable_shared_buffer& shared_buffer, GLuint shader=default_shader, GLuint texture=default_texture);
+
+		// Buffers of the vertex attributes (0 if not used by the layout)
+		GLuint vbo_dynamic; // position then normal (dynamic_position)
+		GLuint vbo_vertex;  // interleaved mesh_vertex_static (dynamic_position) or mesh_vertex_interleaved (interleaved)
+		GLuint vbo_index;
 		GLuint vao;
 
+		mesh_drawable_layout layout;
+		/** The buffers belong to a mesh_drawable_shared_buffer (they are not deleted by clear) */
+		bool shared_buffer;
+		/** Offset in Bytes of the triangles in vbo_index */
+		size_t index_offset;
+
+		GLuint number_vertices;
 		GLuint number_triangles;
 		GLuint shader;
 		GLuint texture;
@@ -31,10 +90,14 @@ namespace vcl
 		static GLuint default_texture;
 
 		void clear();
+		/** Replace the positions/normals (layout dynamic_position only) */
 		mesh_drawable& update_position(buffer<vec3> const& new_position);
 		mesh_drawable& update_normal(buffer<vec3> const& new_normal);
 	};
 
+	/** Vertex attributes of the mesh with default values for the missing ones (normal (0,0,1), color (1,1,1), uv (0,0)) */
+	buffer<mesh_vertex_interleaved> mesh_vertex_interleaved_data(mesh const& data);
+
 	//void send_data_to_gpu(mesh_drawable& to_fill, mesh const& data_to_send, GLuint draw_type=GL_DYNAMIC_DRAW);
 
 	template <typename SCENE>
@@ -42,6 +105,12 @@ namespace vcl
 
 	template <typename SCENE>
 	void draw_wireframe(mesh_drawable const& drawable, SCENE const& scene, vec3 const& color={0,0,1});
+
+	/** Per-object data of the drawable (transform and shading) for the block object_data */
+	uniform_block_object opengl_uniform_block(mesh_drawable const& drawable);
+	/** Draw with a shader using the blocks scene_data and object_data (ex. preset mesh_ubo)
+	* The scene block is bound once per frame, object is the range of opengl_uniform_block(drawable) in a uniform buffer: no uniform is sent. */
+	void draw(mesh_drawable const& drawable, uniform_buffer_range const& object);
 }
 
 
@@ -53,27 +122,23 @@ namespace vcl
 		// Setup shader
 		assert_vcl(drawable.shader!=0, "Try to draw mesh_drawable without shader");
 		assert_vcl(drawable.texture!=0, "Try to draw mesh_drawable without texture");
-		glUseProgram(drawable.shader); opengl_check;
+		opengl_use_program(drawable.shader);
 
 		// Send uniforms for this shader
+		static opengl_uniform_name const model("model");
+		static opengl_uniform_name const image_texture("image_texture");
 		opengl_uniform(drawable.shader, scene);
 		opengl_uniform(drawable.shader, drawable.shading);
-		opengl_uniform(drawable.shader, "model", drawable.transform.matrix());
+		opengl_uniform(drawable.shader, model, drawable.transform.matrix());
 
 		// Set texture
-		glActiveTexture(GL_TEXTURE0); opengl_check;
-		glBindTexture(GL_TEXTURE_2D, drawable.texture); opengl_check;
-		opengl_uniform(drawable.shader, "image_texture", 0);  opengl_check;
+		opengl_bind_texture(drawable.texture);
+		opengl_uniform(drawable.shader, image_texture, 0);  opengl_check;
 		
 		// Call draw function
 		assert_vcl(drawable.number_triangles>0, "Try to draw mesh_drawable with 0 triangles"); opengl_check;
-		glBindVertexArray(drawable.vao);   opengl_check;
-		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, drawable.vbo.at("index")); opengl_check;
-		glDrawElements(GL_TRIANGLES, GLsizei(drawable.number_triangles*3), GL_UNSIGNED_INT, nullptr); opengl_check;
-
-		// Clean buffers
-		glBindVertexArray(0);
-		glBindTexture(GL_TEXTURE_2D, 0);
+		opengl_bind_vertex_array(drawable.vao);
+		glDrawElements(GL_TRIANGLES, GLsizei(drawable.number_triangles*3), GL_UNSIGNED_INT, reinterpret_cast<void const*>(drawable.index_offset)); opengl_check;
 	}
 
 	template <typename SCENE>
@@ -83,11 +148,11 @@ namespace vcl
 		wireframe.shading.phong = {1.0f,0.0f,0.0f,64.0f};
 		wireframe.shading.color = color;
 		wireframe.shading.use_texture = false;
-		glPolygonMode( GL_FRONT_AND_BACK, GL_LINE );
-		glEnable(GL_POLYGON_OFFSET_LINE);
-		glPolygonOffset(-1.0, 1.0);
+		opengl_polygon_mode(GL_LINE);
+		opengl_enable(GL_POLYGON_OFFSET_LINE);
+		opengl_polygon_offset(-1.0f, 1.0f);
 		draw(wireframe, scene);
-		glDisable(GL_POLYGON_OFFSET_LINE);
-		glPolygonMode( GL_FRONT_AND_BACK, GL_FILL );
+		opengl_enable(GL_POLYGON_OFFSET_LINE, false);
+		opengl_polygon_mode(GL_FILL);
 	}
 }
\ No newline at end of file
@@ -0,0 +1,136 @@
+#include "mesh_instanced_drawable.hpp"
+
+#include "vcl/base/base.hpp"
+
+#include <algorithm>
+#include <cstddef>
+
+namespace vcl
+{
+	GLuint mesh_instanced_drawable::default_shader = 0;
+	GLuint mesh_instanced_drawable::default_texture = 0;
+
+	namespace
+	{
+		void set_instance_color(mesh_instance_data& instance, buffer<vec3> const& color, size_t k)
+		{
+			vec3 const c = color.size()>0? color[k] : vec3(1,1,1);
+			for(size_t i=0; i<3; ++i)
+				instance.color[i] = static_cast<unsigned char>(255*std::min(std::max(c[i],0.0f),1.0f)+0.5f);
+			instance.color[3] = 255;
+		}
+	}
+
+	mesh_instanced_drawable::mesh_instanced_drawable()
+		:vbo_vertex(0), vbo_index(0), vbo_instance(0), vao(0), number_triangles(0), number_instances(0), shader(0), texture(0), transform(), shading(), capacity_instances(0), instances()
+	{}
+
+	mesh_instanced_drawable::mesh_instanced_drawable(mesh const& data_to_send, GLuint shader_arg, GLuint texture_arg, GLuint draw_type)
+		:vbo_vertex(0), vbo_index(0), vbo_instance(0), vao(0), number_triangles(0), number_instances(0), shader(shader_arg), texture(texture_arg), transform(), shading(), capacity_instances(0), instances()
+	{
+		// Sanity check OpenGL
+		opengl_check;
+		// Sanity check before sending mesh data to GPU
+		assert_vcl(mesh_check(data_to_send), "Cannot send this mesh data to GPU");
+
+		// Interleaved vertices of the mesh
+		buffer<mesh_vertex_interleaved> const vertices = mesh_vertex_interleaved_data(data_to_send);
+		glGenBuffers(1, &vbo_vertex); opengl_check;
+		glBindBuffer(GL_ARRAY_BUFFER, vbo_vertex); opengl_check;
+		glBufferData(GL_ARRAY_BUFFER, GLsizeiptr(vertices.size()*sizeof(mesh_vertex_interleaved)), vertices.data.data(), draw_type); opengl_check;
+		glBindBuffer(GL_ARRAY_BUFFER, 0); opengl_check;
+		opengl_create_gl_buffer_data(GL_ELEMENT_ARRAY_BUFFER, vbo_index, data_to_send.connectivity, draw_type);
+		number_triangles = static_cast<GLuint>(data_to_send.connectivity.size());
+
+		// Empty instance buffer, allocated by update_instances
+		glGenBuffers(1, &vbo_instance); opengl_check;
+
+		// Generate VAO
+		GLsizei const stride_vertex = sizeof(mesh_vertex_interleaved);
+		GLsizei const stride_instance = sizeof(mesh_instance_data);
+		glGenVertexArrays(1,&vao); opengl_check
+		opengl_bind_vertex_array(vao);
+		opengl_set_vertex_attribute(vbo_vertex, 0, 3, GL_FLOAT, GL_FALSE, stride_vertex, offsetof(mesh_vertex_interleaved, position));
+		opengl_set_vertex_attribute(vbo_vertex, 1, 3, GL_FLOAT, GL_FALSE, stride_vertex, offsetof(mesh_vertex_interleaved, normal));
+		opengl_set_vertex_attribute(vbo_vertex, 2, 3, GL_FLOAT, GL_FALSE, stride_vertex, offsetof(mesh_vertex_interleaved, color));
+		opengl_set_vertex_attribute(vbo_vertex, 3, 2, GL_FLOAT, GL_FALSE, stride_vertex, offsetof(mesh_vertex_interleaved, uv));
+		for(GLuint k=0; k<3; ++k)
+			opengl_set_vertex_attribute(vbo_instance, 4+k, 4, GL_FLOAT, GL_FALSE, stride_instance, offsetof(mesh_instance_data, row)+k*sizeof(vec4));
+		opengl_set_vertex_attribute(vbo_instance, 7, 4, GL_UNSIGNED_BYTE, GL_TRUE, stride_instance, offsetof(mesh_instance_data, color));
+		for(GLuint k=4; k<8; ++k) {
+			glVertexAttribDivisor(k, 1); opengl_check;
+		}
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, vbo_index); opengl_check; // stored in the VAO
+		opengl_bind_vertex_array(0);
+	}
+
+	mesh_instanced_drawable& mesh_instanced_drawable::update_instances(buffer<mat4> const& instance_transform, buffer<vec3> const& instance_color)
+	{
+		size_t const N = instance_transform.size();
+		assert_vcl(instance_color.size()==0 || instance_color.size()==N, "Incorrect number of instance colors");
+		instances.resize(N);
+		parallel_for(N, [&](size_t k) {
+			mat4 const& M = instance_transform[k];
+			for(size_t i=0; i<3; ++i)
+				instances[k].row[i] = M(i);
+			set_instance_color(instances[k], instance_color, k);
+		}, 4096);
+		upload_instances();
+		return *this;
+	}
+
+	mesh_instanced_drawable& mesh_instanced_drawable::update_instances(buffer<affine_rts> const& instance_transform, buffer<vec3> const& instance_color)
+	{
+		size_t const N = instance_transform.size();
+		assert_vcl(instance_color.size()==0 || instance_color.size()==N, "Incorrect number of instance colors");
+		instances.resize(N);
+		parallel_for(N, [&](size_t k) {
+			mat4 const M = instance_transform[k].matrix();
+			for(size_t i=0; i<3; ++i)
+				instances[k].row[i] = M(i);
+			set_instance_color(instances[k], instance_color, k);
+		}, 4096);
+		upload_instances();
+		return *this;
+	}
+
+	void mesh_instanced_drawable::upload_instances()
+	{
+		assert_vcl(vbo_instance!=0, "Try to update the instances of an uninitialized mesh_instanced_drawable");
+		size_t const N = instances.size();
+		GLsizeiptr const size = GLsizeiptr(N*sizeof(mesh_instance_data));
+
+		glBindBuffer(GL_ARRAY_BUFFER, vbo_instance); opengl_check;
+		if(N>capacity_instances) {
+			glBufferData(GL_ARRAY_BUFFER, size, instances.data.data(), GL_DYNAMIC_DRAW); opengl_check;
+			capacity_instances = N;
+		}
+		else if(N>0) {
+			// Orphan the previous storage: the driver doesn't wait for the draws still reading it
+			glBufferData(GL_ARRAY_BUFFER, GLsizeiptr(capacity_instances*sizeof(mesh_instance_data)), nullptr, GL_DYNAMIC_DRAW); opengl_check;
+			glBufferSubData(GL_ARRAY_BUFFER, 0, size, instances.data.data()); opengl_check;
+		}
+		glBindBuffer(GL_ARRAY_BUFFER, 0); opengl_check;
+
+		number_instances = static_cast<GLuint>(N);
+	}
+
+	void mesh_instanced_drawable::clear()
+	{
+		opengl_delete_buffer(vbo_vertex);
+		opengl_delete_buffer(vbo_index);
+		opengl_delete_buffer(vbo_instance);
+
+		opengl_delete_vertex_array(vao);
+		opengl_check;
+
+		number_triangles = 0;
+		number_instances = 0;
+		capacity_instances = 0;
+		instances.clear();
+		shader = 0;
+		texture = 0;
+		transform = affine_rts();
+		shading = shading_parameters_phong();
+	}
+}
@@ -0,0 +1,97 @@
+#pragma once
+
+#include "vcl/display/opengl/opengl.hpp"
+#include "vcl/shape/mesh/mesh.hpp"
+#include "vcl/display/drawable/shading_parameters/shading_parameters.hpp"
+#include "vcl/display/drawable/mesh_drawable/mesh_drawable.hpp"
+
+namespace vcl
+{
+	/** Per-instance data in the instance buffer: the 3 first rows of the affine matrix and a color (52 Bytes) */
+	struct mesh_instance_data
+	{
+		vec4 row[3];
+		unsigned char color[4]; // rgb, 255
+	};
+
+	/** Mesh drawn N times in a single call (glDrawElementsInstanced)
+	* The transform of each instance is stored in a per-instance vertex buffer (attributes 4,5,6: rows of the matrix, 7: color),
+	*  the final model matrix of an instance is transform.matrix() * instance.
+	* Expects a shader reading the instance attributes (shader preset "mesh_instanced_vertex" with "mesh_fragment").
+	* ex.
+	*   mesh_instanced_drawable grass(mesh_primitive_quadrangle(...), shader_instanced);
+	*   grass.update_instances(transforms, colors); // each time the instances change
+	*   draw(grass, scene); */
+	struct mesh_instanced_drawable
+	{
+		mesh_instanced_drawable();
+		// Send mesh data to GPU (interleaved mesh_vertex_interleaved). Set also shader and texture. There is no instance until update_instances.
+		explicit mesh_instanced_drawable(mesh const& data_to_send, GLuint shader=default_shader, GLuint texture=default_texture, GLuint draw_type=GL_STATIC_DRAW);
+
+		GLuint vbo_vertex;
+		GLuint vbo_index;
+		GLuint vbo_instance;
+		GLuint vao;
+
+		GLuint number_triangles;
+		GLuint number_instances;
+		GLuint shader;
+		GLuint texture;
+
+		// Uniform
+		affine_rts transform;
+		shading_parameters_phong shading;
+
+		static GLuint default_shader;
+		static GLuint default_texture;
+
+		void clear();
+
+		/** Replace the instances: one transform per instance, and optionally one color per instance (white otherwise)
+		* The buffer is reallocated only when the number of instances exceeds its capacity. */
+		mesh_instanced_drawable& update_instances(buffer<mat4> const& instance_transform, buffer<vec3> const& instance_color=buffer<vec3>());
+		mesh_instanced_drawable& update_instances(buffer<affine_rts> const& instance_transform, buffer<vec3> const& instance_color=buffer<vec3>());
+
+	private:
+		void upload_instances();
+
+		/** Number of instances allocated in vbo_instance */
+		size_t capacity_instances;
+		buffer<mesh_instance_data> instances;
+	};
+
+	template <typename SCENE>
+	void draw(mesh_instanced_drawable const& drawable, SCENE const& scene);
+}
+
+
+namespace vcl
+{
+	template <typename SCENE>
+	void draw(mesh_instanced_drawable const& drawable, SCENE const& scene)
+	{
+		if(drawable.number_instances==0)
+			return;
+
+		// Setup shader
+		assert_vcl(drawable.shader!=0, "Try to draw mesh_instanced_drawable without shader");
+		assert_vcl(drawable.texture!=0, "Try to draw mesh_instanced_drawable without texture");
+		opengl_use_program(drawable.shader);
+
+		// Send uniforms for this shader
+		static opengl_uniform_name const model("model");
+		static opengl_uniform_name const image_texture("image_texture");
+		opengl_uniform(drawable.shader, scene);
+		opengl_uniform(drawable.shader, drawable.shading);
+		opengl_uniform(drawable.shader, model, drawable.transform.matrix());
+
+		// Set texture
+		opengl_bind_texture(drawable.texture);
+		opengl_uniform(drawable.shader, image_texture, 0);  opengl_check;
+
+		// Call draw function
+		assert_vcl(drawable.number_triangles>0, "Try to draw mesh_instanced_drawable with 0 triangles"); opengl_check;
+		opengl_bind_vertex_array(drawable.vao);
+		glDrawElementsInstanced(GL_TRIANGLES, GLsizei(drawable.number_triangles*3), GL_UNSIGNED_INT, nullptr, GLsizei(drawable.number_instances)); opengl_check;
+	}
+}
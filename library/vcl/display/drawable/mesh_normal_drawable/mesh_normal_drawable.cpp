@@ -32,9 +32,9 @@ namespace vcl
 		// Generate VAO
 		GLuint& vao = gpu_elements_id["vao"];
 		glGenVertexArrays(1,&vao); opengl_check
-		glBindVertexArray(vao);    opengl_check
+		opengl_bind_vertex_array(vao);
 		opengl_set_vertex_attribute(gpu_elements_id["vbo_position"], 0, 3, GL_FLOAT);
-		glBindVertexArray(0);      opengl_check
+		opengl_bind_vertex_array(0);
 
 	}
 }
\ No newline at end of file
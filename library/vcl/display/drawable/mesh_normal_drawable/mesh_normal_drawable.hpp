@@ -30,7 +30,7 @@ namespace vcl
 	{
 		// Setup shader
 		assert_vcl(drawable.shader!=0, "Try to draw mesh_wireframe_drawable without shader");
-		glUseProgram(drawable.shader); opengl_check;
+		opengl_use_program(drawable.shader);
 
 		// Send uniforms for this shader
 		opengl_uniform(drawable.shader, scene);
@@ -39,11 +39,7 @@ namespace vcl
 
 		// Call draw function
 		assert_vcl(drawable.number_normals>0, "Try to draw mesh_wireframe_drawable with 0 edges"); opengl_check;
-		glBindVertexArray(drawable.gpu_elements_id.at("vao")); opengl_check;
+		opengl_bind_vertex_array(drawable.gpu_elements_id.at("vao"));
 		glDrawArrays(GL_LINES, 0, 2*drawable.number_normals); opengl_check;
-
-		// Clean buffers
-		glBindVertexArray(0);
-		glBindTexture(GL_TEXTURE_2D, 0);
 	}
 }
\ No newline at end of file
@@ -0,0 +1,59 @@
+#include "mesh_quantized_drawable.hpp"
+
+#include "vcl/base/base.hpp"
+
+#include <cstddef>
+
+namespace vcl
+{
+	GLuint mesh_quantized_drawable::default_shader = 0;
+	GLuint mesh_quantized_drawable::default_texture = 0;
+
+	mesh_quantized_drawable::mesh_quantized_drawable()
+		:vbo_vertex(0), vbo_index(0), vao(0), number_triangles(0), shader(0), texture(0), position_offset(), position_scale(), transform(), shading()
+	{}
+
+	mesh_quantized_drawable::mesh_quantized_drawable(mesh const& data_to_send, GLuint shader_arg, GLuint texture_arg, GLuint draw_type)
+		:mesh_quantized_drawable(mesh_quantize(data_to_send), shader_arg, texture_arg, draw_type)
+	{}
+
+	mesh_quantized_drawable::mesh_quantized_drawable(mesh_quantized const& data_to_send, GLuint shader_arg, GLuint texture_arg, GLuint draw_type)
+		:vbo_vertex(0), vbo_index(0), vao(0), number_triangles(0), shader(shader_arg), texture(texture_arg), position_offset(data_to_send.position_offset), position_scale(data_to_send.position_scale), transform(), shading()
+	{
+		opengl_check;
+		assert_vcl(data_to_send.vertex.size()>0, "Cannot send empty mesh to GPU");
+
+		// Interleaved vertex buffer
+		glGenBuffers(1, &vbo_vertex); opengl_check;
+		glBindBuffer(GL_ARRAY_BUFFER, vbo_vertex); opengl_check;
+		glBufferData(GL_ARRAY_BUFFER, GLsizeiptr(data_to_send.vertex.size()*sizeof(vertex_quantized)), data_to_send.vertex.data.data(), draw_type); opengl_check;
+		glBindBuffer(GL_ARRAY_BUFFER, 0); opengl_check;
+
+		opengl_create_gl_buffer_data(GL_ELEMENT_ARRAY_BUFFER, vbo_index, data_to_send.connectivity, draw_type);
+		number_triangles = static_cast<GLuint>(data_to_send.connectivity.size());
+
+		// Generate VAO
+		GLsizei const stride = sizeof(vertex_quantized);
+		glGenVertexArrays(1,&vao); opengl_check
+		opengl_bind_vertex_array(vao);
+		opengl_set_vertex_attribute(vbo_vertex, 0, 3, GL_UNSIGNED_SHORT, GL_TRUE, stride, offsetof(vertex_quantized, position));
+		opengl_set_vertex_attribute(vbo_vertex, 1, 2, GL_BYTE, GL_TRUE, stride, offsetof(vertex_quantized, normal));
+		opengl_set_vertex_attribute(vbo_vertex, 2, 4, GL_UNSIGNED_BYTE, GL_TRUE, stride, offsetof(vertex_quantized, color));
+		opengl_set_vertex_attribute(vbo_vertex, 3, 2, GL_HALF_FLOAT, GL_FALSE, stride, offsetof(vertex_quantized, uv));
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, vbo_index); opengl_check; // stored in the VAO
+		opengl_bind_vertex_array(0);
+	}
+
+	void mesh_quantized_drawable::clear()
+	{
+		opengl_delete_buffer(vbo_vertex);
+		opengl_delete_buffer(vbo_index);
+		opengl_delete_vertex_array(vao);
+
+		number_triangles = 0;
+		shader = 0;
+		texture = 0;
+		transform = affine_rts();
+		shading = shading_parameters_phong();
+	}
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include "vcl/display/opengl/opengl.hpp"
+#include "vcl/shape/mesh/mesh.hpp"
+#include "vcl/display/drawable/shading_parameters/shading_parameters.hpp"
+
+namespace vcl
+{
+	/** Drawable storing the mesh with compressed vertex attributes (16 Bytes per vertex) in a single interleaved buffer
+	* Expects a shader decoding the attributes (shader preset "mesh_quantized_vertex" with "mesh_fragment") */
+	struct mesh_quantized_drawable
+	{
+		mesh_quantized_drawable();
+		// Quantize the mesh and send the data to GPU. Set also shader and texture.
+		explicit mesh_quantized_drawable(mesh const& data_to_send, GLuint shader=default_shader, GLuint texture=default_texture, GLuint draw_type=GL_STATIC_DRAW);
+		explicit mesh_quantized_drawable(mesh_quantized const& data_to_send, GLuint shader=default_shader, GLuint texture=default_texture, GLuint draw_type=GL_STATIC_DRAW);
+
+		GLuint vbo_vertex;
+		GLuint vbo_index;
+		GLuint vao;
+
+		GLuint number_triangles;
+		GLuint shader;
+		GLuint texture;
+
+		// Dequantization of the positions (sent as uniform)
+		vec3 position_offset;
+		vec3 position_scale;
+
+		// Uniform
+		affine_rts transform;
+		shading_parameters_phong shading;
+
+		static GLuint default_shader;
+		static GLuint default_texture;
+
+		void clear();
+	};
+
+	template <typename SCENE>
+	void draw(mesh_quantized_drawable const& drawable, SCENE const& scene);
+}
+
+
+namespace vcl
+{
+	template <typename SCENE>
+	void draw(mesh_quantized_drawable const& drawable, SCENE const& scene)
+	{
+		// Setup shader
+		assert_vcl(drawable.shader!=0, "Try to draw mesh_quantized_drawable without shader");
+		assert_vcl(drawable.texture!=0, "Try to draw mesh_quantized_drawable without texture");
+		opengl_use_program(drawable.shader);
+
+		// Send uniforms for this shader
+		static opengl_uniform_name const model("model");
+		static opengl_uniform_name const image_texture("image_texture");
+		static opengl_uniform_name const position_offset("position_offset");
+		static opengl_uniform_name const position_scale("position_scale");
+		opengl_uniform(drawable.shader, scene);
+		opengl_uniform(drawable.shader, drawable.shading);
+		opengl_uniform(drawable.shader, model, drawable.transform.matrix());
+		opengl_uniform(drawable.shader, position_offset, drawable.position_offset);
+		opengl_uniform(drawable.shader, position_scale, drawable.position_scale);
+
+		// Set texture
+		opengl_bind_texture(drawable.texture);
+		opengl_uniform(drawable.shader, image_texture, 0);  opengl_check;
+
+		// Call draw function
+		assert_vcl(drawable.number_triangles>0, "Try to draw mesh_quantized_drawable with 0 triangles"); opengl_check;
+		opengl_bind_vertex_array(drawable.vao);
+		glDrawElements(GL_TRIANGLES, GLsizei(drawable.number_triangles*3), GL_UNSIGNED_INT, nullptr); opengl_check;
+	}
+}
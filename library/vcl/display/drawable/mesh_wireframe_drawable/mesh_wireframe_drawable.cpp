@@ -35,9 +35,9 @@ namespace vcl
 
 		// Generate VAO
 		glGenVertexArrays(1,&vao); opengl_check
-		glBindVertexArray(vao);    opengl_check
+		opengl_bind_vertex_array(vao);
 		opengl_set_vertex_attribute(vbo_position, 0, 3, GL_FLOAT);
-		glBindVertexArray(0);      opengl_check
+		opengl_bind_vertex_array(0);
 
 	}
 
@@ -65,7 +65,7 @@ namespace vcl
 	void mesh_wireframe_drawable::clear()
 	{
 		glDeleteBuffers(1, &vbo_position); vbo_position = 0; opengl_check;
-		glDeleteVertexArrays(1, &vao); vao=0;  opengl_check;
+		opengl_delete_vertex_array(vao); vao=0;  opengl_check;
 		number_edges = 0;
 		shader = 0;
 		transform = affine_rts();
@@ -34,7 +34,7 @@ namespace vcl
 	{
 		// Setup shader
 		assert_vcl(drawable.shader!=0, "Try to draw mesh_wireframe_drawable without shader");
-		glUseProgram(drawable.shader); opengl_check;
+		opengl_use_program(drawable.shader);
 
 		// Send uniforms for this shader
 		opengl_uniform(drawable.shader, scene);
@@ -43,10 +43,7 @@ namespace vcl
 
 		// Call draw function
 		assert_vcl(drawable.number_edges>0, "Try to draw mesh_wireframe_drawable with 0 edges"); opengl_check;
-		glBindVertexArray(drawable.vao); opengl_check;
+		opengl_bind_vertex_array(drawable.vao);
 		glDrawArrays(GL_LINES, 0, 2*drawable.number_edges); opengl_check;
-
-		// Clean buffers
-		glBindVertexArray(0);
 	}
 }
\ No newline at end of file
@@ -9,13 +9,22 @@ namespace vcl
 {
 	void opengl_uniform(GLuint shader, shading_parameters_phong const& shading)
 	{
-		opengl_uniform(shader, "color", shading.color);
-		opengl_uniform(shader, "alpha", shading.alpha);
-		opengl_uniform(shader, "Ka", shading.phong.ambient);
-		opengl_uniform(shader, "Kd", shading.phong.diffuse);
-		opengl_uniform(shader, "Ks", shading.phong.specular);
-		opengl_uniform(shader, "specular_exp", shading.phong.specular_exponent);
-		opengl_uniform(shader, "use_texture", shading.use_texture);
-		opengl_uniform(shader, "texture_inverse_y", shading.texture_inverse_y);
+		static opengl_uniform_name const color("color");
+		static opengl_uniform_name const alpha("alpha");
+		static opengl_uniform_name const Ka("Ka");
+		static opengl_uniform_name const Kd("Kd");
+		static opengl_uniform_name const Ks("Ks");
+		static opengl_uniform_name const specular_exp("specular_exp");
+		static opengl_uniform_name const use_texture("use_texture");
+		static opengl_uniform_name const texture_inverse_y("texture_inverse_y");
+
+		opengl_uniform(shader, color, shading.color);
+		opengl_uniform(shader, alpha, shading.alpha);
+		opengl_uniform(shader, Ka, shading.phong.ambient);
+		opengl_uniform(shader, Kd, shading.phong.diffuse);
+		opengl_uniform(shader, Ks, shading.phong.specular);
+		opengl_uniform(shader, specular_exp, shading.phong.specular_exponent);
+		opengl_uniform(shader, use_texture, shading.use_texture);
+		opengl_uniform(shader, texture_inverse_y, shading.texture_inverse_y);
 	}
 }
\ No newline at end of file
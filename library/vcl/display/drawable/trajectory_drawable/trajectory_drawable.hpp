@@ -26,7 +26,7 @@ namespace vcl
 		if(trajectory.current_size>0){
 			// Setup shader
 			assert_vcl(trajectory.visual.shader!=0, "Try to draw curve_drawable without shader");
-			glUseProgram(trajectory.visual.shader); opengl_check;
+			opengl_use_program(trajectory.visual.shader);
 
 			// Send uniforms for this shader
 			opengl_uniform(trajectory.visual.shader, scene);
@@ -35,11 +35,8 @@ namespace vcl
 
 			// Call draw function
 		
-			glBindVertexArray(trajectory.visual.vao); opengl_check;
+			opengl_bind_vertex_array(trajectory.visual.vao);
 			glDrawArrays(GL_LINE_STRIP, 0, GLsizei(trajectory.current_size) ); opengl_check;
-
-			// Clean buffers
-			glBindVertexArray(0);
 		}
 	}
 }
\ No newline at end of file
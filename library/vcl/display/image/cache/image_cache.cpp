@@ -0,0 +1,221 @@
+#include "image_cache.hpp"
+
+#include "vcl/base/base.hpp"
+#include "vcl/files/files.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+
+namespace vcl
+{
+	namespace
+	{
+		char const image_cache_magic[8] = {'V','C','L','I','M','A','G','E'};
+		uint32_t const image_cache_version = 1;
+		size_t const image_cache_max_level = 32;
+
+		// Header of a .vclimage file, followed by the pixels of each level (each one aligned on 16 bytes)
+		struct image_cache_header {
+			file_cache_header cache;
+			uint32_t width;
+			uint32_t height;
+			uint32_t channels;
+			uint32_t level_count;
+			uint64_t offset[image_cache_max_level];
+		};
+
+		unsigned int channel_count(image_color_type color_type)
+		{
+			return color_type==image_color_type::rgba? 4 : 3;
+		}
+
+		uint64_t options_key(image_color_type color_type, image_cache_options const& options)
+		{
+			return uint64_t(channel_count(color_type)) | (options.mipmap? 256 : 0);
+		}
+
+		// Header expected for the cache of the source file
+		bool source_key(std::string const& filename, image_color_type color_type, image_cache_options const& options, image_cache_header& header)
+		{
+			return file_cache_header_set(header.cache, filename, image_cache_magic, image_cache_version, sizeof(image_cache_header), options_key(color_type, options));
+		}
+
+		void level_dimension(uint32_t width, uint32_t height, uint32_t level, uint32_t& level_width, uint32_t& level_height)
+		{
+			level_width = std::max(uint32_t(1), width>>level);
+			level_height = std::max(uint32_t(1), height>>level);
+		}
+
+		uint32_t mipmap_level_count(uint32_t width, uint32_t height)
+		{
+			uint32_t N = 1;
+			while((width>>N)>0 || (height>>N)>0)
+				N++;
+			return N;
+		}
+
+		// Check the header of a mapped cache against the source file
+		bool image_cache_check(mapped_file const& file, image_cache_header const& key, image_cache_header& header)
+		{
+			if(file.size<sizeof(image_cache_header))
+				return false;
+			std::memcpy(&header, file.data, sizeof(image_cache_header));
+			if(!file_cache_header_match(header.cache, key.cache))
+				return false;
+			if(header.level_count<1 || header.level_count>image_cache_max_level || (header.channels!=3 && header.channels!=4))
+				return false;
+
+			for(uint32_t k=0; k<header.level_count; ++k) {
+				uint32_t w=0, h=0;
+				level_dimension(header.width, header.height, k, w, h);
+				uint64_t const size = uint64_t(w)*h*header.channels;
+				if(header.offset[k]%16!=0 || header.offset[k]<sizeof(image_cache_header) || header.offset[k]+size>file.size)
+					return false;
+			}
+			return true;
+		}
+	}
+
+	image_raw image_mipmap_level(image_raw const& im)
+	{
+		unsigned int const C = channel_count(im.color_type);
+		unsigned int const w = std::max(1u, im.width/2);
+		unsigned int const h = std::max(1u, im.height/2);
+
+		image_raw level(w, h, im.color_type, buffer<unsigned char>());
+		level.data.resize(size_t(w)*h*C);
+		if(im.width==0 || im.height==0)
+			return level;
+		parallel_for(h, [&](size_t j){
+			size_t const j0 = std::min(size_t(2*j), size_t(im.height-1));
+			size_t const j1 = std::min(size_t(2*j+1), size_t(im.height-1));
+			for(size_t i=0; i<w; ++i) {
+				size_t const i0 = std::min(size_t(2*i), size_t(im.width-1));
+				size_t const i1 = std::min(size_t(2*i+1), size_t(im.width-1));
+				for(size_t c=0; c<C; ++c) {
+					unsigned int const sum = im.data.data[(j0*im.width+i0)*C+c] + im.data.data[(j0*im.width+i1)*C+c]
+						+ im.data.data[(j1*im.width+i0)*C+c] + im.data.data[(j1*im.width+i1)*C+c];
+					level.data.data[(j*w+i)*C+c] = static_cast<unsigned char>((sum+2)/4);
+				}
+			}
+		}, 16);
+		return level;
+	}
+
+	std::string image_cache_filename(std::string const& filename, image_cache_options const& options)
+	{
+		return file_cache_filename(filename, options.directory, ".vclimage");
+	}
+
+	bool image_cache_open(std::string const& filename, image_cache_view& view, image_color_type color_type, image_cache_options const& options)
+	{
+		view = image_cache_view();
+
+		image_cache_header key, header;
+		if(!source_key(filename, color_type, options, key))
+			return false;
+		if(!view.file.open(image_cache_filename(filename, options)) || !image_cache_check(view.file, key, header)) {
+			view.file.close();
+			return false;
+		}
+
+		view.color_type = color_type;
+		view.level.resize(header.level_count);
+		for(uint32_t k=0; k<header.level_count; ++k) {
+			image_cache_level& level = view.level[k];
+			level_dimension(header.width, header.height, k, level.width, level.height);
+			level.data = reinterpret_cast<unsigned char const*>(view.file.data+header.offset[k]);
+		}
+		return true;
+	}
+
+	bool image_cache_read(std::string const& filename, image_raw& im, image_color_type color_type, image_cache_options const& options)
+	{
+		image_cache_view view;
+		if(!image_cache_open(filename, view, color_type, options))
+			return false;
+
+		image_cache_level const& level = view.level[0];
+		im = image_raw(level.width, level.height, color_type, buffer<unsigned char>());
+		im.data.data.assign(level.data, level.data+size_t(level.width)*level.height*channel_count(color_type));
+		return true;
+	}
+
+	bool image_cache_write(std::string const& filename, image_raw const& im, image_cache_options const& options)
+	{
+		image_cache_header header;
+		std::memset(&header, 0, sizeof(image_cache_header));
+		if(!source_key(filename, im.color_type, options, header))
+			return false;
+		header.width = im.width;
+		header.height = im.height;
+		header.channels = channel_count(im.color_type);
+		header.level_count = options.mipmap? mipmap_level_count(im.width, im.height) : 1;
+		assert_vcl(im.data.size()==size_t(im.width)*im.height*header.channels, "Incorrect size of image data");
+
+		// Levels computed successively from the previous one
+		std::vector<image_raw> mipmap;
+		for(uint32_t k=1; k<header.level_count; ++k)
+			mipmap.push_back(image_mipmap_level(k==1? im : mipmap.back()));
+
+		uint64_t offset = (sizeof(image_cache_header)+15)/16*16;
+		for(uint32_t k=0; k<header.level_count; ++k) {
+			uint32_t w=0, h=0;
+			level_dimension(header.width, header.height, k, w, h);
+			header.offset[k] = offset;
+			offset = (offset+uint64_t(w)*h*header.channels+15)/16*16;
+		}
+
+		buffer<file_chunk> chunks;
+		chunks.push_back({&header, sizeof(image_cache_header), 0});
+		for(uint32_t k=0; k<header.level_count; ++k) {
+			buffer<unsigned char> const& data = (k==0)? im.data : mipmap[k-1].data;
+			chunks.push_back({data.data.data(), data.size(), header.offset[k]});
+		}
+
+		if(!options.directory.empty())
+			directory_create(options.directory);
+		return file_write_atomic(image_cache_filename(filename, options), chunks);
+	}
+
+	static bool image_load_png_cached(std::string const& filename, image_raw& im, std::string& error, image_color_type color_type, image_cache_options const& options)
+	{
+		if(image_cache_read(filename, im, color_type, options)) {
+			error.clear();
+			return true;
+		}
+		if(!image_load_png(filename, im, error, color_type))
+			return false;
+		image_cache_write(filename, im, options);
+		return true;
+	}
+
+	image_raw image_load_png_cached(std::string const& filename, image_color_type color_type, image_cache_options const& options)
+	{
+		assert_file_exist(filename);
+		image_raw im;
+		std::string error;
+		bool const loaded = image_load_png_cached(filename, im, error, color_type, options);
+		assert_vcl(loaded, error);
+		return im;
+	}
+
+	buffer<image_raw> image_load_png_batch_cached(buffer<std::string> const& filenames, buffer<std::string>& errors, image_color_type color_type, image_cache_options const& options)
+	{
+		size_t const N = filenames.size();
+		buffer<image_raw> images;
+		images.resize(N);
+		errors.clear();
+		errors.resize(N);
+
+		// The files have different sizes: each thread takes the next file to load
+		std::atomic<size_t> next(0);
+		parallel_for(parallel_range_count(N, 1), [&](size_t) {
+			for(size_t k=next++; k<N; k=next++)
+				image_load_png_cached(filenames[k], images[k], errors[k], color_type, options);
+		}, 1);
+		return images;
+	}
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include "../image.hpp"
+#include "vcl/files/mapped_file/mapped_file.hpp"
+
+#include <string>
+
+namespace vcl
+{
+	struct image_cache_options
+	{
+		/** Directory storing the cache files (the cache is stored next to the source file if empty) */
+		std::string directory;
+		/** Also store the mipmap levels of the image (2x2 box filter, down to 1x1) */
+		bool mipmap = false;
+	};
+
+	/** Load a png file through its raw cache (.vclimage): header followed by the uncompressed pixels
+	* The cache is used if it matches the path, size and modification time of the file, the color type and the options.
+	* Otherwise the png file is decoded, and the cache is (re)written for the next call. */
+	image_raw image_load_png_cached(std::string const& filename, image_color_type color_type=image_color_type::rgba, image_cache_options const& options=image_cache_options());
+
+	/** Same as image_load_png_batch, going through the cache of each file (the files are decoded only if their cache is outdated) */
+	buffer<image_raw> image_load_png_batch_cached(buffer<std::string> const& filenames, buffer<std::string>& errors, image_color_type color_type=image_color_type::rgba, image_cache_options const& options=image_cache_options());
+
+	/** Path of the cache file associated to an image file */
+	std::string image_cache_filename(std::string const& filename, image_cache_options const& options=image_cache_options());
+
+	/** Read the full resolution image from the cache of an image file. Returns false if the cache doesn't exist or is outdated. */
+	bool image_cache_read(std::string const& filename, image_raw& im, image_color_type color_type=image_color_type::rgba, image_cache_options const& options=image_cache_options());
+	/** Write the cache of an image loaded from filename (with its mipmap levels if required by the options). Returns false if the cache cannot be written. */
+	bool image_cache_write(std::string const& filename, image_raw const& im, image_cache_options const& options=image_cache_options());
+
+
+	/** Level of a mapped image cache (the pixels point directly to the mapped file) */
+	struct image_cache_level
+	{
+		unsigned int width = 0;
+		unsigned int height = 0;
+		unsigned char const* data = nullptr;
+	};
+
+	/** Zero-copy access to a cached image: level[0] is the full resolution image, followed by the mipmap levels if they are stored */
+	struct image_cache_view
+	{
+		mapped_file file;
+		image_color_type color_type = image_color_type::rgba;
+		buffer<image_cache_level> level;
+	};
+
+	/** Map the cache of an image file. Returns false if the cache doesn't exist or is outdated. */
+	bool image_cache_open(std::string const& filename, image_cache_view& view, image_color_type color_type=image_color_type::rgba, image_cache_options const& options=image_cache_options());
+
+	/** Next mipmap level of an image: 2x2 box filter, the dimensions are halved (rounded down, at least 1) */
+	image_raw image_mipmap_level(image_raw const& im);
+}
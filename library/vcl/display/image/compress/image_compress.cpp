@@ -0,0 +1,534 @@
+#include "image_compress.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP>=2)
+#define VCL_IMAGE_SSE
+#include <emmintrin.h>
+#endif
+
+namespace vcl
+{
+	namespace
+	{
+		// Pixels of a 4x4 block, one array per channel (values in [0,255])
+		struct pixel_block
+		{
+			float channel[4][16];
+		};
+
+		// Copy the block (bx,by), the pixels outside of the image repeat the last row/column
+		void fetch_block(image_raw const& im, size_t bx, size_t by, pixel_block& block)
+		{
+			size_t const channels = (im.color_type==image_color_type::rgba)? 4 : 3;
+			unsigned char const* data = im.data.data.data();
+			for(size_t j=0; j<4; ++j) {
+				size_t const y = std::min(size_t(4*by+j), size_t(im.height-1));
+				for(size_t i=0; i<4; ++i) {
+					size_t const x = std::min(size_t(4*bx+i), size_t(im.width-1));
+					unsigned char const* pixel = data + channels*(x+im.width*y);
+					size_t const k = i+4*j;
+					block.channel[0][k] = pixel[0];
+					block.channel[1][k] = pixel[1];
+					block.channel[2][k] = pixel[2];
+					block.channel[3][k] = (channels==4)? pixel[3] : 255.0f;
+				}
+			}
+		}
+
+		void write_u16(unsigned char* p, unsigned int value)
+		{
+			p[0] = static_cast<unsigned char>(value & 0xff);
+			p[1] = static_cast<unsigned char>((value>>8) & 0xff);
+		}
+		unsigned int read_u16(unsigned char const* p)
+		{
+			return p[0] | (unsigned int)(p[1])<<8;
+		}
+
+
+		// ********************************** //
+		// Single channel block (bc4, alpha of bc3)
+		// ********************************** //
+
+		// 8 values of the palette given the two end points (integer interpolation of the decoders)
+		void single_channel_palette(unsigned int v0, unsigned int v1, int palette[8])
+		{
+			palette[0] = int(v0);
+			palette[1] = int(v1);
+			if(v0>v1) {
+				for(int i=1; i<7; ++i)
+					palette[i+1] = (int(v0)*(7-i)+int(v1)*i+3)/7;
+			}
+			else {
+				for(int i=1; i<5; ++i)
+					palette[i+1] = (int(v0)*(5-i)+int(v1)*i+2)/5;
+				palette[6] = 0;
+				palette[7] = 255;
+			}
+		}
+
+		// The end points are the extremes of the block (8 values mode), each value takes its closest entry of the palette
+		void encode_single_channel(float const value[16], unsigned char* out)
+		{
+			float min_value = value[0], max_value = value[0];
+			for(size_t k=1; k<16; ++k) {
+				min_value = std::min(min_value, value[k]);
+				max_value = std::max(max_value, value[k]);
+			}
+			unsigned int const v0 = static_cast<unsigned int>(max_value+0.5f);
+			unsigned int const v1 = static_cast<unsigned int>(min_value+0.5f);
+			out[0] = static_cast<unsigned char>(v0);
+			out[1] = static_cast<unsigned char>(v1);
+
+			uint64_t bits = 0;
+			if(v0>v1) {
+				int palette[8];
+				single_channel_palette(v0, v1, palette);
+				for(size_t k=0; k<16; ++k) {
+					uint64_t best = 0;
+					float best_error = std::numeric_limits<float>::max();
+					for(uint64_t p=0; p<8; ++p) {
+						float const d = std::abs(value[k]-float(palette[p]));
+						if(d<best_error) {
+							best_error = d;
+							best = p;
+						}
+					}
+					bits |= best<<(3*k);
+				}
+			}
+			for(size_t k=0; k<6; ++k)
+				out[2+k] = static_cast<unsigned char>((bits>>(8*k)) & 0xff);
+		}
+
+		void decode_single_channel(unsigned char const* in, unsigned char value[16])
+		{
+			int palette[8];
+			single_channel_palette(in[0], in[1], palette);
+			uint64_t bits = 0;
+			for(size_t k=0; k<6; ++k)
+				bits |= uint64_t(in[2+k])<<(8*k);
+			for(size_t k=0; k<16; ++k)
+				value[k] = static_cast<unsigned char>(palette[(bits>>(3*k)) & 7]);
+		}
+
+
+		// ********************************** //
+		// Color block (bc1, colors of bc3)
+		// ********************************** //
+
+		unsigned int pack_565(float r, float g, float b)
+		{
+			unsigned int const R = static_cast<unsigned int>(std::min(std::max(r*31.0f/255.0f+0.5f, 0.0f), 31.0f));
+			unsigned int const G = static_cast<unsigned int>(std::min(std::max(g*63.0f/255.0f+0.5f, 0.0f), 63.0f));
+			unsigned int const B = static_cast<unsigned int>(std::min(std::max(b*31.0f/255.0f+0.5f, 0.0f), 31.0f));
+			return (R<<11) | (G<<5) | B;
+		}
+		void unpack_565(unsigned int c, int rgb[3])
+		{
+			int const R = (c>>11) & 31, G = (c>>5) & 63, B = c & 31;
+			rgb[0] = (R<<3) | (R>>2);
+			rgb[1] = (G<<2) | (G>>4);
+			rgb[2] = (B<<3) | (B>>2);
+		}
+
+		// Palette of the 4 colors mode: c0, c1, (2c0+c1)/3, (c0+2c1)/3
+		void color_palette(unsigned int c0, unsigned int c1, float palette[4][3])
+		{
+			int p0[3], p1[3];
+			unpack_565(c0, p0);
+			unpack_565(c1, p1);
+			for(size_t d=0; d<3; ++d) {
+				palette[0][d] = float(p0[d]);
+				palette[1][d] = float(p1[d]);
+				palette[2][d] = float((2*p0[d]+p1[d])/3);
+				palette[3][d] = float((p0[d]+2*p1[d])/3);
+			}
+		}
+
+		// Closest color of the palette for each pixel, returns the squared error of the block
+		float color_indices(pixel_block const& block, float const palette[4][3], unsigned int index[16])
+		{
+#ifdef VCL_IMAGE_SSE
+			__m128 total = _mm_setzero_ps();
+			for(size_t k=0; k<16; k+=4) {
+				__m128 const r = _mm_loadu_ps(block.channel[0]+k);
+				__m128 const g = _mm_loadu_ps(block.channel[1]+k);
+				__m128 const b = _mm_loadu_ps(block.channel[2]+k);
+				__m128 best_error = _mm_set1_ps(std::numeric_limits<float>::max());
+				__m128i best = _mm_setzero_si128();
+				for(int p=0; p<4; ++p) {
+					__m128 const dr = _mm_sub_ps(r, _mm_set1_ps(palette[p][0]));
+					__m128 const dg = _mm_sub_ps(g, _mm_set1_ps(palette[p][1]));
+					__m128 const db = _mm_sub_ps(b, _mm_set1_ps(palette[p][2]));
+					__m128 const error = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dr,dr), _mm_mul_ps(dg,dg)), _mm_mul_ps(db,db));
+					__m128 const closer = _mm_cmplt_ps(error, best_error);
+					best_error = _mm_min_ps(error, best_error);
+					__m128i const mask = _mm_castps_si128(closer);
+					best = _mm_or_si128(_mm_and_si128(mask, _mm_set1_epi32(p)), _mm_andnot_si128(mask, best));
+				}
+				total = _mm_add_ps(total, best_error);
+				alignas(16) int best_index[4];
+				_mm_store_si128(reinterpret_cast<__m128i*>(best_index), best);
+				for(size_t i=0; i<4; ++i)
+					index[k+i] = static_cast<unsigned int>(best_index[i]);
+			}
+			alignas(16) float sum[4];
+			_mm_store_ps(sum, total);
+			return sum[0]+sum[1]+sum[2]+sum[3];
+#else
+			float total = 0.0f;
+			for(size_t k=0; k<16; ++k) {
+				float best_error = std::numeric_limits<float>::max();
+				for(unsigned int p=0; p<4; ++p) {
+					float const dr = block.channel[0][k]-palette[p][0];
+					float const dg = block.channel[1][k]-palette[p][1];
+					float const db = block.channel[2][k]-palette[p][2];
+					float const error = dr*dr+dg*dg+db*db;
+					if(error<best_error) {
+						best_error = error;
+						index[k] = p;
+					}
+				}
+				total += best_error;
+			}
+			return total;
+#endif
+		}
+
+		// Least square end points given the indices of the pixels (returns false if the system is singular)
+		bool refine_end_points(pixel_block const& block, unsigned int const index[16], float e0[3], float e1[3])
+		{
+			float const weight[4] = {1.0f, 0.0f, 2.0f/3.0f, 1.0f/3.0f};
+			float aa = 0, ab = 0, bb = 0;
+			float ax[3] = {0,0,0}, bx[3] = {0,0,0};
+			for(size_t k=0; k<16; ++k) {
+				float const a = weight[index[k]];
+				float const b = 1.0f-a;
+				aa += a*a;
+				ab += a*b;
+				bb += b*b;
+				for(size_t d=0; d<3; ++d) {
+					ax[d] += a*block.channel[d][k];
+					bx[d] += b*block.channel[d][k];
+				}
+			}
+			float const det = aa*bb-ab*ab;
+			if(std::abs(det)<1e-6f)
+				return false;
+			for(size_t d=0; d<3; ++d) {
+				e0[d] = (bb*ax[d]-ab*bx[d])/det;
+				e1[d] = (aa*bx[d]-ab*ax[d])/det;
+			}
+			return true;
+		}
+
+		// End points along the principal axis of the colors, slightly inset to reduce the error of the extremes
+		void principal_end_points(pixel_block const& block, float e0[3], float e1[3])
+		{
+			float mean[3] = {0,0,0};
+			for(size_t d=0; d<3; ++d) {
+				for(size_t k=0; k<16; ++k)
+					mean[d] += block.channel[d][k];
+				mean[d] /= 16.0f;
+			}
+			float cov[6] = {0,0,0,0,0,0}; // xx xy xz yy yz zz
+			for(size_t k=0; k<16; ++k) {
+				float const x = block.channel[0][k]-mean[0];
+				float const y = block.channel[1][k]-mean[1];
+				float const z = block.channel[2][k]-mean[2];
+				cov[0] += x*x; cov[1] += x*y; cov[2] += x*z;
+				cov[3] += y*y; cov[4] += y*z; cov[5] += z*z;
+			}
+
+			// Power iteration started from the diagonal of the bounding box
+			float axis[3] = {1,1,1};
+			for(size_t d=0; d<3; ++d) {
+				float const v_min = *std::min_element(block.channel[d], block.channel[d]+16);
+				float const v_max = *std::max_element(block.channel[d], block.channel[d]+16);
+				axis[d] = v_max-v_min;
+			}
+			for(size_t it=0; it<8; ++it) {
+				float const x = cov[0]*axis[0]+cov[1]*axis[1]+cov[2]*axis[2];
+				float const y = cov[1]*axis[0]+cov[3]*axis[1]+cov[4]*axis[2];
+				float const z = cov[2]*axis[0]+cov[4]*axis[1]+cov[5]*axis[2];
+				float const n = std::max(std::max(std::abs(x), std::abs(y)), std::abs(z));
+				if(n<1e-8f)
+					break;
+				axis[0] = x/n; axis[1] = y/n; axis[2] = z/n;
+			}
+			float const norm2 = axis[0]*axis[0]+axis[1]*axis[1]+axis[2]*axis[2];
+
+			float t_min = 0.0f, t_max = 0.0f;
+			if(norm2>1e-8f) {
+				t_min = std::numeric_limits<float>::max();
+				t_max = -t_min;
+				for(size_t k=0; k<16; ++k) {
+					float const t = ((block.channel[0][k]-mean[0])*axis[0]+(block.channel[1][k]-mean[1])*axis[1]+(block.channel[2][k]-mean[2])*axis[2])/norm2;
+					t_min = std::min(t_min, t);
+					t_max = std::max(t_max, t);
+				}
+				float const inset = (t_max-t_min)/16.0f;
+				t_min += inset;
+				t_max -= inset;
+			}
+			for(size_t d=0; d<3; ++d) {
+				e0[d] = mean[d]+t_max*axis[d];
+				e1[d] = mean[d]+t_min*axis[d];
+			}
+		}
+
+		// Always in the 4 colors mode (c0>c1), which is also the only mode of the color blocks of bc3
+		void encode_color(pixel_block const& block, unsigned char* out)
+		{
+			float e0[3], e1[3];
+			principal_end_points(block, e0, e1);
+
+			unsigned int best_c0 = pack_565(e0[0], e0[1], e0[2]);
+			unsigned int best_c1 = pack_565(e1[0], e1[1], e1[2]);
+			unsigned int best_index[16];
+			float palette[4][3];
+			color_palette(best_c0, best_c1, palette);
+			float best_error = color_indices(block, palette, best_index);
+
+			for(size_t it=0; it<2 && best_error>0.0f; ++it) {
+				if(!refine_end_points(block, best_index, e0, e1))
+					break;
+				unsigned int const c0 = pack_565(e0[0], e0[1], e0[2]);
+				unsigned int const c1 = pack_565(e1[0], e1[1], e1[2]);
+				if(c0==best_c0 && c1==best_c1)
+					break;
+				unsigned int index[16];
+				color_palette(c0, c1, palette);
+				float const error = color_indices(block, palette, index);
+				if(error>=best_error)
+					break;
+				best_error = error;
+				best_c0 = c0;
+				best_c1 = c1;
+				std::copy(index, index+16, best_index);
+			}
+
+			// Order the end points: swapping them exchanges the indices 0<->1 and 2<->3
+			if(best_c0<best_c1) {
+				std::swap(best_c0, best_c1);
+				for(size_t k=0; k<16; ++k)
+					best_index[k] ^= 1;
+			}
+			else if(best_c0==best_c1) {
+				for(size_t k=0; k<16; ++k)
+					best_index[k] = 0;
+			}
+
+			uint32_t bits = 0;
+			for(size_t k=0; k<16; ++k)
+				bits |= uint32_t(best_index[k])<<(2*k);
+			write_u16(out, best_c0);
+			write_u16(out+2, best_c1);
+			for(size_t k=0; k<4; ++k)
+				out[4+k] = static_cast<unsigned char>((bits>>(8*k)) & 0xff);
+		}
+
+		// Decode the colors in rgba (the 3 colors mode of bc1 is supported: index 3 is transparent black)
+		void decode_color(unsigned char const* in, unsigned char rgba[16][4], bool four_colors_only)
+		{
+			unsigned int const c0 = read_u16(in);
+			unsigned int const c1 = read_u16(in+2);
+			int p0[3], p1[3];
+			unpack_565(c0, p0);
+			unpack_565(c1, p1);
+			int palette[4][4];
+			for(size_t d=0; d<3; ++d) {
+				palette[0][d] = p0[d];
+				palette[1][d] = p1[d];
+				if(c0>c1 || four_colors_only) {
+					palette[2][d] = (2*p0[d]+p1[d])/3;
+					palette[3][d] = (p0[d]+2*p1[d])/3;
+				}
+				else {
+					palette[2][d] = (p0[d]+p1[d])/2;
+					palette[3][d] = 0;
+				}
+			}
+			for(size_t p=0; p<4; ++p)
+				palette[p][3] = 255;
+			if(!(c0>c1 || four_colors_only))
+				palette[3][3] = 0;
+
+			uint32_t const bits = in[4] | uint32_t(in[5])<<8 | uint32_t(in[6])<<16 | uint32_t(in[7])<<24;
+			for(size_t k=0; k<16; ++k) {
+				int const* color = palette[(bits>>(2*k)) & 3];
+				for(size_t d=0; d<4; ++d)
+					rgba[k][d] = static_cast<unsigned char>(color[d]);
+			}
+		}
+
+
+		void encode_block(pixel_block const& block, image_block_format format, unsigned char* out)
+		{
+			switch(format) {
+			case image_block_format::bc1:
+				encode_color(block, out);
+				break;
+			case image_block_format::bc3:
+				encode_single_channel(block.channel[3], out);
+				encode_color(block, out+8);
+				break;
+			case image_block_format::bc4:
+				encode_single_channel(block.channel[0], out);
+				break;
+			case image_block_format::bc5:
+				encode_single_channel(block.channel[0], out);
+				encode_single_channel(block.channel[1], out+8);
+				break;
+			}
+		}
+
+		void decode_block(unsigned char const* in, image_block_format format, unsigned char rgba[16][4])
+		{
+			unsigned char value[16];
+			switch(format) {
+			case image_block_format::bc1:
+				decode_color(in, rgba, false);
+				break;
+			case image_block_format::bc3:
+				decode_color(in+8, rgba, true);
+				decode_single_channel(in, value);
+				for(size_t k=0; k<16; ++k)
+					rgba[k][3] = value[k];
+				break;
+			case image_block_format::bc4:
+			case image_block_format::bc5:
+				decode_single_channel(in, value);
+				for(size_t k=0; k<16; ++k) {
+					rgba[k][0] = value[k];
+					rgba[k][1] = 0;
+					rgba[k][2] = 0;
+					rgba[k][3] = 255;
+				}
+				if(format==image_block_format::bc5) {
+					decode_single_channel(in+8, value);
+					for(size_t k=0; k<16; ++k)
+						rgba[k][1] = value[k];
+				}
+				break;
+			}
+		}
+
+		size_t format_channel_count(image_block_format format)
+		{
+			switch(format) {
+			case image_block_format::bc1: return 3;
+			case image_block_format::bc3: return 4;
+			case image_block_format::bc4: return 1;
+			case image_block_format::bc5: return 2;
+			}
+			return 4;
+		}
+	}
+
+
+	size_t image_block_size(image_block_format format)
+	{
+		return (format==image_block_format::bc1 || format==image_block_format::bc4)? 8 : 16;
+	}
+
+	image_compressed image_compress(image_raw const& im, image_block_format format)
+	{
+		assert_vcl(im.width>0 && im.height>0, "Cannot compress an empty image");
+		size_t const channels = (im.color_type==image_color_type::rgba)? 4 : 3;
+		assert_vcl(im.data.size()==channels*im.width*im.height, "Incoherent size of image data");
+
+		image_compressed compressed;
+		compressed.format = format;
+		compressed.width = im.width;
+		compressed.height = im.height;
+
+		size_t const blocks_x = (im.width+3)/4;
+		size_t const blocks_y = (im.height+3)/4;
+		size_t const block_size = image_block_size(format);
+		compressed.data.resize(blocks_x*blocks_y*block_size);
+
+		unsigned char* out = compressed.data.data.data();
+		parallel_for(blocks_y, [&](size_t by){
+			pixel_block block;
+			for(size_t bx=0; bx<blocks_x; ++bx) {
+				fetch_block(im, bx, by, block);
+				encode_block(block, format, out + (bx+blocks_x*by)*block_size);
+			}
+		}, 4);
+
+		return compressed;
+	}
+
+	buffer<image_compressed> image_compress(buffer<image_raw> const& mipmap, image_block_format format)
+	{
+		buffer<image_compressed> compressed(mipmap.size());
+		for(size_t k=0; k<mipmap.size(); ++k)
+			compressed[k] = image_compress(mipmap[k], format);
+		return compressed;
+	}
+
+	image_raw image_decompress(image_compressed const& compressed)
+	{
+		size_t const blocks_x = (compressed.width+3)/4;
+		size_t const blocks_y = (compressed.height+3)/4;
+		size_t const block_size = image_block_size(compressed.format);
+		assert_vcl(compressed.data.size()==blocks_x*blocks_y*block_size, "Incoherent size of compressed data");
+
+		image_raw im;
+		im.width = compressed.width;
+		im.height = compressed.height;
+		im.color_type = image_color_type::rgba;
+		im.data.resize(4*size_t(im.width)*im.height);
+
+		unsigned char const* in = compressed.data.data.data();
+		unsigned char* out = im.data.data.data();
+		parallel_for(blocks_y, [&](size_t by){
+			unsigned char rgba[16][4];
+			for(size_t bx=0; bx<blocks_x; ++bx) {
+				decode_block(in + (bx+blocks_x*by)*block_size, compressed.format, rgba);
+				for(size_t j=0; j<4 && 4*by+j<im.height; ++j)
+					for(size_t i=0; i<4 && 4*bx+i<im.width; ++i)
+						std::copy(rgba[i+4*j], rgba[i+4*j]+4, out + 4*((4*bx+i)+im.width*(4*by+j)));
+			}
+		}, 4);
+
+		return im;
+	}
+
+	double image_psnr(image_raw const& reference, image_raw const& im, size_t channel_count)
+	{
+		assert_vcl(reference.width==im.width && reference.height==im.height, "Images of different dimensions");
+		size_t const channels_reference = (reference.color_type==image_color_type::rgba)? 4 : 3;
+		size_t const channels_im = (im.color_type==image_color_type::rgba)? 4 : 3;
+		assert_vcl(channel_count>0 && channel_count<=std::min(channels_reference, channels_im), "Invalid number of channels");
+
+		size_t const N = size_t(im.width)*im.height;
+		unsigned char const* a = reference.data.data.data();
+		unsigned char const* b = im.data.data.data();
+		double sum = 0.0;
+		for(size_t k=0; k<N; ++k) {
+			for(size_t d=0; d<channel_count; ++d) {
+				double const e = double(a[channels_reference*k+d])-double(b[channels_im*k+d]);
+				sum += e*e;
+			}
+		}
+		double const mse = sum/double(N*channel_count);
+		if(mse==0.0)
+			return std::numeric_limits<double>::infinity();
+		return 10.0*std::log10(255.0*255.0/mse);
+	}
+
+	double image_compression_psnr(image_raw const& reference, image_compressed const& compressed)
+	{
+		size_t channel_count = format_channel_count(compressed.format);
+		if(reference.color_type==image_color_type::rgb)
+			channel_count = std::min(channel_count, size_t(3));
+		return image_psnr(reference, image_decompress(compressed), channel_count);
+	}
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include "../image.hpp"
+
+namespace vcl
+{
+	/** Block compression formats of the GPU (4x4 pixels per block)
+	* bc1: rgb, 8 bytes per block (6x smaller than rgb, 8x than rgba)
+	* bc3: rgba, 16 bytes per block (bc1 colors and bc4 alpha)
+	* bc4: single channel (red), 8 bytes per block
+	* bc5: two channels (red, green - ex. normal maps), 16 bytes per block */
+	enum class image_block_format {bc1, bc3, bc4, bc5};
+
+	/** Image stored as compressed blocks, in the layout expected by glCompressedTexImage2D */
+	struct image_compressed
+	{
+		image_block_format format = image_block_format::bc1;
+		unsigned int width = 0;
+		unsigned int height = 0;
+		/** Blocks of 4x4 pixels row by row (the last blocks of the rows and columns are padded by repeating the border pixels) */
+		buffer<unsigned char> data;
+	};
+
+	/** Size in bytes of a block (8 or 16) */
+	size_t image_block_size(image_block_format format);
+
+	/** Encode an image in blocks (the rows of blocks are encoded in parallel)
+	* bc1 and bc3 fit the colors along their principal axis then refine the end points by least squares, bc4 and bc5 use the range of each channel. */
+	image_compressed image_compress(image_raw const& im, image_block_format format);
+	/** Encode all the levels of a mipmap chain (ex. from image_mipmap_chain) */
+	buffer<image_compressed> image_compress(buffer<image_raw> const& mipmap, image_block_format format);
+
+	/** Decode the blocks in an rgba image (bc4 gives (r,0,0,255), bc5 gives (r,g,0,255)) */
+	image_raw image_decompress(image_compressed const& im);
+
+	/** Peak signal to noise ratio (in dB) between two images of the same dimension, computed on the first channel_count channels (infinite if the images are equal) */
+	double image_psnr(image_raw const& reference, image_raw const& im, size_t channel_count);
+	/** PSNR of the compressed image against its source, on the channels stored by the format */
+	double image_compression_psnr(image_raw const& reference, image_compressed const& compressed);
+}
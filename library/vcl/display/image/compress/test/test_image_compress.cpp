@@ -0,0 +1,94 @@
+#include "test_image_compress.hpp"
+
+#include "vcl/base/base.hpp"
+#include "../image_compress.hpp"
+
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <limits>
+
+using namespace vcl;
+
+namespace vcl_test
+{
+	static image_block_format const formats[] = {image_block_format::bc1, image_block_format::bc3, image_block_format::bc4, image_block_format::bc5};
+	static char const* const format_names[] = {"bc1", "bc3", "bc4", "bc5"};
+
+	// Low frequency waves on the four channels (periods of 100 to 350 pixels whatever the dimension of the image)
+	static image_raw smooth_image(unsigned int width, unsigned int height)
+	{
+		image_raw im(width, height, image_color_type::rgba, buffer<unsigned char>());
+		im.data.resize(size_t(width)*height*4);
+		for(unsigned int j=0; j<height; ++j) {
+			for(unsigned int i=0; i<width; ++i) {
+				float const x = float(i)/16.0f, y = float(j)/16.0f;
+				float const value[4] = {
+					127.5f+120.0f*std::sin(0.7f*x)*std::cos(0.4f*y),
+					127.5f+100.0f*std::sin(0.6f*x+0.4f*y),
+					127.5f+120.0f*std::cos(0.5f*y+0.2f*x),
+					191.0f+64.0f*std::cos(0.3f*x-0.5f*y) };
+				for(size_t c=0; c<4; ++c)
+					im.data[(size_t(j)*width+i)*4+c] = static_cast<unsigned char>(std::round(value[c]));
+			}
+		}
+		return im;
+	}
+
+	void test_image_compress()
+	{
+		// PSNR on a smooth image
+		{
+			image_raw const im = smooth_image(128, 96);
+			double const psnr_min[] = {39.0, 40.0, 50.0, 50.0}; // bc1, bc3, bc4, bc5
+			for(size_t k=0; k<4; ++k) {
+				image_compressed const compressed = image_compress(im, formats[k]);
+				assert_vcl(image_compression_psnr(im, compressed)>psnr_min[k], str("Low PSNR for ")+format_names[k]);
+			}
+		}
+
+		// Constant image: decoded exactly
+		{
+			image_raw im(9, 7, image_color_type::rgba, buffer<unsigned char>());
+			im.data.resize(9*7*4);
+			for(size_t k=0; k<im.data.size(); ++k)
+				im.data[k] = static_cast<unsigned char>(k%4==3? 255 : 37+50*(k%4));
+			assert_vcl_no_msg(image_compression_psnr(im, image_compress(im, image_block_format::bc4))==std::numeric_limits<double>::infinity());
+			assert_vcl_no_msg(image_compression_psnr(im, image_compress(im, image_block_format::bc5))==std::numeric_limits<double>::infinity());
+		}
+
+		// Size of the compressed data, including dimensions that are not multiple of 4
+		{
+			unsigned int const dimensions[][2] = { {4,4}, {16,8}, {1,1}, {5,3}, {13,22}, {30,1} };
+			for(auto const& d : dimensions) {
+				image_raw const im = smooth_image(d[0], d[1]);
+				for(image_block_format format : formats) {
+					image_compressed const compressed = image_compress(im, format);
+					size_t const N_block = size_t((d[0]+3)/4)*((d[1]+3)/4);
+					assert_vcl_no_msg(compressed.width==d[0] && compressed.height==d[1]);
+					assert_vcl_no_msg(compressed.data.size()==N_block*image_block_size(format));
+
+					image_raw const decoded = image_decompress(compressed);
+					assert_vcl_no_msg(decoded.width==d[0] && decoded.height==d[1] && decoded.data.size()==size_t(d[0])*d[1]*4);
+				}
+			}
+		}
+	}
+
+	void benchmark_image_compress()
+	{
+		using clock = std::chrono::steady_clock;
+		auto seconds = [](clock::time_point t0) { return std::chrono::duration<double>(clock::now()-t0).count(); };
+
+		image_raw const im = smooth_image(1024, 1024);
+		double const N_pixel = double(im.width)*im.height;
+		std::cout << "Block compression of a smooth image " << im.width << "x" << im.height << std::endl;
+		for(size_t k=0; k<4; ++k) {
+			clock::time_point const t0 = clock::now();
+			image_compressed const compressed = image_compress(im, formats[k]);
+			double const t_encode = seconds(t0);
+			std::cout << "  " << format_names[k] << ": PSNR " << image_compression_psnr(im, compressed) << " dB, "
+					  << N_pixel/t_encode*1e-6 << " Mpixels/s, " << double(im.data.size())/double(compressed.data.size()) << "x smaller than rgba" << std::endl;
+		}
+	}
+}
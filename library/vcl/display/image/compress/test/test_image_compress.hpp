@@ -0,0 +1,10 @@
+#pragma once
+
+namespace vcl_test
+{
+	/** Check the CPU round trip of the block compression: PSNR of each format on a smooth image, exact constant blocks, size of the compressed data */
+	void test_image_compress();
+
+	/** Report the PSNR and the encoding speed (Mpixels/s) of each format on a smooth image */
+	void benchmark_image_compress();
+}
@@ -0,0 +1,288 @@
+#include "image_convert.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP>=2)
+#define VCL_IMAGE_SSE
+#include <emmintrin.h>
+#endif
+
+namespace vcl
+{
+	namespace
+	{
+		struct conversion_tables
+		{
+			float linear[256];   // k/255
+			float srgb[256];     // sRGB value k/255 in linear space
+			// Linear values of the midpoints between two consecutive sRGB values: the 8 bits sRGB value of x is the number of thresholds below x
+			float srgb_threshold[256];
+			// sRGB value at the beginning of 4096 intervals of [0,1] (a lower bound for the values of the interval)
+			unsigned char srgb_start[4096];
+
+			conversion_tables()
+			{
+				for(int k=0; k<256; ++k) {
+					linear[k] = float(k)/255.0f;
+					srgb[k] = srgb_to_linear(float(k)/255.0f);
+					srgb_threshold[k] = (k<255)? srgb_to_linear((float(k)+0.5f)/255.0f) : 2.0f;
+				}
+				for(int k=0; k<4096; ++k) {
+					// Number of thresholds below the beginning of the interval (slightly shifted to absorb the rounding of the index)
+					float const x = (float(k)-0.5f)/4095.0f;
+					unsigned int v = 0;
+					while(v<255 && srgb_threshold[v]<=x)
+						v++;
+					srgb_start[k] = static_cast<unsigned char>(v);
+				}
+			}
+		};
+
+		conversion_tables const& tables()
+		{
+			static conversion_tables const t;
+			return t;
+		}
+
+		inline float clamp_unit(float x)
+		{
+			return x>0.0f? (x<1.0f? x : 1.0f) : 0.0f; // NaN gives 0
+		}
+
+		inline unsigned char encode_linear(float x)
+		{
+			return static_cast<unsigned char>(int(clamp_unit(x)*255.0f+0.5f));
+		}
+
+		// The sRGB value is the number of thresholds below x: the intervals of the start table are narrower than 1.2 sRGB steps,
+		//  two comparisons complete the value given by the table
+		inline unsigned char encode_srgb(float x, conversion_tables const& t)
+		{
+			x = clamp_unit(x);
+			unsigned int v = t.srgb_start[int(x*4095.0f)];
+			v += (t.srgb_threshold[v]<=x)? 1 : 0;
+			v += (t.srgb_threshold[v]<=x)? 1 : 0;
+			return static_cast<unsigned char>(v);
+		}
+
+		bool identity_swizzle(image_convert_options const& options, size_t channels)
+		{
+			for(size_t c=0; c<channels; ++c)
+				if(options.swizzle[c]!=c)
+					return false;
+			return true;
+		}
+
+		// values/255 for N values
+		void decode_linear_values(unsigned char const* in, float* out, size_t N)
+		{
+			size_t k = 0;
+#ifdef VCL_IMAGE_SSE
+			__m128i const zero = _mm_setzero_si128();
+			__m128 const scale = _mm_set1_ps(255.0f);
+			for(; k+16<=N; k+=16) {
+				__m128i const bytes = _mm_loadu_si128(reinterpret_cast<__m128i const*>(in+k));
+				__m128i const low = _mm_unpacklo_epi8(bytes, zero);
+				__m128i const high = _mm_unpackhi_epi8(bytes, zero);
+				_mm_storeu_ps(out+k,    _mm_div_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(low, zero)), scale));
+				_mm_storeu_ps(out+k+4,  _mm_div_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(low, zero)), scale));
+				_mm_storeu_ps(out+k+8,  _mm_div_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(high, zero)), scale));
+				_mm_storeu_ps(out+k+12, _mm_div_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(high, zero)), scale));
+			}
+#endif
+			float const* const table = tables().linear;
+			for(; k<N; ++k)
+				out[k] = table[in[k]];
+		}
+
+		// Clamped and rounded values*255 for N values
+		void encode_linear_values(float const* in, unsigned char* out, size_t N)
+		{
+			size_t k = 0;
+#ifdef VCL_IMAGE_SSE
+			__m128 const zero = _mm_setzero_ps();
+			__m128 const one = _mm_set1_ps(1.0f);
+			__m128 const scale = _mm_set1_ps(255.0f);
+			__m128 const half = _mm_set1_ps(0.5f);
+			for(; k+16<=N; k+=16) {
+				__m128i v[4];
+				for(int i=0; i<4; ++i) {
+					__m128 const x = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(in+k+4*i), zero), one); // max returns 0 for NaN
+					v[i] = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(x, scale), half));
+				}
+				__m128i const bytes = _mm_packus_epi16(_mm_packs_epi32(v[0], v[1]), _mm_packs_epi32(v[2], v[3]));
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(out+k), bytes);
+			}
+#endif
+			for(; k<N; ++k)
+				out[k] = encode_linear(in[k]);
+		}
+
+		void decode_row(unsigned char const* in, float* out, size_t width, size_t in_channels, size_t out_channels, image_convert_options const& options, bool fast)
+		{
+			conversion_tables const& t = tables();
+			bool const srgb = options.color_space==image_color_space::srgb;
+			if(fast && !srgb) {
+				decode_linear_values(in, out, width*in_channels);
+				return;
+			}
+
+			// Table used for each input channel (the alpha channel is linear)
+			float const* table[4];
+			for(size_t c=0; c<4; ++c)
+				table[c] = (srgb && c<3)? t.srgb : t.linear;
+
+			if(fast) {
+				for(size_t i=0; i<width; ++i, in+=in_channels, out+=out_channels)
+					for(size_t c=0; c<in_channels; ++c)
+						out[c] = table[c][in[c]];
+				return;
+			}
+
+			for(size_t i=0; i<width; ++i, in+=in_channels, out+=out_channels) {
+				float const alpha = (in_channels==4)? t.linear[in[3]] : 1.0f;
+				for(size_t c=0; c<out_channels; ++c) {
+					unsigned int const source = options.swizzle[c];
+					if(source>=in_channels)
+						out[c] = (c==3)? 1.0f : 0.0f;
+					else if(source<3 && options.premultiplied_alpha)
+						out[c] = table[source][in[source]]*alpha;
+					else
+						out[c] = table[source][in[source]];
+				}
+			}
+		}
+
+		void encode_row(float const* in, unsigned char* out, size_t width, size_t in_channels, size_t out_channels, image_convert_options const& options, bool fast)
+		{
+			conversion_tables const& t = tables();
+			bool const srgb = options.color_space==image_color_space::srgb;
+			if(fast && !srgb) {
+				encode_linear_values(in, out, width*in_channels);
+				return;
+			}
+
+			if(fast) {
+				size_t const color_channels = std::min(in_channels, size_t(3));
+				for(size_t i=0; i<width; ++i, in+=in_channels, out+=out_channels) {
+					for(size_t c=0; c<color_channels; ++c)
+						out[c] = encode_srgb(in[c], t);
+					if(in_channels==4)
+						out[3] = encode_linear(in[3]);
+				}
+				return;
+			}
+
+			for(size_t i=0; i<width; ++i, in+=in_channels, out+=out_channels) {
+				float const alpha = (in_channels==4)? in[3] : 1.0f;
+				for(size_t c=0; c<out_channels; ++c) {
+					unsigned int const source = options.swizzle[c];
+					if(source>=in_channels) {
+						out[c] = (c==3)? 255 : 0;
+						continue;
+					}
+					float x = in[source];
+					if(source<3 && options.premultiplied_alpha)
+						x = alpha>0.0f? x/alpha : 0.0f;
+					out[c] = (srgb && source<3)? encode_srgb(x, t) : encode_linear(x);
+				}
+			}
+		}
+
+		// Rows per parallel range: about 64K pixels
+		size_t row_grain(size_t width)
+		{
+			return std::max(size_t(1), size_t(65536)/std::max(size_t(1), width));
+		}
+
+		void check_views(size_t in_width, size_t in_height, size_t in_channels, size_t out_width, size_t out_height, size_t out_channels)
+		{
+			assert_vcl(in_width==out_width && in_height==out_height, "Images of different dimensions");
+			assert_vcl(in_channels>=1 && in_channels<=4 && out_channels>=1 && out_channels<=4, "Images must have 1 to 4 channels");
+		}
+	}
+
+	float srgb_to_linear(float s)
+	{
+		double const x = double(s);
+		return float(x<=0.04045? x/12.92 : std::pow((x+0.055)/1.055, 2.4));
+	}
+
+	float linear_to_srgb(float x)
+	{
+		double const y = double(x);
+		return float(y<=0.0031308? 12.92*y : 1.055*std::pow(y, 1.0/2.4)-0.055);
+	}
+
+	image_view<unsigned char> image_view_of(image_raw& im)
+	{
+		return image_view<unsigned char>(im.data.data.data(), im.width, im.height, im.color_type==image_color_type::rgba? 4 : 3);
+	}
+	image_view<unsigned char const> image_view_of(image_raw const& im)
+	{
+		return image_view<unsigned char const>(im.data.data.data(), im.width, im.height, im.color_type==image_color_type::rgba? 4 : 3);
+	}
+	image_view<float> image_view_of(grid_2D<vec3>& im)
+	{
+		return image_view<float>(reinterpret_cast<float*>(im.data.data.data()), im.dimension.x, im.dimension.y, 3);
+	}
+	image_view<float const> image_view_of(grid_2D<vec3> const& im)
+	{
+		return image_view<float const>(reinterpret_cast<float const*>(im.data.data.data()), im.dimension.x, im.dimension.y, 3);
+	}
+	image_view<float> image_view_of(grid_2D<vec4>& im)
+	{
+		return image_view<float>(reinterpret_cast<float*>(im.data.data.data()), im.dimension.x, im.dimension.y, 4);
+	}
+	image_view<float const> image_view_of(grid_2D<vec4> const& im)
+	{
+		return image_view<float const>(reinterpret_cast<float const*>(im.data.data.data()), im.dimension.x, im.dimension.y, 4);
+	}
+
+	void image_convert(image_view<unsigned char const> const& in, image_view<float> const& out, image_convert_options const& options)
+	{
+		check_views(in.width, in.height, in.channels, out.width, out.height, out.channels);
+		bool const fast = in.channels==out.channels && !options.premultiplied_alpha && identity_swizzle(options, out.channels);
+		tables();
+		parallel_for(in.height, [&](size_t y){
+			decode_row(in.row(y), out.row(y), in.width, in.channels, out.channels, options, fast);
+		}, row_grain(in.width));
+	}
+
+	void image_convert(image_view<float const> const& in, image_view<unsigned char> const& out, image_convert_options const& options)
+	{
+		check_views(in.width, in.height, in.channels, out.width, out.height, out.channels);
+		bool const fast = in.channels==out.channels && !options.premultiplied_alpha && identity_swizzle(options, out.channels);
+		tables();
+		parallel_for(in.height, [&](size_t y){
+			encode_row(in.row(y), out.row(y), in.width, in.channels, out.channels, options, fast);
+		}, row_grain(in.width));
+	}
+
+	void convert(image_raw const& in, grid_2D<vec4>& out, image_convert_options const& options)
+	{
+		out.resize(in.width, in.height);
+		image_convert(image_view_of(in), image_view_of(out), options);
+	}
+
+	void convert(image_raw const& in, grid_2D<vec3>& out, image_convert_options const& options)
+	{
+		out.resize(in.width, in.height);
+		image_convert(image_view_of(in), image_view_of(out), options);
+	}
+
+	void convert(grid_2D<vec3> const& in, image_raw& out, image_convert_options const& options)
+	{
+		out = image_raw(unsigned(in.dimension.x), unsigned(in.dimension.y), image_color_type::rgb, buffer<unsigned char>());
+		out.data.resize(3*in.size());
+		image_convert(image_view_of(in), image_view_of(out), options);
+	}
+
+	void convert(grid_2D<vec4> const& in, image_raw& out, image_convert_options const& options)
+	{
+		out = image_raw(unsigned(in.dimension.x), unsigned(in.dimension.y), image_color_type::rgba, buffer<unsigned char>());
+		out.data.resize(4*in.size());
+		image_convert(image_view_of(in), image_view_of(out), options);
+	}
+}
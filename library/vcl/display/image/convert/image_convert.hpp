@@ -0,0 +1,81 @@
+#pragma once
+
+#include "vcl/base/base.hpp"
+#include "../image.hpp"
+
+#include <type_traits>
+
+namespace vcl
+{
+	/** Non-owning view on the pixels of an image (a full image, a sub-rectangle, or external memory)
+	* The value of channel c of the pixel (x,y) is data[y*stride + x*channels + c]. */
+	template <typename T>
+	struct image_view
+	{
+		T* data = nullptr;
+		size_t width = 0;
+		size_t height = 0;
+		size_t channels = 0;
+		/** Number of values between the beginning of two consecutive rows (width*channels for a contiguous image) */
+		size_t stride = 0;
+
+		image_view() {}
+		image_view(T* data_arg, size_t width_arg, size_t height_arg, size_t channels_arg, size_t stride_arg=0)
+			:data(data_arg), width(width_arg), height(height_arg), channels(channels_arg), stride(stride_arg==0? width_arg*channels_arg : stride_arg) {}
+
+		/** Read-only view on a mutable image */
+		template <typename U, typename = typename std::enable_if<std::is_convertible<U*,T*>::value>::type>
+		image_view(image_view<U> const& other) :data(other.data), width(other.width), height(other.height), channels(other.channels), stride(other.stride) {}
+
+		T* row(size_t y) const { return data+y*stride; }
+		/** View on the rectangle of size (w,h) starting at the pixel (x,y) */
+		image_view<T> subview(size_t x, size_t y, size_t w, size_t h) const;
+	};
+
+	image_view<unsigned char> image_view_of(image_raw& im);
+	image_view<unsigned char const> image_view_of(image_raw const& im);
+	image_view<float> image_view_of(grid_2D<vec3>& im);
+	image_view<float const> image_view_of(grid_2D<vec3> const& im);
+	image_view<float> image_view_of(grid_2D<vec4>& im);
+	image_view<float const> image_view_of(grid_2D<vec4> const& im);
+
+	enum class image_color_space {linear, srgb};
+
+	struct image_convert_options
+	{
+		/** Encoding of the 8 bits colors: with srgb, the 8 bits colors are sRGB encoded and the float colors are linear (alpha is always linear) */
+		image_color_space color_space = image_color_space::linear;
+		/** The float colors are premultiplied by alpha (multiplied when converted to float, divided when converted to 8 bits) */
+		bool premultiplied_alpha = false;
+		/** Input channel read for each output channel (ex. {2,1,0,3} swaps red and blue)
+		* An output channel reading a missing input channel is set to 0, or to 1 for the alpha channel. */
+		unsigned int swizzle[4] = {0,1,2,3};
+	};
+
+	/** Convert 8 bits pixels to float values in [0,1], or float values to 8 bits pixels (clamped and rounded)
+	* The views have 1 to 4 channels (the 4th one is alpha) and the same dimension. The rows are converted in parallel,
+	*  the common cases (same channels, no swizzle nor premultiplied alpha) use SSE2 in linear space and lookup tables for sRGB. */
+	void image_convert(image_view<unsigned char const> const& in, image_view<float> const& out, image_convert_options const& options=image_convert_options());
+	void image_convert(image_view<float const> const& in, image_view<unsigned char> const& out, image_convert_options const& options=image_convert_options());
+
+	/** Conversions of full images (the output is resized) */
+	void convert(image_raw const& in, grid_2D<vec4>& out, image_convert_options const& options=image_convert_options());
+	void convert(image_raw const& in, grid_2D<vec3>& out, image_convert_options const& options);
+	void convert(grid_2D<vec3> const& in, image_raw& out, image_convert_options const& options=image_convert_options());
+	void convert(grid_2D<vec4> const& in, image_raw& out, image_convert_options const& options=image_convert_options());
+
+	/** Conversion of a single value between sRGB and linear space (in [0,1]) */
+	float srgb_to_linear(float s);
+	float linear_to_srgb(float x);
+}
+
+
+namespace vcl
+{
+	template <typename T>
+	image_view<T> image_view<T>::subview(size_t x, size_t y, size_t w, size_t h) const
+	{
+		assert_vcl(x+w<=width && y+h<=height, "Sub-view outside of the image");
+		return image_view<T>(data+y*stride+x*channels, w, h, channels, stride);
+	}
+}
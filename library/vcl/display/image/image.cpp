@@ -2,9 +2,12 @@
 
 #include "vcl/base/base.hpp"
 #include "vcl/files/files.hpp"
+#include "convert/image_convert.hpp"
 #include "third_party/src/lodepng/lodepng.h"
 #include "vcl/display/opengl/opengl.hpp"
 
+#include <atomic>
+
 namespace vcl
 {
 	image_raw::image_raw()
@@ -19,6 +22,19 @@ namespace vcl
     {
         assert_file_exist(filename);
 
+        image_raw im;
+        std::string error;
+        if( !image_load_png(filename, im, error, color_type) )
+        {
+            std::cerr<<error<<std::endl;
+            exit(1);
+        }
+
+        return im;
+    }
+
+    bool image_load_png(const std::string& filename, image_raw& im, std::string& error, image_color_type color_type)
+    {
         LodePNGColorType lodepng_color_type;
         if(color_type==image_color_type::rgb)
             lodepng_color_type = LCT_RGB;
@@ -26,22 +42,40 @@ namespace vcl
             lodepng_color_type = LCT_RGBA;
         else
         {
-            std::cerr<<"Unkown color type for file"<<filename<<std::endl;
-            exit(1);
+            error = "Unkown color type for file "+filename;
+            return false;
         }
 
-        image_raw im;
+        im = image_raw();
         im.color_type = color_type;
 
-        unsigned error = lodepng::decode(im.data.data, im.width, im.height, filename, lodepng_color_type);
-        if ( error )
+        unsigned const code = lodepng::decode(im.data.data, im.width, im.height, filename, lodepng_color_type);
+        if ( code )
         {
-            std::cerr<<"Error Loading png file "<<filename<<std::endl;
-            std::cerr<<"Decoder error " << error << ": " << lodepng_error_text(error) << std::endl;
-            exit(1);
+            error = "Error Loading png file "+filename+"\nDecoder error "+str(int(code))+": "+lodepng_error_text(code);
+            im = image_raw();
+            return false;
         }
 
-        return im;
+        error.clear();
+        return true;
+    }
+
+    buffer<image_raw> image_load_png_batch(buffer<std::string> const& filenames, buffer<std::string>& errors, image_color_type color_type)
+    {
+        size_t const N = filenames.size();
+        buffer<image_raw> images;
+        images.resize(N);
+        errors.clear();
+        errors.resize(N);
+
+        // The files have different sizes: each thread takes the next file to decode
+        std::atomic<size_t> next(0);
+        parallel_for(parallel_range_count(N, 1), [&](size_t) {
+            for(size_t k=next++; k<N; k=next++)
+                image_load_png(filenames[k], images[k], errors[k], color_type);
+        }, 1);
+        return images;
     }
 
     void image_save_png(const std::string& filename, const image_raw& im)
@@ -69,22 +103,6 @@ namespace vcl
 
     void convert(image_raw const& in, grid_2D<vec3>& out)
     {
-        size_t const N = size_t(in.width) * size_t(in.height);
-        out.resize(in.width, in.height);
-        if (in.color_type == image_color_type::rgb)
-        {
-            for(size_t k=0; k<N; ++k)
-                out[k] = vec3(in.data[3*k+0], in.data[3*k+1], in.data[3*k+2])/255.0f;
-        }
-        else if (in.color_type == image_color_type::rgba)
-        {
-            for(size_t k=0; k<N; ++k)
-                out[k] = vec3(in.data[4*k+0], in.data[4*k+1], in.data[4*k+2])/255.0f;
-        }
+        convert(in, out, image_convert_options());
     }
-
-
-
-
-
-}
\ No newline at end of file
+}
@@ -17,6 +17,11 @@ namespace vcl
 	};
 
 	image_raw image_load_png(const std::string& filename, image_color_type color_type = image_color_type::rgba);
+	/** Load a png file without stopping the program: returns false and fills the error message if the file cannot be decoded */
+	bool image_load_png(const std::string& filename, image_raw& im, std::string& error, image_color_type color_type = image_color_type::rgba);
+	/** Load several png files in parallel (each file is decoded by a single thread, the files are distributed over the threads)
+	* errors[k] is empty if the k-th image is loaded, and contains the error message otherwise. */
+	buffer<image_raw> image_load_png_batch(buffer<std::string> const& filenames, buffer<std::string>& errors, image_color_type color_type = image_color_type::rgba);
 	void image_save_png(const std::string& filename, const image_raw& im);
 
 	void convert(image_raw const& in, grid_2D<vec3>& out);
@@ -0,0 +1,366 @@
+#include "image_resample.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP>=2)
+#define VCL_IMAGE_SSE
+#include <emmintrin.h>
+#endif
+
+namespace vcl
+{
+	namespace
+	{
+		double const kaiser_beta = 4.0;
+
+		double filter_support(image_filter filter)
+		{
+			switch(filter) {
+			case image_filter::box: return 0.5;
+			case image_filter::tent: return 1.0;
+			case image_filter::lanczos3: return 3.0;
+			case image_filter::kaiser: return 3.0;
+			}
+			return 1.0;
+		}
+
+		double sinc(double x)
+		{
+			if(std::abs(x)<1e-8)
+				return 1.0;
+			double const a = 3.14159265358979323846*x;
+			return std::sin(a)/a;
+		}
+
+		// Modified Bessel function of the first kind of order 0 (series expansion)
+		double bessel_i0(double x)
+		{
+			double sum = 1.0, term = 1.0;
+			double const q = x*x/4.0;
+			for(int k=1; k<50 && term>1e-12*sum; ++k) {
+				term *= q/(double(k)*double(k));
+				sum += term;
+			}
+			return sum;
+		}
+
+		double filter_value(image_filter filter, double x)
+		{
+			double const a = std::abs(x);
+			switch(filter) {
+			case image_filter::box: return a<=0.5? 1.0 : 0.0;
+			case image_filter::tent: return std::max(0.0, 1.0-a);
+			case image_filter::lanczos3: return a<3.0? sinc(x)*sinc(x/3.0) : 0.0;
+			case image_filter::kaiser: {
+				if(a>=3.0)
+					return 0.0;
+				double const t = a/3.0;
+				return sinc(x)*bessel_i0(kaiser_beta*std::sqrt(1.0-t*t))/bessel_i0(kaiser_beta);
+			}
+			}
+			return 0.0;
+		}
+
+		// Weights of the input pixels contributing to each output pixel along one axis
+		struct axis_weights
+		{
+			std::vector<size_t> begin;   // taps of the output o: [begin[o], begin[o+1])
+			std::vector<size_t> index;   // input pixel (clamped to the image)
+			std::vector<float> weight;   // normalized weights
+			std::vector<size_t> index_min, index_max;
+		};
+
+		axis_weights compute_axis_weights(size_t N_in, size_t N_out, image_filter filter)
+		{
+			axis_weights w;
+			w.begin.resize(N_out+1, 0);
+			w.index_min.resize(N_out);
+			w.index_max.resize(N_out);
+
+			double const scale = double(N_in)/double(N_out);
+			double const stretch = std::max(1.0, scale); // the filter is widened to cover the reduced pixels
+			double const radius = filter_support(filter)*stretch;
+			for(size_t o=0; o<N_out; ++o)
+			{
+				double const center = (double(o)+0.5)*scale-0.5;
+				long long const i_begin = static_cast<long long>(std::floor(center-radius));
+				long long const i_end = static_cast<long long>(std::ceil(center+radius));
+
+				size_t const first = w.index.size();
+				double sum = 0.0;
+				for(long long i=i_begin; i<=i_end; ++i) {
+					double const value = filter_value(filter, (double(i)-center)/stretch);
+					if(value==0.0)
+						continue;
+					w.index.push_back(size_t(std::min(std::max(i, 0ll), static_cast<long long>(N_in)-1)));
+					w.weight.push_back(float(value));
+					sum += value;
+				}
+				if(w.index.size()==first || std::abs(sum)<1e-12) {
+					// Degenerated filter: nearest pixel
+					w.index.resize(first);
+					w.weight.resize(first);
+					w.index.push_back(std::min(size_t(std::max(0.0, std::floor(center+0.5))), N_in-1));
+					w.weight.push_back(1.0f);
+					sum = 1.0;
+				}
+				for(size_t k=first; k<w.index.size(); ++k)
+					w.weight[k] = float(w.weight[k]/sum);
+
+				w.begin[o+1] = w.index.size();
+				w.index_min[o] = *std::min_element(w.index.begin()+first, w.index.end());
+				w.index_max[o] = *std::max_element(w.index.begin()+first, w.index.end());
+			}
+			return w;
+		}
+
+		// Output pixels [o_begin,o_end) depending on the input pixels [i_begin,i_end)
+		void dependent_range(axis_weights const& w, size_t i_begin, size_t i_end, size_t& o_begin, size_t& o_end)
+		{
+			size_t const N_out = w.index_min.size();
+			o_begin = N_out;
+			o_end = 0;
+			for(size_t o=0; o<N_out; ++o) {
+				if(w.index_max[o]>=i_begin && w.index_min[o]<i_end) {
+					o_begin = std::min(o_begin, o);
+					o_end = o+1;
+				}
+			}
+			if(o_begin>=o_end)
+				o_begin = o_end = 0;
+		}
+
+		template <size_t C>
+		void horizontal_pass(float const* in, float* out, axis_weights const& w, size_t x_begin, size_t x_end)
+		{
+			for(size_t o=x_begin; o<x_end; ++o, out+=C) {
+				float sum[C] = {};
+				for(size_t t=w.begin[o]; t<w.begin[o+1]; ++t) {
+					float const weight = w.weight[t];
+					float const* const p = in+w.index[t]*C;
+					for(size_t c=0; c<C; ++c)
+						sum[c] += weight*p[c];
+				}
+				for(size_t c=0; c<C; ++c)
+					out[c] = sum[c];
+			}
+		}
+
+#ifdef VCL_IMAGE_SSE
+		// The 4 channels of a pixel are processed together
+		template <>
+		void horizontal_pass<4>(float const* in, float* out, axis_weights const& w, size_t x_begin, size_t x_end)
+		{
+			for(size_t o=x_begin; o<x_end; ++o, out+=4) {
+				__m128 sum = _mm_setzero_ps();
+				for(size_t t=w.begin[o]; t<w.begin[o+1]; ++t)
+					sum = _mm_add_ps(sum, _mm_mul_ps(_mm_set1_ps(w.weight[t]), _mm_loadu_ps(in+w.index[t]*4)));
+				_mm_storeu_ps(out, sum);
+			}
+		}
+#endif
+
+		void horizontal_pass(float const* in, float* out, size_t channels, axis_weights const& w, size_t x_begin, size_t x_end)
+		{
+			switch(channels) {
+			case 1: horizontal_pass<1>(in, out, w, x_begin, x_end); break;
+			case 2: horizontal_pass<2>(in, out, w, x_begin, x_end); break;
+			case 3: horizontal_pass<3>(in, out, w, x_begin, x_end); break;
+			default: horizontal_pass<4>(in, out, w, x_begin, x_end); break;
+			}
+		}
+
+		// out += weight*in for N values
+		void accumulate_row(float* out, float const* in, float weight, size_t N)
+		{
+			size_t k = 0;
+#ifdef VCL_IMAGE_SSE
+			__m128 const w = _mm_set1_ps(weight);
+			for(; k+4<=N; k+=4)
+				_mm_storeu_ps(out+k, _mm_add_ps(_mm_loadu_ps(out+k), _mm_mul_ps(w, _mm_loadu_ps(in+k))));
+#endif
+			for(; k<N; ++k)
+				out[k] += weight*in[k];
+		}
+
+		// Image of float values stored in a vector
+		struct float_image
+		{
+			std::vector<float> data;
+			size_t width = 0;
+			size_t height = 0;
+			size_t channels = 0;
+
+			void resize(size_t w, size_t h, size_t c) { width = w; height = h; channels = c; data.resize(w*h*c); }
+			image_view<float> view() { return image_view<float>(data.data(), width, height, channels); }
+			image_view<float const> view() const { return image_view<float const>(data.data(), width, height, channels); }
+		};
+
+		image_convert_options convert_options(image_resample_options const& options, image_color_type color_type)
+		{
+			image_convert_options convert;
+			convert.color_space = options.color_space;
+			convert.premultiplied_alpha = options.alpha_weighted && color_type==image_color_type::rgba;
+			return convert;
+		}
+
+		size_t channel_count(image_color_type color_type)
+		{
+			return color_type==image_color_type::rgba? 4 : 3;
+		}
+
+		image_raw to_image_raw(float_image const& im, image_color_type color_type, image_convert_options const& convert)
+		{
+			image_raw out(unsigned(im.width), unsigned(im.height), color_type, buffer<unsigned char>());
+			out.data.resize(im.width*im.height*im.channels);
+			image_convert(im.view(), image_view_of(out), convert);
+			return out;
+		}
+
+		template <typename T>
+		grid_2D<T> resize_grid(grid_2D<T> const& im, size_t width, size_t height, image_filter filter)
+		{
+			grid_2D<T> out(width, height);
+			image_resample(image_view_of(im), image_view_of(out), filter);
+			return out;
+		}
+
+		void next_level_dimension(size_t width, size_t height, size_t& next_width, size_t& next_height)
+		{
+			next_width = std::max(size_t(1), width/2);
+			next_height = std::max(size_t(1), height/2);
+		}
+	}
+
+	void image_resample(image_view<float const> const& in, image_view<float> const& out, image_filter filter, image_rectangle const& output_region)
+	{
+		size_t const C = in.channels;
+		assert_vcl(C==out.channels && C>=1 && C<=4, "Images must have the same number of channels (1 to 4)");
+		assert_vcl(in.width>0 && in.height>0, "Cannot resample an empty image");
+
+		image_rectangle rect = output_region;
+		if(rect.width==0 || rect.height==0)
+			rect = {0, 0, out.width, out.height};
+		assert_vcl(rect.x+rect.width<=out.width && rect.y+rect.height<=out.height, "Region outside of the output image");
+		if(rect.width==0 || rect.height==0)
+			return;
+
+		axis_weights const wx = compute_axis_weights(in.width, out.width, filter);
+		axis_weights const wy = compute_axis_weights(in.height, out.height, filter);
+
+		// Horizontal pass on the input rows used by the output region
+		size_t row_min = in.height, row_max = 0;
+		for(size_t y=rect.y; y<rect.y+rect.height; ++y) {
+			row_min = std::min(row_min, wy.index_min[y]);
+			row_max = std::max(row_max, wy.index_max[y]);
+		}
+		size_t const row_size = rect.width*C;
+		std::vector<float> horizontal((row_max-row_min+1)*row_size);
+		parallel_for(row_max-row_min+1, [&](size_t r){
+			horizontal_pass(in.row(row_min+r), horizontal.data()+r*row_size, C, wx, rect.x, rect.x+rect.width);
+		}, std::max(size_t(1), size_t(16384)/row_size));
+
+		// Vertical pass: weighted sum of rows
+		parallel_for(rect.height, [&](size_t j){
+			size_t const y = rect.y+j;
+			float* const target = out.row(y)+rect.x*C;
+			std::fill(target, target+row_size, 0.0f);
+			for(size_t t=wy.begin[y]; t<wy.begin[y+1]; ++t)
+				accumulate_row(target, horizontal.data()+(wy.index[t]-row_min)*row_size, wy.weight[t], row_size);
+		}, std::max(size_t(1), size_t(16384)/row_size));
+	}
+
+	image_raw image_resize(image_raw const& im, size_t width, size_t height, image_resample_options const& options)
+	{
+		image_convert_options const convert = convert_options(options, im.color_type);
+		size_t const C = channel_count(im.color_type);
+
+		float_image linear, resized;
+		linear.resize(im.width, im.height, C);
+		resized.resize(width, height, C);
+		image_convert(image_view_of(im), linear.view(), convert);
+		image_resample(linear.view(), resized.view(), options.filter);
+		return to_image_raw(resized, im.color_type, convert);
+	}
+
+	grid_2D<vec3> image_resize(grid_2D<vec3> const& im, size_t width, size_t height, image_filter filter)
+	{
+		return resize_grid(im, width, height, filter);
+	}
+
+	grid_2D<vec4> image_resize(grid_2D<vec4> const& im, size_t width, size_t height, image_filter filter)
+	{
+		return resize_grid(im, width, height, filter);
+	}
+
+	buffer<image_raw> image_mipmap_chain(image_raw const& im, image_resample_options const& options)
+	{
+		image_convert_options const convert = convert_options(options, im.color_type);
+		size_t const C = channel_count(im.color_type);
+
+		buffer<image_raw> chain;
+		chain.push_back(im);
+		float_image level;
+		level.resize(im.width, im.height, C);
+		image_convert(image_view_of(im), level.view(), convert);
+		while(level.width>1 || level.height>1) {
+			float_image next;
+			size_t w=0, h=0;
+			next_level_dimension(level.width, level.height, w, h);
+			next.resize(w, h, C);
+			image_resample(level.view(), next.view(), options.filter);
+			chain.push_back(to_image_raw(next, im.color_type, convert));
+			level = std::move(next);
+		}
+		return chain;
+	}
+
+	buffer<grid_2D<vec3>> image_mipmap_chain(grid_2D<vec3> const& im, image_filter filter)
+	{
+		buffer<grid_2D<vec3>> chain;
+		chain.push_back(im);
+		while(chain.data.back().dimension.x>1 || chain.data.back().dimension.y>1) {
+			grid_2D<vec3> const& level = chain.data.back();
+			size_t w=0, h=0;
+			next_level_dimension(level.dimension.x, level.dimension.y, w, h);
+			grid_2D<vec3> next = resize_grid(level, w, h, filter);
+			chain.push_back(next);
+		}
+		return chain;
+	}
+
+	buffer<image_rectangle> image_mipmap_update(buffer<grid_2D<vec3>>& mipmap, image_rectangle const& region, image_filter filter)
+	{
+		buffer<image_rectangle> updated;
+		updated.resize(mipmap.size());
+		if(mipmap.size()==0)
+			return updated;
+
+		grid_2D<vec3> const& level_0 = mipmap.data[0];
+		image_rectangle current;
+		current.x = std::min(region.x, size_t(level_0.dimension.x));
+		current.y = std::min(region.y, size_t(level_0.dimension.y));
+		current.width = std::min(region.width, size_t(level_0.dimension.x)-current.x);
+		current.height = std::min(region.height, size_t(level_0.dimension.y)-current.y);
+		updated.data[0] = current;
+
+		for(size_t k=1; k<mipmap.size() && current.width>0 && current.height>0; ++k)
+		{
+			grid_2D<vec3> const& previous = mipmap.data[k-1];
+			grid_2D<vec3>& level = mipmap.data[k];
+			axis_weights const wx = compute_axis_weights(previous.dimension.x, level.dimension.x, filter);
+			axis_weights const wy = compute_axis_weights(previous.dimension.y, level.dimension.y, filter);
+
+			size_t x_begin=0, x_end=0, y_begin=0, y_end=0;
+			dependent_range(wx, current.x, current.x+current.width, x_begin, x_end);
+			dependent_range(wy, current.y, current.y+current.height, y_begin, y_end);
+			current = {x_begin, y_begin, x_end-x_begin, y_end-y_begin};
+			if(current.width>0 && current.height>0)
+				image_resample(image_view_of(previous), image_view_of(level), filter, current);
+			updated.data[k] = current;
+		}
+		return updated;
+	}
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include "../convert/image_convert.hpp"
+
+namespace vcl
+{
+	/** Resampling filters, from the sharpest aliasing to the smoothest: box (average of the covered pixels), tent (bilinear),
+	* lanczos3 (windowed sinc, sharp with light ringing), kaiser (Kaiser windowed sinc, used for mipmaps) */
+	enum class image_filter {box, tent, lanczos3, kaiser};
+
+	/** Rectangle of pixels [x,x+width) x [y,y+height) */
+	struct image_rectangle
+	{
+		size_t x = 0;
+		size_t y = 0;
+		size_t width = 0;
+		size_t height = 0;
+	};
+
+	struct image_resample_options
+	{
+		image_filter filter = image_filter::kaiser;
+		/** Encoding of the 8 bits colors: the filtering is always done in linear space (gamma-correct for sRGB images) */
+		image_color_space color_space = image_color_space::srgb;
+		/** Weight the colors by alpha during the filtering (the transparent pixels don't bleed on their neighbors) */
+		bool alpha_weighted = true;
+	};
+
+	/** Resample an image of float values into an image of another dimension with the same number of channels
+	* The filter is separable (horizontal then vertical pass), its support is widened when the image is reduced. The rows are computed in parallel.
+	* Only the pixels of the output rectangle are computed if it is not empty. */
+	void image_resample(image_view<float const> const& in, image_view<float> const& out, image_filter filter, image_rectangle const& output_region=image_rectangle());
+
+	/** Resized copy of an image */
+	image_raw image_resize(image_raw const& im, size_t width, size_t height, image_resample_options const& options=image_resample_options());
+	grid_2D<vec3> image_resize(grid_2D<vec3> const& im, size_t width, size_t height, image_filter filter=image_filter::kaiser);
+	grid_2D<vec4> image_resize(grid_2D<vec4> const& im, size_t width, size_t height, image_filter filter=image_filter::kaiser);
+
+	/** Mipmap levels of an image: level 0 is the image, each level halves the dimensions of the previous one (rounded down, at least 1) down to 1x1
+	* The levels of an image_raw are computed in linear float values and converted once to 8 bits. */
+	buffer<image_raw> image_mipmap_chain(image_raw const& im, image_resample_options const& options=image_resample_options());
+	buffer<grid_2D<vec3>> image_mipmap_chain(grid_2D<vec3> const& im, image_filter filter=image_filter::kaiser);
+
+	/** Update the mipmap levels after a modification of the region of level 0
+	* Only the pixels of the higher levels depending on the region are recomputed. Returns the updated region of each level. */
+	buffer<image_rectangle> image_mipmap_update(buffer<grid_2D<vec3>>& mipmap, image_rectangle const& region, image_filter filter=image_filter::kaiser);
+}
@@ -9,4 +9,12 @@ namespace vcl
 		glVertexAttribPointer(index, size, type, GL_FALSE, 0, nullptr);       opengl_check
 		glBindBuffer(GL_ARRAY_BUFFER, 0);                                     opengl_check
 	}
+
+	void opengl_set_vertex_attribute(GLuint vbo, GLuint index, GLuint size, GLenum type, GLboolean normalized, GLsizei stride, size_t offset)
+	{
+		glBindBuffer(GL_ARRAY_BUFFER, vbo);                                   opengl_check
+		glEnableVertexAttribArray( index );                                   opengl_check
+		glVertexAttribPointer(index, size, type, normalized, stride, reinterpret_cast<void const*>(offset)); opengl_check
+		glBindBuffer(GL_ARRAY_BUFFER, 0);                                     opengl_check
+	}
 }
\ No newline at end of file
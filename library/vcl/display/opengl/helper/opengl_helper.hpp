@@ -2,6 +2,7 @@
 
 #include "../glad/glad.hpp"
 #include "vcl/display/opengl/debug/debug.hpp"
+#include "vcl/display/opengl/state/opengl_state.hpp"
 
 namespace vcl
 {
@@ -15,6 +16,11 @@ namespace vcl
 	void opengl_create_array_buffer_data(GLuint& vbo, T const& element, GLenum draw_type = GL_DYNAMIC_DRAW);
 
 	void opengl_set_vertex_attribute(GLuint vbo, GLuint index, GLuint size, GLenum type);
+
+	/** Set a vertex attribute reading an interleaved buffer
+	* @normalized: integer values are mapped to [0,1] (unsigned) or [-1,1] (signed) when GL_TRUE
+	* @stride: size in Bytes of one vertex, @offset: offset in Bytes of the attribute within the vertex */
+	void opengl_set_vertex_attribute(GLuint vbo, GLuint index, GLuint size, GLenum type, GLboolean normalized, GLsizei stride, size_t offset);
 }
 
 
@@ -23,6 +29,10 @@ namespace vcl
 	template <typename T>
 	void opengl_create_gl_buffer_data(GLuint buffer_type, GLuint& vbo, T const& element, GLenum draw_type)
 	{
+		// The element buffer binding is part of the VAO: don't modify the last one bound
+		if(buffer_type==GL_ELEMENT_ARRAY_BUFFER)
+			opengl_bind_vertex_array(0);
+
 		glGenBuffers(1, &vbo);                                                       opengl_check
 		glBindBuffer(buffer_type, vbo);                                              opengl_check
 		glBufferData(buffer_type, GLsizeiptr(size_in_memory(element)), ptr(element), draw_type); opengl_check
@@ -3,6 +3,9 @@
 #include "glad/glad.hpp"
 #include "helper/opengl_helper.hpp"
 #include "debug/debug.hpp"
+#include "state/opengl_state.hpp"
 #include "uniform/uniform.hpp"
+#include "uniform_buffer/uniform_buffer.hpp"
 #include "shaders/shaders.hpp"
-#include "texture/texture.hpp"
\ No newline at end of file
+#include "texture/texture.hpp"
+#include "texture_dynamic/texture_dynamic.hpp"
\ No newline at end of file
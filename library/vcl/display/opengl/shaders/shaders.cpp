@@ -1,6 +1,8 @@
 #include "shaders.hpp"
 
 #include "vcl/base/base.hpp"
+#include "../uniform/uniform.hpp"
+#include "../uniform_buffer/uniform_buffer.hpp"
 #include <iostream>
 
 namespace vcl
@@ -101,6 +103,11 @@ namespace vcl
         glDetachShader( program_id, vertex_shader_id);
         glDetachShader( program_id, fragment_shader_id);
 
+        // Locations of the uniforms listed once
+        opengl_uniform_introspect(program_id);
+        // Uniform blocks of the preset shaders
+        opengl_uniform_block_binding(program_id);
+
         return program_id;
 	}
 }
\ No newline at end of file
@@ -0,0 +1,225 @@
+#include "opengl_state.hpp"
+
+#include "vcl/base/base.hpp"
+#include "vcl/display/opengl/debug/debug.hpp"
+
+#include <array>
+
+namespace vcl
+{
+	namespace
+	{
+		// Cached value, invalid until it is set once
+		template <typename T>
+		struct cached
+		{
+			T value = T();
+			bool valid = false;
+		};
+
+		struct buffer_range
+		{
+			GLuint buffer;
+			size_t offset;
+			size_t size;
+			bool operator==(buffer_range const& other) const { return buffer==other.buffer && offset==other.offset && size==other.size; }
+		};
+
+		struct blend_function
+		{
+			GLenum source;
+			GLenum destination;
+			bool operator==(blend_function const& other) const { return source==other.source && destination==other.destination; }
+		};
+
+		struct polygon_offset
+		{
+			float factor;
+			float units;
+			bool operator==(polygon_offset const& other) const { return factor==other.factor && units==other.units; }
+		};
+
+		size_t const texture_unit_count = 16;
+		size_t const uniform_binding_count = 16;
+		GLenum const cached_capabilities[] = {GL_BLEND, GL_DEPTH_TEST, GL_CULL_FACE, GL_POLYGON_OFFSET_FILL, GL_POLYGON_OFFSET_LINE};
+		size_t const capability_count = sizeof(cached_capabilities)/sizeof(GLenum);
+
+		struct opengl_state
+		{
+			cached<GLuint> program;
+			cached<GLuint> vao;
+			cached<GLuint> active_texture;
+			std::array<cached<GLuint>, texture_unit_count> texture;
+			std::array<cached<buffer_range>, uniform_binding_count> uniform_block;
+			std::array<cached<bool>, capability_count> capability;
+			cached<blend_function> blend;
+			cached<bool> depth_mask;
+			cached<GLenum> polygon_mode;
+			cached<polygon_offset> offset;
+
+			opengl_state_counters counters;
+		};
+
+		opengl_state& state()
+		{
+			static opengl_state s;
+			return s;
+		}
+
+		// Returns true if the value must be sent to OpenGL, and stores it
+		template <typename T>
+		bool change(cached<T>& current, T const& value)
+		{
+			opengl_state_counters& counters = state().counters;
+			if(current.valid && current.value==value) {
+				counters.skipped++;
+				return false;
+			}
+			current.value = value;
+			current.valid = true;
+			counters.issued++;
+			return true;
+		}
+
+		size_t capability_index(GLenum capability)
+		{
+			for(size_t k=0; k<capability_count; ++k)
+				if(cached_capabilities[k]==capability)
+					return k;
+			return capability_count;
+		}
+	}
+
+	void opengl_use_program(GLuint program)
+	{
+		if(change(state().program, program)) {
+			glUseProgram(program); opengl_check;
+		}
+	}
+
+	void opengl_bind_vertex_array(GLuint vao)
+	{
+		if(change(state().vao, vao)) {
+			glBindVertexArray(vao); opengl_check;
+		}
+	}
+
+	void opengl_bind_texture(GLuint texture, GLuint unit)
+	{
+		assert_vcl(unit<texture_unit_count, "Texture unit "+str(unit)+" is not cached");
+		opengl_state& s = state();
+		if(s.texture[unit].valid && s.texture[unit].value==texture) {
+			s.counters.skipped++;
+			return;
+		}
+		if(change(s.active_texture, unit)) {
+			glActiveTexture(GL_TEXTURE0+unit); opengl_check;
+		}
+		change(s.texture[unit], texture);
+		glBindTexture(GL_TEXTURE_2D, texture); opengl_check;
+	}
+
+	void opengl_bind_buffer_range(GLuint binding, GLuint buffer, size_t offset, size_t size)
+	{
+		assert_vcl(binding<uniform_binding_count, "Uniform block binding "+str(binding)+" is not cached");
+		if(change(state().uniform_block[binding], buffer_range{buffer, offset, size})) {
+			glBindBufferRange(GL_UNIFORM_BUFFER, binding, buffer, GLintptr(offset), GLsizeiptr(size)); opengl_check;
+		}
+	}
+
+	void opengl_enable(GLenum capability, bool enabled)
+	{
+		size_t const index = capability_index(capability);
+		if(index==capability_count)
+			state().counters.issued++;
+		if(index==capability_count || change(state().capability[index], enabled)) {
+			if(enabled)
+				glEnable(capability);
+			else
+				glDisable(capability);
+			opengl_check;
+		}
+	}
+
+	void opengl_blend_func(GLenum source, GLenum destination)
+	{
+		if(change(state().blend, blend_function{source, destination})) {
+			glBlendFunc(source, destination); opengl_check;
+		}
+	}
+
+	void opengl_depth_mask(bool write)
+	{
+		if(change(state().depth_mask, write)) {
+			glDepthMask(write? GL_TRUE : GL_FALSE); opengl_check;
+		}
+	}
+
+	void opengl_polygon_mode(GLenum mode)
+	{
+		if(change(state().polygon_mode, mode)) {
+			glPolygonMode(GL_FRONT_AND_BACK, mode); opengl_check;
+		}
+	}
+
+	void opengl_polygon_offset(float factor, float units)
+	{
+		if(change(state().offset, polygon_offset{factor, units})) {
+			glPolygonOffset(factor, units); opengl_check;
+		}
+	}
+
+	// Deleting a bound object resets its binding to 0
+	void opengl_delete_vertex_array(GLuint& vao)
+	{
+		if(vao==0)
+			return;
+		opengl_state& s = state();
+		if(s.vao.valid && s.vao.value==vao)
+			s.vao.value = 0;
+		glDeleteVertexArrays(1, &vao); opengl_check;
+		vao = 0;
+	}
+
+	void opengl_delete_texture(GLuint& texture)
+	{
+		if(texture==0)
+			return;
+		for(cached<GLuint>& unit : state().texture)
+			if(unit.valid && unit.value==texture)
+				unit.value = 0;
+		glDeleteTextures(1, &texture); opengl_check;
+		texture = 0;
+	}
+
+	void opengl_delete_buffer(GLuint& buffer)
+	{
+		if(buffer==0)
+			return;
+		for(cached<buffer_range>& binding : state().uniform_block)
+			if(binding.valid && binding.value.buffer==buffer)
+				binding.value = buffer_range{0, 0, 0};
+		glDeleteBuffers(1, &buffer); opengl_check;
+		buffer = 0;
+	}
+
+	void opengl_state_invalidate()
+	{
+		opengl_state& s = state();
+		opengl_state_counters const counters = s.counters;
+		s = opengl_state();
+		s.counters = counters;
+	}
+
+	opengl_state_counters opengl_state_frame_counters()
+	{
+		return state().counters;
+	}
+
+	opengl_state_counters opengl_state_next_frame()
+	{
+		opengl_state_counters const counters = state().counters;
+		state().counters = opengl_state_counters();
+		return counters;
+	}
+}
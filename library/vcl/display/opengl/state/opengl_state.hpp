@@ -0,0 +1,46 @@
+#pragma once
+
+#include "vcl/display/opengl/glad/glad.hpp"
+
+#include <cstddef>
+
+namespace vcl
+{
+	/** Cache of the OpenGL state used by the drawables: a change to the current value is skipped
+	* All the VCL code binding programs, vertex arrays, textures and uniform blocks goes through these functions.
+	* Code calling OpenGL directly (ex. ImGui) must be followed by opengl_state_invalidate().
+	* The cache is used from the OpenGL thread only. */
+
+	void opengl_use_program(GLuint program);
+	void opengl_bind_vertex_array(GLuint vao);
+	/** Bind a GL_TEXTURE_2D on a texture unit (glActiveTexture is called only if the unit changes) */
+	void opengl_bind_texture(GLuint texture, GLuint unit=0);
+	/** Bind a range of buffer to an indexed GL_UNIFORM_BUFFER binding point */
+	void opengl_bind_buffer_range(GLuint binding, GLuint buffer, size_t offset, size_t size);
+
+	/** glEnable/glDisable of GL_BLEND, GL_DEPTH_TEST, GL_CULL_FACE, GL_POLYGON_OFFSET_FILL or GL_POLYGON_OFFSET_LINE (other capabilities are not cached) */
+	void opengl_enable(GLenum capability, bool enabled=true);
+	void opengl_blend_func(GLenum source, GLenum destination);
+	void opengl_depth_mask(bool write);
+	/** Polygon mode of the front and back faces */
+	void opengl_polygon_mode(GLenum mode);
+	void opengl_polygon_offset(float factor, float units);
+
+	/** Delete the object and remove it from the cache (a new object can get the same id) */
+	void opengl_delete_vertex_array(GLuint& vao);
+	void opengl_delete_texture(GLuint& texture);
+	void opengl_delete_buffer(GLuint& buffer);
+
+	/** Forget all the cached values: the next change of each state is issued */
+	void opengl_state_invalidate();
+
+	struct opengl_state_counters
+	{
+		size_t issued = 0;  // state changes sent to OpenGL
+		size_t skipped = 0; // redundant changes
+	};
+	/** Counters since the beginning of the frame */
+	opengl_state_counters opengl_state_frame_counters();
+	/** Start a new frame: returns the counters of the previous one and resets them */
+	opengl_state_counters opengl_state_next_frame();
+}
@@ -1,6 +1,17 @@
 #include "texture.hpp"
 
 #include "vcl/base/base.hpp"
+#include "vcl/display/opengl/state/opengl_state.hpp"
+
+#include <cstring>
+
+// S3TC formats are not part of the core profile loaded by glad
+#ifndef GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_RGB_S3TC_DXT1_EXT 0x83F0
+#endif
+#ifndef GL_COMPRESSED_RGBA_S3TC_DXT5_EXT
+#define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT 0x83F3
+#endif
 
 namespace vcl
 {
@@ -8,7 +19,7 @@ namespace vcl
     {
         GLuint id = 0;
         glGenTextures(1,&id); opengl_check;
-        glBindTexture(GL_TEXTURE_2D,id); opengl_check;
+        opengl_bind_texture(id); opengl_check;
 
         // Send texture on GPU
         if(im.color_type==image_color_type::rgba){
@@ -26,7 +37,7 @@ namespace vcl
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR); opengl_check;
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR); opengl_check;
 
-        glBindTexture(GL_TEXTURE_2D,0); opengl_check;
+        opengl_bind_texture(0); opengl_check;
 
         return id;
     }
@@ -34,7 +45,7 @@ namespace vcl
     {
         GLuint id = 0;
         glGenTextures(1,&id); opengl_check;
-        glBindTexture(GL_TEXTURE_2D,id); opengl_check;
+        opengl_bind_texture(id); opengl_check;
 
         // Send texture on GPU
         glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB32F, GLsizei(im.dimension.x), GLsizei(im.dimension.y), 0, GL_RGB, GL_FLOAT, ptr(im.data)); opengl_check;
@@ -47,7 +58,7 @@ namespace vcl
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
 
-        glBindTexture(GL_TEXTURE_2D,0);
+        opengl_bind_texture(0);
 
         return id;
     }
@@ -55,10 +66,141 @@ namespace vcl
     {
         assert_vcl(glIsTexture(texture_id), "Incorrect texture id");
 
-        glBindTexture(GL_TEXTURE_2D, texture_id);
+        opengl_bind_texture(texture_id);
         glTexSubImage2D(GL_TEXTURE_2D, 0, 0,0, GLsizei(im.dimension.x), GLsizei(im.dimension.y), GL_RGB, GL_FLOAT, ptr(im.data));
         glGenerateMipmap(GL_TEXTURE_2D);
-        glBindTexture(GL_TEXTURE_2D,0);
+        opengl_bind_texture(0);
+    }
+
+    static void set_texture_parameters(GLint wrap_s, GLint wrap_t, size_t level_count)
+    {
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, 0); opengl_check;
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, GLint(level_count)-1); opengl_check;
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, wrap_s); opengl_check;
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, wrap_t); opengl_check;
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR); opengl_check;
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, level_count>1? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR); opengl_check;
+    }
+
+    GLuint opengl_texture_to_gpu(buffer<image_raw> const& mipmap, GLint wrap_s, GLint wrap_t)
+    {
+        assert_vcl(mipmap.size()>0, "Empty mipmap");
+        GLuint id = 0;
+        glGenTextures(1,&id); opengl_check;
+        opengl_bind_texture(id); opengl_check;
+
+        // The rows of the rgb levels are not aligned on 4 bytes
+        // The levels are stored with 8 bits per channel, as computed by image_mipmap_chain
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1); opengl_check;
+        for(size_t k=0; k<mipmap.size(); ++k) {
+            image_raw const& im = mipmap[k];
+            assert_vcl(im.color_type==mipmap[0].color_type, "Mipmap levels with different color types");
+            if(im.color_type==image_color_type::rgba){
+                glTexImage2D(GL_TEXTURE_2D, GLint(k), GL_RGBA8, im.width, im.height, 0, GL_RGBA, GL_UNSIGNED_BYTE, im.data.data.data()); opengl_check;
+            }
+            if(im.color_type==image_color_type::rgb){
+                glTexImage2D(GL_TEXTURE_2D, GLint(k), GL_RGB8, im.width, im.height, 0, GL_RGB, GL_UNSIGNED_BYTE, im.data.data.data()); opengl_check;
+            }
+        }
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4); opengl_check;
+
+        set_texture_parameters(wrap_s, wrap_t, mipmap.size());
+        opengl_bind_texture(0); opengl_check;
+        return id;
+    }
+
+    GLuint opengl_texture_to_gpu(buffer<grid_2D<vec3>> const& mipmap, GLint wrap_s, GLint wrap_t)
+    {
+        assert_vcl(mipmap.size()>0, "Empty mipmap");
+        GLuint id = 0;
+        glGenTextures(1,&id); opengl_check;
+        opengl_bind_texture(id); opengl_check;
+
+        for(size_t k=0; k<mipmap.size(); ++k) {
+            grid_2D<vec3> const& im = mipmap[k];
+            glTexImage2D(GL_TEXTURE_2D, GLint(k), GL_RGB32F, GLsizei(im.dimension.x), GLsizei(im.dimension.y), 0, GL_RGB, GL_FLOAT, im.data.data.data()); opengl_check;
+        }
+
+        set_texture_parameters(wrap_s, wrap_t, mipmap.size());
+        opengl_bind_texture(0); opengl_check;
+        return id;
+    }
+
+    void opengl_update_texture_gpu(GLuint texture_id, grid_2D<vec3> const& im, image_rectangle const& region, GLint level)
+    {
+        assert_vcl(glIsTexture(texture_id), "Incorrect texture id");
+        assert_vcl(region.x+region.width<=im.dimension.x && region.y+region.height<=im.dimension.y, "Region outside of the image");
+        if(region.width==0 || region.height==0)
+            return;
+
+        // Only the pixels of the region are read from the full image
+        opengl_bind_texture(texture_id); opengl_check;
+        glPixelStorei(GL_UNPACK_ROW_LENGTH, GLint(im.dimension.x)); opengl_check;
+        glPixelStorei(GL_UNPACK_SKIP_PIXELS, GLint(region.x)); opengl_check;
+        glPixelStorei(GL_UNPACK_SKIP_ROWS, GLint(region.y)); opengl_check;
+        glTexSubImage2D(GL_TEXTURE_2D, level, GLint(region.x), GLint(region.y), GLsizei(region.width), GLsizei(region.height), GL_RGB, GL_FLOAT, im.data.data.data()); opengl_check;
+        glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+        glPixelStorei(GL_UNPACK_SKIP_PIXELS, 0);
+        glPixelStorei(GL_UNPACK_SKIP_ROWS, 0);
+        opengl_bind_texture(0);
+    }
+
+    void opengl_update_texture_gpu(GLuint texture_id, buffer<grid_2D<vec3>> const& mipmap, buffer<image_rectangle> const& regions)
+    {
+        assert_vcl(mipmap.size()==regions.size(), "One region is expected per mipmap level");
+        for(size_t k=0; k<mipmap.size(); ++k)
+            opengl_update_texture_gpu(texture_id, mipmap[k], regions[k], GLint(k));
     }
 
-}
\ No newline at end of file
+    static GLenum compressed_internal_format(image_block_format format)
+    {
+        switch(format) {
+        case image_block_format::bc1: return GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+        case image_block_format::bc3: return GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+        case image_block_format::bc4: return GL_COMPRESSED_RED_RGTC1;
+        case image_block_format::bc5: return GL_COMPRESSED_RG_RGTC2;
+        }
+        return GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+    }
+
+    bool opengl_texture_compression_supported(image_block_format format)
+    {
+        if(format==image_block_format::bc4 || format==image_block_format::bc5)
+            return true;
+
+        GLint N_extension = 0;
+        glGetIntegerv(GL_NUM_EXTENSIONS, &N_extension); opengl_check;
+        for(GLint k=0; k<N_extension; ++k) {
+            char const* name = reinterpret_cast<char const*>(glGetStringi(GL_EXTENSIONS, GLuint(k)));
+            if(name!=nullptr && std::strcmp(name, "GL_EXT_texture_compression_s3tc")==0)
+                return true;
+        }
+        return false;
+    }
+
+    GLuint opengl_texture_to_gpu(image_compressed const& im, GLint wrap_s, GLint wrap_t)
+    {
+        buffer<image_compressed> mipmap;
+        mipmap.push_back(im);
+        return opengl_texture_to_gpu(mipmap, wrap_s, wrap_t);
+    }
+
+    GLuint opengl_texture_to_gpu(buffer<image_compressed> const& mipmap, GLint wrap_s, GLint wrap_t)
+    {
+        assert_vcl(mipmap.size()>0, "Empty mipmap");
+        GLenum const format = compressed_internal_format(mipmap[0].format);
+        GLuint id = 0;
+        glGenTextures(1,&id); opengl_check;
+        opengl_bind_texture(id); opengl_check;
+
+        for(size_t k=0; k<mipmap.size(); ++k) {
+            image_compressed const& im = mipmap[k];
+            assert_vcl(im.format==mipmap[0].format, "Mipmap levels with different block formats");
+            glCompressedTexImage2D(GL_TEXTURE_2D, GLint(k), format, GLsizei(im.width), GLsizei(im.height), 0, GLsizei(im.data.size()), im.data.data.data()); opengl_check;
+        }
+
+        set_texture_parameters(wrap_s, wrap_t, mipmap.size());
+        opengl_bind_texture(0); opengl_check;
+        return id;
+    }
+}
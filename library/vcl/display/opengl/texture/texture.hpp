@@ -1,6 +1,8 @@
 #pragma once
 
 #include "vcl/display/image/image.hpp"
+#include "vcl/display/image/resample/image_resample.hpp"
+#include "vcl/display/image/compress/image_compress.hpp"
 #include "vcl/display/opengl/opengl.hpp"
 #include "vcl/containers/containers.hpp"
 
@@ -9,5 +11,20 @@ namespace vcl
 	GLuint opengl_texture_to_gpu(image_raw const& im, GLint wrap_s=GL_CLAMP_TO_EDGE, GLint wrap_t=GL_CLAMP_TO_EDGE);
 	GLuint opengl_texture_to_gpu(grid_2D<vec3> const& im, GLint wrap_s=GL_CLAMP_TO_EDGE, GLint wrap_t=GL_CLAMP_TO_EDGE);
 	void opengl_update_texture_gpu(GLuint texture_id, grid_2D<vec3> const& im);
+
+	/** Send a texture with its prebuilt mipmap levels (level 0 first, ex. from image_mipmap_chain): glGenerateMipmap is not called */
+	GLuint opengl_texture_to_gpu(buffer<image_raw> const& mipmap, GLint wrap_s=GL_CLAMP_TO_EDGE, GLint wrap_t=GL_CLAMP_TO_EDGE);
+	GLuint opengl_texture_to_gpu(buffer<grid_2D<vec3>> const& mipmap, GLint wrap_s=GL_CLAMP_TO_EDGE, GLint wrap_t=GL_CLAMP_TO_EDGE);
+	/** Update the region of one level of a texture (im is the full image of this level), the other levels are not modified */
+	void opengl_update_texture_gpu(GLuint texture_id, grid_2D<vec3> const& im, image_rectangle const& region, GLint level=0);
+	/** Update the regions of each mipmap level (ex. returned by image_mipmap_update) */
+	void opengl_update_texture_gpu(GLuint texture_id, buffer<grid_2D<vec3>> const& mipmap, buffer<image_rectangle> const& regions);
+
+	/** Send a block compressed texture (glCompressedTexImage2D), with its mipmap levels if more than one image is given
+	* bc1 and bc3 require the extension GL_EXT_texture_compression_s3tc (see opengl_texture_compression_supported), bc4 and bc5 are core since OpenGL 3.0 */
+	GLuint opengl_texture_to_gpu(image_compressed const& im, GLint wrap_s=GL_CLAMP_TO_EDGE, GLint wrap_t=GL_CLAMP_TO_EDGE);
+	GLuint opengl_texture_to_gpu(buffer<image_compressed> const& mipmap, GLint wrap_s=GL_CLAMP_TO_EDGE, GLint wrap_t=GL_CLAMP_TO_EDGE);
+	/** Check if the current context can use the block format */
+	bool opengl_texture_compression_supported(image_block_format format);
     
 }
\ No newline at end of file
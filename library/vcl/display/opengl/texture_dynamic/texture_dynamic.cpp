@@ -0,0 +1,257 @@
+#include "texture_dynamic.hpp"
+
+#include "vcl/base/base.hpp"
+#include "vcl/display/opengl/debug/debug.hpp"
+#include "vcl/display/opengl/state/opengl_state.hpp"
+#include "vcl/display/image/convert/image_convert.hpp"
+#include "vcl/math/quantization/quantization.hpp"
+
+#include <algorithm>
+#include <vector>
+
+namespace vcl
+{
+	namespace
+	{
+		size_t texel_size(texture_upload_format format)
+		{
+			switch(format) {
+			case texture_upload_format::rgba8: return 4;
+			case texture_upload_format::rgb16f: return 6;
+			case texture_upload_format::rgb32f: return 12;
+			}
+			return 12;
+		}
+
+		GLint internal_format(texture_upload_format format)
+		{
+			switch(format) {
+			case texture_upload_format::rgba8: return GL_RGBA8;
+			case texture_upload_format::rgb16f: return GL_RGB16F;
+			case texture_upload_format::rgb32f: return GL_RGB32F;
+			}
+			return GL_RGB32F;
+		}
+
+		// Rectangles of modified tiles: consecutive tiles of a row are merged, then the identical spans of consecutive rows
+		std::vector<image_rectangle> modified_rectangles(grid_2D<unsigned char> const& tiles)
+		{
+			std::vector<image_rectangle> rectangles;
+			std::vector<size_t> open; // rectangles ending on the previous row
+			for(size_t ty=0; ty<tiles.dimension.y; ++ty) {
+				std::vector<size_t> current;
+				size_t tx = 0;
+				while(tx<tiles.dimension.x) {
+					if(tiles(tx,ty)==0) {
+						++tx;
+						continue;
+					}
+					size_t const start = tx;
+					while(tx<tiles.dimension.x && tiles(tx,ty)!=0)
+						++tx;
+
+					auto const it = std::find_if(open.begin(), open.end(), [&](size_t k){ return rectangles[k].x==start && rectangles[k].width==tx-start; });
+					if(it!=open.end()) {
+						rectangles[*it].height++;
+						current.push_back(*it);
+					}
+					else {
+						image_rectangle r;
+						r.x = start;
+						r.y = ty;
+						r.width = tx-start;
+						r.height = 1;
+						current.push_back(rectangles.size());
+						rectangles.push_back(r);
+					}
+				}
+				open.swap(current);
+			}
+			return rectangles;
+		}
+	}
+
+	texture_dynamic::texture_dynamic()
+	{}
+
+	texture_dynamic::texture_dynamic(grid_2D<vec3> const& image_arg, texture_dynamic_options const& options_arg)
+	{
+		initialize(image_arg, options_arg);
+	}
+
+	void texture_dynamic::initialize(grid_2D<vec3> const& image_arg, texture_dynamic_options const& options_arg)
+	{
+		assert_vcl(image_arg.dimension.x>0 && image_arg.dimension.y>0, "Empty texture image");
+		assert_vcl(options_arg.tile_size>0, "Tile size must be strictly positive");
+		clear();
+		options = options_arg;
+
+		if(options.mipmap)
+			mipmap = image_mipmap_chain(image_arg, options.mipmap_filter);
+		else {
+			mipmap.resize(1);
+			mipmap[0] = image_arg;
+		}
+
+		size_t const tile = options.tile_size;
+		modified_tiles.resize((image_arg.dimension.x+tile-1)/tile, (image_arg.dimension.y+tile-1)/tile);
+		modified_tiles.fill(0);
+		has_modification = false;
+
+		// Storage of all the levels, then full upload
+		glGenTextures(1, &id); opengl_check;
+		opengl_bind_texture(id); opengl_check;
+		for(size_t k=0; k<mipmap.size(); ++k) {
+			glTexImage2D(GL_TEXTURE_2D, GLint(k), internal_format(options.format), GLsizei(mipmap[k].dimension.x), GLsizei(mipmap[k].dimension.y), 0, GL_RGB, GL_FLOAT, nullptr); opengl_check;
+		}
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, 0); opengl_check;
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, GLint(mipmap.size())-1); opengl_check;
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, options.wrap_s); opengl_check;
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, options.wrap_t); opengl_check;
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR); opengl_check;
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, mipmap.size()>1? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR); opengl_check;
+		opengl_bind_texture(0); opengl_check;
+
+		last_update = texture_upload_counters();
+		total = texture_upload_counters();
+		for(size_t k=0; k<mipmap.size(); ++k) {
+			image_rectangle full;
+			full.width = mipmap[k].dimension.x;
+			full.height = mipmap[k].dimension.y;
+			upload(k, full);
+		}
+	}
+
+	void texture_dynamic::clear()
+	{
+		opengl_delete_texture(id);
+		mipmap.clear();
+		modified_tiles.clear();
+		has_modification = false;
+	}
+
+	grid_2D<vec3>& texture_dynamic::image()
+	{
+		assert_vcl(mipmap.size()>0, "Texture is not initialized");
+		return mipmap[0];
+	}
+	grid_2D<vec3> const& texture_dynamic::image() const
+	{
+		assert_vcl(mipmap.size()>0, "Texture is not initialized");
+		return mipmap[0];
+	}
+
+	void texture_dynamic::mark_modified(image_rectangle const& region)
+	{
+		grid_2D<vec3> const& im = image();
+		size_t const x_max = std::min(region.x+region.width, im.dimension.x);
+		size_t const y_max = std::min(region.y+region.height, im.dimension.y);
+		if(region.x>=x_max || region.y>=y_max)
+			return;
+
+		size_t const tile = options.tile_size;
+		for(size_t ty=region.y/tile; ty<=(y_max-1)/tile; ++ty)
+			for(size_t tx=region.x/tile; tx<=(x_max-1)/tile; ++tx)
+				modified_tiles(tx,ty) = 1;
+		has_modification = true;
+	}
+
+	void texture_dynamic::mark_modified(size_t x, size_t y)
+	{
+		assert_vcl(x<image().dimension.x && y<image().dimension.y, "Pixel outside of the texture");
+		modified_tiles(x/options.tile_size, y/options.tile_size) = 1;
+		has_modification = true;
+	}
+
+	void texture_dynamic::mark_all_modified()
+	{
+		modified_tiles.fill(1);
+		has_modification = true;
+	}
+
+	bool texture_dynamic::modified() const
+	{
+		return has_modification;
+	}
+
+	void texture_dynamic::update()
+	{
+		last_update = texture_upload_counters();
+		if(!has_modification)
+			return;
+
+		grid_2D<vec3> const& im = image();
+		size_t const tile = options.tile_size;
+		for(image_rectangle const& r : modified_rectangles(modified_tiles)) {
+			image_rectangle region;
+			region.x = r.x*tile;
+			region.y = r.y*tile;
+			region.width = std::min((r.x+r.width)*tile, im.dimension.x) - region.x;
+			region.height = std::min((r.y+r.height)*tile, im.dimension.y) - region.y;
+
+			upload(0, region);
+			if(mipmap.size()>1) {
+				buffer<image_rectangle> const levels = image_mipmap_update(mipmap, region, options.mipmap_filter);
+				for(size_t k=1; k<levels.size(); ++k)
+					upload(k, levels[k]);
+			}
+		}
+
+		modified_tiles.fill(0);
+		has_modification = false;
+	}
+
+	void texture_dynamic::upload(size_t level, image_rectangle const& region)
+	{
+		if(region.width==0 || region.height==0)
+			return;
+		grid_2D<vec3> const& im = mipmap[level];
+		size_t const N = region.width*region.height;
+
+		opengl_bind_texture(id); opengl_check;
+		switch(options.format) {
+		case texture_upload_format::rgba8: {
+			staging.resize(4*N);
+			image_view<unsigned char> const out(staging.data.data(), region.width, region.height, 4);
+			image_convert(image_view_of(im).subview(region.x, region.y, region.width, region.height), out);
+			glTexSubImage2D(GL_TEXTURE_2D, GLint(level), GLint(region.x), GLint(region.y), GLsizei(region.width), GLsizei(region.height), GL_RGBA, GL_UNSIGNED_BYTE, staging.data.data()); opengl_check;
+			break;
+		}
+		case texture_upload_format::rgb16f: {
+			staging_half.resize(3*N);
+			uint16_t* out = staging_half.data.data();
+			parallel_for(region.height, [&](size_t j){
+				float const* row = &im(region.x, region.y+j).x;
+				uint16_t* out_row = out + 3*region.width*j;
+				for(size_t i=0; i<3*region.width; ++i)
+					out_row[i] = float_to_half(row[i]);
+			}, 16);
+			// Rows of 6 bytes per texel are only aligned on 2 bytes
+			glPixelStorei(GL_UNPACK_ALIGNMENT, 2); opengl_check;
+			glTexSubImage2D(GL_TEXTURE_2D, GLint(level), GLint(region.x), GLint(region.y), GLsizei(region.width), GLsizei(region.height), GL_RGB, GL_HALF_FLOAT, out); opengl_check;
+			glPixelStorei(GL_UNPACK_ALIGNMENT, 4); opengl_check;
+			break;
+		}
+		case texture_upload_format::rgb32f: {
+			// The region is read directly in the full image
+			glPixelStorei(GL_UNPACK_ROW_LENGTH, GLint(im.dimension.x)); opengl_check;
+			glPixelStorei(GL_UNPACK_SKIP_PIXELS, GLint(region.x)); opengl_check;
+			glPixelStorei(GL_UNPACK_SKIP_ROWS, GLint(region.y)); opengl_check;
+			glTexSubImage2D(GL_TEXTURE_2D, GLint(level), GLint(region.x), GLint(region.y), GLsizei(region.width), GLsizei(region.height), GL_RGB, GL_FLOAT, im.data.data.data()); opengl_check;
+			glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+			glPixelStorei(GL_UNPACK_SKIP_PIXELS, 0);
+			glPixelStorei(GL_UNPACK_SKIP_ROWS, 0);
+			break;
+		}
+		}
+		opengl_bind_texture(0); opengl_check;
+
+		size_t const bytes = N*texel_size(options.format);
+		last_update.bytes += bytes;
+		last_update.texels += N;
+		last_update.regions++;
+		total.bytes += bytes;
+		total.texels += N;
+		total.regions++;
+	}
+}
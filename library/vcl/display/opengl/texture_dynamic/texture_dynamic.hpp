@@ -0,0 +1,81 @@
+#pragma once
+
+#include "vcl/display/opengl/glad/glad.hpp"
+#include "vcl/display/image/resample/image_resample.hpp"
+#include "vcl/containers/containers.hpp"
+
+#include <cstdint>
+
+namespace vcl
+{
+	/** Format of the texture on the GPU, the float values are converted on the CPU before the upload
+	* rgba8: 4 bytes per texel (values clamped in [0,1]), rgb16f: 6 bytes (half floats), rgb32f: 12 bytes (no conversion) */
+	enum class texture_upload_format {rgba8, rgb16f, rgb32f};
+
+	struct texture_dynamic_options
+	{
+		texture_upload_format format = texture_upload_format::rgba8;
+		/** Mipmap levels computed on the CPU, only in the region of the modified tiles (glGenerateMipmap recomputes the full texture) */
+		bool mipmap = true;
+		image_filter mipmap_filter = image_filter::box;
+		/** Size in pixels of the square tiles tracking the modifications */
+		size_t tile_size = 64;
+		GLint wrap_s = GL_CLAMP_TO_EDGE;
+		GLint wrap_t = GL_CLAMP_TO_EDGE;
+	};
+
+	struct texture_upload_counters
+	{
+		size_t bytes = 0;   // data sent to glTexSubImage2D
+		size_t texels = 0;
+		size_t regions = 0; // number of glTexSubImage2D calls
+	};
+
+	/** Texture painted on the CPU and updated on the GPU once per frame
+	* The modified regions of the image are declared with mark_modified, update() sends only the modified tiles (merged in rectangles)
+	*  and the mipmap levels depending on them.
+	* ex.
+	*   texture_dynamic canvas(grid_2D<vec3>(4096,4096));
+	*   // animation loop
+	*   canvas.image()(x,y) = color;
+	*   canvas.mark_modified(x,y);
+	*   canvas.update();
+	*   drawable.texture = canvas.id; */
+	struct texture_dynamic
+	{
+		texture_dynamic();
+		explicit texture_dynamic(grid_2D<vec3> const& image, texture_dynamic_options const& options=texture_dynamic_options());
+
+		/** Create the texture and send the full image */
+		void initialize(grid_2D<vec3> const& image, texture_dynamic_options const& options=texture_dynamic_options());
+		/** Delete the texture */
+		void clear();
+
+		/** CPU image (level 0), modified by the user */
+		grid_2D<vec3>& image();
+		grid_2D<vec3> const& image() const;
+
+		/** Declare a modification of the image (the region is clamped to the image) */
+		void mark_modified(image_rectangle const& region);
+		void mark_modified(size_t x, size_t y);
+		void mark_all_modified();
+		bool modified() const;
+
+		/** Send the modified tiles to the GPU (and update their mipmap region), the counters of this update are in last_update */
+		void update();
+
+		GLuint id = 0;
+		texture_dynamic_options options;
+		texture_upload_counters last_update;
+		texture_upload_counters total;
+
+	private:
+		void upload(size_t level, image_rectangle const& region);
+
+		buffer<grid_2D<vec3>> mipmap;
+		grid_2D<unsigned char> modified_tiles;
+		bool has_modification = false;
+		buffer<unsigned char> staging;
+		buffer<uint16_t> staging_half;
+	};
+}
@@ -0,0 +1,150 @@
+#include "test_uniform.hpp"
+
+#include "vcl/base/base.hpp"
+#include "vcl/display/opengl/debug/debug.hpp"
+#include "vcl/display/opengl/state/opengl_state.hpp"
+#include "vcl/display/opengl/uniform/uniform.hpp"
+#include "vcl/display/drawable/shading_parameters/shading_parameters.hpp"
+
+#include <chrono>
+#include <iostream>
+#include <string>
+
+using namespace vcl;
+
+namespace vcl_test
+{
+	namespace
+	{
+		// The function pointers loaded by glad are replaced by counting wrappers during the benchmark
+		size_t counter_location = 0;
+		size_t counter_error = 0;
+		size_t counter_uniform = 0;
+
+		PFNGLGETUNIFORMLOCATIONPROC original_location;
+		PFNGLGETERRORPROC original_error;
+		PFNGLUNIFORM1IPROC original_1i;
+		PFNGLUNIFORM1FPROC original_1f;
+		PFNGLUNIFORM3FPROC original_3f;
+		PFNGLUNIFORMMATRIX4FVPROC original_matrix4;
+
+		GLint APIENTRY count_location(GLuint program, GLchar const* name) { counter_location++; return original_location(program, name); }
+		GLenum APIENTRY count_error() { counter_error++; return original_error(); }
+		void APIENTRY count_1i(GLint location, GLint v) { counter_uniform++; original_1i(location, v); }
+		void APIENTRY count_1f(GLint location, GLfloat v) { counter_uniform++; original_1f(location, v); }
+		void APIENTRY count_3f(GLint location, GLfloat x, GLfloat y, GLfloat z) { counter_uniform++; original_3f(location, x, y, z); }
+		void APIENTRY count_matrix4(GLint location, GLsizei count, GLboolean transpose, GLfloat const* m) { counter_uniform++; original_matrix4(location, count, transpose, m); }
+
+		void start_counting()
+		{
+			original_location = glad_glGetUniformLocation; glad_glGetUniformLocation = count_location;
+			original_error = glad_glGetError; glad_glGetError = count_error;
+			original_1i = glad_glUniform1i; glad_glUniform1i = count_1i;
+			original_1f = glad_glUniform1f; glad_glUniform1f = count_1f;
+			original_3f = glad_glUniform3f; glad_glUniform3f = count_3f;
+			original_matrix4 = glad_glUniformMatrix4fv; glad_glUniformMatrix4fv = count_matrix4;
+		}
+		void stop_counting()
+		{
+			glad_glGetUniformLocation = original_location;
+			glad_glGetError = original_error;
+			glad_glUniform1i = original_1i;
+			glad_glUniform1f = original_1f;
+			glad_glUniform3f = original_3f;
+			glad_glUniformMatrix4fv = original_matrix4;
+		}
+		void reset_counters()
+		{
+			counter_location = 0;
+			counter_error = 0;
+			counter_uniform = 0;
+		}
+
+		// Previous implementation of opengl_uniform: the location is queried at each call
+		void uniform_value(GLint location, int value) { glUniform1i(location, value); }
+		void uniform_value(GLint location, float value) { glUniform1f(location, value); }
+		void uniform_value(GLint location, vec3 const& value) { glUniform3f(location, value.x, value.y, value.z); }
+		void uniform_value(GLint location, mat4 const& value) { glUniformMatrix4fv(location, 1, GL_TRUE, ptr(value)); }
+		template <typename T> void send_uniform_uncached(GLuint shader, std::string const& name, T const& value)
+		{
+			GLint const location = glGetUniformLocation(shader, name.c_str()); opengl_check;
+			if(location!=-1)
+				uniform_value(location, value);
+			opengl_check;
+		}
+
+		void draw_uncached(GLuint shader, shading_parameters_phong const& shading, mat4 const& model)
+		{
+			send_uniform_uncached(shader, "color", shading.color);
+			send_uniform_uncached(shader, "alpha", shading.alpha);
+			send_uniform_uncached(shader, "Ka", shading.phong.ambient);
+			send_uniform_uncached(shader, "Kd", shading.phong.diffuse);
+			send_uniform_uncached(shader, "Ks", shading.phong.specular);
+			send_uniform_uncached(shader, "specular_exp", shading.phong.specular_exponent);
+			send_uniform_uncached(shader, "use_texture", int(shading.use_texture));
+			send_uniform_uncached(shader, "texture_inverse_y", int(shading.texture_inverse_y));
+			send_uniform_uncached(shader, "model", model);
+			send_uniform_uncached(shader, "image_texture", 0);
+		}
+
+		void draw_string(GLuint shader, shading_parameters_phong const& shading, mat4 const& model)
+		{
+			opengl_uniform(shader, "color", shading.color, false);
+			opengl_uniform(shader, "alpha", shading.alpha, false);
+			opengl_uniform(shader, "Ka", shading.phong.ambient, false);
+			opengl_uniform(shader, "Kd", shading.phong.diffuse, false);
+			opengl_uniform(shader, "Ks", shading.phong.specular, false);
+			opengl_uniform(shader, "specular_exp", shading.phong.specular_exponent, false);
+			opengl_uniform(shader, "use_texture", shading.use_texture, false);
+			opengl_uniform(shader, "texture_inverse_y", shading.texture_inverse_y, false);
+			opengl_uniform(shader, "model", model, false);
+			opengl_uniform(shader, "image_texture", 0, false);
+		}
+
+		void draw_interned(GLuint shader, shading_parameters_phong const& shading, mat4 const& model)
+		{
+			static opengl_uniform_name const color("color"), alpha("alpha"), Ka("Ka"), Kd("Kd"), Ks("Ks"), specular_exp("specular_exp");
+			static opengl_uniform_name const use_texture("use_texture"), texture_inverse_y("texture_inverse_y"), model_name("model"), image_texture("image_texture");
+			opengl_uniform(shader, color, shading.color, false);
+			opengl_uniform(shader, alpha, shading.alpha, false);
+			opengl_uniform(shader, Ka, shading.phong.ambient, false);
+			opengl_uniform(shader, Kd, shading.phong.diffuse, false);
+			opengl_uniform(shader, Ks, shading.phong.specular, false);
+			opengl_uniform(shader, specular_exp, shading.phong.specular_exponent, false);
+			opengl_uniform(shader, use_texture, shading.use_texture, false);
+			opengl_uniform(shader, texture_inverse_y, shading.texture_inverse_y, false);
+			opengl_uniform(shader, model_name, model, false);
+			opengl_uniform(shader, image_texture, 0, false);
+		}
+	}
+
+	void benchmark_opengl_uniform(GLuint shader, size_t N_draw)
+	{
+		assert_vcl(shader!=0 && N_draw>0, "Invalid shader or number of draws");
+		using clock = std::chrono::steady_clock;
+		auto seconds = [](clock::time_point t0) { return std::chrono::duration<double>(clock::now()-t0).count(); };
+
+		opengl_use_program(shader);
+		shading_parameters_phong const shading;
+		mat4 const model = mat4::identity();
+
+		struct variant { std::string name; void (*draw)(GLuint, shading_parameters_phong const&, mat4 const&); };
+		variant const variants[] = { {"Location per call", draw_uncached}, {"String names     ", draw_string}, {"Interned names   ", draw_interned} };
+
+		start_counting();
+		for(variant const& v : variants) {
+			v.draw(shader, shading, model); // fill the caches
+			reset_counters();
+			clock::time_point const t0 = clock::now();
+			for(size_t k=0; k<N_draw; ++k)
+				v.draw(shader, shading, model);
+			double const t = seconds(t0);
+			std::cout << v.name << ": " << t*1e6/N_draw << " us/draw, GL calls per draw: "
+				<< double(counter_location)/N_draw << " glGetUniformLocation, "
+				<< double(counter_error)/N_draw << " glGetError, "
+				<< double(counter_uniform)/N_draw << " glUniform" << std::endl;
+		}
+		stop_counting();
+		opengl_use_program(0);
+	}
+}
@@ -0,0 +1,13 @@
+#pragma once
+
+#include "vcl/display/opengl/glad/glad.hpp"
+
+#include <cstddef>
+
+namespace vcl_test
+{
+	/** Count the OpenGL calls and measure the time per draw to send the uniforms of a mesh_drawable (shading, model, texture)
+	* with the location queried at each call (previous behavior), the string names and the interned names.
+	* Requires a current OpenGL context, shader is a linked program (ex. mesh_drawable::default_shader). */
+	void benchmark_opengl_uniform(GLuint shader, size_t N_draw=10000);
+}
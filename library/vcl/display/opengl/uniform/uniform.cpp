@@ -4,6 +4,9 @@
 #include "vcl/base/base.hpp"
 #include "vcl/display/opengl/debug/debug.hpp"
 
+#include <unordered_map>
+#include <vector>
+
 #define CHECK_OPENGL_UNIFORM_WARNING
 
 #ifdef CHECK_OPENGL_UNIFORM_STRICT
@@ -16,76 +19,253 @@
 #endif
 #endif
 
+// The error check after each uniform is skipped with VCL_NO_DEBUG: a draw sends many uniforms, and glGetError may synchronize with the driver
+#ifndef VCL_NO_DEBUG
+#define opengl_check_uniform opengl_check
+#else
+#define opengl_check_uniform
+#endif
+
 namespace vcl
 {
-	static bool check_location(GLint location, std::string const& name, GLuint shader, bool expected)
+	namespace
 	{
-		if (location == -1 && expected == true)
+		// Table of interned names
+		struct uniform_name_table
+		{
+			std::unordered_map<std::string, size_t> id;
+			std::vector<std::string> name;
+		};
+		uniform_name_table& uniform_names()
+		{
+			static uniform_name_table table;
+			return table;
+		}
+
+		// Location of each interned name in a program (location_unknown: not queried yet)
+		GLint const location_unknown = -2;
+		struct program_uniforms
+		{
+			std::vector<GLint> location;
+		};
+		std::unordered_map<GLuint, program_uniforms>& program_cache()
+		{
+			static std::unordered_map<GLuint, program_uniforms> cache;
+			return cache;
+		}
+
+		// The uniforms of a draw call are sent to the same program: the last one is looked up first
+		GLuint last_program = 0;
+		program_uniforms* last_uniforms = nullptr;
+
+		size_t intern(std::string const& name)
+		{
+			uniform_name_table& table = uniform_names();
+			auto const it = table.id.find(name);
+			if(it!=table.id.end())
+				return it->second;
+			size_t const id = table.name.size();
+			table.name.push_back(name);
+			table.id[name] = id;
+			return id;
+		}
+
+		program_uniforms& uniforms_of(GLuint shader)
+		{
+			if(shader==last_program && last_uniforms!=nullptr)
+				return *last_uniforms;
+
+			std::unordered_map<GLuint, program_uniforms>& cache = program_cache();
+			auto it = cache.find(shader);
+			if(it==cache.end()) {
+				// Program not created by opengl_create_shader_program
+				opengl_uniform_introspect(shader);
+				it = cache.find(shader);
+			}
+			last_program = shader;
+			last_uniforms = &it->second;
+			return it->second;
+		}
+
+		GLint checked_location(GLuint shader, opengl_uniform_name const& name, bool expected)
 		{
-			error_vcl("Try to send uniform variable ["+name+"] to a shader that doesn't use it.\n Either change the uniform variable to expected=false, or correct the associated shader (id="+str(shader)+").");
+			assert_vcl(shader!=0, "Try to send unifor "+name.str()+" to unspecified shader");
+			GLint const location = opengl_uniform_location(shader, name);
+			if (location == -1 && expected == true)
+			{
+				error_vcl("Try to send uniform variable ["+name.str()+"] to a shader that doesn't use it.\n Either change the uniform variable to expected=false, or correct the associated shader (id="+str(shader)+").");
+			}
+			return location;
+		}
+	}
+
+	opengl_uniform_name::opengl_uniform_name(std::string const& name)
+		:id(intern(name))
+	{}
+
+	std::string const& opengl_uniform_name::str() const
+	{
+		return uniform_names().name[id];
+	}
+
+	GLint opengl_uniform_location(GLuint shader, opengl_uniform_name const& name)
+	{
+		program_uniforms& uniforms = uniforms_of(shader);
+		if(name.id>=uniforms.location.size())
+			uniforms.location.resize(uniform_names().name.size(), location_unknown);
+
+		// Names that are not active uniforms (or elements of arrays after the first one) are queried once
+		GLint& location = uniforms.location[name.id];
+		if(location==location_unknown) {
+			location = glGetUniformLocation(shader, name.str().c_str()); opengl_check;
+		}
+		return location;
+	}
+
+	GLint opengl_uniform_location(GLuint shader, std::string const& name)
+	{
+		return opengl_uniform_location(shader, opengl_uniform_name(name));
+	}
+
+	void opengl_uniform_introspect(GLuint shader)
+	{
+		assert_vcl(shader!=0, "Try to list the uniforms of unspecified shader");
+		program_uniforms& uniforms = program_cache()[shader];
+		uniforms.location.assign(uniform_names().name.size(), location_unknown);
+
+		GLint N_uniform = 0;
+		GLint max_length = 0;
+		glGetProgramiv(shader, GL_ACTIVE_UNIFORMS, &N_uniform); opengl_check;
+		glGetProgramiv(shader, GL_ACTIVE_UNIFORM_MAX_LENGTH, &max_length); opengl_check;
+		std::vector<GLchar> buffer_name(size_t(max_length)+1);
+		for(GLint k=0; k<N_uniform; ++k) {
+			GLsizei length = 0;
+			GLint size = 0;
+			GLenum type = 0;
+			glGetActiveUniform(shader, GLuint(k), GLsizei(buffer_name.size()), &length, &size, &type, buffer_name.data()); opengl_check;
+			std::string const name(buffer_name.data(), size_t(length));
+			GLint const location = glGetUniformLocation(shader, name.c_str()); opengl_check;
+			if(location==-1) // uniforms of blocks
+				continue;
+
+			// Arrays are listed as name[0], and can be accessed as name
+			std::vector<size_t> ids = {intern(name)};
+			if(name.size()>3 && name.compare(name.size()-3, 3, "[0]")==0)
+				ids.push_back(intern(name.substr(0, name.size()-3)));
+			for(size_t id : ids) {
+				if(id>=uniforms.location.size())
+					uniforms.location.resize(uniform_names().name.size(), location_unknown);
+				uniforms.location[id] = location;
+			}
 		}
-		if(location==-1 && expected==false)
-			return false;
-		else
-			return true;
 
+		// The other names known so far are inactive, except the elements of arrays that are not listed
+		std::vector<std::string> const& names = uniform_names().name;
+		for(size_t id=0; id<uniforms.location.size(); ++id)
+			if(uniforms.location[id]==location_unknown && names[id].find('[')==std::string::npos)
+				uniforms.location[id] = -1;
+
+		last_program = 0;
+		last_uniforms = nullptr;
+	}
+
+	void opengl_uniform_cache_clear(GLuint shader)
+	{
+		program_cache().erase(shader);
+		last_program = 0;
+		last_uniforms = nullptr;
+	}
+
+
+	void opengl_uniform(GLuint shader, opengl_uniform_name const& name, int value, bool expected)
+	{
+		GLint const location = checked_location(shader, name, expected);
+		if(location!=-1) {
+			glUniform1i(location, value); opengl_check_uniform;
+		}
+	}
+	void opengl_uniform(GLuint shader, opengl_uniform_name const& name, float value, bool expected)
+	{
+		GLint const location = checked_location(shader, name, expected);
+		if(location!=-1) {
+			glUniform1f(location, value); opengl_check_uniform;
+		}
+	}
+	void opengl_uniform(GLuint shader, opengl_uniform_name const& name, vec3 const& value, bool expected)
+	{
+		GLint const location = checked_location(shader, name, expected);
+		if(location!=-1) {
+			glUniform3f(location, value.x, value.y, value.z); opengl_check_uniform;
+		}
+	}
+	void opengl_uniform(GLuint shader, opengl_uniform_name const& name, vec4 const& value, bool expected)
+	{
+		GLint const location = checked_location(shader, name, expected);
+		if(location!=-1) {
+			glUniform4f(location, value.x, value.y, value.z, value.w); opengl_check_uniform;
+		}
+	}
+	void opengl_uniform(GLuint shader, opengl_uniform_name const& name, float x, float y, float z, bool expected)
+	{
+		GLint const location = checked_location(shader, name, expected);
+		if(location!=-1) {
+			glUniform3f(location, x, y, z); opengl_check_uniform;
+		}
+	}
+	void opengl_uniform(GLuint shader, opengl_uniform_name const& name, float x, float y, float z, float w, bool expected)
+	{
+		GLint const location = checked_location(shader, name, expected);
+		if(location!=-1) {
+			glUniform4f(location, x, y, z, w); opengl_check_uniform;
+		}
+	}
+	void opengl_uniform(GLuint shader, opengl_uniform_name const& name, mat4 const& m, bool expected)
+	{
+		GLint const location = checked_location(shader, name, expected);
+		if(location!=-1) {
+			glUniformMatrix4fv(location, 1, GL_TRUE, ptr(m)); opengl_check_uniform;
+		}
+	}
+	void opengl_uniform(GLuint shader, opengl_uniform_name const& name, mat3 const& m, bool expected)
+	{
+		GLint const location = checked_location(shader, name, expected);
+		if(location!=-1) {
+			glUniformMatrix3fv(location, 1, GL_TRUE, ptr(m)); opengl_check_uniform;
+		}
 	}
 
+	// The string names are interned at each call (a hash of the string, without query to the driver)
 	void opengl_uniform(GLuint shader, std::string const& name, int value, bool expected)
 	{
-		assert_vcl(shader!=0, "Try to send unifor "+name+" to unspecified shader");
-		GLint const location = glGetUniformLocation(shader, name.c_str()); opengl_check;
-		if(check_location(location, name, shader, expected))
-			glUniform1i(location, value); opengl_check;
+		opengl_uniform(shader, opengl_uniform_name(name), value, expected);
 	}
 	void opengl_uniform(GLuint shader, std::string const& name, float value, bool expected)
 	{
-		assert_vcl(shader!=0, "Try to send unifor "+name+" to unspecified shader");
-		GLint const location = glGetUniformLocation(shader, name.c_str()); opengl_check;
-		if(check_location(location, name, shader, expected))
-			glUniform1f(location, value); opengl_check;
+		opengl_uniform(shader, opengl_uniform_name(name), value, expected);
 	}
 	void opengl_uniform(GLuint shader, std::string const& name, vec3 const& value, bool expected)
 	{
-		assert_vcl(shader!=0, "Try to send unifor "+name+" to unspecified shader");
-		GLint const location = glGetUniformLocation(shader, name.c_str()); opengl_check;
-		if(check_location(location, name, shader, expected))
-			glUniform3f(location, value.x,value.y, value.z); opengl_check;
+		opengl_uniform(shader, opengl_uniform_name(name), value, expected);
 	}
 	void opengl_uniform(GLuint shader, std::string const& name, vec4 const& value, bool expected)
 	{
-		assert_vcl(shader!=0, "Try to send unifor "+name+" to unspecified shader");
-		GLint const location = glGetUniformLocation(shader, name.c_str()); opengl_check;
-		if(check_location(location, name, shader, expected))
-			glUniform4f(location, value.x,value.y, value.z, value.w); opengl_check;
+		opengl_uniform(shader, opengl_uniform_name(name), value, expected);
 	}
 	void opengl_uniform(GLuint shader, std::string const& name, float x, float y, float z, bool expected)
 	{
-		assert_vcl(shader!=0, "Try to send unifor "+name+" to unspecified shader");
-		GLint const location = glGetUniformLocation(shader, name.c_str()); opengl_check;
-		if(check_location(location, name, shader, expected))
-			glUniform3f(location, x, y, z);  opengl_check;
+		opengl_uniform(shader, opengl_uniform_name(name), x, y, z, expected);
 	}
 	void opengl_uniform(GLuint shader, std::string const& name, float x, float y, float z, float w, bool expected)
 	{
-		assert_vcl(shader!=0, "Try to send unifor "+name+" to unspecified shader");
-		GLint const location = glGetUniformLocation(shader, name.c_str()); opengl_check;
-		if(check_location(location, name, shader, expected))
-			glUniform4f(location, x, y, z, w);  opengl_check;
+		opengl_uniform(shader, opengl_uniform_name(name), x, y, z, w, expected);
 	}
 	void opengl_uniform(GLuint shader, std::string const& name, mat4 const& m, bool expected)
 	{
-		assert_vcl(shader!=0, "Try to send unifor "+name+" to unspecified shader");
-		GLint const location = glGetUniformLocation(shader, name.c_str()); opengl_check;
-		if(check_location(location, name, shader, expected))
-			glUniformMatrix4fv(location, 1, GL_TRUE, ptr(m));  opengl_check;
+		opengl_uniform(shader, opengl_uniform_name(name), m, expected);
 	}
 	void opengl_uniform(GLuint shader, std::string const& name, mat3 const& m, bool expected)
 	{
-		assert_vcl(shader!=0, "Try to send unifor "+name+" to unspecified shader");
-		GLint const location = glGetUniformLocation(shader, name.c_str()); opengl_check;
-		if(check_location(location, name, shader, expected))
-			glUniformMatrix3fv(location, 1, GL_TRUE, ptr(m)); opengl_check;
+		opengl_uniform(shader, opengl_uniform_name(name), m, expected);
 	}
 
 }
\ No newline at end of file
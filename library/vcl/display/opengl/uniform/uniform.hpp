@@ -6,6 +6,20 @@
 
 namespace vcl
 {
+	/** Name of a uniform variable interned once (ex. in a static variable)
+	* The location of an interned name is found in the cache of the program without hashing the string.
+	* ex.
+	*   static opengl_uniform_name const model("model");
+	*   opengl_uniform(shader, model, drawable.transform.matrix()); */
+	struct opengl_uniform_name
+	{
+		explicit opengl_uniform_name(std::string const& name);
+		std::string const& str() const;
+
+		/** Index of the name in the table of interned names */
+		size_t id;
+	};
+
 	void opengl_uniform(GLuint shader, std::string const& name, int value, bool expected=true);
 	void opengl_uniform(GLuint shader, std::string const& name, float value, bool expected=true);
 	void opengl_uniform(GLuint shader, std::string const& name, vec3 const& value, bool expected=true);
@@ -14,5 +28,25 @@ namespace vcl
 	void opengl_uniform(GLuint shader, std::string const& name, float x, float y, float z, float w, bool expected=true);
 	void opengl_uniform(GLuint shader, std::string const& name, mat4 const& m, bool expected=true);
 	void opengl_uniform(GLuint shader, std::string const& name, mat3 const& m, bool expected=true);
+
+	void opengl_uniform(GLuint shader, opengl_uniform_name const& name, int value, bool expected=true);
+	void opengl_uniform(GLuint shader, opengl_uniform_name const& name, float value, bool expected=true);
+	void opengl_uniform(GLuint shader, opengl_uniform_name const& name, vec3 const& value, bool expected=true);
+	void opengl_uniform(GLuint shader, opengl_uniform_name const& name, vec4 const& value, bool expected=true);
+	void opengl_uniform(GLuint shader, opengl_uniform_name const& name, float x, float y, float z, bool expected=true);
+	void opengl_uniform(GLuint shader, opengl_uniform_name const& name, float x, float y, float z, float w, bool expected=true);
+	void opengl_uniform(GLuint shader, opengl_uniform_name const& name, mat4 const& m, bool expected=true);
+	void opengl_uniform(GLuint shader, opengl_uniform_name const& name, mat3 const& m, bool expected=true);
+
+	/** Location of a uniform variable (-1 if the program doesn't use it)
+	* The locations are cached per program: the active uniforms are listed once (at link time for the programs of opengl_create_shader_program),
+	*  the other names are queried once to the driver. The cache is used from the OpenGL thread only. */
+	GLint opengl_uniform_location(GLuint shader, opengl_uniform_name const& name);
+	GLint opengl_uniform_location(GLuint shader, std::string const& name);
+
+	/** Fill the cache of a linked program with its active uniforms */
+	void opengl_uniform_introspect(GLuint shader);
+	/** Remove a program from the cache (to call when the program is deleted or linked again) */
+	void opengl_uniform_cache_clear(GLuint shader);
 }
 
@@ -0,0 +1,140 @@
+#include "uniform_buffer.hpp"
+
+#include "vcl/base/base.hpp"
+#include "vcl/display/opengl/debug/debug.hpp"
+#include "vcl/display/opengl/state/opengl_state.hpp"
+
+#include <cstring>
+
+namespace vcl
+{
+	// The structures are copied as is in the std140 blocks
+	static_assert(sizeof(mat4)==64 && sizeof(vec4)==16, "Matrices and vectors must be tightly packed floats");
+	static_assert(sizeof(uniform_block_scene)==160, "Incorrect std140 layout of uniform_block_scene");
+	static_assert(sizeof(uniform_block_object)==112, "Incorrect std140 layout of uniform_block_object");
+
+	namespace
+	{
+		size_t align_up(size_t value, size_t alignment)
+		{
+			return (value+alignment-1)/alignment*alignment;
+		}
+	}
+
+	uniform_buffer_ring::uniform_buffer_ring()
+		:id(0), capacity_per_frame(0), frame_count(0), alignment(256), fences(), staging(), frame(0), used(0), uploaded(0)
+	{}
+
+	void uniform_buffer_ring::initialize(size_t capacity_per_frame_arg, size_t frame_count_arg)
+	{
+		assert_vcl(capacity_per_frame_arg>0 && frame_count_arg>0, "Empty uniform buffer ring");
+		clear();
+
+		GLint offset_alignment = 0;
+		glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &offset_alignment); opengl_check;
+		alignment = offset_alignment>0? size_t(offset_alignment) : 256;
+
+		capacity_per_frame = align_up(capacity_per_frame_arg, alignment);
+		frame_count = frame_count_arg;
+		fences.assign(frame_count, nullptr);
+		staging.resize(capacity_per_frame);
+		frame = frame_count-1;
+		used = 0;
+		uploaded = 0;
+
+		glGenBuffers(1, &id); opengl_check;
+		glBindBuffer(GL_UNIFORM_BUFFER, id); opengl_check;
+		glBufferData(GL_UNIFORM_BUFFER, GLsizeiptr(capacity_per_frame*frame_count), nullptr, GL_STREAM_DRAW); opengl_check;
+		glBindBuffer(GL_UNIFORM_BUFFER, 0); opengl_check;
+	}
+
+	void uniform_buffer_ring::clear()
+	{
+		for(GLsync& fence : fences) {
+			if(fence!=nullptr)
+				glDeleteSync(fence);
+			fence = nullptr;
+		}
+		opengl_delete_buffer(id);
+		capacity_per_frame = 0;
+		frame_count = 0;
+		staging.clear();
+		used = 0;
+		uploaded = 0;
+	}
+
+	void uniform_buffer_ring::begin_frame()
+	{
+		assert_vcl(id!=0, "Uniform buffer ring is not initialized");
+		frame = (frame+1)%frame_count;
+		used = 0;
+		uploaded = 0;
+
+		GLsync& fence = fences[frame];
+		if(fence!=nullptr) {
+			// Wait at most 1s, the commands are flushed on the first call
+			GLenum const status = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000); opengl_check;
+			bool const gpu_done = (status==GL_ALREADY_SIGNALED || status==GL_CONDITION_SATISFIED);
+			assert_vcl(gpu_done, "Timeout while waiting for the GPU to release the uniform buffer");
+			glDeleteSync(fence);
+			fence = nullptr;
+		}
+	}
+
+	uniform_buffer_range uniform_buffer_ring::push(void const* data, size_t size)
+	{
+		size_t const offset = align_up(used, alignment);
+		if(offset+size>capacity_per_frame)
+			error_vcl("Uniform buffer ring is full ("+str(capacity_per_frame)+" bytes per frame): increase capacity_per_frame");
+		std::memcpy(staging.data()+offset, data, size);
+		used = offset+size;
+
+		uniform_buffer_range range;
+		range.buffer = id;
+		range.offset = frame*capacity_per_frame + offset;
+		range.size = size;
+		return range;
+	}
+
+	void uniform_buffer_ring::upload()
+	{
+		if(used==uploaded)
+			return;
+
+		// The section is not read by the GPU anymore (fence of begin_frame): no synchronization is needed
+		size_t const start = frame*capacity_per_frame + uploaded;
+		glBindBuffer(GL_UNIFORM_BUFFER, id); opengl_check;
+		void* p = glMapBufferRange(GL_UNIFORM_BUFFER, GLintptr(start), GLsizeiptr(used-uploaded), GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT); opengl_check;
+		assert_vcl(p!=nullptr, "Cannot map the uniform buffer");
+		std::memcpy(p, staging.data()+uploaded, used-uploaded);
+		glUnmapBuffer(GL_UNIFORM_BUFFER); opengl_check;
+		glBindBuffer(GL_UNIFORM_BUFFER, 0); opengl_check;
+		uploaded = used;
+	}
+
+	void uniform_buffer_ring::end_frame()
+	{
+		assert_vcl(used==uploaded, "Blocks pushed in the uniform buffer ring without upload");
+		GLsync& fence = fences[frame];
+		if(fence!=nullptr)
+			glDeleteSync(fence);
+		fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0); opengl_check;
+	}
+
+	void opengl_bind_uniform_block(GLuint binding, uniform_buffer_range const& range)
+	{
+		opengl_bind_buffer_range(binding, range.buffer, range.offset, range.size);
+	}
+
+	void opengl_uniform_block_binding(GLuint shader)
+	{
+		GLuint const scene = glGetUniformBlockIndex(shader, "scene_data"); opengl_check;
+		if(scene!=GL_INVALID_INDEX) {
+			glUniformBlockBinding(shader, scene, opengl_uniform_block_scene); opengl_check;
+		}
+		GLuint const object = glGetUniformBlockIndex(shader, "object_data"); opengl_check;
+		if(object!=GL_INVALID_INDEX) {
+			glUniformBlockBinding(shader, object, opengl_uniform_block_object); opengl_check;
+		}
+	}
+}
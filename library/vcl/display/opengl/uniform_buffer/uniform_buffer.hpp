@@ -0,0 +1,103 @@
+#pragma once
+
+#include "vcl/display/opengl/glad/glad.hpp"
+#include "vcl/containers/containers.hpp"
+#include "vcl/math/math.hpp"
+
+#include <cstdint>
+#include <vector>
+
+namespace vcl
+{
+	/** Binding points of the uniform blocks of the preset shaders (set by opengl_create_shader_program) */
+	GLuint const opengl_uniform_block_scene = 0;  // block scene_data
+	GLuint const opengl_uniform_block_object = 1; // block object_data
+
+	/** Per-frame data of the block scene_data (std140, row_major matrices as vcl::mat4) */
+	struct uniform_block_scene
+	{
+		mat4 projection;
+		mat4 view;
+		vec4 light;  // position in xyz
+		vec4 eye;    // camera position in xyz
+	};
+
+	/** Per-object data of the block object_data (std140, row_major matrices as vcl::mat4) */
+	struct uniform_block_object
+	{
+		mat4 model;
+		vec4 color;        // rgb, alpha
+		vec4 phong;        // ambient, diffuse, specular, specular exponent
+		int32_t use_texture;
+		int32_t texture_inverse_y;
+		int32_t padding[2];
+	};
+
+	/** Range of a buffer bound to a uniform block */
+	struct uniform_buffer_range
+	{
+		GLuint buffer = 0;
+		size_t offset = 0;
+		size_t size = 0;
+	};
+
+	/** Uniform buffer filled once per frame and bound by range for each draw
+	* The buffer is split in frame_count sections used in turn: the section of a frame is rewritten only once the GPU has finished the frame (fence),
+	*  so that it is mapped without synchronization. The blocks are copied on the CPU by push(), and sent together by upload().
+	* ex.
+	*   uniform_buffer_ring ring; ring.initialize();
+	*   // each frame
+	*   ring.begin_frame();
+	*   uniform_buffer_range const frame = ring.push(scene_block);
+	*   for(auto& d : drawables) offsets.push_back(ring.push(opengl_uniform_block(d)));
+	*   ring.upload();
+	*   opengl_bind_uniform_block(opengl_uniform_block_scene, frame);
+	*   for(size_t k=0; k<drawables.size(); ++k) draw(drawables[k], offsets[k]);
+	*   ring.end_frame(); */
+	struct uniform_buffer_ring
+	{
+		uniform_buffer_ring();
+
+		/** Create the buffer (capacity in bytes of the data of one frame) */
+		void initialize(size_t capacity_per_frame=size_t(1)<<20, size_t frame_count=3);
+		void clear();
+
+		/** Start the next section, waiting for the GPU if it still reads it */
+		void begin_frame();
+		/** Copy a block, at an offset aligned as required by glBindBufferRange */
+		uniform_buffer_range push(void const* data, size_t size);
+		template <typename T> uniform_buffer_range push(T const& block);
+		/** Send the blocks pushed since the last upload (to call before the draws using them) */
+		void upload();
+		/** Mark the end of the commands using the section */
+		void end_frame();
+
+		GLuint id;
+		size_t capacity_per_frame;
+		size_t frame_count;
+		/** GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT */
+		size_t alignment;
+
+	private:
+		std::vector<GLsync> fences;
+		std::vector<unsigned char> staging;
+		size_t frame;
+		size_t used;
+		size_t uploaded;
+	};
+
+	/** Bind a range of buffer to a uniform block binding point */
+	void opengl_bind_uniform_block(GLuint binding, uniform_buffer_range const& range);
+	/** Associate the blocks scene_data and object_data of a program (if used) to their binding points */
+	void opengl_uniform_block_binding(GLuint shader);
+}
+
+
+namespace vcl
+{
+	template <typename T>
+	uniform_buffer_range uniform_buffer_ring::push(T const& block)
+	{
+		return push(&block, sizeof(T));
+	}
+}
@@ -0,0 +1,142 @@
+#include "render_queue.hpp"
+
+#include "vcl/base/base.hpp"
+
+#include <cstring>
+#include <vector>
+
+namespace vcl
+{
+	void render_queue::clear()
+	{
+		items.clear();
+		keys.clear();
+		order.clear();
+	}
+
+	void render_queue::submit(mesh_drawable const& drawable)
+	{
+		submit(drawable, drawable.transform, drawable.shading);
+	}
+
+	void render_queue::submit(mesh_drawable const& drawable, affine_rts const& transform, shading_parameters_phong const& shading)
+	{
+		submit(drawable, transform, shading, shading.alpha<1.0f? render_pass::transparent : render_pass::opaque);
+	}
+
+	void render_queue::submit(mesh_drawable const& drawable, affine_rts const& transform, shading_parameters_phong const& shading, render_pass pass)
+	{
+		render_item item;
+		item.drawable = &drawable;
+		item.transform = transform;
+		item.shading = shading;
+		item.shader = drawable.shader;
+		item.texture = drawable.texture;
+		item.pass = pass;
+		items.push_back(item);
+	}
+
+	void render_queue::sort(vec3 const& eye)
+	{
+		size_t const N = items.size();
+		assert_vcl(N<=size_t(UINT32_MAX), "Too many items in render_queue");
+		keys.resize(N);
+		order.resize(N);
+		for(size_t k=0; k<N; ++k) {
+			render_item const& item = items[k];
+			vec3 const d = item.transform.translate-eye;
+			keys[k] = render_queue_key(item.pass, item.shader, item.texture, dot(d,d));
+			order[k] = uint32_t(k);
+		}
+		buffer<uint64_t> sorted_keys = keys;
+		radix_sort(sorted_keys, order);
+	}
+
+	size_t render_queue::size() const
+	{
+		return items.size();
+	}
+
+	uint64_t render_queue_key(render_pass pass, GLuint shader, GLuint texture, float depth)
+	{
+		// The bits of a positive float are ordered as its value: keep the 30 most significant ones (the sign bit is 0)
+		uint32_t depth_bits = 0;
+		if(depth>0.0f)
+			std::memcpy(&depth_bits, &depth, sizeof(float));
+		uint64_t const depth_key = uint64_t(depth_bits>>1) & 0x3FFFFFFF;
+		uint64_t const shader_key = uint64_t(shader & 0xFFFF);
+		uint64_t const texture_key = uint64_t(texture & 0xFFFF);
+
+		uint64_t const pass_key = uint64_t(pass)<<62;
+		if(pass==render_pass::opaque)
+			return pass_key | (shader_key<<46) | (texture_key<<30) | depth_key;
+		else
+			return pass_key | ((0x3FFFFFFF-depth_key)<<32) | (shader_key<<16) | texture_key;
+	}
+
+	void radix_sort(buffer<uint64_t>& keys, buffer<uint32_t>& values)
+	{
+		size_t const N = keys.size();
+		assert_vcl(values.size()==N, "Incompatible number of keys and values in radix_sort");
+
+		std::vector<uint64_t> keys_tmp(N);
+		std::vector<uint32_t> values_tmp(N);
+		uint64_t* key_in = keys.data.data();
+		uint64_t* key_out = keys_tmp.data();
+		uint32_t* value_in = values.data.data();
+		uint32_t* value_out = values_tmp.data();
+
+		for(int shift=0; shift<64; shift+=8)
+		{
+			size_t count[256] = {};
+			for(size_t k=0; k<N; ++k)
+				count[(key_in[k]>>shift) & 0xFF]++;
+			if(N==0 || count[(key_in[0]>>shift) & 0xFF]==N) // all the keys have the same byte
+				continue;
+
+			size_t offset = 0;
+			for(size_t b=0; b<256; ++b) {
+				size_t const c = count[b];
+				count[b] = offset;
+				offset += c;
+			}
+			for(size_t k=0; k<N; ++k) {
+				size_t const dst = count[(key_in[k]>>shift) & 0xFF]++;
+				key_out[dst] = key_in[k];
+				value_out[dst] = value_in[k];
+			}
+			std::swap(key_in, key_out);
+			std::swap(value_in, value_out);
+		}
+
+		// Odd number of passes: the result is in the temporary arrays
+		if(key_in!=keys.data.data()) {
+			std::memcpy(keys.data.data(), key_in, N*sizeof(uint64_t));
+			std::memcpy(values.data.data(), value_in, N*sizeof(uint32_t));
+		}
+	}
+
+	render_queue_state_changes render_queue_count_state_changes(render_queue const& queue, bool sorted)
+	{
+		size_t const N = queue.items.size();
+		assert_vcl(!sorted || queue.order.size()==N, "Count the state changes of a render_queue that is not sorted");
+
+		render_queue_state_changes changes;
+		GLuint shader = 0, texture = 0, vao = 0;
+		bool blend = false;
+		for(size_t k=0; k<N; ++k)
+		{
+			render_item const& item = queue.items[sorted? size_t(queue.order[k]) : k];
+			bool const item_blend = (item.pass==render_pass::transparent);
+			GLuint const item_vao = item.drawable->vao;
+
+			// The first item sets the program, texture and VAO, blending is initially disabled
+			if(item_blend!=blend) { changes.blend++; blend = item_blend; }
+			if(k==0 || item.shader!=shader) { changes.program++; shader = item.shader; }
+			if(k==0 || item.texture!=texture) { changes.texture++; texture = item.texture; }
+			if(k==0 || item_vao!=vao) { changes.vertex_array++; vao = item_vao; }
+			changes.draw++;
+		}
+		return changes;
+	}
+}
@@ -0,0 +1,127 @@
+#pragma once
+
+#include "vcl/display/drawable/mesh_drawable/mesh_drawable.hpp"
+
+#include <cstdint>
+
+namespace vcl
+{
+	/** The opaque items are drawn first grouped by shader and texture (front to back within a group),
+	*   then the transparent items back to front with blending */
+	enum class render_pass : uint8_t { opaque=0, transparent=1 };
+
+	/** Drawable submitted to a render_queue with the transform and shading of this draw */
+	struct render_item
+	{
+		mesh_drawable const* drawable = nullptr;
+		affine_rts transform;
+		shading_parameters_phong shading;
+		GLuint shader = 0;
+		GLuint texture = 0;
+		render_pass pass = render_pass::opaque;
+	};
+
+	/** Drawables collected during a frame and drawn in an order minimizing the state changes
+	* ex.
+	*   queue.clear();
+	*   for(auto& d : drawables) queue.submit(d);
+	*   queue.sort(scene.camera.position());
+	*   draw(queue, scene); */
+	struct render_queue
+	{
+		void clear();
+
+		/** Submit the drawable with its own transform and shading (transparent if shading.alpha<1) */
+		void submit(mesh_drawable const& drawable);
+		void submit(mesh_drawable const& drawable, affine_rts const& transform, shading_parameters_phong const& shading);
+		void submit(mesh_drawable const& drawable, affine_rts const& transform, shading_parameters_phong const& shading, render_pass pass);
+
+		/** Build the sort keys with the depth relative to the camera position eye, and fill order */
+		void sort(vec3 const& eye);
+
+		size_t size() const;
+
+		buffer<render_item> items;
+		/** Sort key of each item (set by sort) */
+		buffer<uint64_t> keys;
+		/** Index of the items in drawing order (set by sort) */
+		buffer<uint32_t> order;
+	};
+
+	/** 64-bit sort key of an item
+	*   opaque:      [pass 2 bits][shader 16][texture 16][depth 30]  - groups by state, then front to back
+	*   transparent: [pass 2 bits][~depth 30][shader 16][texture 16] - back to front
+	* depth is a positive value increasing with the distance (ex. squared distance to the camera).
+	* Shader and texture ids are truncated to 16 bits: a collision only reduces the batching. */
+	uint64_t render_queue_key(render_pass pass, GLuint shader, GLuint texture, float depth);
+
+	/** Stable LSD radix sort of the keys, the values are moved with their key
+	* The passes on bytes shared by all the keys are skipped. */
+	void radix_sort(buffer<uint64_t>& keys, buffer<uint32_t>& values);
+
+	/** Number of state changes done by draw(render_queue) */
+	struct render_queue_state_changes
+	{
+		size_t program = 0;
+		size_t texture = 0;
+		size_t vertex_array = 0;
+		size_t blend = 0;
+		size_t draw = 0;
+	};
+	/** Count the state changes of the queue in drawing order (sorted=true), or in submission order (sorted=false), without OpenGL calls */
+	render_queue_state_changes render_queue_count_state_changes(render_queue const& queue, bool sorted=true);
+
+	/** Draw the items in sorted order
+	* The scene uniforms are sent once per program change, and the per-object uniforms (model, shading) for each item. */
+	template <typename SCENE>
+	void draw(render_queue const& queue, SCENE const& scene);
+}
+
+
+namespace vcl
+{
+	template <typename SCENE>
+	void draw(render_queue const& queue, SCENE const& scene)
+	{
+		assert_vcl(queue.order.size()==queue.items.size(), "Draw a render_queue that is not sorted");
+
+		static opengl_uniform_name const model("model");
+		static opengl_uniform_name const image_texture("image_texture");
+
+		GLuint current_shader = 0;
+		bool blend = false;
+		for(uint32_t index : queue.order)
+		{
+			render_item const& item = queue.items[index];
+			mesh_drawable const& drawable = *item.drawable;
+			assert_vcl(item.shader!=0, "Try to draw render_item without shader");
+			assert_vcl(item.texture!=0, "Try to draw render_item without texture");
+			assert_vcl(drawable.number_triangles>0, "Try to draw render_item with 0 triangles");
+
+			if(item.pass==render_pass::transparent && !blend) {
+				opengl_enable(GL_BLEND);
+				opengl_blend_func(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+				opengl_depth_mask(false);
+				blend = true;
+			}
+
+			if(item.shader!=current_shader) {
+				opengl_use_program(item.shader);
+				opengl_uniform(item.shader, scene);
+				opengl_uniform(item.shader, image_texture, 0);
+				current_shader = item.shader;
+			}
+			opengl_uniform(item.shader, item.shading);
+			opengl_uniform(item.shader, model, item.transform.matrix());
+
+			opengl_bind_texture(item.texture);
+			opengl_bind_vertex_array(drawable.vao);
+			glDrawElements(GL_TRIANGLES, GLsizei(drawable.number_triangles*3), GL_UNSIGNED_INT, reinterpret_cast<void const*>(drawable.index_offset)); opengl_check;
+		}
+
+		if(blend) {
+			opengl_depth_mask(true);
+			opengl_enable(GL_BLEND, false);
+		}
+	}
+}
@@ -0,0 +1,146 @@
+#include "test_render_queue.hpp"
+
+#include "vcl/base/base.hpp"
+#include "../render_queue.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+
+using namespace vcl;
+
+namespace vcl_test
+{
+	// Drawables with interleaved shaders and textures (no OpenGL objects: only the ids are set)
+	static buffer<mesh_drawable> render_queue_drawables(size_t N_drawable)
+	{
+		buffer<mesh_drawable> drawables(N_drawable);
+		for(size_t k=0; k<N_drawable; ++k) {
+			drawables[k].vao = GLuint(k+1);
+			drawables[k].number_triangles = 1;
+			drawables[k].shader = GLuint(1+k%3);
+			drawables[k].texture = GLuint(10+k%4);
+		}
+		return drawables;
+	}
+
+	// Submit N_instance times each drawable at random positions, one drawable over 5 is transparent
+	static void fill_render_queue(render_queue& queue, buffer<mesh_drawable> const& drawables, size_t N_instance)
+	{
+		for(size_t i=0; i<N_instance; ++i) {
+			for(size_t k=0; k<drawables.size(); ++k) {
+				shading_parameters_phong shading = drawables[k].shading;
+				shading.alpha = (k%5==0)? 0.5f : 1.0f;
+				affine_rts transform;
+				transform.translate = { rand_interval(-10,10), rand_interval(-10,10), rand_interval(-10,10) };
+				queue.submit(drawables[k], transform, shading);
+			}
+		}
+	}
+
+	void test_render_queue()
+	{
+		// Radix sort: same result as a stable sort
+		{
+			size_t const N = 5000;
+			buffer<uint64_t> keys(N);
+			buffer<uint32_t> values(N);
+			for(size_t k=0; k<N; ++k) {
+				// Random high bytes and few distinct low bytes to have equal keys
+				keys[k] = (uint64_t(rand_interval(0,65535))<<48) | (uint64_t(rand_interval(0,255))<<20) | uint64_t(k%3);
+				values[k] = uint32_t(k);
+			}
+			buffer<uint32_t> expected = values;
+			std::stable_sort(expected.begin(), expected.end(), [&keys](uint32_t a, uint32_t b) { return keys[a]<keys[b]; });
+
+			buffer<uint64_t> sorted = keys;
+			radix_sort(sorted, values);
+			for(size_t k=0; k<N; ++k) {
+				assert_vcl_no_msg(values[k]==expected[k]);
+				assert_vcl_no_msg(sorted[k]==keys[expected[k]]);
+			}
+		}
+
+		// Keys: opaque before transparent, grouped by shader then texture, depth increasing for opaque and decreasing for transparent
+		{
+			assert_vcl_no_msg(render_queue_key(render_pass::opaque, 9, 9, 100.0f) < render_queue_key(render_pass::transparent, 1, 1, 0.1f));
+			assert_vcl_no_msg(render_queue_key(render_pass::opaque, 1, 9, 100.0f) < render_queue_key(render_pass::opaque, 2, 1, 0.1f));
+			assert_vcl_no_msg(render_queue_key(render_pass::opaque, 1, 1, 100.0f) < render_queue_key(render_pass::opaque, 1, 2, 0.1f));
+			assert_vcl_no_msg(render_queue_key(render_pass::opaque, 1, 1, 0.1f) < render_queue_key(render_pass::opaque, 1, 1, 100.0f));
+			assert_vcl_no_msg(render_queue_key(render_pass::transparent, 9, 9, 100.0f) < render_queue_key(render_pass::transparent, 1, 1, 0.1f));
+		}
+
+		// Queue of drawables with interleaved shaders and textures
+		{
+			buffer<mesh_drawable> const drawables = render_queue_drawables(12);
+			render_queue queue;
+			fill_render_queue(queue, drawables, 20);
+			vec3 const eye = {0,0,20};
+			queue.sort(eye);
+			assert_vcl_no_msg(queue.order.size()==queue.size());
+
+			// Every item is drawn once
+			buffer<int> drawn(queue.size());
+			drawn.fill(0);
+			for(uint32_t index : queue.order)
+				drawn[index]++;
+			for(int d : drawn)
+				assert_vcl_no_msg(d==1);
+
+			auto depth = [&](render_item const& item) { vec3 const d = item.transform.translate-eye; return dot(d,d); };
+			bool transparent = false;
+			for(size_t k=0; k<queue.size(); ++k)
+			{
+				render_item const& item = queue.items[queue.order[k]];
+				if(item.pass==render_pass::transparent)
+					transparent = true;
+				assert_vcl_no_msg(item.pass==(transparent? render_pass::transparent : render_pass::opaque)); // opaque first
+				if(k==0)
+					continue;
+
+				render_item const& previous = queue.items[queue.order[k-1]];
+				if(previous.pass!=item.pass)
+					continue;
+				if(item.pass==render_pass::opaque) {
+					bool const same_state = previous.shader==item.shader && previous.texture==item.texture;
+					assert_vcl_no_msg(previous.shader<=item.shader);
+					assert_vcl_no_msg(previous.shader<item.shader || previous.texture<=item.texture);
+					assert_vcl_no_msg(!same_state || depth(previous)<=depth(item)*1.0001f); // front to back (30 bits of depth)
+				}
+				else
+					assert_vcl_no_msg(depth(previous)*1.0001f>=depth(item)); // back to front
+			}
+
+			// Each (shader,texture) of the opaque items is set once, transparency is enabled once
+			render_queue_state_changes const unsorted = render_queue_count_state_changes(queue, false);
+			render_queue_state_changes const sorted = render_queue_count_state_changes(queue, true);
+			assert_vcl_no_msg(sorted.draw==queue.size() && unsorted.draw==queue.size());
+			assert_vcl_no_msg(sorted.blend==1);
+			assert_vcl_no_msg(sorted.program < unsorted.program);
+			assert_vcl_no_msg(sorted.texture < unsorted.texture);
+		}
+	}
+
+	void benchmark_render_queue()
+	{
+		using clock = std::chrono::steady_clock;
+		auto seconds = [](clock::time_point t0) { return std::chrono::duration<double>(clock::now()-t0).count(); };
+
+		buffer<mesh_drawable> const drawables = render_queue_drawables(12);
+		render_queue queue;
+		fill_render_queue(queue, drawables, 20000);
+
+		clock::time_point const t0 = clock::now();
+		queue.sort({0,0,20});
+		double const t_sort = seconds(t0);
+
+		render_queue_state_changes const unsorted = render_queue_count_state_changes(queue, false);
+		render_queue_state_changes const sorted = render_queue_count_state_changes(queue, true);
+
+		std::cout << "render_queue: " << queue.size() << " draws (sort " << t_sort*1000 << " ms)" << std::endl;
+		std::cout << "  State changes (submission order -> sorted): program " << unsorted.program << " -> " << sorted.program
+				  << ", texture " << unsorted.texture << " -> " << sorted.texture
+				  << ", vertex array " << unsorted.vertex_array << " -> " << sorted.vertex_array
+				  << ", blend " << unsorted.blend << " -> " << sorted.blend << std::endl;
+	}
+}
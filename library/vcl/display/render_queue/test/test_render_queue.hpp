@@ -0,0 +1,11 @@
+#pragma once
+
+namespace vcl_test
+{
+	/** Check the sort keys, the radix sort, the drawing order and the number of state changes of render_queue.
+	* Only the CPU side is used: no OpenGL context is needed. */
+	void test_render_queue();
+
+	/** Compare the number of state changes between the submission order and the sorted order, and time the sort of a large queue */
+	void benchmark_render_queue();
+}
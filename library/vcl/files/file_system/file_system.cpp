@@ -0,0 +1,227 @@
+#include "file_system.hpp"
+
+#include "vcl/base/base.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <sstream>
+#include <thread>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#include <direct.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#else
+#include <dirent.h>
+#include <climits>
+#include <sys/stat.h>
+#include <sys/types.h>
+#endif
+
+namespace vcl
+{
+	bool file_status(std::string const& filename, uint64_t& size, int64_t& modification_time)
+	{
+#ifdef _WIN32
+		struct __stat64 info;
+		if(_stat64(filename.c_str(), &info)!=0)
+			return false;
+		size = uint64_t(info.st_size);
+		modification_time = int64_t(info.st_mtime)*1000000000;
+#else
+		struct stat info;
+		if(stat(filename.c_str(), &info)!=0)
+			return false;
+		size = uint64_t(info.st_size);
+#if defined(__APPLE__)
+		modification_time = int64_t(info.st_mtimespec.tv_sec)*1000000000 + int64_t(info.st_mtimespec.tv_nsec);
+#else
+		modification_time = int64_t(info.st_mtim.tv_sec)*1000000000 + int64_t(info.st_mtim.tv_nsec);
+#endif
+#endif
+		return true;
+	}
+
+	std::string file_absolute_path(std::string const& filename)
+	{
+#ifdef _WIN32
+		char path[MAX_PATH];
+		if(_fullpath(path, filename.c_str(), MAX_PATH)==nullptr)
+			return filename;
+		return path;
+#else
+		char path[PATH_MAX];
+		if(realpath(filename.c_str(), path)==nullptr)
+			return filename;
+		return path;
+#endif
+	}
+
+	static bool has_extension(std::string const& filename, std::string const& extension)
+	{
+		if(extension.empty())
+			return true;
+		if(filename.size()<extension.size())
+			return false;
+		return std::equal(extension.begin(), extension.end(), filename.end()-extension.size(), [](char a, char b){
+			return std::tolower(static_cast<unsigned char>(a))==std::tolower(static_cast<unsigned char>(b));
+		});
+	}
+
+	static void directory_files_recursive(std::string const& directory, std::string const& extension, bool recursive, buffer<std::string>& files)
+	{
+#ifdef _WIN32
+		WIN32_FIND_DATAA entry;
+		HANDLE const handle = FindFirstFileA((directory+"\\*").c_str(), &entry);
+		if(handle==INVALID_HANDLE_VALUE)
+			return;
+		do {
+			std::string const name = entry.cFileName;
+			if(name=="." || name=="..")
+				continue;
+			std::string const path = directory+"/"+name;
+			if(entry.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) {
+				if(recursive)
+					directory_files_recursive(path, extension, recursive, files);
+			}
+			else if(has_extension(name, extension))
+				files.push_back(path);
+		} while(FindNextFileA(handle, &entry));
+		FindClose(handle);
+#else
+		DIR* const dir = opendir(directory.c_str());
+		if(dir==nullptr)
+			return;
+		while(dirent const* entry = readdir(dir)) {
+			std::string const name = entry->d_name;
+			if(name=="." || name=="..")
+				continue;
+			std::string const path = directory+"/"+name;
+			struct stat info;
+			if(stat(path.c_str(), &info)!=0)
+				continue;
+			if(S_ISDIR(info.st_mode)) {
+				if(recursive)
+					directory_files_recursive(path, extension, recursive, files);
+			}
+			else if(S_ISREG(info.st_mode) && has_extension(name, extension))
+				files.push_back(path);
+		}
+		closedir(dir);
+#endif
+	}
+
+	buffer<std::string> directory_files(std::string const& directory, std::string const& extension, bool recursive)
+	{
+		buffer<std::string> files;
+		directory_files_recursive(directory, extension, recursive, files);
+		std::sort(files.begin(), files.end());
+		return files;
+	}
+
+	bool directory_create(std::string const& directory)
+	{
+#ifdef _WIN32
+		if(_mkdir(directory.c_str())==0)
+			return true;
+		struct __stat64 info;
+		return _stat64(directory.c_str(), &info)==0 && (info.st_mode & _S_IFDIR);
+#else
+		if(mkdir(directory.c_str(), 0755)==0)
+			return true;
+		struct stat info;
+		return stat(directory.c_str(), &info)==0 && S_ISDIR(info.st_mode);
+#endif
+	}
+
+	static uint64_t hash_string(std::string const& s)
+	{
+		uint64_t h = 0xcbf29ce484222325ull; // FNV-1a
+		for(char c : s) {
+			h ^= uint64_t(static_cast<unsigned char>(c));
+			h *= 0x100000001b3ull;
+		}
+		return h;
+	}
+
+	bool file_cache_header_set(file_cache_header& header, std::string const& filename, char const* magic, uint32_t version, uint32_t header_size, uint64_t options)
+	{
+		uint64_t size = 0;
+		int64_t time = 0;
+		if(!file_status(filename, size, time))
+			return false;
+		std::memcpy(header.magic, magic, 8);
+		header.version = version;
+		header.header_size = header_size;
+		header.source_size = size;
+		header.source_modification_time = time;
+		header.source_path_hash = hash_string(file_absolute_path(filename));
+		header.options = options;
+		return true;
+	}
+
+	bool file_cache_header_match(file_cache_header const& header, file_cache_header const& expected)
+	{
+		return std::memcmp(header.magic, expected.magic, 8)==0 && header.version==expected.version && header.header_size==expected.header_size
+			&& header.source_size==expected.source_size && header.source_modification_time==expected.source_modification_time
+			&& header.source_path_hash==expected.source_path_hash && header.options==expected.options;
+	}
+
+	std::string file_cache_filename(std::string const& filename, std::string const& directory, std::string const& extension)
+	{
+		if(directory.empty())
+			return filename+extension;
+
+		// Several sources may have the same name: the name of the cache includes the hash of the full path
+		size_t const separator = filename.find_last_of("/\\");
+		std::string const name = separator==std::string::npos? filename : filename.substr(separator+1);
+		std::ostringstream stream;
+		stream << directory << "/" << name << "." << std::hex << hash_string(file_absolute_path(filename)) << extension;
+		return stream.str();
+	}
+
+	bool file_write_atomic(std::string const& filename, buffer<file_chunk> const& chunks)
+	{
+		// The temporary file is specific to the thread: several threads may write the same file
+		std::ostringstream tmp_name;
+		tmp_name << filename << ".tmp" << std::hash<std::thread::id>()(std::this_thread::get_id());
+		std::string const tmp_filename = tmp_name.str();
+
+		FILE* file = std::fopen(tmp_filename.c_str(), "wb");
+		if(file==nullptr)
+			return false;
+		char const zeros[64] = {0};
+		bool ok = true;
+		uint64_t position = 0;
+		for(file_chunk const& chunk : chunks) {
+			assert_vcl(chunk.offset>=position, "The chunks written by file_write_atomic must be sorted and must not overlap");
+			while(ok && position<chunk.offset) {
+				size_t const N = size_t(std::min(chunk.offset-position, uint64_t(sizeof(zeros))));
+				ok = std::fwrite(zeros, 1, N, file)==N;
+				position += N;
+			}
+			ok = ok && std::fwrite(chunk.data, 1, chunk.size, file)==chunk.size;
+			position = chunk.offset+chunk.size;
+		}
+		ok = (std::fclose(file)==0) && ok;
+
+		if(ok) {
+			std::remove(filename.c_str()); // rename doesn't replace an existing file on Windows
+			ok = std::rename(tmp_filename.c_str(), filename.c_str())==0;
+		}
+		if(!ok)
+			std::remove(tmp_filename.c_str());
+		return ok;
+	}
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include "vcl/containers/buffer/buffer.hpp"
+
+#include <cstdint>
+#include <string>
+
+namespace vcl
+{
+	/** Size (in bytes) and last modification time of a file
+	* Returns false if the file cannot be accessed */
+	bool file_status(std::string const& filename, uint64_t& size, int64_t& modification_time);
+
+	/** Absolute path of a file (the path is returned unchanged if it cannot be resolved) */
+	std::string file_absolute_path(std::string const& filename);
+
+	/** Regular files contained in a directory (sorted full paths)
+	* @extension: only keep the files with this extension (ex. ".obj", case insensitive), all files if empty */
+	buffer<std::string> directory_files(std::string const& directory, std::string const& extension="", bool recursive=false);
+
+	/** Create the directory if it doesn't exist yet (the parent directory must exist). Returns false in case of failure. */
+	bool directory_create(std::string const& directory);
+
+
+	/** Beginning of the header of a binary cache file (ex. .vclmesh, .vclimage)
+	* The cache matches its source file if the format (magic, version, header size), the source key (size, modification time, path) and the options are the same. */
+	struct file_cache_header
+	{
+		char magic[8];
+		uint32_t version;
+		uint32_t header_size; // size of the complete header of the cache
+		// Key of the source file
+		uint64_t source_size;
+		int64_t source_modification_time;
+		uint64_t source_path_hash;
+		uint64_t options;
+	};
+
+	/** Set the header expected for the cache of the file filename (magic is a string of 8 characters)
+	* Returns false if the source file cannot be accessed */
+	bool file_cache_header_set(file_cache_header& header, std::string const& filename, char const* magic, uint32_t version, uint32_t header_size, uint64_t options);
+	/** True if the header read in a cache file is the expected one */
+	bool file_cache_header_match(file_cache_header const& header, file_cache_header const& expected);
+
+	/** Path of the cache file of filename with the given extension (ex. ".vclmesh")
+	* The cache is next to the file if directory is empty, otherwise its name in directory includes the hash of the full path of the file. */
+	std::string file_cache_filename(std::string const& filename, std::string const& directory, std::string const& extension);
+
+	/** Part of a file written by file_write_atomic: size bytes of data at the position offset */
+	struct file_chunk
+	{
+		void const* data;
+		size_t size;
+		uint64_t offset;
+	};
+	/** Write the chunks (sorted by offset, the space between two chunks is filled with 0) in a temporary file, then rename it to filename
+	* A concurrent reader never sees a partial file. Returns false if the file cannot be written. */
+	bool file_write_atomic(std::string const& filename, buffer<file_chunk> const& chunks);
+}
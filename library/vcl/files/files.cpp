@@ -3,6 +3,7 @@
 #include "vcl/base/base.hpp"
 
 #include <fstream>
+#include <vector>
 
 namespace vcl
 {
@@ -40,4 +41,15 @@ namespace vcl
 
         stream.close();
     }
-}
\ No newline at end of file
+
+    std::string read_stream_content(std::istream& stream)
+    {
+        std::string content;
+        std::vector<char> block(size_t(1)<<20);
+        while(stream.good()) {
+            stream.read(block.data(), std::streamsize(block.size()));
+            content.append(block.data(), size_t(stream.gcount()));
+        }
+        return content;
+    }
+}
@@ -2,10 +2,16 @@
 
 
 #include "vcl/containers/containers.hpp"
+#include "mapped_file/mapped_file.hpp"
+#include "text_scanner/text_scanner.hpp"
+#include "text_reader/text_reader.hpp"
+#include "text_writer/text_writer.hpp"
+#include "file_system/file_system.hpp"
 
 #include <string>
 #include <sstream>
 #include <fstream>
+#include <type_traits>
 
 namespace vcl
 {
@@ -17,14 +23,45 @@ namespace vcl
 	bool check_file_exist(const std::string filename);
 
 
+	/** Read the remaining content of the stream (by large blocks) */
+	std::string read_stream_content(std::istream& stream);
+
+	/** Numerical types read by text_read_values (mapped file, parallel parsing, single allocation) instead of std::istream
+	* Also true for the buffer_stack of these types (ex. vec3, int3) */
+	template <typename T> struct is_text_value : std::false_type {};
+	template <> struct is_text_value<float> : std::true_type {};
+	template <> struct is_text_value<double> : std::true_type {};
+	template <> struct is_text_value<int> : std::true_type {};
+	template <> struct is_text_value<unsigned int> : std::true_type {};
+	template <> struct is_text_value<long long> : std::true_type {};
+	template <> struct is_text_value<size_t> : std::true_type {};
+	template <typename T, size_t N> struct is_text_value<buffer_stack<T,N>> : is_text_value<T> {};
+	/** Numerical types read line by line by text_read_values_per_line (buffer<buffer<T>> and grid_2D<T>) */
+	template <typename T> using is_text_scalar = std::integral_constant<bool, is_text_value<T>::value && std::is_arithmetic<T>::value>;
+
+	/** Read the values of a text file (separated by blanks, end of lines, commas or semicolons)
+	* The buffers of numerical values (and of their buffer_stack) are read from the mapped file and parsed in parallel,
+	* the other types are read with std::istream. The values are appended to the buffer. */
 	template <typename T> void read_from_file(std::string const& filename, T& data);
+	template <typename T> void read_from_file(std::string const& filename, buffer<T>& data);
+	/** Read the values of each line of a text file (the empty lines are ignored) */
 	template <typename T> void read_from_file(std::string const& filename, buffer<buffer<T>>& data);
+	/** Read a grid of numerical values: each line of the file is a row of the grid
+	* The dimension of the grid is (number of values per line, number of lines). */
+	template <typename T> void read_from_file(std::string const& filename, grid_2D<T>& data);
 
 	template <typename T> std::istream& read_from_stream(std::istream& stream, T& data);
 	template <typename T, size_t N> std::istream& read_from_stream(std::istream& stream, buffer_stack<T,N>& data);
 	template <typename T> std::istream& read_line_from_stream(std::istream& stream, T& data);
 	template <typename T> std::istream& read_from_stream(std::istream& stream, buffer<T>& data);
 	template <typename T> std::istream& read_from_stream_per_line(std::istream& stream, buffer<T>& data);
+	template <typename T> std::istream& read_from_stream_per_line(std::istream& stream, buffer<buffer<T>>& data);
+
+	/** Read the numerical values of [begin,end) (appended to the buffer) */
+	template <typename T> void read_text_values(char const* begin, char const* end, buffer<T>& data);
+	template <typename T, size_t N> void read_text_values(char const* begin, char const* end, buffer<buffer_stack<T,N>>& data);
+	/** Read the numerical values of each line of [begin,end) (appended to the buffer, the empty lines are ignored) */
+	template <typename T> void read_text_values_per_line(char const* begin, char const* end, buffer<buffer<T>>& data);
 }
 
 
@@ -62,7 +99,50 @@ namespace vcl
 	}
 
 	template <typename T>
-	std::istream& read_from_stream(std::istream& stream, buffer<T>& data)
+	void read_text_values(char const* begin, char const* end, buffer<T>& data)
+	{
+		text_read_values(begin, end, data);
+	}
+
+	template <typename T, size_t N>
+	void read_text_values(char const* begin, char const* end, buffer<buffer_stack<T,N>>& data)
+	{
+		static_assert(sizeof(buffer_stack<T,N>)==N*sizeof(T), "The values of a buffer_stack are contiguous");
+		buffer<T> values;
+		text_read_values(begin, end, values);
+		assert_vcl(values.size()%N==0, "The number of values ("+str(values.size())+") is not a multiple of "+str(N));
+
+		size_t const offset = data.size();
+		data.resize(offset+values.size()/N);
+		if(values.size()>0)
+			std::copy(values.data.begin(), values.data.end(), &data.data[offset][0]);
+	}
+
+	template <typename T>
+	void read_text_values_per_line(char const* begin, char const* end, buffer<buffer<T>>& data)
+	{
+		buffer<T> values;
+		buffer<size_t> line_offset;
+		text_read_values_per_line(begin, end, values, line_offset);
+
+		size_t const N_line = line_offset.size()-1;
+		size_t const offset = data.size();
+		data.resize(offset+N_line);
+		parallel_for(N_line, [&](size_t k){
+			data.data[offset+k].data.assign(values.data.begin()+line_offset.data[k], values.data.begin()+line_offset.data[k+1]);
+		}, 4096);
+	}
+
+	template <typename T>
+	std::istream& read_from_stream_generic(std::istream& stream, buffer<T>& data, std::true_type)
+	{
+		std::string const text = read_stream_content(stream);
+		read_text_values(text.data(), text.data()+text.size(), data);
+		return stream;
+	}
+
+	template <typename T>
+	std::istream& read_from_stream_generic(std::istream& stream, buffer<T>& data, std::false_type)
 	{
 		while(stream.good()) {
 			T temp;
@@ -74,6 +154,12 @@ namespace vcl
 		return stream;
 	}
 
+	template <typename T>
+	std::istream& read_from_stream(std::istream& stream, buffer<T>& data)
+	{
+		return read_from_stream_generic(stream, data, is_text_value<T>());
+	}
+
 	template <typename T>
 	std::istream& read_from_stream_per_line(std::istream& stream, buffer<T>& data)
 	{
@@ -87,6 +173,33 @@ namespace vcl
 		return stream;
 	}
 
+	template <typename T>
+	std::istream& read_from_stream_per_line_generic(std::istream& stream, buffer<buffer<T>>& data, std::true_type)
+	{
+		std::string const text = read_stream_content(stream);
+		read_text_values_per_line(text.data(), text.data()+text.size(), data);
+		return stream;
+	}
+
+	template <typename T>
+	std::istream& read_from_stream_per_line_generic(std::istream& stream, buffer<buffer<T>>& data, std::false_type)
+	{
+		while(stream.good()) {
+			buffer<T> temp;
+			read_line_from_stream(stream, temp);
+			if(stream.good())
+				data.push_back(temp);
+		}
+
+		return stream;
+	}
+
+	template <typename T>
+	std::istream& read_from_stream_per_line(std::istream& stream, buffer<buffer<T>>& data)
+	{
+		return read_from_stream_per_line_generic(stream, data, is_text_scalar<T>());
+	}
+
 	template <typename T>
 	void read_from_file(std::string const& filename, T& data)
 	{
@@ -103,7 +216,23 @@ namespace vcl
 	}
 
 	template <typename T>
-	void read_from_file(std::string const& filename, buffer<buffer<T>>& data)
+	void read_from_file_generic(std::string const& filename, buffer<T>& data, std::false_type)
+	{
+		read_from_file<buffer<T>>(filename, data);
+	}
+
+	template <typename T>
+	void read_from_file_generic(std::string const& filename, buffer<T>& data, std::true_type)
+	{
+		assert_file_exist(filename);
+		mapped_file file;
+		bool const is_open = file.open(filename);
+		assert_vcl(is_open, "Cannot open file "+filename);
+		read_text_values(file.begin(), file.end(), data);
+	}
+
+	template <typename T>
+	void read_from_file_per_line_generic(std::string const& filename, buffer<buffer<T>>& data, std::false_type)
 	{
 		assert_file_exist(filename);
 
@@ -117,5 +246,47 @@ namespace vcl
 		assert_vcl_no_msg(!stream.is_open());
 	}
 
+	template <typename T>
+	void read_from_file_per_line_generic(std::string const& filename, buffer<buffer<T>>& data, std::true_type)
+	{
+		assert_file_exist(filename);
+		mapped_file file;
+		bool const is_open = file.open(filename);
+		assert_vcl(is_open, "Cannot open file "+filename);
+		read_text_values_per_line(file.begin(), file.end(), data);
+	}
+
+	template <typename T>
+	void read_from_file(std::string const& filename, buffer<T>& data)
+	{
+		read_from_file_generic(filename, data, is_text_value<T>());
+	}
+
+	template <typename T>
+	void read_from_file(std::string const& filename, buffer<buffer<T>>& data)
+	{
+		read_from_file_per_line_generic(filename, data, is_text_scalar<T>());
+	}
+
+	template <typename T>
+	void read_from_file(std::string const& filename, grid_2D<T>& data)
+	{
+		static_assert(is_text_scalar<T>::value, "grid_2D files store numerical values");
+		assert_file_exist(filename);
+		mapped_file file;
+		bool const is_open = file.open(filename);
+		assert_vcl(is_open, "Cannot open file "+filename);
+
+		buffer<size_t> line_offset;
+		data.data.clear();
+		text_read_values_per_line(file.begin(), file.end(), data.data, line_offset);
+
+		size_t const N_line = line_offset.size()-1;
+		size_t const N_column = (N_line>0)? line_offset.data[1] : 0;
+		for(size_t k=0; k<N_line; ++k)
+			assert_vcl(line_offset.data[k+1]-line_offset.data[k]==N_column, "Line "+str(k)+" of file "+filename+" does not have "+str(N_column)+" values");
+		data.dimension = {N_column, N_line};
+	}
+
 
 }
\ No newline at end of file
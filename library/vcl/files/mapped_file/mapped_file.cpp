@@ -0,0 +1,156 @@
+#include "mapped_file.hpp"
+
+#include <cstdio>
+#include <utility>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace vcl
+{
+	mapped_file::mapped_file()
+	{}
+
+	mapped_file::mapped_file(std::string const& filename)
+	{
+		open(filename);
+	}
+
+	mapped_file::~mapped_file()
+	{
+		close();
+	}
+
+	mapped_file::mapped_file(mapped_file&& other)
+	{
+		swap(other);
+	}
+
+	mapped_file& mapped_file::operator=(mapped_file&& other)
+	{
+		if(this!=&other) {
+			close();
+			swap(other);
+		}
+		return *this;
+	}
+
+	void mapped_file::swap(mapped_file& other)
+	{
+		std::swap(data, other.data);
+		std::swap(size, other.size);
+		std::swap(mapping, other.mapping);
+		std::swap(copy, other.copy);
+	}
+
+	// Fallback: read the full file in memory
+	static bool read_file_in_memory(std::string const& filename, char*& copy, size_t& size)
+	{
+		FILE* file = std::fopen(filename.c_str(), "rb");
+		if(file==nullptr)
+			return false;
+
+		std::fseek(file, 0, SEEK_END);
+		long const file_size = std::ftell(file);
+		std::fseek(file, 0, SEEK_SET);
+		if(file_size<0) {
+			std::fclose(file);
+			return false;
+		}
+
+		size = size_t(file_size);
+		copy = new char[size+1];
+		size_t const N_read = std::fread(copy, 1, size, file);
+		std::fclose(file);
+		size = N_read;
+		copy[size] = '\0';
+		return true;
+	}
+
+	bool mapped_file::open(std::string const& filename)
+	{
+		close();
+
+#ifdef _WIN32
+		HANDLE const file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+		if(file!=INVALID_HANDLE_VALUE)
+		{
+			LARGE_INTEGER file_size;
+			if(GetFileSizeEx(file, &file_size) && file_size.QuadPart==0) {
+				CloseHandle(file);
+				return true;
+			}
+			HANDLE const handle = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+			CloseHandle(file);
+			if(handle!=nullptr) {
+				void* const view = MapViewOfFile(handle, FILE_MAP_READ, 0, 0, 0);
+				if(view!=nullptr) {
+					mapping = handle;
+					data = static_cast<char const*>(view);
+					size = size_t(file_size.QuadPart);
+					return true;
+				}
+				CloseHandle(handle);
+			}
+		}
+#else
+		int const file = ::open(filename.c_str(), O_RDONLY);
+		if(file>=0)
+		{
+			struct stat info;
+			if(fstat(file, &info)==0 && S_ISREG(info.st_mode))
+			{
+				if(info.st_size==0) {
+					::close(file);
+					return true;
+				}
+				void* const view = mmap(nullptr, size_t(info.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+				if(view!=MAP_FAILED) {
+					madvise(view, size_t(info.st_size), MADV_SEQUENTIAL);
+					::close(file);
+					mapping = view;
+					data = static_cast<char const*>(view);
+					size = size_t(info.st_size);
+					return true;
+				}
+			}
+			::close(file);
+		}
+#endif
+
+		if(read_file_in_memory(filename, copy, size)==false)
+			return false;
+		data = copy;
+		return true;
+	}
+
+	void mapped_file::close()
+	{
+		if(mapping!=nullptr) {
+#ifdef _WIN32
+			UnmapViewOfFile(data);
+			CloseHandle(static_cast<HANDLE>(mapping));
+#else
+			munmap(mapping, size);
+#endif
+		}
+		delete[] copy;
+
+		mapping = nullptr;
+		copy = nullptr;
+		data = nullptr;
+		size = 0;
+	}
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+namespace vcl
+{
+	/** Read-only access to the content of a file mapped in memory (mmap on Unix, MapViewOfFile on Windows)
+	* The content is read in a memory buffer if the file cannot be mapped.
+	* The mapping is released when the structure is destroyed. */
+	struct mapped_file
+	{
+		mapped_file();
+		explicit mapped_file(std::string const& filename);
+		~mapped_file();
+
+		mapped_file(mapped_file const&) = delete;
+		mapped_file& operator=(mapped_file const&) = delete;
+		mapped_file(mapped_file&& other);
+		mapped_file& operator=(mapped_file&& other);
+
+		/** Map the file, returns false if the file cannot be opened */
+		bool open(std::string const& filename);
+		void close();
+
+		char const* begin() const { return data; }
+		char const* end() const { return data+size; }
+
+		char const* data = nullptr;
+		size_t size = 0;
+
+	private:
+		void* mapping = nullptr;  // system handle of the mapping (nullptr when the content is read in memory)
+		char* copy = nullptr;     // content read in memory when the mapping is not possible
+		void swap(mapped_file& other);
+	};
+}
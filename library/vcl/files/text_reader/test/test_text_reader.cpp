@@ -0,0 +1,111 @@
+#include "test_text_reader.hpp"
+
+#include "vcl/base/base.hpp"
+#include "vcl/files/files.hpp"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+
+using namespace vcl;
+
+namespace vcl_test
+{
+	static void write_text(std::string const& filename, std::string const& text)
+	{
+		std::ofstream stream(filename, std::ios::binary);
+		stream << text;
+	}
+
+	void test_text_reader()
+	{
+		std::string const filename = "test_text_reader.txt";
+
+		// Whitespace and CSV separators, windows end of lines, empty lines
+		write_text(filename, "1 2.5\t-3e2\r\n\n4,5;6\n  \n7");
+		buffer<float> values;
+		read_from_file(filename, values);
+		assert_vcl(values.size()==7 && values[1]==2.5f && values[2]==-300.0f && values[6]==7.0f, "Incorrect values");
+		read_from_file(filename, values); // appended
+		assert_vcl(values.size()==14 && values[13]==7.0f, "Values not appended");
+
+		buffer<vec3> positions;
+		write_text(filename, "0 1 2\n3 4 5\n");
+		read_from_file(filename, positions);
+		assert_vcl(positions.size()==2 && positions[1].x==3.0f && positions[1].z==5.0f, "Incorrect positions");
+
+		buffer<buffer<int>> lines;
+		write_text(filename, "1 2 3\n\n4\n5 6");
+		read_from_file(filename, lines);
+		assert_vcl(lines.size()==3 && lines[0].size()==3 && lines[1].size()==1 && lines[2][1]==6, "Incorrect lines");
+
+		grid_2D<double> grid;
+		write_text(filename, "1,2,3\n4,5,6\n");
+		read_from_file(filename, grid);
+		assert_vcl(grid.dimension.x==3 && grid.dimension.y==2 && grid(2,1)==6.0 && grid(0,1)==4.0, "Incorrect grid");
+
+		std::istringstream stream("10 20 30");
+		buffer<size_t> indices;
+		read_from_stream(stream, indices);
+		assert_vcl(indices.size()==3 && indices[2]==30, "Incorrect stream values");
+
+		// Large file read in parallel chunks, compared with std::istream
+		std::mt19937 generator(7);
+		std::uniform_real_distribution<float> distribution(-1000.0f, 1000.0f);
+		std::string text;
+		size_t const N = 2000000;
+		for(size_t k=0; k<N; ++k)
+			text += std::to_string(distribution(generator)) + ((k%5==4)? "\n" : " ");
+		write_text(filename, text);
+
+		buffer<float> fast;
+		read_from_file(filename, fast);
+		std::istringstream reference_stream(text);
+		buffer<float> reference;
+		float x = 0.0f;
+		while(reference_stream >> x)
+			reference.push_back(x);
+		assert_vcl(fast.size()==N && reference.size()==N, "Incorrect number of values");
+		for(size_t k=0; k<N; ++k)
+			assert_vcl(fast[k]==reference[k], "Value "+str(k)+" differs from std::istream");
+
+		buffer<buffer<float>> rows;
+		read_from_file(filename, rows);
+		assert_vcl(rows.size()==N/5 && rows[N/5-1][4]==reference[N-1], "Incorrect rows");
+
+		std::remove(filename.c_str());
+	}
+
+	void benchmark_text_reader(size_t N)
+	{
+		std::string const filename = "benchmark_text_reader.txt";
+		std::mt19937 generator(7);
+		std::uniform_real_distribution<float> distribution(-1000.0f, 1000.0f);
+		std::vector<text_writer> chunks(1);
+		for(size_t k=0; k<3*N; ++k)
+			chunks[0].write_number(distribution(generator)).write((k%3==2)? '\n' : ' ');
+		text_write_file(filename, chunks);
+
+		auto t0 = std::chrono::steady_clock::now();
+		buffer<vec3> fast;
+		read_from_file(filename, fast);
+		auto t1 = std::chrono::steady_clock::now();
+
+		buffer<vec3> reference;
+		std::ifstream stream(filename);
+		vec3 p;
+		while(stream >> p.x >> p.y >> p.z)
+			reference.push_back(p);
+		auto t2 = std::chrono::steady_clock::now();
+
+		assert_vcl(fast.size()==N && reference.size()==N, "Incorrect number of positions");
+		std::cout << "Read " << N << " positions: read_from_file " << std::chrono::duration<double>(t1-t0).count() << "s, std::istream "
+			<< std::chrono::duration<double>(t2-t1).count() << "s" << std::endl;
+		std::remove(filename.c_str());
+	}
+}
@@ -0,0 +1,12 @@
+#pragma once
+
+#include <cstddef>
+
+namespace vcl_test
+{
+	/** Check read_from_file on whitespace and CSV files (buffers, buffer_stack, lines, grid_2D) against std::istream */
+	void test_text_reader();
+
+	/** Compare the reading time of N random positions (3 floats per line) by read_from_file and by std::istream */
+	void benchmark_text_reader(size_t N=3000000);
+}
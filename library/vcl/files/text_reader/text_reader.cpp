@@ -0,0 +1,179 @@
+#include "text_reader.hpp"
+
+#include "vcl/base/base.hpp"
+#include "../text_scanner/text_scanner.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace vcl
+{
+	namespace
+	{
+		// Texts smaller than a chunk are read by a single thread
+		size_t const text_chunk_size = size_t(1)<<22;
+
+		inline bool is_separator(char c)
+		{
+			return c==' ' || c=='\t' || c=='\n' || c=='\r' || c==',' || c==';';
+		}
+		inline bool is_blank(char c)
+		{
+			return c==' ' || c=='\t' || c=='\r' || c==',' || c==';';
+		}
+
+		char const* parse_value(char const* first, char const* last, float& value) { return parse_float(first, last, value); }
+		char const* parse_value(char const* first, char const* last, double& value) { return parse_float(first, last, value); }
+		template <typename T> char const* parse_value(char const* first, char const* last, T& value) { return parse_int(first, last, value); }
+
+		// Parse the token starting at p, which must be followed by a separator
+		template <typename T> char const* read_token(char const* p, char const* end, T& value)
+		{
+			char const* const next = parse_value(p, end, value);
+			if(next==p || (next<end && !is_separator(*next))) {
+				char const* token_end = p;
+				while(token_end<end && !is_separator(*token_end) && token_end-p<32)
+					++token_end;
+				error_vcl("Invalid number \""+std::string(p, token_end)+"\" in text");
+			}
+			return next;
+		}
+
+		// Split [begin,end) in chunks starting at the beginning of a line
+		std::vector<char const*> split_lines(char const* begin, char const* end)
+		{
+			size_t const N_chunk = parallel_range_count(size_t(end-begin), text_chunk_size);
+			std::vector<char const*> bounds(N_chunk+1, end);
+			bounds[0] = begin;
+			for(size_t k=1; k<N_chunk; ++k) {
+				char const* p = std::max(begin + k*size_t(end-begin)/N_chunk, bounds[k-1]);
+				void const* eol = (p<end)? std::memchr(p, '\n', size_t(end-p)) : nullptr;
+				bounds[k] = (eol!=nullptr)? static_cast<char const*>(eol)+1 : end;
+			}
+			return bounds;
+		}
+
+		// Number of tokens in [begin,end) (the chunks start at a line, so that a token is never split)
+		size_t count_values(char const* begin, char const* end)
+		{
+			size_t N = 0;
+			bool previous_is_separator = true;
+			for(char const* p=begin; p<end; ++p) {
+				bool const separator = is_separator(*p);
+				N += (previous_is_separator && !separator);
+				previous_is_separator = separator;
+			}
+			return N;
+		}
+
+		// Number of tokens, and of lines with at least one token
+		void count_values_and_lines(char const* begin, char const* end, size_t& N_value, size_t& N_line)
+		{
+			N_value = 0;
+			N_line = 0;
+			bool previous_is_separator = true;
+			bool empty_line = true;
+			for(char const* p=begin; p<end; ++p) {
+				char const c = *p;
+				if(c=='\n') {
+					N_line += !empty_line;
+					empty_line = true;
+					previous_is_separator = true;
+				}
+				else if(is_blank(c))
+					previous_is_separator = true;
+				else {
+					N_value += previous_is_separator;
+					empty_line = false;
+					previous_is_separator = false;
+				}
+			}
+			N_line += !empty_line;
+		}
+
+		template <typename T> void read_values(char const* begin, char const* end, buffer<T>& values)
+		{
+			std::vector<char const*> const bounds = split_lines(begin, end);
+			size_t const N_chunk = bounds.size()-1;
+
+			// Count the values of each chunk to know where they are stored
+			std::vector<size_t> offset(N_chunk+1, 0);
+			parallel_for(N_chunk, [&](size_t k){ offset[k+1] = count_values(bounds[k], bounds[k+1]); }, 1);
+			offset[0] = values.size();
+			for(size_t k=0; k<N_chunk; ++k)
+				offset[k+1] += offset[k];
+			values.resize(offset[N_chunk]);
+
+			parallel_for(N_chunk, [&](size_t k){
+				T* value = values.data.data()+offset[k];
+				char const* p = bounds[k];
+				char const* const chunk_end = bounds[k+1];
+				while(true) {
+					while(p<chunk_end && is_separator(*p))
+						++p;
+					if(p>=chunk_end)
+						break;
+					p = read_token(p, chunk_end, *value++);
+				}
+			}, 1);
+		}
+
+		template <typename T> void read_values_per_line(char const* begin, char const* end, buffer<T>& values, buffer<size_t>& line_offset)
+		{
+			std::vector<char const*> const bounds = split_lines(begin, end);
+			size_t const N_chunk = bounds.size()-1;
+
+			std::vector<size_t> value_offset(N_chunk+1, 0);
+			std::vector<size_t> line_start(N_chunk+1, 0);
+			parallel_for(N_chunk, [&](size_t k){ count_values_and_lines(bounds[k], bounds[k+1], value_offset[k+1], line_start[k+1]); }, 1);
+			for(size_t k=0; k<N_chunk; ++k) {
+				value_offset[k+1] += value_offset[k];
+				line_start[k+1] += line_start[k];
+			}
+			values.resize(value_offset[N_chunk]);
+			line_offset.resize(line_start[N_chunk]+1);
+			line_offset.data[line_start[N_chunk]] = value_offset[N_chunk];
+
+			parallel_for(N_chunk, [&](size_t k){
+				size_t index = value_offset[k];
+				size_t line = line_start[k];
+				char const* p = bounds[k];
+				char const* const chunk_end = bounds[k+1];
+				bool empty_line = true;
+				while(p<chunk_end) {
+					char const c = *p;
+					if(c=='\n') {
+						empty_line = true;
+						++p;
+					}
+					else if(is_blank(c))
+						++p;
+					else {
+						if(empty_line) {
+							line_offset.data[line++] = index;
+							empty_line = false;
+						}
+						p = read_token(p, chunk_end, values.data[index++]);
+					}
+				}
+			}, 1);
+		}
+	}
+
+
+	void text_read_values(char const* begin, char const* end, buffer<float>& values) { read_values(begin, end, values); }
+	void text_read_values(char const* begin, char const* end, buffer<double>& values) { read_values(begin, end, values); }
+	void text_read_values(char const* begin, char const* end, buffer<int>& values) { read_values(begin, end, values); }
+	void text_read_values(char const* begin, char const* end, buffer<unsigned int>& values) { read_values(begin, end, values); }
+	void text_read_values(char const* begin, char const* end, buffer<long long>& values) { read_values(begin, end, values); }
+	void text_read_values(char const* begin, char const* end, buffer<size_t>& values) { read_values(begin, end, values); }
+
+	void text_read_values_per_line(char const* begin, char const* end, buffer<float>& values, buffer<size_t>& line_offset) { read_values_per_line(begin, end, values, line_offset); }
+	void text_read_values_per_line(char const* begin, char const* end, buffer<double>& values, buffer<size_t>& line_offset) { read_values_per_line(begin, end, values, line_offset); }
+	void text_read_values_per_line(char const* begin, char const* end, buffer<int>& values, buffer<size_t>& line_offset) { read_values_per_line(begin, end, values, line_offset); }
+	void text_read_values_per_line(char const* begin, char const* end, buffer<unsigned int>& values, buffer<size_t>& line_offset) { read_values_per_line(begin, end, values, line_offset); }
+	void text_read_values_per_line(char const* begin, char const* end, buffer<long long>& values, buffer<size_t>& line_offset) { read_values_per_line(begin, end, values, line_offset); }
+	void text_read_values_per_line(char const* begin, char const* end, buffer<size_t>& values, buffer<size_t>& line_offset) { read_values_per_line(begin, end, values, line_offset); }
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+#include "vcl/containers/buffer/buffer.hpp"
+
+#include <cstddef>
+
+namespace vcl
+{
+	/** Read all the numbers of the text [begin,end) separated by blanks, end of lines, commas or semicolons (whitespace or CSV files)
+	* The values are appended to the buffer: they are counted first to resize the buffer once, and large texts are counted and parsed in parallel chunks.
+	* A token that is not a number raises an error. */
+	void text_read_values(char const* begin, char const* end, buffer<float>& values);
+	void text_read_values(char const* begin, char const* end, buffer<double>& values);
+	void text_read_values(char const* begin, char const* end, buffer<int>& values);
+	void text_read_values(char const* begin, char const* end, buffer<unsigned int>& values);
+	void text_read_values(char const* begin, char const* end, buffer<long long>& values);
+	void text_read_values(char const* begin, char const* end, buffer<size_t>& values);
+
+	/** Read the numbers of each line of the text (the empty lines are ignored)
+	* The values of the k-th line are values[line_offset[k]] ... values[line_offset[k+1]-1], the previous content of the buffers is replaced. */
+	void text_read_values_per_line(char const* begin, char const* end, buffer<float>& values, buffer<size_t>& line_offset);
+	void text_read_values_per_line(char const* begin, char const* end, buffer<double>& values, buffer<size_t>& line_offset);
+	void text_read_values_per_line(char const* begin, char const* end, buffer<int>& values, buffer<size_t>& line_offset);
+	void text_read_values_per_line(char const* begin, char const* end, buffer<unsigned int>& values, buffer<size_t>& line_offset);
+	void text_read_values_per_line(char const* begin, char const* end, buffer<long long>& values, buffer<size_t>& line_offset);
+	void text_read_values_per_line(char const* begin, char const* end, buffer<size_t>& values, buffer<size_t>& line_offset);
+}
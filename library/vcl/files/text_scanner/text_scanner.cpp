@@ -0,0 +1,229 @@
+#include "text_scanner.hpp"
+
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <string>
+
+namespace vcl
+{
+	namespace
+	{
+		double const power_of_ten[] = {
+			1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+			1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+		};
+
+		bool is_digit(char c) { return c>='0' && c<='9'; }
+
+		bool match_word(char const*& p, char const* last, char const* word)
+		{
+			char const* q = p;
+			for(; *word!='\0'; ++word, ++q) {
+				if(q>=last || (*q|0x20)!=*word)
+					return false;
+			}
+			p = q;
+			return true;
+		}
+
+		// Decimal value decomposed as (-1)^negative * mantissa * 10^exponent
+		struct decimal_number {
+			bool negative = false;
+			uint64_t mantissa = 0;
+			int64_t exponent = 0;
+			bool truncated = false; // more than 19 significant digits
+			bool special = false;   // inf or nan
+			double special_value = 0.0;
+		};
+
+		// Scan the syntax of a number, returns first if no valid number is found
+		char const* scan_decimal(char const* first, char const* last, decimal_number& number)
+		{
+			char const* p = first;
+			if(p<last && (*p=='-' || *p=='+')) {
+				number.negative = (*p=='-');
+				++p;
+			}
+
+			if(p<last && !is_digit(*p) && *p!='.') {
+				if(match_word(p, last, "inf")) {
+					match_word(p, last, "inity");
+					number.special = true;
+					number.special_value = std::numeric_limits<double>::infinity();
+					return p;
+				}
+				if(match_word(p, last, "nan")) {
+					number.special = true;
+					number.special_value = std::numeric_limits<double>::quiet_NaN();
+					return p;
+				}
+				return first;
+			}
+
+			int N_digit = 0;
+			int N_significant = 0;
+			auto read_digit = [&](char c, bool fractional) {
+				N_digit++;
+				if(number.mantissa==0 && c=='0') { // leading zeros
+					if(fractional)
+						number.exponent--;
+					return;
+				}
+				if(N_significant<19) {
+					number.mantissa = 10*number.mantissa + uint64_t(c-'0');
+					N_significant++;
+					if(fractional)
+						number.exponent--;
+				}
+				else {
+					if(c!='0')
+						number.truncated = true;
+					if(!fractional)
+						number.exponent++;
+				}
+			};
+
+			while(p<last && is_digit(*p))
+				read_digit(*p++, false);
+			if(p<last && *p=='.') {
+				++p;
+				while(p<last && is_digit(*p))
+					read_digit(*p++, true);
+			}
+			if(N_digit==0)
+				return first;
+
+			// Exponent: only consumed if followed by digits
+			if(p<last && (*p=='e' || *p=='E')) {
+				char const* q = p+1;
+				bool negative_exponent = false;
+				if(q<last && (*q=='-' || *q=='+')) {
+					negative_exponent = (*q=='-');
+					++q;
+				}
+				if(q<last && is_digit(*q)) {
+					int64_t e = 0;
+					while(q<last && is_digit(*q)) {
+						if(e<100000)
+							e = 10*e + (*q-'0');
+						++q;
+					}
+					number.exponent += negative_exponent? -e : e;
+					p = q;
+				}
+			}
+			return p;
+		}
+
+		// Exact conversion when the mantissa and the power of ten are exactly representable (Clinger's fast path)
+		bool fast_path(decimal_number const& number, double& value)
+		{
+			if(number.truncated || number.mantissa>(uint64_t(1)<<53) || number.exponent<-22 || number.exponent>22)
+				return false;
+			double const m = double(number.mantissa);
+			value = number.exponent<0? m/power_of_ten[-number.exponent] : m*power_of_ten[number.exponent];
+			return true;
+		}
+
+		template <typename T>
+		T slow_path(char const* first, char const* last)
+		{
+			std::string const token(first, last);
+			return static_cast<T>(std::strtod(token.c_str(), nullptr));
+		}
+
+		template <typename T>
+		char const* parse_integer_value(char const* first, char const* last, T& value)
+		{
+			char const* p = first;
+			bool negative = false;
+			if(p<last && (*p=='-' || *p=='+')) {
+				negative = (*p=='-');
+				++p;
+			}
+			if(negative && !std::numeric_limits<T>::is_signed)
+				return first;
+
+			char const* const digit_begin = p;
+			uint64_t v = 0;
+			uint64_t const v_max = negative? uint64_t(std::numeric_limits<T>::max())+1 : uint64_t(std::numeric_limits<T>::max());
+			while(p<last && is_digit(*p)) {
+				uint64_t const d = uint64_t(*p-'0');
+				if(v>(v_max-d)/10)
+					return first; // overflow
+				v = 10*v + d;
+				++p;
+			}
+			if(p==digit_begin)
+				return first;
+
+			value = negative? T(-int64_t(v-1)-1) : T(v);
+			return p;
+		}
+	}
+
+	char const* parse_float(char const* first, char const* last, double& value)
+	{
+		decimal_number number;
+		char const* const p = scan_decimal(first, last, number);
+		if(p==first)
+			return first;
+
+		double v = 0.0;
+		if(number.special)
+			v = number.special_value;
+		else if(number.mantissa==0)
+			v = 0.0;
+		else if(!fast_path(number, v))
+			v = slow_path<double>(first, p);
+		value = number.negative? -std::abs(v) : std::abs(v);
+		return p;
+	}
+
+	char const* parse_float(char const* first, char const* last, float& value)
+	{
+		decimal_number number;
+		char const* const p = scan_decimal(first, last, number);
+		if(p==first)
+			return first;
+
+		float v = 0.0f;
+		double d = 0.0;
+		if(number.special)
+			v = float(number.special_value);
+		else if(number.mantissa==0)
+			v = 0.0f;
+		else if(number.mantissa<=(uint64_t(1)<<24) && number.exponent>=-10 && number.exponent<=10 && !number.truncated) // exact in single precision
+			v = number.exponent<0? float(number.mantissa)/float(power_of_ten[-number.exponent]) : float(number.mantissa)*float(power_of_ten[number.exponent]);
+		else if(fast_path(number, d)) {
+			// The double is correctly rounded: rounding it again to float is exact unless it lies on a midpoint between two floats
+			uint64_t bits = 0;
+			std::memcpy(&bits, &d, sizeof(double));
+			if((bits & 0x1FFFFFFFull)==0x10000000ull)
+				v = std::strtof(std::string(first,p).c_str(), nullptr);
+			else
+				v = float(d);
+		}
+		else
+			v = std::strtof(std::string(first,p).c_str(), nullptr);
+
+		value = number.negative? -std::abs(v) : std::abs(v);
+		return p;
+	}
+
+	char const* parse_int(char const* first, char const* last, int& value) { return parse_integer_value(first, last, value); }
+	char const* parse_int(char const* first, char const* last, long long& value) { return parse_integer_value(first, last, value); }
+	char const* parse_int(char const* first, char const* last, unsigned int& value) { return parse_integer_value(first, last, value); }
+	char const* parse_int(char const* first, char const* last, size_t& value) { return parse_integer_value(first, last, value); }
+
+	void text_scanner::skip_line()
+	{
+		if(current>=end)
+			return;
+		char const* const next = static_cast<char const*>(std::memchr(current, '\n', size_t(end-current)));
+		current = (next==nullptr)? end : next+1;
+	}
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstddef>
+
+namespace vcl
+{
+	/** Parse a floating point value at the beginning of [first,last) (similar to std::from_chars)
+	* Accepts an optional sign, decimal or scientific notation, inf and nan.
+	* Returns the pointer after the parsed characters, or first if no value can be parsed (value is then unchanged).
+	* The result is correctly rounded: uncommon inputs (very long mantissa, large exponent) fall back to strtod. */
+	char const* parse_float(char const* first, char const* last, float& value);
+	char const* parse_float(char const* first, char const* last, double& value);
+
+	/** Parse an integer value with optional sign (similar to std::from_chars)
+	* Returns first if no value can be parsed, or if the value overflows. */
+	char const* parse_int(char const* first, char const* last, int& value);
+	char const* parse_int(char const* first, char const* last, long long& value);
+	char const* parse_int(char const* first, char const* last, unsigned int& value);
+	char const* parse_int(char const* first, char const* last, size_t& value);
+
+
+	/** Sequential reader over a range of characters (typically a mapped_file)
+	* Used by the file loaders to tokenize text without allocation. */
+	struct text_scanner
+	{
+		char const* current = nullptr;
+		char const* end = nullptr;
+
+		text_scanner() {}
+		text_scanner(char const* begin_arg, char const* end_arg) :current(begin_arg), end(end_arg) {}
+
+		bool eof() const { return current>=end; }
+		/** True at the end of the line (or of the text) */
+		bool eol() const { return current>=end || *current=='\n' || *current=='\r'; }
+
+		/** Skip spaces and tabulations (stops at the end of the line) */
+		void skip_blank() { while(current<end && (*current==' ' || *current=='\t')) ++current; }
+		/** Skip spaces, tabulations and end of lines */
+		void skip_whitespace() { while(current<end && (*current==' ' || *current=='\t' || *current=='\n' || *current=='\r')) ++current; }
+		/** Go to the beginning of the next line */
+		void skip_line();
+
+		/** Read a value after optional blanks, returns false (and does not move) if no value can be read */
+		template <typename T> bool read_number(T& value)
+		{
+			skip_blank();
+			char const* next = parse_number(current, end, value);
+			if(next==current)
+				return false;
+			current = next;
+			return true;
+		}
+
+		/** Consume the character c if it is the next one */
+		bool match(char c)
+		{
+			if(current<end && *current==c) {
+				++current;
+				return true;
+			}
+			return false;
+		}
+
+	private:
+		static char const* parse_number(char const* first, char const* last, float& value) { return parse_float(first, last, value); }
+		static char const* parse_number(char const* first, char const* last, double& value) { return parse_float(first, last, value); }
+		template <typename T> static char const* parse_number(char const* first, char const* last, T& value) { return parse_int(first, last, value); }
+	};
+}
@@ -0,0 +1,77 @@
+#include "test_text_writer.hpp"
+
+#include "vcl/base/base.hpp"
+#include "../text_writer.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <random>
+#include <string>
+
+using namespace vcl;
+
+namespace vcl_test
+{
+	// Number of significant digits of a number written in decimal
+	static int significant_digits(std::string const& text)
+	{
+		std::string mantissa = text.substr(0, text.find_first_of("eE"));
+		mantissa.erase(std::remove(mantissa.begin(), mantissa.end(), '.'), mantissa.end());
+		size_t const first = mantissa.find_first_of("123456789");
+		size_t const last = mantissa.find_last_of("123456789");
+		return first==std::string::npos? 0 : int(last-first+1);
+	}
+
+	static void check_format(float value)
+	{
+		char text[text_number_max_size+1];
+		*format_float(text, value) = '\0';
+		float const parsed = std::strtof(text, nullptr);
+		assert_vcl(std::memcmp(&parsed, &value, sizeof(float))==0, std::string("Incorrect round trip of ")+text);
+
+		// Shortest text given by printf
+		char reference[64];
+		for(int p=1; p<=9; ++p) {
+			std::snprintf(reference, sizeof(reference), "%.*g", p, double(value));
+			if(std::strtof(reference, nullptr)==value)
+				break;
+		}
+		assert_vcl(significant_digits(text)<=significant_digits(reference), std::string("Text ")+text+" is longer than "+reference);
+	}
+
+	void test_text_writer()
+	{
+		float const values[] = {0.1f, 0.5f, 1.0f, 1200.0f, 1e-7f, 123456.7f, 1e8f, 16777216.0f, -2.75f,
+			std::numeric_limits<float>::max(), std::numeric_limits<float>::min(), std::numeric_limits<float>::denorm_min()};
+		for(float value : values)
+			check_format(value);
+
+		// Random bit patterns, and values with few decimals
+		std::mt19937 generator(42);
+		for(size_t k=0; k<200000; ++k) {
+			uint32_t const bits = generator();
+			float value = 0.0f;
+			std::memcpy(&value, &bits, sizeof(float));
+			if(std::isfinite(value))
+				check_format(value);
+			check_format(float(generator()%200000)/1000.0f - 100.0f);
+		}
+
+		char text[text_number_max_size+1];
+		*format_float(text, 0.1) = '\0';
+		assert_vcl_no_msg(std::string(text)=="0.1");
+		*format_float(text, 0.1+0.2) = '\0';
+		assert_vcl_no_msg(std::strtod(text, nullptr)==0.1+0.2);
+		*format_int(text, -1234567890123ll) = '\0';
+		assert_vcl_no_msg(std::string(text)=="-1234567890123");
+
+		text_writer writer;
+		writer.write("v ").write_number(1.5f).write(' ').write_number(42u).write('\n');
+		assert_vcl_no_msg(writer.text=="v 1.5 42\n");
+	}
+}
@@ -0,0 +1,7 @@
+#pragma once
+
+namespace vcl_test
+{
+	/** Check that format_float writes the shortest text read back exactly (compared with printf using increasing precision) */
+	void test_text_writer();
+}
@@ -0,0 +1,262 @@
+#include "text_writer.hpp"
+
+#include "../text_scanner/text_scanner.hpp"
+
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+
+namespace vcl
+{
+	namespace
+	{
+		// Powers of ten from 1e0 to 1e60 (exact up to 1e22, correctly rounded after)
+		double const power_of_ten[] = {
+			1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19,
+			1e20, 1e21, 1e22, 1e23, 1e24, 1e25, 1e26, 1e27, 1e28, 1e29, 1e30, 1e31, 1e32, 1e33, 1e34, 1e35, 1e36, 1e37, 1e38, 1e39,
+			1e40, 1e41, 1e42, 1e43, 1e44, 1e45, 1e46, 1e47, 1e48, 1e49, 1e50, 1e51, 1e52, 1e53, 1e54, 1e55, 1e56, 1e57, 1e58, 1e59, 1e60
+		};
+
+		uint64_t const integer_power_of_ten[] = {
+			1ull, 10ull, 100ull, 1000ull, 10000ull, 100000ull, 1000000ull, 10000000ull, 100000000ull, 1000000000ull,
+			10000000000ull, 100000000000ull, 1000000000000ull, 10000000000000ull, 100000000000000ull, 1000000000000000ull, 10000000000000000ull
+		};
+
+		char const digit_pairs[] =
+			"00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+			"40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+			"8081828384858687888990919293949596979899";
+
+		// value * 10^exponent with a single rounding for |exponent|<=22 (two otherwise)
+		double scale_power_of_ten(double value, int exponent)
+		{
+			return exponent>=0? value*power_of_ten[exponent] : value/power_of_ten[-exponent];
+		}
+
+		// Write the digits of value in [output, output+N), returns N
+		int write_digits(char* output, uint64_t value)
+		{
+			char digits[24];
+			char* p = digits+24;
+			while(value>=100) {
+				uint64_t const q = value/100;
+				unsigned const r = unsigned(value-100*q);
+				p -= 2;
+				std::memcpy(p, digit_pairs+2*r, 2);
+				value = q;
+			}
+			if(value>=10) {
+				p -= 2;
+				std::memcpy(p, digit_pairs+2*value, 2);
+			}
+			else
+				*--p = char('0'+value);
+			int const N = int(digits+24-p);
+			std::memcpy(output, p, size_t(N));
+			return N;
+		}
+
+		// Write digits*10^exponent in fixed or scientific notation (the shortest one)
+		char* write_decimal(char* output, uint64_t digits, int exponent)
+		{
+			while(digits>0 && digits%10==0) {
+				digits /= 10;
+				exponent++;
+			}
+			char text[24];
+			int const N = write_digits(text, digits);
+			int const E = exponent+N-1; // exponent of the first digit
+
+			char exponent_text[8];
+			int const N_exponent = write_digits(exponent_text, uint64_t(E<0? -E : E));
+			int const scientific_size = N + (N>1? 1:0) + 1 + (E<0? 1:0) + N_exponent;
+			int fixed_size = 0;
+			if(exponent>=0) fixed_size = N+exponent;    // integer
+			else if(E>=0) fixed_size = N+1;             // ddd.ddd
+			else fixed_size = N+1-E;                    // 0.000ddd
+
+			if(fixed_size<=scientific_size) {
+				if(exponent>=0) {
+					std::memcpy(output, text, size_t(N));
+					output += N;
+					std::memset(output, '0', size_t(exponent));
+					output += exponent;
+				}
+				else if(E>=0) {
+					std::memcpy(output, text, size_t(E+1));
+					output += E+1;
+					*output++ = '.';
+					std::memcpy(output, text+E+1, size_t(N-E-1));
+					output += N-E-1;
+				}
+				else {
+					*output++ = '0';
+					*output++ = '.';
+					std::memset(output, '0', size_t(-E-1));
+					output += -E-1;
+					std::memcpy(output, text, size_t(N));
+					output += N;
+				}
+			}
+			else {
+				*output++ = text[0];
+				if(N>1) {
+					*output++ = '.';
+					std::memcpy(output, text+1, size_t(N-1));
+					output += N-1;
+				}
+				*output++ = 'e';
+				if(E<0)
+					*output++ = '-';
+				std::memcpy(output, exponent_text, size_t(N_exponent));
+				output += N_exponent;
+			}
+			return output;
+		}
+
+		char* write_special(char* output, double value)
+		{
+			char const* text = std::isnan(value)? "nan" : (value<0? "-inf" : "inf");
+			size_t const N = std::strlen(text);
+			std::memcpy(output, text, N);
+			return output+N;
+		}
+	}
+
+	// The 16 first significant digits are computed in double precision, then their roundings to 9 digits and fewer are tested:
+	//  the rounding to 9 digits without its trailing zeros gives the first candidate, then the number of digits is decreased one by one while the rounding stays valid.
+	//  A candidate is valid if it is strictly inside the interval of the values rounded to the float (bounded by the midpoints with its neighbors).
+	//  The midpoints are exact in double precision, and the candidates have a relative error below 1e-15:
+	//  the rare candidates closer than this error to a midpoint are tested by parsing them.
+	char* format_float(char* output, float value)
+	{
+		if(!std::isfinite(value))
+			return write_special(output, double(value));
+		if(std::signbit(value))
+			*output++ = '-';
+		float const a = std::abs(value);
+		if(a==0.0f) {
+			*output++ = '0';
+			return output;
+		}
+
+		double const x = double(a);
+		uint32_t bits = 0;
+		std::memcpy(&bits, &a, sizeof(float));
+
+		// Exponent of the first significant digit, estimated from the binary exponent (and corrected by the number of digits of D)
+		int const e2 = int(bits>>23)-127;
+		int e10 = (e2>-127)? int(std::floor(e2*0.30102999566398120)) : int(std::floor(std::log10(x)));
+		uint64_t D = uint64_t(scale_power_of_ten(x, 15-e10)+0.5);
+		while(D>=integer_power_of_ten[16]) {
+			e10++;
+			D = uint64_t(scale_power_of_ten(x, 15-e10)+0.5);
+		}
+		while(D<integer_power_of_ten[15]) {
+			e10--;
+			D = uint64_t(scale_power_of_ten(x, 15-e10)+0.5);
+		}
+
+		// Neighbors of the positive float a
+		float below = 0.0f, above = 0.0f;
+		uint32_t const bits_below = bits-1, bits_above = bits+1;
+		std::memcpy(&below, &bits_below, sizeof(float));
+		std::memcpy(&above, &bits_above, sizeof(float));
+		double const low = 0.5*(x+double(below));
+		double const high = std::isfinite(above)? 0.5*(x+double(above)) : x+(x-low);
+		double const margin = 1e-15;
+
+		auto is_valid = [&](int p, uint64_t& candidate, int& exponent) {
+			uint64_t const divisor = integer_power_of_ten[16-p];
+			candidate = (D+divisor/2)/divisor;
+			exponent = e10-p+1;
+			double const y = scale_power_of_ten(double(candidate), exponent);
+			if(std::abs(y-low)>margin*low && std::abs(y-high)>margin*high)
+				return y>low && y<high;
+
+			// Candidate too close to the boundary: check it by parsing
+			char text[text_number_max_size];
+			char* const end = write_decimal(text, candidate, exponent);
+			float parsed = 0.0f;
+			parse_float(text, end, parsed);
+			return parsed==a;
+		};
+
+		// Smallest number of digits giving a valid candidate, searched downward from 9 digits
+		//  The validity is monotone in p: a rounding to p digits is also a number with p+1 digits, and the rounding to p+1 digits is at least as close to the value.
+		//  (Only the asymmetric interval of a power of 2 can break it: the search may then stop on a longer valid candidate.)
+		uint64_t candidate = 0;
+		int exponent = 0;
+		if(is_valid(9, candidate, exponent))
+		{
+			int p = 9;
+			while(p>1 && candidate%10==0) {
+				candidate /= 10;
+				exponent++;
+				p--;
+			}
+			uint64_t c = 0;
+			int e = 0;
+			while(p>1 && is_valid(p-1, c, e)) {
+				candidate = c;
+				exponent = e;
+				p--;
+			}
+			return write_decimal(output, candidate, exponent);
+		}
+
+		// The digits are incorrect (value extremely close to a rounding boundary of the double computation)
+		char text[text_number_max_size];
+		int const N = std::snprintf(text, sizeof(text), "%.9g", x);
+		std::memcpy(output, text, size_t(N));
+		return output+N;
+	}
+
+	// The shortest text of a double has at most 17 digits: the text with 15 digits is correct for most values
+	//  (trailing zeros are removed by %g, and a shorter text would have the same rounding to 15 digits)
+	char* format_float(char* output, double value)
+	{
+		if(!std::isfinite(value))
+			return write_special(output, value);
+
+		char text[text_number_max_size];
+		int N = 0;
+		for(int p=15; p<=17; ++p) {
+			N = std::snprintf(text, sizeof(text), "%.*g", p, value);
+			double parsed = 0.0;
+			parse_float(text, text+N, parsed);
+			if(parsed==value)
+				break;
+		}
+		std::memcpy(output, text, size_t(N));
+		return output+N;
+	}
+
+	char* format_int(char* output, unsigned long long value)
+	{
+		return output+write_digits(output, value);
+	}
+
+	char* format_int(char* output, long long value)
+	{
+		if(value<0) {
+			*output++ = '-';
+			return format_int(output, 0ull-static_cast<unsigned long long>(value));
+		}
+		return format_int(output, static_cast<unsigned long long>(value));
+	}
+
+	bool text_write_file(std::string const& filename, std::vector<text_writer> const& chunks)
+	{
+		std::FILE* file = std::fopen(filename.c_str(), "wb");
+		if(file==nullptr)
+			return false;
+		bool success = true;
+		for(text_writer const& chunk : chunks)
+			success = success && std::fwrite(chunk.text.data(), 1, chunk.text.size(), file)==chunk.text.size();
+		success = (std::fclose(file)==0) && success;
+		return success;
+	}
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include "vcl/base/parallel/parallel.hpp"
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace vcl
+{
+	/** Maximal number of characters written by format_float and format_int */
+	size_t const text_number_max_size = 32;
+
+	/** Write the shortest decimal text of the value that is read back exactly (by parse_float, strtof or strtod)
+	* Uses the fixed or the scientific notation, whichever is shorter (ex. 0.1, 1200, 1e-07 for a float).
+	* The output is not null terminated, returns the pointer after the last written character. */
+	char* format_float(char* output, float value);
+	char* format_float(char* output, double value);
+
+	/** Write the decimal text of an integer, returns the pointer after the last written character */
+	char* format_int(char* output, long long value);
+	char* format_int(char* output, unsigned long long value);
+
+
+	/** Text formatted in memory before being written in a file (used by the file writers instead of std::ostream)
+	* ex.
+	*   text_writer writer;
+	*   writer.write("v ").write_number(p.x).write(' ').write_number(p.y).write('\n'); */
+	struct text_writer
+	{
+		std::string text;
+
+		text_writer& write(char c) { text += c; return *this; }
+		text_writer& write(char const* s) { text += s; return *this; }
+		text_writer& write(std::string const& s) { text += s; return *this; }
+
+		text_writer& write_number(float value) { char s[text_number_max_size]; text.append(s, format_float(s, value)); return *this; }
+		text_writer& write_number(double value) { char s[text_number_max_size]; text.append(s, format_float(s, value)); return *this; }
+		text_writer& write_number(int value) { return write_signed(value); }
+		text_writer& write_number(long value) { return write_signed(value); }
+		text_writer& write_number(long long value) { return write_signed(value); }
+		text_writer& write_number(unsigned int value) { return write_unsigned(value); }
+		text_writer& write_number(unsigned long value) { return write_unsigned(value); }
+		text_writer& write_number(unsigned long long value) { return write_unsigned(value); }
+
+	private:
+		text_writer& write_signed(long long value) { char s[text_number_max_size]; text.append(s, format_int(s, value)); return *this; }
+		text_writer& write_unsigned(unsigned long long value) { char s[text_number_max_size]; text.append(s, format_int(s, value)); return *this; }
+	};
+
+	/** Format N elements by chunks in parallel: f(text_writer&, k) appends the text of the k-th element
+	* The chunks are added at the end of the vector in the order of the elements */
+	template <typename F> void text_write_parallel(std::vector<text_writer>& chunks, size_t N, F const& f, size_t grain=16384);
+
+	/** Write the text of the chunks in a file (in order, without copying them in a single string)
+	* Returns false if the file cannot be written */
+	bool text_write_file(std::string const& filename, std::vector<text_writer> const& chunks);
+}
+
+
+namespace vcl
+{
+	template <typename F> void text_write_parallel(std::vector<text_writer>& chunks, size_t N, F const& f, size_t grain)
+	{
+		size_t const N_chunk = parallel_range_count(N, grain);
+		size_t const offset = chunks.size();
+		chunks.resize(offset+N_chunk);
+		parallel_for(N_chunk, [&](size_t k_chunk) {
+			size_t k_begin=0, k_end=0;
+			parallel_range_bounds(N, N_chunk, k_chunk, k_begin, k_end);
+			text_writer& writer = chunks[offset+k_chunk];
+			for(size_t k=k_begin; k<k_end; ++k)
+				f(writer, k);
+		}, 1);
+	}
+}
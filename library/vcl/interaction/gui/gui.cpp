@@ -1,5 +1,7 @@
 #include "gui.hpp"
 
+#include "vcl/display/opengl/state/opengl_state.hpp"
+
 namespace vcl
 {
 
@@ -26,6 +28,9 @@ void imgui_render_frame(GLFWwindow* window)
     int display_w, display_h;
     glfwGetFramebufferSize(window, &display_w, &display_h);
     ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+
+    // ImGui changes the program, VAO, textures and blend state directly
+    opengl_state_invalidate();
 }
 
 void imgui_cleanup()
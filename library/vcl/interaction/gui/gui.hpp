@@ -1,5 +1,7 @@
 #pragma once
 
+#include "vcl/display/opengl/glad/glad.hpp" // before GLFW
+
 #include "third_party/src/imgui/imgui.h"
 #include "third_party/src/imgui/imgui_impl_glfw.h"
 #include "third_party/src/imgui/imgui_impl_opengl3.h"
@@ -0,0 +1,176 @@
+#include "quantization.hpp"
+
+#include "vcl/base/base.hpp"
+
+#include <cmath>
+#include <cstring>
+
+namespace vcl
+{
+	uint8_t quantize_unorm8(float x)
+	{
+		return static_cast<uint8_t>(clamp(x, 0.0f, 1.0f)*255.0f + 0.5f);
+	}
+	uint16_t quantize_unorm16(float x)
+	{
+		return static_cast<uint16_t>(clamp(x, 0.0f, 1.0f)*65535.0f + 0.5f);
+	}
+	int8_t quantize_snorm8(float x)
+	{
+		return static_cast<int8_t>(std::round(clamp(x, -1.0f, 1.0f)*127.0f));
+	}
+	int16_t quantize_snorm16(float x)
+	{
+		return static_cast<int16_t>(std::round(clamp(x, -1.0f, 1.0f)*32767.0f));
+	}
+
+	float dequantize_unorm8(uint8_t q)
+	{
+		return q/255.0f;
+	}
+	float dequantize_unorm16(uint16_t q)
+	{
+		return q/65535.0f;
+	}
+	// Follow the OpenGL convention for normalized signed integers: -128 and -127 are both mapped to -1
+	float dequantize_snorm8(int8_t q)
+	{
+		return std::max(q/127.0f, -1.0f);
+	}
+	float dequantize_snorm16(int16_t q)
+	{
+		return std::max(q/32767.0f, -1.0f);
+	}
+
+	uint16_t float_to_half(float x)
+	{
+		uint32_t bits = 0;
+		std::memcpy(&bits, &x, sizeof(float));
+
+		uint32_t const sign = (bits>>16) & 0x8000u;
+		uint32_t const exponent = (bits>>23) & 0xffu;
+		uint32_t mantissa = bits & 0x7fffffu;
+
+		if(exponent==0xffu) // inf or nan
+			return static_cast<uint16_t>(sign | 0x7c00u | (mantissa!=0? 0x200u : 0u));
+
+		int const e = int(exponent) - 127 + 15;
+		if(e>=31) // overflow: inf
+			return static_cast<uint16_t>(sign | 0x7c00u);
+
+		if(e<=0) { // denormal or zero
+			if(e<-10)
+				return static_cast<uint16_t>(sign);
+			mantissa |= 0x800000u;
+			uint32_t const shift = uint32_t(14-e);
+			uint32_t half_mantissa = mantissa>>shift;
+			uint32_t const remainder = mantissa & ((1u<<shift)-1u);
+			uint32_t const halfway = 1u<<(shift-1);
+			if(remainder>halfway || (remainder==halfway && (half_mantissa&1u)))
+				half_mantissa++;
+			return static_cast<uint16_t>(sign | half_mantissa);
+		}
+
+		uint32_t half = sign | (uint32_t(e)<<10) | (mantissa>>13);
+		uint32_t const remainder = mantissa & 0x1fffu;
+		if(remainder>0x1000u || (remainder==0x1000u && (half&1u)))
+			half++; // rounding may carry into the exponent, which is the correct behavior
+		return static_cast<uint16_t>(half);
+	}
+
+	float half_to_float(uint16_t h)
+	{
+		uint32_t const sign = uint32_t(h&0x8000u)<<16;
+		uint32_t exponent = (h>>10) & 0x1fu;
+		uint32_t mantissa = h & 0x3ffu;
+
+		uint32_t bits = 0;
+		if(exponent==0) {
+			if(mantissa==0)
+				bits = sign;
+			else { // normalize the denormal
+				exponent = 1;
+				while((mantissa & 0x400u)==0) {
+					mantissa <<= 1;
+					exponent--;
+				}
+				mantissa &= 0x3ffu;
+				bits = sign | ((exponent+127-15)<<23) | (mantissa<<13);
+			}
+		}
+		else if(exponent==31)
+			bits = sign | 0x7f800000u | (mantissa<<13);
+		else
+			bits = sign | ((exponent+127-15)<<23) | (mantissa<<13);
+
+		float x = 0.0f;
+		std::memcpy(&x, &bits, sizeof(float));
+		return x;
+	}
+
+	static float sign_not_zero(float x)
+	{
+		return x>=0.0f? 1.0f : -1.0f;
+	}
+
+	vec2 octahedral_encode(vec3 const& n)
+	{
+		float const L1 = std::abs(n.x)+std::abs(n.y)+std::abs(n.z);
+		if(L1<1e-20f)
+			return {0.0f, 0.0f};
+		vec2 e = {n.x/L1, n.y/L1};
+		if(n.z<0.0f)
+			e = { (1.0f-std::abs(e.y))*sign_not_zero(e.x), (1.0f-std::abs(e.x))*sign_not_zero(e.y) };
+		return e;
+	}
+
+	vec3 octahedral_decode(vec2 const& e)
+	{
+		vec3 n = {e.x, e.y, 1.0f-std::abs(e.x)-std::abs(e.y)};
+		float const t = std::max(-n.z, 0.0f);
+		n.x += n.x>=0.0f? -t : t;
+		n.y += n.y>=0.0f? -t : t;
+		return normalize(n);
+	}
+
+	// Test the 4 possible roundings of the encoded value and keep the most accurate one
+	template <typename INT>
+	static buffer_stack<INT,2> octahedral_encode_precise(vec3 const& n, float scale)
+	{
+		vec2 const e = octahedral_encode(n);
+		float const L = norm(n);
+		vec3 const n_unit = L>0? n/L : vec3{0,0,1};
+
+		buffer_stack<INT,2> best = {INT(0), INT(0)};
+		float best_dot = -2.0f;
+		for(int dx=0; dx<2; ++dx) {
+			for(int dy=0; dy<2; ++dy) {
+				float const qx = clamp((dx==0? std::floor(e.x*scale) : std::ceil(e.x*scale)), -scale, scale);
+				float const qy = clamp((dy==0? std::floor(e.y*scale) : std::ceil(e.y*scale)), -scale, scale);
+				float const d = dot(octahedral_decode({qx/scale, qy/scale}), n_unit);
+				if(d>best_dot) {
+					best_dot = d;
+					best = {INT(qx), INT(qy)};
+				}
+			}
+		}
+		return best;
+	}
+
+	buffer_stack<int8_t,2> octahedral_encode_snorm8(vec3 const& n)
+	{
+		return octahedral_encode_precise<int8_t>(n, 127.0f);
+	}
+	vec3 octahedral_decode_snorm8(buffer_stack<int8_t,2> const& q)
+	{
+		return octahedral_decode({dequantize_snorm8(q.x), dequantize_snorm8(q.y)});
+	}
+	buffer_stack<int16_t,2> octahedral_encode_snorm16(vec3 const& n)
+	{
+		return octahedral_encode_precise<int16_t>(n, 32767.0f);
+	}
+	vec3 octahedral_decode_snorm16(buffer_stack<int16_t,2> const& q)
+	{
+		return octahedral_decode({dequantize_snorm16(q.x), dequantize_snorm16(q.y)});
+	}
+}
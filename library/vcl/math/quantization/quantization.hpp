@@ -0,0 +1,40 @@
+#pragma once
+
+#include "vcl/containers/containers.hpp"
+
+#include <cstdint>
+
+// Conversion of floating point values to compact fixed-point or half-precision representations
+//  - unorm: value in [0,1] stored as unsigned integer (0 -> 0, 1 -> max integer)
+//  - snorm: value in [-1,1] stored as signed integer (-1 -> -max, 1 -> max)
+//  - half: IEEE 754 16-bit floating point (binary16)
+//  - octahedral: unit vector mapped to 2 values in [-1,1]
+
+namespace vcl
+{
+	uint8_t  quantize_unorm8(float x);
+	uint16_t quantize_unorm16(float x);
+	int8_t   quantize_snorm8(float x);
+	int16_t  quantize_snorm16(float x);
+
+	float dequantize_unorm8(uint8_t q);
+	float dequantize_unorm16(uint16_t q);
+	float dequantize_snorm8(int8_t q);
+	float dequantize_snorm16(int16_t q);
+
+	/** Convert a float to a half float (round to nearest even, handle inf/nan/denormals) */
+	uint16_t float_to_half(float x);
+	float half_to_float(uint16_t h);
+
+	/** Octahedral encoding of a unit vector into two values in [-1,1] */
+	vec2 octahedral_encode(vec3 const& n);
+	/** Decode an octahedral encoded vector (the returned vector is normalized) */
+	vec3 octahedral_decode(vec2 const& e);
+
+	/** Octahedral encoding of a unit vector as two snorm8 selecting the rounding with the smallest angular error */
+	buffer_stack<int8_t,2> octahedral_encode_snorm8(vec3 const& n);
+	vec3 octahedral_decode_snorm8(buffer_stack<int8_t,2> const& q);
+	/** Octahedral encoding of a unit vector as two snorm16 */
+	buffer_stack<int16_t,2> octahedral_encode_snorm16(vec3 const& n);
+	vec3 octahedral_decode_snorm16(buffer_stack<int16_t,2> const& q);
+}
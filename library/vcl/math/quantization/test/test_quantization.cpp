@@ -0,0 +1,51 @@
+#include "test_quantization.hpp"
+
+#include "vcl/base/base.hpp"
+#include "../quantization.hpp"
+
+#include <cmath>
+
+using namespace vcl;
+
+namespace vcl_test
+{
+	void test_quantization()
+	{
+		// Fixed point
+		{
+			assert_vcl_no_msg(quantize_unorm8(0.0f)==0 && quantize_unorm8(1.0f)==255 && quantize_unorm8(2.0f)==255);
+			assert_vcl_no_msg(quantize_unorm16(0.5f)==32768);
+			assert_vcl_no_msg(quantize_snorm8(-1.0f)==-127 && quantize_snorm8(1.0f)==127);
+			assert_vcl_no_msg(dequantize_snorm8(-128)==-1.0f);
+			assert_vcl_no_msg(is_equal(dequantize_unorm16(quantize_unorm16(0.3f)), 0.3f));
+		}
+
+		// Half float
+		{
+			assert_vcl_no_msg(float_to_half(0.0f)==0x0000);
+			assert_vcl_no_msg(float_to_half(-0.0f)==0x8000);
+			assert_vcl_no_msg(float_to_half(1.0f)==0x3c00);
+			assert_vcl_no_msg(float_to_half(-2.0f)==0xc000);
+			assert_vcl_no_msg(float_to_half(65504.0f)==0x7bff);
+			assert_vcl_no_msg(float_to_half(1e6f)==0x7c00);      // overflow to inf
+			assert_vcl_no_msg(float_to_half(5.9604645e-8f)==0x0001); // smallest denormal
+			assert_vcl_no_msg(half_to_float(0x3555)==0.333251953125f);
+
+			// All finite half values are exactly represented as float
+			for(unsigned int h=0; h<0x7c00; ++h) {
+				assert_vcl_no_msg(float_to_half(half_to_float(uint16_t(h)))==h);
+				assert_vcl_no_msg(float_to_half(-half_to_float(uint16_t(h)))==(h|0x8000));
+			}
+		}
+
+		// Octahedral encoding
+		{
+			vec3 const directions[] = { {0,0,1}, {0,0,-1}, {1,0,0}, {0,-1,0}, normalize(vec3{1,2,3}), normalize(vec3{-1,0.5f,-3}), normalize(vec3{0.2f,-0.9f,-0.1f}) };
+			for(vec3 const& n : directions) {
+				assert_vcl_no_msg(is_equal(octahedral_decode(octahedral_encode(n)), n));
+				assert_vcl_no_msg(dot(octahedral_decode_snorm16(octahedral_encode_snorm16(n)), n)>0.99999f);
+				assert_vcl_no_msg(dot(octahedral_decode_snorm8(octahedral_encode_snorm8(n)), n)>0.9995f);
+			}
+		}
+	}
+}
@@ -0,0 +1,42 @@
+std::string s = R"(
+#version 330 core
+
+layout (location = 0) in vec3 position;
+layout (location = 1) in vec3 normal;
+layout (location = 2) in vec3 color;
+layout (location = 3) in vec2 uv;
+
+// Per-instance attributes: 3 first rows of the affine matrix, and color
+layout (location = 4) in vec4 instance_row0;
+layout (location = 5) in vec4 instance_row1;
+layout (location = 6) in vec4 instance_row2;
+layout (location = 7) in vec4 instance_color;
+
+out struct fragment_data
+{
+    vec3 position;
+    vec3 normal;
+    vec3 color;
+    vec2 uv;
+	vec3 eye;
+} fragment;
+
+uniform mat4 model;
+uniform mat4 view;
+uniform mat4 projection;
+
+void main()
+{
+	// Rows given as columns of the constructor
+	mat4 instance = transpose(mat4(instance_row0, instance_row1, instance_row2, vec4(0.0, 0.0, 0.0, 1.0)));
+	mat4 M = model * instance;
+
+	fragment.position = vec3(M * vec4(position,1.0));
+	fragment.normal   = vec3(M * vec4(normal  ,0.0));
+	fragment.color = color * instance_color.rgb;
+	fragment.uv = uv;
+	fragment.eye = vec3(inverse(view)*vec4(0,0,0,1.0));
+
+	gl_Position = projection * view * vec4(fragment.position, 1.0);
+}
+)";
\ No newline at end of file
@@ -0,0 +1,70 @@
+std::string s = R"(
+#version 330 core
+
+in struct fragment_data
+{
+    vec3 position;
+    vec3 normal;
+    vec3 color;
+    vec2 uv;
+
+	vec3 eye;
+} fragment;
+
+layout(location=0) out vec4 FragColor;
+
+uniform sampler2D image_texture;
+
+layout (std140, row_major) uniform scene_data
+{
+	mat4 projection;
+	mat4 view;
+	vec4 light;
+	vec4 eye;
+} scene;
+
+// color: (r,g,b,alpha), phong: (Ka,Kd,Ks,specular_exp), flags: (use_texture,texture_inverse_y,-,-)
+layout (std140, row_major) uniform object_data
+{
+	mat4 model;
+	vec4 color;
+	vec4 phong;
+	ivec4 flags;
+} object;
+
+void main()
+{
+	float Ka = object.phong.x;
+	float Kd = object.phong.y;
+	float Ks = object.phong.z;
+	float specular_exp = object.phong.w;
+
+	vec3 N = normalize(fragment.normal);
+	if (!gl_FrontFacing) {
+		N = -N;
+	}
+	vec3 L = normalize(scene.light.xyz-fragment.position);
+
+	float diffuse = max(dot(N,L),0.0);
+	float specular = 0.0;
+	if(diffuse>0.0){
+		vec3 R = reflect(-L,N);
+		vec3 V = normalize(fragment.eye-fragment.position);
+		specular = pow( max(dot(R,V),0.0), specular_exp );
+	}
+
+
+	vec2 uv_image = vec2(fragment.uv.x, 1.0-fragment.uv.y);
+	if(object.flags.y!=0) {
+		uv_image.y = 1.0-uv_image.y;
+	}
+	vec4 color_image_texture = texture(image_texture, uv_image);
+	if(object.flags.x==0) {
+		color_image_texture=vec4(1.0,1.0,1.0,1.0);
+	}
+	vec3 color_object  = fragment.color * object.color.rgb * color_image_texture.rgb;
+	vec3 color_shading = (Ka + Kd * diffuse) * color_object + Ks * specular * vec3(1.0, 1.0, 1.0);
+	
+	FragColor = vec4(color_shading, object.color.a * color_image_texture.a);
+}
+)";
\ No newline at end of file
@@ -0,0 +1,46 @@
+std::string s = R"(
+#version 330 core
+
+layout (location = 0) in vec3 position;
+layout (location = 1) in vec3 normal;
+layout (location = 2) in vec3 color;
+layout (location = 3) in vec2 uv;
+
+out struct fragment_data
+{
+    vec3 position;
+    vec3 normal;
+    vec3 color;
+    vec2 uv;
+	vec3 eye;
+} fragment;
+
+// Per-frame data (uniform_block_scene)
+layout (std140, row_major) uniform scene_data
+{
+	mat4 projection;
+	mat4 view;
+	vec4 light;
+	vec4 eye;
+} scene;
+
+// Per-object data (uniform_block_object)
+layout (std140, row_major) uniform object_data
+{
+	mat4 model;
+	vec4 color;
+	vec4 phong;
+	ivec4 flags;
+} object;
+
+void main()
+{
+	fragment.position = vec3(object.model * vec4(position,1.0));
+	fragment.normal   = vec3(object.model * vec4(normal  ,0.0));
+	fragment.color = color;
+	fragment.uv = uv;
+	fragment.eye = scene.eye.xyz;
+
+	gl_Position = scene.projection * scene.view * object.model * vec4(position, 1.0);
+}
+)";
\ No newline at end of file
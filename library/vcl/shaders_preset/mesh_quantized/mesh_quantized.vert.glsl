@@ -0,0 +1,46 @@
+std::string s = R"(
+#version 330 core
+
+layout (location = 0) in vec3 position; // unorm16 within the bounding box
+layout (location = 1) in vec2 normal;   // octahedral encoding (snorm8)
+layout (location = 2) in vec4 color;    // unorm8
+layout (location = 3) in vec2 uv;       // half float
+
+out struct fragment_data
+{
+    vec3 position;
+    vec3 normal;
+    vec3 color;
+    vec2 uv;
+	vec3 eye;
+} fragment;
+
+uniform mat4 model;
+uniform mat4 view;
+uniform mat4 projection;
+
+uniform vec3 position_offset;
+uniform vec3 position_scale;
+
+vec3 octahedral_decode(vec2 e)
+{
+	vec3 n = vec3(e.x, e.y, 1.0-abs(e.x)-abs(e.y));
+	float t = max(-n.z, 0.0);
+	n.x += n.x>=0.0 ? -t : t;
+	n.y += n.y>=0.0 ? -t : t;
+	return normalize(n);
+}
+
+void main()
+{
+	vec3 p = position_offset + position_scale * position;
+
+	fragment.position = vec3(model * vec4(p,1.0));
+	fragment.normal   = vec3(model * vec4(octahedral_decode(normal),0.0));
+	fragment.color = color.rgb;
+	fragment.uv = uv;
+	fragment.eye = vec3(inverse(view)*vec4(0,0,0,1.0));
+
+	gl_Position = projection * view * model * vec4(p, 1.0);
+}
+)";
\ No newline at end of file
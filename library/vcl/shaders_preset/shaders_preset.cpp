@@ -15,6 +15,25 @@ namespace vcl
 			return s;
 		}
 
+		if (shader_name == "mesh_ubo_vertex") {
+			#include "mesh/mesh_ubo.vert.glsl"
+			return s;
+		}
+		if (shader_name == "mesh_ubo_fragment") {
+			#include "mesh/mesh_ubo.frag.glsl"
+			return s;
+		}
+
+		if (shader_name == "mesh_instanced_vertex") {
+			#include "mesh/mesh_instanced.vert.glsl"
+			return s;
+		}
+
+		if (shader_name == "mesh_quantized_vertex") {
+			#include "mesh_quantized/mesh_quantized.vert.glsl"
+			return s;
+		}
+
 		if (shader_name == "single_color_vertex") {
 			#include "single_color/single_color.vert.glsl"
 			return s;
@@ -0,0 +1,509 @@
+#include "bvh.hpp"
+
+#include "vcl/base/base.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <thread>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP>=2)
+#define VCL_BVH_SSE
+#include <emmintrin.h>
+#endif
+
+namespace vcl
+{
+	namespace
+	{
+		struct bvh_box {
+			vec3 p_min = {  std::numeric_limits<float>::max(),  std::numeric_limits<float>::max(),  std::numeric_limits<float>::max() };
+			vec3 p_max = { -std::numeric_limits<float>::max(), -std::numeric_limits<float>::max(), -std::numeric_limits<float>::max() };
+
+			void extend(vec3 const& p_min_arg, vec3 const& p_max_arg) {
+				for(size_t k=0; k<3; ++k) {
+					p_min[k] = std::min(p_min[k], p_min_arg[k]);
+					p_max[k] = std::max(p_max[k], p_max_arg[k]);
+				}
+			}
+			void extend(vec3 const& p) { extend(p,p); }
+			float area() const {
+				vec3 const d = p_max-p_min;
+				if(d.x<0 || d.y<0 || d.z<0)
+					return 0.0f;
+				return d.x*d.y + d.y*d.z + d.z*d.x;
+			}
+		};
+
+		struct bvh_build_context {
+			buffer<vec3> const& box_min;
+			buffer<vec3> const& box_max;
+			buffer<vec3> centroid;
+			buffer<unsigned int>& primitive_index;
+			bvh_parameters parameters;
+			size_t parallel_depth;
+		};
+
+		size_t const bvh_max_depth_sah = 48; // beyond this depth, split by median to bound the depth of the tree
+		size_t const bvh_parallel_min_size = 8192;
+		size_t const bvh_max_bin = 64;
+	}
+
+	// Build recursively the subtree of primitive_index[begin,end) at nodes[node_index]
+	static void bvh_build_node(bvh_build_context& context, std::vector<bvh_node>& nodes, size_t node_index, size_t begin, size_t end, size_t depth)
+	{
+		buffer<unsigned int>& primitive_index = context.primitive_index;
+		size_t const N = end-begin;
+
+		bvh_box box, centroid_box;
+		for(size_t k=begin; k<end; ++k) {
+			unsigned int const idx = primitive_index.data[k];
+			box.extend(context.box_min.data[idx], context.box_max.data[idx]);
+			centroid_box.extend(context.centroid.data[idx]);
+		}
+		nodes[node_index].box_min = box.p_min;
+		nodes[node_index].box_max = box.p_max;
+
+		auto make_leaf = [&]() {
+			nodes[node_index].first = static_cast<unsigned int>(begin);
+			nodes[node_index].count = static_cast<unsigned int>(N);
+		};
+		if(N<=1) {
+			make_leaf();
+			return;
+		}
+
+		// Binned SAH: find the best (axis, bin) split
+		size_t const N_bin = std::min(bvh_max_bin, std::max(size_t(2), context.parameters.bin_count));
+		float best_cost = std::numeric_limits<float>::max();
+		int best_axis = -1;
+		size_t best_bin = 0;
+		if(depth<bvh_max_depth_sah)
+		{
+			bvh_box bins[bvh_max_bin];
+			size_t bin_count[bvh_max_bin];
+			float right_area[bvh_max_bin];
+			size_t right_count[bvh_max_bin];
+
+			for(int axis=0; axis<3; ++axis) {
+				float const c_min = centroid_box.p_min[axis];
+				float const extent = centroid_box.p_max[axis]-c_min;
+				if(!(extent>0.0f))
+					continue;
+				float const scale = N_bin/extent;
+
+				std::fill(bins, bins+N_bin, bvh_box());
+				std::fill(bin_count, bin_count+N_bin, size_t(0));
+				for(size_t k=begin; k<end; ++k) {
+					unsigned int const idx = primitive_index.data[k];
+					size_t const b = std::min(N_bin-1, size_t((context.centroid.data[idx][axis]-c_min)*scale));
+					bins[b].extend(context.box_min.data[idx], context.box_max.data[idx]);
+					bin_count[b]++;
+				}
+
+				// Sweep from the right, then from the left
+				bvh_box right_box;
+				size_t count = 0;
+				for(size_t b=N_bin-1; b>0; --b) {
+					right_box.extend(bins[b].p_min, bins[b].p_max);
+					count += bin_count[b];
+					right_area[b] = right_box.area();
+					right_count[b] = count;
+				}
+				bvh_box left_box;
+				count = 0;
+				for(size_t b=0; b<N_bin-1; ++b) {
+					left_box.extend(bins[b].p_min, bins[b].p_max);
+					count += bin_count[b];
+					if(count==0 || right_count[b+1]==0)
+						continue;
+					float const cost = left_box.area()*count + right_area[b+1]*right_count[b+1];
+					if(cost<best_cost) {
+						best_cost = cost;
+						best_axis = axis;
+						best_bin = b;
+					}
+				}
+			}
+		}
+
+		// SAH costs relative to the parent area (traversal step and primitive test have the same unit cost)
+		float const leaf_cost = box.area()*N;
+		float const split_cost = box.area() + best_cost;
+		if(N<=context.parameters.max_leaf_size && (best_axis==-1 || split_cost>=leaf_cost)) {
+			make_leaf();
+			return;
+		}
+
+		// Partition the primitives
+		size_t mid = begin;
+		if(best_axis!=-1)
+		{
+			float const c_min = centroid_box.p_min[best_axis];
+			float const scale = N_bin/(centroid_box.p_max[best_axis]-c_min);
+			auto const it = std::partition(primitive_index.data.begin()+begin, primitive_index.data.begin()+end, [&](unsigned int idx){
+				size_t const b = std::min(N_bin-1, size_t((context.centroid.data[idx][best_axis]-c_min)*scale));
+				return b<=best_bin;
+			});
+			mid = size_t(it-primitive_index.data.begin());
+		}
+		if(mid==begin || mid==end) // no valid SAH split (identical centroids or depth limit): median split on the largest axis
+		{
+			vec3 const d = centroid_box.p_max-centroid_box.p_min;
+			int const axis = (d.x>=d.y && d.x>=d.z)? 0 : (d.y>=d.z? 1 : 2);
+			mid = begin+N/2;
+			std::nth_element(primitive_index.data.begin()+begin, primitive_index.data.begin()+mid, primitive_index.data.begin()+end, [&](unsigned int a, unsigned int b){
+				return context.centroid.data[a][axis]<context.centroid.data[b][axis];
+			});
+		}
+
+		// Children
+		if(depth<context.parallel_depth && N>=bvh_parallel_min_size)
+		{
+			// The right subtree is built in a separated array by another thread, then appended
+			std::vector<bvh_node> nodes_right(1);
+			std::thread thread_right([&context, &nodes_right, mid, end, depth](){
+				bvh_build_node(context, nodes_right, 0, mid, end, depth+1);
+			});
+
+			size_t const left = nodes.size();
+			nodes.push_back(bvh_node());
+			bvh_build_node(context, nodes, left, begin, mid, depth+1);
+			thread_right.join();
+
+			unsigned int const offset = static_cast<unsigned int>(nodes.size());
+			for(bvh_node node : nodes_right) {
+				if(node.count==0) {
+					node.left += offset;
+					node.right += offset;
+				}
+				nodes.push_back(node);
+			}
+			nodes[node_index].left = static_cast<unsigned int>(left);
+			nodes[node_index].right = offset;
+		}
+		else
+		{
+			size_t const left = nodes.size();
+			nodes.push_back(bvh_node());
+			bvh_build_node(context, nodes, left, begin, mid, depth+1);
+			size_t const right = nodes.size();
+			nodes.push_back(bvh_node());
+			bvh_build_node(context, nodes, right, mid, end, depth+1);
+
+			nodes[node_index].left = static_cast<unsigned int>(left);
+			nodes[node_index].right = static_cast<unsigned int>(right);
+		}
+		nodes[node_index].count = 0;
+	}
+
+	// Set the bounds of the child k of a 4-wide node from a binary node
+	static void bvh_set_child4(bvh_node4& node4, size_t k, bvh_node const& node)
+	{
+		node4.box_min_x[k] = node.box_min.x; node4.box_min_y[k] = node.box_min.y; node4.box_min_z[k] = node.box_min.z;
+		node4.box_max_x[k] = node.box_max.x; node4.box_max_y[k] = node.box_max.y; node4.box_max_z[k] = node.box_max.z;
+	}
+
+	static float bvh_node_area(bvh_node const& node)
+	{
+		vec3 const d = node.box_max-node.box_min;
+		return d.x*d.y + d.y*d.z + d.z*d.x;
+	}
+
+	// Collapse the binary tree into a 4-wide tree: each internal node takes its (up to) 4 largest descendants
+	static void bvh_collapse(bvh& tree)
+	{
+		tree.nodes4.clear();
+		if(tree.nodes.size()==0)
+			return;
+
+		// Pairs (binary node, 4-wide node to fill)
+		std::vector<std::pair<unsigned int, size_t>> to_process;
+		tree.nodes4.push_back(bvh_node4());
+		if(tree.nodes[0].count>0) { // the root is a leaf
+			bvh_node4& root = tree.nodes4[0];
+			root.child_count = 1;
+			root.child[0] = -1;
+			root.source[0] = 0;
+			bvh_set_child4(root, 0, tree.nodes[0]);
+			return;
+		}
+		to_process.push_back({0u, 0});
+
+		while(!to_process.empty())
+		{
+			unsigned int const binary_index = to_process.back().first;
+			size_t const node4_index = to_process.back().second;
+			to_process.pop_back();
+
+			// Open the internal child of largest area until 4 children are reached
+			unsigned int children[4] = { tree.nodes.data[binary_index].left, tree.nodes.data[binary_index].right, 0, 0 };
+			unsigned int N_child = 2;
+			while(N_child<4) {
+				int best = -1;
+				float best_area = -1.0f;
+				for(unsigned int k=0; k<N_child; ++k) {
+					bvh_node const& c = tree.nodes.data[children[k]];
+					if(c.count==0 && bvh_node_area(c)>best_area) {
+						best_area = bvh_node_area(c);
+						best = int(k);
+					}
+				}
+				if(best==-1)
+					break;
+				bvh_node const& c = tree.nodes.data[children[best]];
+				children[best] = c.left;
+				children[N_child++] = c.right;
+			}
+
+			bvh_node4 node4;
+			node4.child_count = N_child;
+			for(unsigned int k=0; k<4; ++k) {
+				node4.child[k] = 0;
+				node4.source[k] = 0;
+				node4.box_min_x[k] = node4.box_min_y[k] = node4.box_min_z[k] = 0.0f;
+				node4.box_max_x[k] = node4.box_max_y[k] = node4.box_max_z[k] = 0.0f;
+			}
+			for(unsigned int k=0; k<N_child; ++k) {
+				bvh_node const& c = tree.nodes.data[children[k]];
+				bvh_set_child4(node4, k, c);
+				node4.source[k] = children[k];
+				if(c.count>0)
+					node4.child[k] = -int(children[k])-1;
+				else {
+					node4.child[k] = int(tree.nodes4.size());
+					tree.nodes4.push_back(bvh_node4());
+					to_process.push_back({children[k], size_t(node4.child[k])});
+				}
+			}
+			tree.nodes4.data[node4_index] = node4;
+		}
+	}
+
+	bvh bvh_build(buffer<vec3> const& box_min, buffer<vec3> const& box_max, bvh_parameters const& parameters)
+	{
+		assert_vcl(box_min.size()==box_max.size(), "Incoherent size of bounding boxes");
+		size_t const N = box_min.size();
+
+		bvh tree;
+		if(N==0)
+			return tree;
+
+		tree.primitive_index.resize(N);
+		for(size_t k=0; k<N; ++k)
+			tree.primitive_index.data[k] = static_cast<unsigned int>(k);
+
+		size_t parallel_depth = 0;
+		if(parameters.parallel)
+			while((size_t(1)<<parallel_depth) < parallel_thread_count())
+				parallel_depth++;
+
+		bvh_build_context context = {box_min, box_max, buffer<vec3>(N), tree.primitive_index, parameters, parallel_depth};
+		parallel_for(N, [&](size_t k){
+			context.centroid.data[k] = (box_min.data[k]+box_max.data[k])/2.0f;
+		});
+
+		std::vector<bvh_node> nodes(1);
+		nodes.reserve(2*N);
+		bvh_build_node(context, nodes, 0, 0, N, 0);
+		tree.nodes.data = std::move(nodes);
+
+		bvh_collapse(tree);
+		return tree;
+	}
+
+	static void bvh_triangle_bounds(buffer<vec3> const& position, buffer<uint3> const& connectivity, buffer<vec3>& box_min, buffer<vec3>& box_max)
+	{
+		size_t const N = connectivity.size();
+		box_min.resize(N);
+		box_max.resize(N);
+		parallel_for(N, [&](size_t k){
+			uint3 const& tri = connectivity.data[k];
+			bvh_box box;
+			for(unsigned int idx : tri) {
+				assert_vcl_no_msg(idx<position.size());
+				box.extend(position.data[idx]);
+			}
+			box_min.data[k] = box.p_min;
+			box_max.data[k] = box.p_max;
+		});
+	}
+
+	static void bvh_sphere_bounds(buffer<vec3> const& center, float radius, buffer<vec3>& box_min, buffer<vec3>& box_max)
+	{
+		size_t const N = center.size();
+		box_min.resize(N);
+		box_max.resize(N);
+		vec3 const r = {radius, radius, radius};
+		parallel_for(N, [&](size_t k){
+			box_min.data[k] = center.data[k]-r;
+			box_max.data[k] = center.data[k]+r;
+		});
+	}
+
+	bvh bvh_build_triangles(buffer<vec3> const& position, buffer<uint3> const& connectivity, bvh_parameters const& parameters)
+	{
+		buffer<vec3> box_min, box_max;
+		bvh_triangle_bounds(position, connectivity, box_min, box_max);
+		return bvh_build(box_min, box_max, parameters);
+	}
+
+	bvh bvh_build_spheres(buffer<vec3> const& center, float radius, bvh_parameters const& parameters)
+	{
+		buffer<vec3> box_min, box_max;
+		bvh_sphere_bounds(center, radius, box_min, box_max);
+		return bvh_build(box_min, box_max, parameters);
+	}
+
+	void bvh_refit(bvh& tree, buffer<vec3> const& box_min, buffer<vec3> const& box_max)
+	{
+		assert_vcl(box_min.size()==tree.primitive_count() && box_max.size()==tree.primitive_count(), "The number of primitives changed since the construction of the BVH");
+
+		// Children are stored after their parent: update in reverse order
+		size_t const N_node = tree.nodes.size();
+		for(size_t k=N_node; k>0; --k) {
+			bvh_node& node = tree.nodes.data[k-1];
+			bvh_box box;
+			if(node.count>0) {
+				for(unsigned int i=node.first; i<node.first+node.count; ++i) {
+					unsigned int const idx = tree.primitive_index.data[i];
+					box.extend(box_min.data[idx], box_max.data[idx]);
+				}
+			}
+			else {
+				box.extend(tree.nodes.data[node.left].box_min, tree.nodes.data[node.left].box_max);
+				box.extend(tree.nodes.data[node.right].box_min, tree.nodes.data[node.right].box_max);
+			}
+			node.box_min = box.p_min;
+			node.box_max = box.p_max;
+		}
+
+		parallel_for(tree.nodes4.size(), [&tree](size_t k){
+			bvh_node4& node4 = tree.nodes4.data[k];
+			for(unsigned int c=0; c<node4.child_count; ++c)
+				bvh_set_child4(node4, c, tree.nodes.data[node4.source[c]]);
+		});
+	}
+
+	void bvh_refit_triangles(bvh& tree, buffer<vec3> const& position, buffer<uint3> const& connectivity)
+	{
+		buffer<vec3> box_min, box_max;
+		bvh_triangle_bounds(position, connectivity, box_min, box_max);
+		bvh_refit(tree, box_min, box_max);
+	}
+
+	void bvh_refit_spheres(bvh& tree, buffer<vec3> const& center, float radius)
+	{
+		buffer<vec3> box_min, box_max;
+		bvh_sphere_bounds(center, radius, box_min, box_max);
+		bvh_refit(tree, box_min, box_max);
+	}
+
+	size_t bvh::primitive_count() const
+	{
+		return primitive_index.size();
+	}
+
+
+	unsigned int bvh_intersect_node4(bvh_node4 const& node, vec3 const& o, vec3 const& inv_d, float t_max, float t_near[4])
+	{
+#ifdef VCL_BVH_SSE
+		__m128 const ox = _mm_set1_ps(o.x), oy = _mm_set1_ps(o.y), oz = _mm_set1_ps(o.z);
+		__m128 const ix = _mm_set1_ps(inv_d.x), iy = _mm_set1_ps(inv_d.y), iz = _mm_set1_ps(inv_d.z);
+
+		__m128 const tx0 = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(node.box_min_x), ox), ix);
+		__m128 const tx1 = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(node.box_max_x), ox), ix);
+		__m128 const ty0 = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(node.box_min_y), oy), iy);
+		__m128 const ty1 = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(node.box_max_y), oy), iy);
+		__m128 const tz0 = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(node.box_min_z), oz), iz);
+		__m128 const tz1 = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(node.box_max_z), oz), iz);
+
+		__m128 t_enter = _mm_max_ps(_mm_min_ps(tx0,tx1), _mm_setzero_ps());
+		t_enter = _mm_max_ps(t_enter, _mm_min_ps(ty0,ty1));
+		t_enter = _mm_max_ps(t_enter, _mm_min_ps(tz0,tz1));
+		__m128 t_exit = _mm_min_ps(_mm_max_ps(tx0,tx1), _mm_set1_ps(t_max));
+		t_exit = _mm_min_ps(t_exit, _mm_max_ps(ty0,ty1));
+		t_exit = _mm_min_ps(t_exit, _mm_max_ps(tz0,tz1));
+
+		_mm_storeu_ps(t_near, t_enter);
+		unsigned int const mask = static_cast<unsigned int>(_mm_movemask_ps(_mm_cmple_ps(t_enter, t_exit)));
+		return mask & ((1u<<node.child_count)-1u);
+#else
+		unsigned int mask = 0;
+		for(unsigned int k=0; k<node.child_count; ++k)
+		{
+			float const tx0 = (node.box_min_x[k]-o.x)*inv_d.x, tx1 = (node.box_max_x[k]-o.x)*inv_d.x;
+			float const ty0 = (node.box_min_y[k]-o.y)*inv_d.y, ty1 = (node.box_max_y[k]-o.y)*inv_d.y;
+			float const tz0 = (node.box_min_z[k]-o.z)*inv_d.z, tz1 = (node.box_max_z[k]-o.z)*inv_d.z;
+
+			float const t_enter = std::max(std::max(std::max(std::min(tx0,tx1), std::min(ty0,ty1)), std::min(tz0,tz1)), 0.0f);
+			float const t_exit = std::min(std::min(std::min(std::max(tx0,tx1), std::max(ty0,ty1)), std::max(tz0,tz1)), t_max);
+			t_near[k] = t_enter;
+			if(t_enter<=t_exit)
+				mask |= (1u<<k);
+		}
+		return mask;
+#endif
+	}
+
+
+	intersection_structure intersection_ray_mesh_closest(bvh const& tree, buffer<vec3> const& position, buffer<uint3> const& connectivity, vec3 const& ray_origin, vec3 const& ray_direction, int* triangle_index)
+	{
+		intersection_structure closest;
+		int index_closest = -1;
+		float t_max = std::numeric_limits<float>::max();
+		bvh_traverse(tree, ray_origin, ray_direction, t_max, [&](unsigned int k, float& t) {
+			uint3 const& tri = connectivity.data[k];
+			intersection_structure const inter = intersection_ray_triangle(ray_origin, ray_direction, position.data[tri[0]], position.data[tri[1]], position.data[tri[2]]);
+			if(inter.valid && inter.t<t) {
+				t = inter.t;
+				closest = inter;
+				index_closest = int(k);
+				return true;
+			}
+			return false;
+		});
+
+		if(triangle_index!=nullptr)
+			*triangle_index = index_closest;
+		return closest;
+	}
+
+	bool intersection_ray_mesh_any(bvh const& tree, buffer<vec3> const& position, buffer<uint3> const& connectivity, vec3 const& ray_origin, vec3 const& ray_direction, float t_max)
+	{
+		return bvh_traverse(tree, ray_origin, ray_direction, t_max, [&](unsigned int k, float& t) {
+			uint3 const& tri = connectivity.data[k];
+			intersection_structure const inter = intersection_ray_triangle(ray_origin, ray_direction, position.data[tri[0]], position.data[tri[1]], position.data[tri[2]]);
+			return inter.valid && inter.t<t;
+		}, true);
+	}
+
+	intersection_structure intersection_ray_spheres_closest(bvh const& tree, buffer<vec3> const& centers, float radius, vec3 const& ray_origin, vec3 const& ray_direction, int* shape_index)
+	{
+		intersection_structure closest;
+		int index_closest = 0; // same convention than the linear version
+		float t_max = std::numeric_limits<float>::max();
+		bvh_traverse(tree, ray_origin, ray_direction, t_max, [&](unsigned int k, float& t) {
+			intersection_structure const inter = intersection_ray_sphere(ray_origin, ray_direction, centers.data[k], radius);
+			if(inter.valid && inter.t<t) {
+				t = inter.t;
+				closest = inter;
+				index_closest = int(k);
+				return true;
+			}
+			return false;
+		});
+
+		if(shape_index!=nullptr)
+			*shape_index = index_closest;
+		return closest;
+	}
+
+	bool intersection_ray_spheres_any(bvh const& tree, buffer<vec3> const& centers, float radius, vec3 const& ray_origin, vec3 const& ray_direction, float t_max)
+	{
+		return bvh_traverse(tree, ray_origin, ray_direction, t_max, [&](unsigned int k, float& t) {
+			intersection_structure const inter = intersection_ray_sphere(ray_origin, ray_direction, centers.data[k], radius);
+			return inter.valid && inter.t<t;
+		}, true);
+	}
+}
@@ -0,0 +1,148 @@
+#pragma once
+
+#include "vcl/containers/containers.hpp"
+#include "vcl/shape/intersection/intersection.hpp"
+
+namespace vcl
+{
+	/** Node of the binary hierarchy (leaf if count>0) */
+	struct bvh_node
+	{
+		vec3 box_min;
+		vec3 box_max;
+		unsigned int first = 0; // leaf: first element in bvh.primitive_index
+		unsigned int count = 0; // leaf: number of primitives
+		unsigned int left = 0;  // internal node: children
+		unsigned int right = 0;
+	};
+
+	/** 4-wide node used for traversal: the boxes of the 4 children are stored per coordinate to be tested at once */
+	struct bvh_node4
+	{
+		float box_min_x[4], box_min_y[4], box_min_z[4];
+		float box_max_x[4], box_max_y[4], box_max_z[4];
+		int child[4];            // >=0: index of a bvh_node4, <0: leaf given by the binary node -(child+1)
+		unsigned int source[4];  // binary node corresponding to each child (used to refit)
+		unsigned int child_count = 0;
+	};
+
+	/** Bounding Volume Hierarchy over a set of primitives given by their bounding boxes
+	* - built from binned Surface Area Heuristic (the top levels are built in parallel)
+	* - traversed as a 4-wide tree (4 boxes tested at once using SSE when available) */
+	struct bvh
+	{
+		buffer<bvh_node> nodes;          // binary tree, the root is nodes[0], children are always stored after their parent
+		buffer<bvh_node4> nodes4;        // collapsed 4-wide tree used for traversal, the root is nodes4[0]
+		buffer<unsigned int> primitive_index; // primitives referenced by the leaves
+
+		size_t primitive_count() const;
+	};
+
+	struct bvh_parameters
+	{
+		size_t bin_count = 16;     // bins per axis for the SAH evaluation (at most 64)
+		size_t max_leaf_size = 4;  // a leaf is always split above this size
+		bool parallel = true;
+	};
+
+	/** Build the hierarchy from the bounding box of each primitive */
+	bvh bvh_build(buffer<vec3> const& box_min, buffer<vec3> const& box_max, bvh_parameters const& parameters=bvh_parameters());
+	bvh bvh_build_triangles(buffer<vec3> const& position, buffer<uint3> const& connectivity, bvh_parameters const& parameters=bvh_parameters());
+	bvh bvh_build_spheres(buffer<vec3> const& center, float radius, bvh_parameters const& parameters=bvh_parameters());
+
+	/** Update the boxes of the hierarchy after a deformation of the primitives (the topology of the tree is kept) */
+	void bvh_refit(bvh& tree, buffer<vec3> const& box_min, buffer<vec3> const& box_max);
+	void bvh_refit_triangles(bvh& tree, buffer<vec3> const& position, buffer<uint3> const& connectivity);
+	void bvh_refit_spheres(bvh& tree, buffer<vec3> const& center, float radius);
+
+
+	/** Closest intersection between a ray and a triangle mesh
+	* @triangle_index: (optional) index of the intersected triangle */
+	intersection_structure intersection_ray_mesh_closest(bvh const& tree, buffer<vec3> const& position, buffer<uint3> const& connectivity, vec3 const& ray_origin, vec3 const& ray_direction, int* triangle_index=nullptr);
+	/** Return true if the ray intersects a triangle for 0<t<t_max (shadow ray) */
+	bool intersection_ray_mesh_any(bvh const& tree, buffer<vec3> const& position, buffer<uint3> const& connectivity, vec3 const& ray_origin, vec3 const& ray_direction, float t_max=1e30f);
+
+	/** Closest intersection between a ray and a set of spheres (ray_direction is expected to be normalized) */
+	intersection_structure intersection_ray_spheres_closest(bvh const& tree, buffer<vec3> const& sphere_centers, float sphere_radius, vec3 const& ray_origin, vec3 const& ray_direction, int* shape_index=nullptr);
+	bool intersection_ray_spheres_any(bvh const& tree, buffer<vec3> const& sphere_centers, float sphere_radius, vec3 const& ray_origin, vec3 const& ray_direction, float t_max=1e30f);
+
+
+	/** Generic traversal of the hierarchy along a ray
+	* @intersect_primitive: function (unsigned int primitive, float& t_max) -> bool
+	*    returns true if the primitive is intersected for t<t_max, and updates t_max to the intersection parameter
+	* @any_hit: stops at the first intersection found
+	* Returns true if at least one primitive has been intersected (t_max contains then the closest intersection) */
+	template <typename F>
+	bool bvh_traverse(bvh const& tree, vec3 const& ray_origin, vec3 const& ray_direction, float& t_max, F const& intersect_primitive, bool any_hit=false);
+
+	/** Intersect the ray with the (up to) 4 boxes of the node for t in [0,t_max]
+	* Returns a bit mask of the intersected children, and fill t_near with the entry parameter of each box */
+	unsigned int bvh_intersect_node4(bvh_node4 const& node, vec3 const& ray_origin, vec3 const& ray_direction_inverse, float t_max, float t_near[4]);
+}
+
+
+namespace vcl
+{
+	template <typename F>
+	bool bvh_traverse(bvh const& tree, vec3 const& ray_origin, vec3 const& ray_direction, float& t_max, F const& intersect_primitive, bool any_hit)
+	{
+		if(tree.nodes4.size()==0)
+			return false;
+
+		vec3 const inv_dir = { 1.0f/ray_direction.x, 1.0f/ray_direction.y, 1.0f/ray_direction.z };
+
+		// Stack of nodes to visit with their entry parameter
+		int stack_node[256];
+		float stack_t[256];
+		int stack_size = 0;
+		stack_node[stack_size] = 0;
+		stack_t[stack_size] = 0.0f;
+		stack_size++;
+
+		bool hit = false;
+		while(stack_size>0)
+		{
+			stack_size--;
+			if(stack_t[stack_size]>t_max) // a closer intersection has been found since the node was pushed
+				continue;
+			int const child = stack_node[stack_size];
+
+			if(child<0) { // leaf
+				bvh_node const& leaf = tree.nodes.data[size_t(-(child+1))];
+				for(unsigned int k=leaf.first; k<leaf.first+leaf.count; ++k) {
+					if(intersect_primitive(tree.primitive_index.data[k], t_max)) {
+						hit = true;
+						if(any_hit)
+							return true;
+					}
+				}
+				continue;
+			}
+
+			bvh_node4 const& node = tree.nodes4.data[size_t(child)];
+			float t_near[4];
+			unsigned int const mask = bvh_intersect_node4(node, ray_origin, inv_dir, t_max, t_near);
+
+			// Push the intersected children from the farthest to the closest (the closest is visited first)
+			int order[4];
+			int N_hit = 0;
+			for(int k=0; k<4; ++k) {
+				if(mask & (1u<<k)) {
+					int j = N_hit++;
+					while(j>0 && t_near[order[j-1]]<t_near[k]) {
+						order[j] = order[j-1];
+						--j;
+					}
+					order[j] = k;
+				}
+			}
+			assert_vcl(stack_size+N_hit<=256, "BVH traversal stack overflow");
+			for(int k=0; k<N_hit; ++k) {
+				stack_node[stack_size] = node.child[order[k]];
+				stack_t[stack_size] = t_near[order[k]];
+				stack_size++;
+			}
+		}
+		return hit;
+	}
+}
@@ -0,0 +1,165 @@
+#include "test_bvh.hpp"
+
+#include "vcl/base/base.hpp"
+#include "../bvh.hpp"
+#include "../../mesh/primitive/mesh_primitive.hpp"
+
+#include <chrono>
+#include <iostream>
+#include <limits>
+
+using namespace vcl;
+
+namespace vcl_test
+{
+	// Reference: closest triangle by linear scan
+	static intersection_structure intersection_ray_mesh_linear(buffer<vec3> const& position, buffer<uint3> const& connectivity, vec3 const& p, vec3 const& d, int* index)
+	{
+		intersection_structure closest;
+		closest.t = std::numeric_limits<float>::max();
+		for(size_t k=0; k<connectivity.size(); ++k) {
+			uint3 const& tri = connectivity[k];
+			intersection_structure const inter = intersection_ray_triangle(p, d, position[tri[0]], position[tri[1]], position[tri[2]]);
+			if(inter.valid && inter.t<closest.t) {
+				closest = inter;
+				*index = int(k);
+			}
+		}
+		return closest;
+	}
+
+	static void random_ray(vec3& p, vec3& d)
+	{
+		p = { rand_interval(-3,3), rand_interval(-3,3), rand_interval(-3,3) };
+		d = normalize(vec3(rand_interval(-1,1), rand_interval(-1,1), rand_interval(-1,1)) - p/6.0f);
+	}
+
+	void test_bvh()
+	{
+		// Ray-triangle
+		{
+			intersection_structure const inter = intersection_ray_triangle({0.25f,0.25f,1.0f}, {0,0,-1}, {0,0,0}, {1,0,0}, {0,1,0});
+			assert_vcl_no_msg(inter.valid);
+			assert_vcl_no_msg(is_equal(inter.t, 1.0f));
+			assert_vcl_no_msg(is_equal(inter.normal, vec3(0,0,1)));
+			assert_vcl_no_msg(!intersection_ray_triangle({1.0f,1.0f,1.0f}, {0,0,-1}, {0,0,0}, {1,0,0}, {0,1,0}).valid);
+		}
+
+		// Triangle mesh: same result than the linear scan, before and after refit
+		{
+			mesh shape = mesh_primitive_torus(1.0f, 0.3f, {0,0,0}, {0,0,1}, 60, 20);
+			bvh tree = bvh_build_triangles(shape.position, shape.connectivity);
+			assert_vcl_no_msg(tree.primitive_count()==shape.connectivity.size());
+
+			for(int pass=0; pass<2; ++pass)
+			{
+				for(int k_ray=0; k_ray<500; ++k_ray)
+				{
+					vec3 p, d;
+					random_ray(p, d);
+
+					int index_linear = -1, index_bvh = -1;
+					intersection_structure const ref = intersection_ray_mesh_linear(shape.position, shape.connectivity, p, d, &index_linear);
+					intersection_structure const inter = intersection_ray_mesh_closest(tree, shape.position, shape.connectivity, p, d, &index_bvh);
+
+					assert_vcl_no_msg(ref.valid==inter.valid);
+					assert_vcl_no_msg(ref.valid==intersection_ray_mesh_any(tree, shape.position, shape.connectivity, p, d));
+					if(ref.valid)
+						assert_vcl_no_msg(is_equal(ref.t, inter.t));
+				}
+
+				// Deform the shape and refit the hierarchy
+				for(auto& p : shape.position)
+					p = p + vec3(0.0f, 0.0f, 0.5f*std::sin(3*p.x));
+				bvh_refit_triangles(tree, shape.position, shape.connectivity);
+			}
+		}
+
+		// Spheres: same result than the linear version
+		{
+			buffer<vec3> centers(2000);
+			for(auto& c : centers)
+				c = { rand_interval(-2,2), rand_interval(-2,2), rand_interval(-2,2) };
+			float const r = 0.05f;
+			bvh const tree = bvh_build_spheres(centers, r);
+
+			for(int k_ray=0; k_ray<500; ++k_ray)
+			{
+				vec3 p, d;
+				random_ray(p, d);
+
+				int index_linear = -1, index_bvh = -1;
+				intersection_structure const ref = intersection_ray_spheres_closest(p, d, centers, r, &index_linear);
+				intersection_structure const inter = intersection_ray_spheres_closest(tree, centers, r, p, d, &index_bvh);
+				assert_vcl_no_msg(ref.valid==inter.valid);
+				assert_vcl_no_msg(ref.valid==intersection_ray_spheres_any(tree, centers, r, p, d));
+				if(ref.valid) {
+					assert_vcl_no_msg(index_linear==index_bvh);
+					assert_vcl_no_msg(is_equal(ref.t, inter.t));
+				}
+			}
+		}
+	}
+
+	void benchmark_bvh()
+	{
+		using clock = std::chrono::steady_clock;
+		auto seconds = [](clock::time_point t0) { return std::chrono::duration<double>(clock::now()-t0).count(); };
+
+		size_t const N_ray = 2000;
+		buffer<vec3> ray_p(N_ray), ray_d(N_ray);
+		for(size_t k=0; k<N_ray; ++k)
+			random_ray(ray_p[k], ray_d[k]);
+
+		// Triangles
+		{
+			mesh const shape = mesh_primitive_sphere(1.0f, {0,0,0}, 200, 100);
+
+			clock::time_point t0 = clock::now();
+			bvh const tree = bvh_build_triangles(shape.position, shape.connectivity);
+			double const t_build = seconds(t0);
+
+			int index = 0, hit_linear = 0, hit_bvh = 0;
+			t0 = clock::now();
+			for(size_t k=0; k<N_ray; ++k)
+				hit_linear += intersection_ray_mesh_linear(shape.position, shape.connectivity, ray_p[k], ray_d[k], &index).valid;
+			double const t_linear = seconds(t0);
+
+			t0 = clock::now();
+			for(size_t k=0; k<N_ray; ++k)
+				hit_bvh += intersection_ray_mesh_closest(tree, shape.position, shape.connectivity, ray_p[k], ray_d[k]).valid;
+			double const t_bvh = seconds(t0);
+
+			std::cout << "Triangles: " << shape.connectivity.size() << " (build " << t_build*1000 << " ms, " << tree.nodes.size() << " nodes)" << std::endl;
+			std::cout << "  Linear: " << N_ray/t_linear << " rays/s (" << hit_linear << " hits)" << std::endl;
+			std::cout << "  BVH:    " << N_ray/t_bvh << " rays/s (" << hit_bvh << " hits)" << std::endl;
+		}
+
+		// Spheres
+		{
+			buffer<vec3> centers(100000);
+			for(auto& c : centers)
+				c = { rand_interval(-2,2), rand_interval(-2,2), rand_interval(-2,2) };
+			float const r = 0.01f;
+
+			clock::time_point t0 = clock::now();
+			bvh const tree = bvh_build_spheres(centers, r);
+			double const t_build = seconds(t0);
+
+			int hit_linear = 0, hit_bvh = 0;
+			t0 = clock::now();
+			for(size_t k=0; k<N_ray; ++k)
+				hit_linear += intersection_ray_spheres_closest(ray_p[k], ray_d[k], centers, r).valid;
+			double const t_linear = seconds(t0);
+
+			t0 = clock::now();
+			for(size_t k=0; k<N_ray; ++k)
+				hit_bvh += intersection_ray_spheres_closest(tree, centers, r, ray_p[k], ray_d[k]).valid;
+			double const t_bvh = seconds(t0);
+
+			std::cout << "Spheres: " << centers.size() << " (build " << t_build*1000 << " ms, " << tree.nodes.size() << " nodes)" << std::endl;
+			std::cout << "  Linear: " << N_ray/t_linear << " rays/s (" << hit_linear << " hits)" << std::endl;
+			std::cout << "  BVH:    " << N_ray/t_bvh << " rays/s (" << hit_bvh << " hits)" << std::endl;
+		}
+	}
+}
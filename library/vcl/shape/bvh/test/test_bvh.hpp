@@ -0,0 +1,9 @@
+#pragma once
+
+namespace vcl_test
+{
+	void test_bvh();
+
+	/** Compare the number of rays/s between the linear intersection and the BVH (spheres and triangle mesh) */
+	void benchmark_bvh();
+}
@@ -24,6 +24,7 @@ namespace vcl
                 inter.valid = true;
                 inter.position = p_ray + t*d_ray;
                 inter.normal = normalize(inter.position - center);
+                inter.t = t;
             }
         }
 
@@ -44,7 +45,7 @@ namespace vcl
             intersection_structure const inter = intersection_ray_sphere(p_ray, d_ray, c, radius);
             if (inter.valid)
             {
-                float const t = norm(inter.position - p_ray);
+                float const t = inter.t;
                 if (first || t_closest > t)
                 {
                     first=false;
@@ -60,4 +61,37 @@ namespace vcl
         return intersection_closest;
         
     }
+
+    intersection_structure intersection_ray_triangle(vec3 const& p_ray, vec3 const& d_ray, vec3 const& p0, vec3 const& p1, vec3 const& p2)
+    {
+        intersection_structure inter;
+
+        vec3 const e1 = p1-p0;
+        vec3 const e2 = p2-p0;
+        vec3 const h = cross(d_ray, e2);
+        float const a = dot(e1, h);
+        if(std::abs(a)<1e-12f) // ray parallel to the triangle
+            return inter;
+
+        float const f = 1.0f/a;
+        vec3 const s = p_ray-p0;
+        float const u = f*dot(s, h);
+        if(u<0.0f || u>1.0f)
+            return inter;
+
+        vec3 const q = cross(s, e1);
+        float const v = f*dot(d_ray, q);
+        if(v<0.0f || u+v>1.0f)
+            return inter;
+
+        float const t = f*dot(e2, q);
+        if(t>0.0f) {
+            inter.valid = true;
+            inter.t = t;
+            inter.position = p_ray + t*d_ray;
+            vec3 const n = normalize(cross(e1,e2));
+            inter.normal = dot(n,d_ray)<0? n : -n;
+        }
+        return inter;
+    }
 }
\ No newline at end of file
@@ -9,9 +9,14 @@ namespace vcl
 		bool valid = false;
 		vec3 position = {0,0,0}; // position
 		vec3 normal   = {0,0,1}; // normal
+		float t = 0.0f;            // parameter along the ray: position = ray_origin + t*ray_direction
 	};
 
 	intersection_structure intersection_ray_sphere(vec3 const& ray_origin, vec3 const& ray_direction, vec3 const& sphere_center, float sphere_radius);
 
+	/** Intersection between a ray and a triangle (both faces) - Moller-Trumbore algorithm
+	* The normal is the geometric normal of the triangle oriented toward the ray origin */
+	intersection_structure intersection_ray_triangle(vec3 const& ray_origin, vec3 const& ray_direction, vec3 const& p0, vec3 const& p1, vec3 const& p2);
+
 	intersection_structure intersection_ray_spheres_closest(vec3 const& ray_origin, vec3 const& ray_direction, buffer<vec3> const& sphere_centers, float sphere_radius, int* shape_index=nullptr );
 }
\ No newline at end of file
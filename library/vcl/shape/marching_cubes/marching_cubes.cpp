@@ -0,0 +1,466 @@
+#include "marching_cubes.hpp"
+
+#include "vcl/base/base.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <unordered_map>
+#include <vector>
+
+namespace vcl
+{
+	namespace
+	{
+		// The corner c of a cell is at the offset (c&1, (c>>1)&1, (c>>2)&1) from its first sample.
+		// The edge e is along the axis e/4, and goes from its corner [0] to its corner [1].
+		int const mc_edge_corner[12][2] = {
+			{0,1}, {2,3}, {4,5}, {6,7}, // along x
+			{0,2}, {1,3}, {4,6}, {5,7}, // along y
+			{0,4}, {1,5}, {2,6}, {3,7}  // along z
+		};
+
+		struct mc_case {
+			unsigned int triangle_count = 0;
+			unsigned char edge[36];
+		};
+
+		struct mc_table {
+			mc_case cases[256];
+		};
+
+		int mc_edge_from_corners(int a, int b)
+		{
+			for(int e=0; e<12; ++e)
+				if( (mc_edge_corner[e][0]==a && mc_edge_corner[e][1]==b) || (mc_edge_corner[e][0]==b && mc_edge_corner[e][1]==a) )
+					return e;
+			return -1;
+		}
+
+		bool mc_edges_on_same_face(int const face[6][4], int e0, int e1)
+		{
+			for(int f=0; f<6; ++f) {
+				int count = 0;
+				for(int k=0; k<4; ++k)
+					for(int e : {e0, e1})
+						for(int corner : mc_edge_corner[e])
+							count += (face[f][k]==corner);
+				if(count==4)
+					return true;
+			}
+			return false;
+		}
+
+		// Build the triangulation of the 256 configurations of a cell.
+		// On each face, the contour segments separate the inside corners from the outside ones
+		//  (two inside corners on the diagonal of a face are always separated: the choice only depends on the face, which keeps the surface watertight between cells).
+		// The segments are then chained into closed polygons that are triangulated as fans.
+		mc_table mc_build_table()
+		{
+			// Corners of each face given in cyclic order, and outward normal of the face
+			int face[6][4] = {
+				{0,2,6,4}, {1,3,7,5},
+				{0,1,5,4}, {2,3,7,6},
+				{0,1,3,2}, {4,5,7,6}
+			};
+			int const face_normal[6][3] = { {-1,0,0}, {1,0,0}, {0,-1,0}, {0,1,0}, {0,0,-1}, {0,0,1} };
+
+			// Orient the faces counter-clockwise when seen from the outside of the cell
+			for(int f=0; f<6; ++f) {
+				int p[3][3];
+				for(int k=0; k<3; ++k)
+					for(int d=0; d<3; ++d)
+						p[k][d] = (face[f][k]>>d)&1;
+				int const u[3] = { p[1][0]-p[0][0], p[1][1]-p[0][1], p[1][2]-p[0][2] };
+				int const v[3] = { p[2][0]-p[1][0], p[2][1]-p[1][1], p[2][2]-p[1][2] };
+				int const n[3] = { u[1]*v[2]-u[2]*v[1], u[2]*v[0]-u[0]*v[2], u[0]*v[1]-u[1]*v[0] };
+				if(n[0]*face_normal[f][0]+n[1]*face_normal[f][1]+n[2]*face_normal[f][2]<0)
+					std::swap(face[f][1], face[f][3]);
+			}
+
+			mc_table table;
+			for(int config=0; config<256; ++config)
+			{
+				auto inside = [config](int corner) { return ((config>>corner)&1)==1; };
+
+				// next[e]: edge following e along the contour
+				int next[12];
+				std::fill(next, next+12, -1);
+				for(int f=0; f<6; ++f) {
+					int const* v = face[f];
+					for(int i=0; i<4; ++i) {
+						if(inside(v[i]) && !inside(v[(i+1)%4])) {
+							// Segment from the exit of the run of inside corners ending at v[i] to its entry
+							int j = (i+3)%4;
+							while(inside(v[j]))
+								j = (j+3)%4;
+							next[mc_edge_from_corners(v[i],v[(i+1)%4])] = mc_edge_from_corners(v[j],v[(j+1)%4]);
+						}
+					}
+				}
+
+				mc_case& c = table.cases[config];
+				bool used[12] = {false};
+				for(int e0=0; e0<12; ++e0) {
+					if(next[e0]==-1 || used[e0])
+						continue;
+					int polygon[12];
+					int N = 0;
+					for(int e=e0; !used[e]; e=next[e]) {
+						used[e] = true;
+						polygon[N++] = e;
+					}
+
+					// Start the fan from a vertex whose diagonals cross the cell: a diagonal lying on a face could be duplicated by the neighboring cell
+					int start = 0;
+					for(int s0=0; s0<N; ++s0) {
+						bool valid = true;
+						for(int k=2; k+1<N && valid; ++k)
+							valid = !mc_edges_on_same_face(face, polygon[s0], polygon[(s0+k)%N]);
+						if(valid) {
+							start = s0;
+							break;
+						}
+					}
+					for(int k=1; k+1<N; ++k) {
+						assert_vcl_no_msg(c.triangle_count<12);
+						c.edge[3*c.triangle_count+0] = static_cast<unsigned char>(polygon[start]);
+						c.edge[3*c.triangle_count+1] = static_cast<unsigned char>(polygon[(start+k+1)%N]);
+						c.edge[3*c.triangle_count+2] = static_cast<unsigned char>(polygon[(start+k)%N]);
+						c.triangle_count++;
+					}
+				}
+			}
+			return table;
+		}
+
+		mc_table const& mc_get_table()
+		{
+			static mc_table const table = mc_build_table();
+			return table;
+		}
+
+		unsigned int const mc_no_vertex = ~0u;
+
+		// Access to the sampled field
+		struct mc_field {
+			float const* value;
+			size_t Nx, Ny, Nz;
+			vec3 p_min;
+			vec3 step;
+			float isovalue;
+			bool compute_normal;
+
+			float operator()(size_t i, size_t j, size_t k) const { return value[i+Nx*(j+Ny*k)]; }
+
+			vec3 gradient(size_t i, size_t j, size_t k) const {
+				size_t const i0 = i>0? i-1 : i, i1 = i+1<Nx? i+1 : i;
+				size_t const j0 = j>0? j-1 : j, j1 = j+1<Ny? j+1 : j;
+				size_t const k0 = k>0? k-1 : k, k1 = k+1<Nz? k+1 : k;
+				return { ((*this)(i1,j,k)-(*this)(i0,j,k))/((i1-i0)*step.x),
+				         ((*this)(i,j1,k)-(*this)(i,j0,k))/((j1-j0)*step.y),
+				         ((*this)(i,j,k1)-(*this)(i,j,k0))/((k1-k0)*step.z) };
+			}
+		};
+
+		// Surface extracted from a box of cells
+		struct mc_box_output {
+			buffer<vec3> position;
+			buffer<vec3> normal;
+			buffer<uint64_t> edge_key;
+			buffer<uint3> connectivity;
+			size_t last_layer_first_vertex = 0; // the vertices of the last layer (along z) are stored at the end
+		};
+	}
+
+	// Extract the cells in [c0,c1) (cell (i,j,k) spans the samples (i,j,k) to (i+1,j+1,k+1))
+	// The vertices are created layer by layer along z: [x and y edges of layer k] [z edges between k and k+1] [x and y edges of layer k+1] ...
+	//  two boxes sharing a layer create therefore the vertices of this layer in the same order.
+	static void marching_cubes_box(mc_field const& F, size_t3 const& c0, size_t3 const& c1, bool store_key, mc_box_output& out)
+	{
+		mc_table const& table = mc_get_table();
+		size_t const nx = c1.x-c0.x+1; // number of samples along x and y in the box
+		size_t const ny = c1.y-c0.y+1;
+
+		std::vector<unsigned char> inside[2] = { std::vector<unsigned char>(nx*ny), std::vector<unsigned char>(nx*ny) };
+		std::vector<unsigned int> edge_x[2] = { std::vector<unsigned int>((nx-1)*ny), std::vector<unsigned int>((nx-1)*ny) };
+		std::vector<unsigned int> edge_y[2] = { std::vector<unsigned int>(nx*(ny-1)), std::vector<unsigned int>(nx*(ny-1)) };
+		std::vector<unsigned int> edge_z(nx*ny);
+
+		auto add_vertex = [&](size_t i, size_t j, size_t k, int axis) -> unsigned int
+		{
+			size_t const i1 = i+(axis==0), j1 = j+(axis==1), k1 = k+(axis==2);
+			float const f0 = F(i,j,k), f1 = F(i1,j1,k1);
+			float const t = std::min(1.0f, std::max(0.0f, (F.isovalue-f0)/(f1-f0)));
+
+			vec3 const p0 = F.p_min + vec3(i*F.step.x, j*F.step.y, k*F.step.z);
+			vec3 const p1 = F.p_min + vec3(i1*F.step.x, j1*F.step.y, k1*F.step.z);
+			out.position.push_back( (1-t)*p0 + t*p1 );
+
+			if(F.compute_normal) {
+				vec3 const n = (1-t)*F.gradient(i,j,k) + t*F.gradient(i1,j1,k1);
+				float const n_norm = norm(n);
+				out.normal.push_back( n_norm>1e-12f? n/n_norm : vec3(0,0,1) );
+			}
+			if(store_key) {
+				// The edge is on the boundary of the box if it lies in one of its faces
+				bool const boundary = (axis!=0 && (i==c0.x || i==c1.x)) || (axis!=1 && (j==c0.y || j==c1.y)) || (axis!=2 && (k==c0.z || k==c1.z));
+				uint64_t const edge = 3*uint64_t(i+F.Nx*(j+F.Ny*k)) + uint64_t(axis);
+				out.edge_key.push_back( (edge<<1) | uint64_t(boundary) );
+			}
+			return static_cast<unsigned int>(out.position.size()-1);
+		};
+
+		auto classify_layer = [&](size_t k, std::vector<unsigned char>& layer_inside) {
+			for(size_t j=0; j<ny; ++j)
+				for(size_t i=0; i<nx; ++i)
+					layer_inside[i+nx*j] = F(c0.x+i, c0.y+j, k)<F.isovalue;
+		};
+		auto build_layer_edges = [&](size_t k, int L) {
+			for(size_t j=0; j<ny; ++j)
+				for(size_t i=0; i+1<nx; ++i)
+					edge_x[L][i+(nx-1)*j] = inside[L][i+nx*j]!=inside[L][i+1+nx*j]? add_vertex(c0.x+i, c0.y+j, k, 0) : mc_no_vertex;
+			for(size_t j=0; j+1<ny; ++j)
+				for(size_t i=0; i<nx; ++i)
+					edge_y[L][i+nx*j] = inside[L][i+nx*j]!=inside[L][i+nx*(j+1)]? add_vertex(c0.x+i, c0.y+j, k, 1) : mc_no_vertex;
+		};
+
+		classify_layer(c0.z, inside[0]);
+		build_layer_edges(c0.z, 0);
+		for(size_t k=c0.z; k<c1.z; ++k)
+		{
+			int const L0 = (k-c0.z)&1;
+			int const L1 = L0^1;
+
+			classify_layer(k+1, inside[L1]);
+			for(size_t j=0; j<ny; ++j)
+				for(size_t i=0; i<nx; ++i)
+					edge_z[i+nx*j] = inside[L0][i+nx*j]!=inside[L1][i+nx*j]? add_vertex(c0.x+i, c0.y+j, k, 2) : mc_no_vertex;
+			if(k+1==c1.z)
+				out.last_layer_first_vertex = out.position.size();
+			build_layer_edges(k+1, L1);
+
+			// Triangulate the cells of the layer
+			for(size_t j=0; j+1<ny; ++j)
+			{
+				for(size_t i=0; i+1<nx; ++i)
+				{
+					int config = 0;
+					for(int c=0; c<8; ++c) {
+						int const L = (c&4)? L1 : L0;
+						config |= inside[L][(i+(c&1))+nx*(j+((c>>1)&1))] << c;
+					}
+					mc_case const& cell = table.cases[config];
+					if(cell.triangle_count==0)
+						continue;
+
+					unsigned int vertex[12];
+					for(int e=0; e<12; ++e) {
+						int const corner = mc_edge_corner[e][0];
+						size_t const ic = i+(corner&1), jc = j+((corner>>1)&1);
+						int const L = (corner&4)? L1 : L0;
+						switch(e/4) {
+						case 0: vertex[e] = edge_x[L][ic+(nx-1)*jc]; break;
+						case 1: vertex[e] = edge_y[L][ic+nx*jc]; break;
+						default: vertex[e] = edge_z[ic+nx*jc]; break;
+						}
+					}
+					for(unsigned int t=0; t<cell.triangle_count; ++t)
+						out.connectivity.push_back({ vertex[cell.edge[3*t]], vertex[cell.edge[3*t+1]], vertex[cell.edge[3*t+2]] });
+				}
+			}
+		}
+	}
+
+	static mc_field marching_cubes_field(grid_3D<float> const& field, marching_cubes_parameters const& parameters)
+	{
+		mc_field F;
+		F.value = field.data.data.data();
+		F.Nx = field.dimension.x;
+		F.Ny = field.dimension.y;
+		F.Nz = field.dimension.z;
+		F.p_min = parameters.p_min;
+		vec3 const d = parameters.p_max-parameters.p_min;
+		F.step = { d.x/(F.Nx-1), d.y/(F.Ny-1), d.z/(F.Nz-1) };
+		F.isovalue = parameters.isovalue;
+		F.compute_normal = parameters.compute_normal;
+		return F;
+	}
+
+	mesh marching_cubes(grid_3D<float> const& field, marching_cubes_parameters const& parameters)
+	{
+		mesh m;
+		size_t3 const N = field.dimension;
+		if(N.x<2 || N.y<2 || N.z<2)
+			return m;
+		mc_field const F = marching_cubes_field(field, parameters);
+
+		// Each slab extracts its layers of cells independently.
+		// The last layer of vertices of a slab is the first one of the next slab: these vertices are kept from the next slab.
+		size_t const N_slab = parameters.parallel? parallel_range_count(N.z-1, 8) : 1;
+		std::vector<mc_box_output> slabs(N_slab);
+		parallel_for(N_slab, [&](size_t s) {
+			size_t z_begin=0, z_end=0;
+			parallel_range_bounds(N.z-1, N_slab, s, z_begin, z_end);
+			marching_cubes_box(F, {0,0,z_begin}, {N.x-1,N.y-1,z_end}, false, slabs[s]);
+		}, 1);
+
+		// Merge: prefix sum over the vertices and triangles of each slab
+		std::vector<size_t> vertex_offset(N_slab+1, 0), triangle_offset(N_slab+1, 0);
+		for(size_t s=0; s<N_slab; ++s) {
+			size_t const N_vertex_own = s+1<N_slab? slabs[s].last_layer_first_vertex : slabs[s].position.size();
+			vertex_offset[s+1] = vertex_offset[s] + N_vertex_own;
+			triangle_offset[s+1] = triangle_offset[s] + slabs[s].connectivity.size();
+		}
+
+		m.position.resize(vertex_offset[N_slab]);
+		if(parameters.compute_normal)
+			m.normal.resize(vertex_offset[N_slab]);
+		m.connectivity.resize(triangle_offset[N_slab]);
+
+		parallel_for(N_slab, [&](size_t s) {
+			mc_box_output const& slab = slabs[s];
+			size_t const N_vertex_own = vertex_offset[s+1]-vertex_offset[s];
+			std::copy(slab.position.data.begin(), slab.position.data.begin()+N_vertex_own, m.position.data.begin()+vertex_offset[s]);
+			if(parameters.compute_normal)
+				std::copy(slab.normal.data.begin(), slab.normal.data.begin()+N_vertex_own, m.normal.data.begin()+vertex_offset[s]);
+
+			for(size_t t=0; t<slab.connectivity.size(); ++t) {
+				uint3 tri = slab.connectivity.data[t];
+				for(unsigned int& idx : tri)
+					idx = static_cast<unsigned int>( idx<N_vertex_own? vertex_offset[s]+idx : vertex_offset[s+1]+(idx-N_vertex_own) );
+				m.connectivity.data[triangle_offset[s]+t] = tri;
+			}
+		}, 1);
+
+		if(!parameters.compute_normal)
+			m.compute_normal();
+		return m;
+	}
+
+
+	void marching_cubes_incremental::initialize(grid_3D<float> const& field, marching_cubes_parameters const& parameters_arg, size_t block_size_arg)
+	{
+		assert_vcl(block_size_arg>0, "Block size must be positive");
+		parameters = parameters_arg;
+		block_size = block_size_arg;
+		field_dimension = field.dimension;
+
+		size_t3 const N_cell = { field_dimension.x>1? field_dimension.x-1 : 0, field_dimension.y>1? field_dimension.y-1 : 0, field_dimension.z>1? field_dimension.z-1 : 0 };
+		for(size_t k=0; k<3; ++k)
+			block_count[k] = (N_cell[k]+block_size-1)/block_size;
+
+		blocks.clear();
+		blocks.resize(block_count.x*block_count.y*block_count.z);
+		update(field);
+	}
+
+	void marching_cubes_incremental::set_dirty_all()
+	{
+		for(marching_cubes_block& block : blocks)
+			block.dirty = true;
+	}
+
+	void marching_cubes_incremental::set_dirty(int3 const& idx_min, int3 const& idx_max)
+	{
+		if(blocks.size()==0)
+			return;
+
+		// A sample is used by the cells around it, and by the gradient of its neighbors
+		int3 b_min, b_max;
+		for(size_t k=0; k<3; ++k) {
+			int const N_cell = int(field_dimension[k])-1;
+			int const c_min = std::max(0, std::min(idx_min[k], idx_max[k])-2);
+			int const c_max = std::min(N_cell-1, std::max(idx_min[k], idx_max[k])+1);
+			if(c_min>c_max)
+				return;
+			b_min[k] = c_min/int(block_size);
+			b_max[k] = c_max/int(block_size);
+		}
+
+		for(int bz=b_min.z; bz<=b_max.z; ++bz)
+			for(int by=b_min.y; by<=b_max.y; ++by)
+				for(int bx=b_min.x; bx<=b_max.x; ++bx)
+					blocks[offset_grid(size_t(bx), size_t(by), size_t(bz), block_count.x, block_count.y)].dirty = true;
+	}
+
+	size_t marching_cubes_incremental::update(grid_3D<float> const& field)
+	{
+		assert_vcl(is_equal(field.dimension, field_dimension), "The dimension of the field changed since the initialization");
+
+		surface = mesh();
+		if(blocks.size()==0)
+			return 0;
+
+		// Extract the dirty blocks
+		std::vector<size_t> dirty_blocks;
+		for(size_t k=0; k<blocks.size(); ++k)
+			if(blocks[k].dirty)
+				dirty_blocks.push_back(k);
+
+		mc_field const F = marching_cubes_field(field, parameters);
+		size_t3 const N_cell = { field_dimension.x-1, field_dimension.y-1, field_dimension.z-1 };
+		auto extract_block = [&](size_t d) {
+			size_t const b = dirty_blocks[d];
+			size_t3 const block_index = { b%block_count.x, (b/block_count.x)%block_count.y, b/(block_count.x*block_count.y) };
+			size_t3 c0, c1;
+			for(size_t k=0; k<3; ++k) {
+				c0[k] = block_index[k]*block_size;
+				c1[k] = std::min(c0[k]+block_size, N_cell[k]);
+			}
+
+			mc_box_output out;
+			marching_cubes_box(F, c0, c1, true, out);
+			marching_cubes_block& block = blocks[b];
+			block.position = std::move(out.position);
+			block.normal = std::move(out.normal);
+			block.edge_key = std::move(out.edge_key);
+			block.connectivity = std::move(out.connectivity);
+			block.dirty = false;
+		};
+		if(parameters.parallel)
+			parallel_for(dirty_blocks.size(), extract_block, 1);
+		else
+			for(size_t d=0; d<dirty_blocks.size(); ++d)
+				extract_block(d);
+
+		// Assemble the blocks: vertices on the faces of the blocks are shared using their edge
+		size_t N_vertex = 0, N_triangle = 0;
+		for(marching_cubes_block const& block : blocks) {
+			N_vertex += block.position.size();
+			N_triangle += block.connectivity.size();
+		}
+		surface.position.data.reserve(N_vertex);
+		if(parameters.compute_normal)
+			surface.normal.data.reserve(N_vertex);
+		surface.connectivity.data.reserve(N_triangle);
+
+		std::unordered_map<uint64_t, unsigned int> shared_vertex;
+		std::vector<unsigned int> index;
+		for(marching_cubes_block const& block : blocks)
+		{
+			index.resize(block.position.size());
+			for(size_t k=0; k<block.position.size(); ++k)
+			{
+				uint64_t const key = block.edge_key.data[k];
+				if(key&1) {
+					auto const it = shared_vertex.find(key);
+					if(it!=shared_vertex.end()) {
+						index[k] = it->second;
+						continue;
+					}
+					shared_vertex[key] = static_cast<unsigned int>(surface.position.size());
+				}
+				index[k] = static_cast<unsigned int>(surface.position.size());
+				surface.position.push_back(block.position.data[k]);
+				if(parameters.compute_normal)
+					surface.normal.push_back(block.normal.data[k]);
+			}
+			for(uint3 const& tri : block.connectivity)
+				surface.connectivity.push_back({ index[tri[0]], index[tri[1]], index[tri[2]] });
+		}
+
+		if(!parameters.compute_normal)
+			surface.compute_normal();
+		return dirty_blocks.size();
+	}
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include "vcl/containers/containers.hpp"
+#include "vcl/shape/mesh/structure/mesh.hpp"
+
+#include <cstdint>
+
+namespace vcl
+{
+	struct marching_cubes_parameters
+	{
+		float isovalue = 0.0f;
+		vec3 p_min = {0,0,0}; // position of the sample (0,0,0) of the grid
+		vec3 p_max = {1,1,1}; // position of the sample (Nx-1,Ny-1,Nz-1) of the grid
+		bool compute_normal = true; // normals interpolated from the gradient of the field
+		bool parallel = true;
+	};
+
+	/** Extract the isosurface of a scalar field sampled on a regular grid as a triangle mesh (Marching Cubes)
+	* - The inside of the shape is the region where field<isovalue (signed distance convention),
+	*    the triangles and the normals are oriented toward the increasing values of the field.
+	* - Each vertex is shared between all the triangles adjacent to its edge of the grid.
+	* - The grid is split in slabs along z that are extracted in parallel. */
+	mesh marching_cubes(grid_3D<float> const& field, marching_cubes_parameters const& parameters=marching_cubes_parameters());
+
+
+	/** Surface extracted per block of cells */
+	struct marching_cubes_block
+	{
+		buffer<vec3> position;
+		buffer<vec3> normal;
+		buffer<uint64_t> edge_key; // edge of the grid supporting each vertex (used to share the vertices between blocks)
+		buffer<uint3> connectivity;
+		bool dirty = true;
+	};
+
+	/** Incremental extraction of the isosurface of a field edited over time
+	* Only the blocks marked as dirty are extracted again when calling update.
+	* Usage:
+	*   marching_cubes_incremental isosurface;
+	*   isosurface.initialize(field, parameters);
+	*   [edit field in the samples between idx_min and idx_max]
+	*   isosurface.set_dirty(idx_min, idx_max);
+	*   isosurface.update(field); // isosurface.surface contains the updated mesh */
+	struct marching_cubes_incremental
+	{
+		marching_cubes_parameters parameters;
+		size_t block_size = 16; // number of cells per block along each axis
+
+		/** Surface assembled from all the blocks (updated by update()) */
+		mesh surface;
+
+		size_t3 field_dimension = {0,0,0};
+		size_t3 block_count = {0,0,0};
+		buffer<marching_cubes_block> blocks;
+
+		/** Extract the full surface */
+		void initialize(grid_3D<float> const& field, marching_cubes_parameters const& parameters=marching_cubes_parameters(), size_t block_size=16);
+		/** Mark the blocks affected by a modification of the samples in [idx_min,idx_max] (inclusive) */
+		void set_dirty(int3 const& idx_min, int3 const& idx_max);
+		void set_dirty_all();
+		/** Extract the dirty blocks and assemble the surface. Returns the number of blocks extracted. */
+		size_t update(grid_3D<float> const& field);
+	};
+}
@@ -0,0 +1,152 @@
+#include "test_marching_cubes.hpp"
+
+#include "vcl/base/base.hpp"
+#include "../marching_cubes.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <map>
+#include <utility>
+#include <vector>
+
+using namespace vcl;
+
+namespace vcl_test
+{
+	static vec3 sample_position(marching_cubes_parameters const& parameters, size_t3 const& N, size_t i, size_t j, size_t k)
+	{
+		vec3 const d = parameters.p_max-parameters.p_min;
+		return parameters.p_min + vec3{ d.x*i/float(N.x-1), d.y*j/float(N.y-1), d.z*k/float(N.z-1) };
+	}
+
+	// Every edge is shared by exactly two triangles with opposite orientations
+	static bool is_watertight(mesh const& m)
+	{
+		std::map<std::pair<unsigned int,unsigned int>, int> directed_edge;
+		for(uint3 const& tri : m.connectivity)
+			for(size_t k=0; k<3; ++k)
+				directed_edge[{tri[k], tri[(k+1)%3]}]++;
+		for(auto const& edge : directed_edge) {
+			if(edge.second!=1)
+				return false;
+			auto const opposite = directed_edge.find({edge.first.second, edge.first.first});
+			if(opposite==directed_edge.end() || opposite->second!=1)
+				return false;
+		}
+		return true;
+	}
+
+	// Triangles given by their positions, starting at their smallest vertex (the orientation is kept), and sorted
+	static std::vector<std::array<float,9>> sorted_triangles(mesh const& m)
+	{
+		std::vector<std::array<float,9>> triangles;
+		for(uint3 const& tri : m.connectivity) {
+			std::array<float,9> t;
+			for(size_t k=0; k<3; ++k)
+				for(size_t d=0; d<3; ++d)
+					t[3*k+d] = m.position[tri[k]][d];
+			std::array<float,9> best = t;
+			for(size_t r=1; r<3; ++r) {
+				std::array<float,9> rotated;
+				for(size_t k=0; k<9; ++k)
+					rotated[k] = t[(k+3*r)%9];
+				best = std::min(best, rotated);
+			}
+			triangles.push_back(best);
+		}
+		std::sort(triangles.begin(), triangles.end());
+		return triangles;
+	}
+
+	// Exactly the same values
+	template <typename T>
+	static bool same_values(buffer<T> const& a, buffer<T> const& b)
+	{
+		return a.size()==b.size() && (a.size()==0 || std::memcmp(a.data.data(), b.data.data(), a.size()*sizeof(T))==0);
+	}
+	static bool same_mesh(mesh const& a, mesh const& b)
+	{
+		return same_values(a.position, b.position) && same_values(a.normal, b.normal) && same_values(a.connectivity, b.connectivity);
+	}
+
+	void test_marching_cubes()
+	{
+		size_t3 const N = {34, 30, 32};
+		vec3 const center = {0.05f, -0.03f, 0.02f};
+		float const radius = 0.6f;
+
+		marching_cubes_parameters parameters;
+		parameters.p_min = {-1,-1,-1};
+		parameters.p_max = {1,1,1};
+
+		grid_3D<float> field(N);
+		for(size_t k=0; k<N.z; ++k)
+			for(size_t j=0; j<N.y; ++j)
+				for(size_t i=0; i<N.x; ++i)
+					field(i,j,k) = norm(sample_position(parameters, N, i, j, k)-center)-radius;
+
+		// Sphere: closed surface, vertices on the sphere with outward normals
+		mesh const surface = marching_cubes(field, parameters);
+		{
+			assert_vcl_no_msg(surface.connectivity.size()>0);
+			assert_vcl_no_msg(surface.normal.size()==surface.position.size());
+			assert_vcl_no_msg(is_watertight(surface));
+
+			float const h = 2.0f/float(N.y-1); // largest cell size
+			for(size_t k=0; k<surface.position.size(); ++k) {
+				vec3 const& p = surface.position[k];
+				assert_vcl_no_msg(std::abs(norm(p-center)-radius)<0.1f*h);
+				assert_vcl_no_msg(dot(surface.normal[k], normalize(p-center))>0.95f);
+			}
+
+			// Triangles oriented outward: positive enclosed volume
+			float volume = 0.0f;
+			for(uint3 const& tri : surface.connectivity)
+				volume += dot(surface.position[tri[0]]-center, cross(surface.position[tri[1]]-center, surface.position[tri[2]]-center))/6.0f;
+			float const volume_sphere = 4.0f/3.0f*3.14159265f*radius*radius*radius;
+			assert_vcl_no_msg(std::abs(volume-volume_sphere)<0.02f*volume_sphere);
+		}
+
+		// Parallel extraction: same mesh than the sequential one
+		{
+			marching_cubes_parameters parameters_sequential = parameters;
+			parameters_sequential.parallel = false;
+			assert_vcl_no_msg(same_mesh(surface, marching_cubes(field, parameters_sequential)));
+		}
+
+		// Incremental update after an edit of a sub-block: same surface than a full extraction of the edited field
+		{
+			marching_cubes_incremental isosurface;
+			isosurface.initialize(field, parameters, 8);
+			assert_vcl_no_msg(sorted_triangles(isosurface.surface)==sorted_triangles(surface));
+
+			// Union with a small sphere on the surface, limited to the samples in [idx_min,idx_max]
+			vec3 const bump_center = center+vec3{radius,0,0};
+			float const bump_radius = 0.15f;
+			int3 const idx_min = {22, 11, 12};
+			int3 const idx_max = {29, 18, 19};
+			for(int k=idx_min.z; k<=idx_max.z; ++k)
+				for(int j=idx_min.y; j<=idx_max.y; ++j)
+					for(int i=idx_min.x; i<=idx_max.x; ++i) {
+						float const bump = norm(sample_position(parameters, N, size_t(i), size_t(j), size_t(k))-bump_center)-bump_radius;
+						field(i,j,k) = std::min(field(i,j,k), bump);
+					}
+
+			isosurface.set_dirty(idx_min, idx_max);
+			size_t const N_updated = isosurface.update(field);
+			assert_vcl_no_msg(N_updated>0 && N_updated<isosurface.blocks.size());
+			assert_vcl_no_msg(is_watertight(isosurface.surface));
+
+			marching_cubes_incremental reference;
+			reference.initialize(field, parameters, 8);
+			assert_vcl_no_msg(same_mesh(isosurface.surface, reference.surface));
+
+			mesh const full = marching_cubes(field, parameters);
+			assert_vcl_no_msg(isosurface.surface.position.size()==full.position.size());
+			assert_vcl_no_msg(sorted_triangles(isosurface.surface)==sorted_triangles(full));
+			assert_vcl_no_msg(sorted_triangles(full)!=sorted_triangles(surface));
+		}
+	}
+}
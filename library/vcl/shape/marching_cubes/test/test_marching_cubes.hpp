@@ -0,0 +1,8 @@
+#pragma once
+
+namespace vcl_test
+{
+	/** Check the surface extracted from the signed distance of a sphere (watertight, vertices on the sphere),
+	* the parallel extraction against the sequential one, and the incremental update against a full extraction */
+	void test_marching_cubes();
+}
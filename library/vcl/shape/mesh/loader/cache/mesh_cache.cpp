@@ -0,0 +1,210 @@
+#include "mesh_cache.hpp"
+
+#include "vcl/base/base.hpp"
+#include "vcl/files/files.hpp"
+#include "vcl/files/file_system/file_system.hpp"
+#include "../obj/obj.hpp"
+
+#include <cstdint>
+#include <cstring>
+
+namespace vcl
+{
+	namespace
+	{
+		char const mesh_cache_magic[8] = {'V','C','L','M','E','S','H','\0'};
+		uint32_t const mesh_cache_version = 1;
+
+		enum mesh_cache_attribute { cache_position=0, cache_normal, cache_color, cache_uv, cache_connectivity, cache_attribute_count };
+
+		// Header of a .vclmesh file, followed by the attribute arrays (each one aligned on 16 bytes)
+		struct mesh_cache_header {
+			file_cache_header cache;
+			uint64_t vertex_count;
+			uint64_t triangle_count;
+			uint64_t offset[cache_attribute_count]; // 0 if the attribute is not stored
+			uint64_t size[cache_attribute_count];   // in bytes
+		};
+
+		static_assert(sizeof(vec3)==3*sizeof(float) && sizeof(vec2)==2*sizeof(float) && sizeof(uint3)==3*sizeof(unsigned int), "Attributes are expected to be tightly packed");
+
+		uint64_t options_key(mesh_cache_options const& options)
+		{
+			return options.fill_empty_field? 1 : 0;
+		}
+
+		// Header expected for the cache of the source file
+		bool source_key(std::string const& filename, mesh_cache_options const& options, mesh_cache_header& header)
+		{
+			return file_cache_header_set(header.cache, filename, mesh_cache_magic, mesh_cache_version, sizeof(mesh_cache_header), options_key(options));
+		}
+
+		// Check the header of a mapped cache against the source file
+		bool mesh_cache_check(mapped_file const& file, mesh_cache_header const& key, mesh_cache_header& header)
+		{
+			if(file.size<sizeof(mesh_cache_header))
+				return false;
+			std::memcpy(&header, file.data, sizeof(mesh_cache_header));
+			if(!file_cache_header_match(header.cache, key.cache))
+				return false;
+
+			uint64_t const expected_size[cache_attribute_count] = {
+				header.vertex_count*sizeof(vec3), header.vertex_count*sizeof(vec3), header.vertex_count*sizeof(vec3), header.vertex_count*sizeof(vec2), header.triangle_count*sizeof(uint3) };
+			for(int k=0; k<cache_attribute_count; ++k) {
+				if(header.offset[k]==0)
+					continue;
+				if(header.size[k]!=expected_size[k] || header.offset[k]%16!=0 || header.offset[k]+header.size[k]>file.size)
+					return false;
+			}
+			// The empty arrays are not stored: a mesh without faces has no connectivity
+			bool const has_position = header.offset[cache_position]!=0;
+			bool const has_connectivity = header.offset[cache_connectivity]!=0;
+			return has_position==(header.vertex_count>0) && has_connectivity==(header.triangle_count>0);
+		}
+
+		template <typename T>
+		void copy_attribute(mapped_file const& file, mesh_cache_header const& header, int attribute, buffer<T>& data)
+		{
+			data.clear();
+			if(header.offset[attribute]==0)
+				return;
+			data.resize(header.size[attribute]/sizeof(T));
+			std::memcpy(data.data.data(), file.data+header.offset[attribute], header.size[attribute]);
+		}
+
+		template <typename T>
+		T const* attribute_pointer(mapped_file const& file, mesh_cache_header const& header, int attribute)
+		{
+			if(header.offset[attribute]==0)
+				return nullptr;
+			return reinterpret_cast<T const*>(file.data+header.offset[attribute]);
+		}
+	}
+
+	std::string mesh_cache_filename(std::string const& filename, mesh_cache_options const& options)
+	{
+		return file_cache_filename(filename, options.directory, ".vclmesh");
+	}
+
+	bool mesh_cache_read(std::string const& filename, mesh& m, mesh_cache_options const& options)
+	{
+		mesh_cache_header key, header;
+		if(!source_key(filename, options, key))
+			return false;
+
+		mapped_file file;
+		if(!file.open(mesh_cache_filename(filename, options)) || !mesh_cache_check(file, key, header))
+			return false;
+
+		copy_attribute(file, header, cache_position, m.position);
+		copy_attribute(file, header, cache_normal, m.normal);
+		copy_attribute(file, header, cache_color, m.color);
+		copy_attribute(file, header, cache_uv, m.uv);
+		copy_attribute(file, header, cache_connectivity, m.connectivity);
+		return true;
+	}
+
+	bool mesh_cache_open(std::string const& filename, mesh_cache_view& view, mesh_cache_options const& options)
+	{
+		view = mesh_cache_view();
+
+		mesh_cache_header key, header;
+		if(!source_key(filename, options, key))
+			return false;
+		if(!view.file.open(mesh_cache_filename(filename, options)) || !mesh_cache_check(view.file, key, header)) {
+			view.file.close();
+			return false;
+		}
+
+		view.vertex_count = size_t(header.vertex_count);
+		view.triangle_count = size_t(header.triangle_count);
+		view.position = attribute_pointer<vec3>(view.file, header, cache_position);
+		view.normal = attribute_pointer<vec3>(view.file, header, cache_normal);
+		view.color = attribute_pointer<vec3>(view.file, header, cache_color);
+		view.uv = attribute_pointer<vec2>(view.file, header, cache_uv);
+		view.connectivity = attribute_pointer<uint3>(view.file, header, cache_connectivity);
+		return true;
+	}
+
+	bool mesh_cache_write(std::string const& filename, mesh const& m, mesh_cache_options const& options)
+	{
+		mesh_cache_header header;
+		std::memset(&header, 0, sizeof(mesh_cache_header));
+		if(!source_key(filename, options, header))
+			return false;
+		header.vertex_count = m.position.size();
+		header.triangle_count = m.connectivity.size();
+
+		// Layout of the attributes (only the attributes with one value per vertex are stored)
+		void const* data[cache_attribute_count] = {nullptr, nullptr, nullptr, nullptr, nullptr};
+		auto add_attribute = [&](int attribute, void const* ptr, size_t N, size_t element_size, size_t N_expected) {
+			if(N==0 || N!=N_expected)
+				return;
+			data[attribute] = ptr;
+			header.size[attribute] = N*element_size;
+		};
+		add_attribute(cache_position, m.position.data.data(), m.position.size(), sizeof(vec3), m.position.size());
+		add_attribute(cache_normal, m.normal.data.data(), m.normal.size(), sizeof(vec3), m.position.size());
+		add_attribute(cache_color, m.color.data.data(), m.color.size(), sizeof(vec3), m.position.size());
+		add_attribute(cache_uv, m.uv.data.data(), m.uv.size(), sizeof(vec2), m.position.size());
+		add_attribute(cache_connectivity, m.connectivity.data.data(), m.connectivity.size(), sizeof(uint3), m.connectivity.size());
+
+		uint64_t offset = (sizeof(mesh_cache_header)+15)/16*16;
+		for(int k=0; k<cache_attribute_count; ++k) {
+			if(data[k]==nullptr)
+				continue;
+			header.offset[k] = offset;
+			offset = (offset+header.size[k]+15)/16*16;
+		}
+
+		buffer<file_chunk> chunks;
+		chunks.push_back({&header, sizeof(mesh_cache_header), 0});
+		for(int k=0; k<cache_attribute_count; ++k)
+			if(data[k]!=nullptr)
+				chunks.push_back({data[k], size_t(header.size[k]), header.offset[k]});
+
+		if(!options.directory.empty())
+			directory_create(options.directory);
+		return file_write_atomic(mesh_cache_filename(filename, options), chunks);
+	}
+
+	static bool mesh_load_file_obj_options(std::string const& filename, mesh_cache_options const& options, mesh& m, std::string& error)
+	{
+		if(options.fill_empty_field)
+			return mesh_load_file_obj(filename, m, error);
+		obj_vertex_correspondance correspondance;
+		return mesh_load_file_obj(filename, m, correspondance, error);
+	}
+
+	mesh mesh_load_file_obj_cached(std::string const& filename, mesh_cache_options const& options)
+	{
+		mesh m;
+		if(mesh_cache_read(filename, m, options))
+			return m;
+
+		assert_file_exist(filename);
+		std::string error;
+		if(!mesh_load_file_obj_options(filename, options, m, error))
+			error_vcl(error);
+		mesh_cache_write(filename, m, options);
+		return m;
+	}
+
+	mesh_cache_prebake_result mesh_cache_prebake(std::string const& filename, std::string& error, mesh_cache_options const& options)
+	{
+		error.clear();
+		mesh_cache_view view;
+		if(mesh_cache_open(filename, view, options))
+			return mesh_cache_prebake_result::up_to_date;
+		view.file.close();
+
+		mesh m;
+		if(!mesh_load_file_obj_options(filename, options, m, error))
+			return mesh_cache_prebake_result::failed;
+		if(!mesh_cache_write(filename, m, options)) {
+			error = "Cannot write "+mesh_cache_filename(filename, options);
+			return mesh_cache_prebake_result::failed;
+		}
+		return mesh_cache_prebake_result::baked;
+	}
+}
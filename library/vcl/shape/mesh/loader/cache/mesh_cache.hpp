@@ -0,0 +1,55 @@
+#pragma once
+
+#include "../../structure/mesh.hpp"
+#include "vcl/files/mapped_file/mapped_file.hpp"
+
+#include <string>
+
+namespace vcl
+{
+	struct mesh_cache_options
+	{
+		/** Directory storing the cache files (the cache is stored next to the source file if empty) */
+		std::string directory;
+		/** Same loading option than mesh_load_file_obj(filename): fill the empty attributes with default values */
+		bool fill_empty_field = true;
+	};
+
+	/** Load an obj file through its binary cache (.vclmesh)
+	* The cache is used if it matches the path, size and modification time of the file, and the loading options.
+	* Otherwise the obj file is parsed, and the cache is (re)written for the next call. */
+	mesh mesh_load_file_obj_cached(std::string const& filename, mesh_cache_options const& options=mesh_cache_options());
+
+	/** Path of the cache file associated to a mesh file */
+	std::string mesh_cache_filename(std::string const& filename, mesh_cache_options const& options=mesh_cache_options());
+
+	/** Read the cache of a mesh file. Returns false if the cache doesn't exist or is outdated. */
+	bool mesh_cache_read(std::string const& filename, mesh& m, mesh_cache_options const& options=mesh_cache_options());
+	/** Write the cache of a mesh loaded from filename. Returns false if the cache cannot be written. */
+	bool mesh_cache_write(std::string const& filename, mesh const& m, mesh_cache_options const& options=mesh_cache_options());
+
+	enum class mesh_cache_prebake_result {up_to_date, baked, failed};
+	/** Create the cache of an obj file if it doesn't exist or is outdated
+	* Returns baked if the cache has been (re)generated, failed with an error message if the obj file is invalid or the cache cannot be written (ex. read-only directory).
+	* Doesn't abort on an invalid file: a batch of files can continue after a failure. */
+	mesh_cache_prebake_result mesh_cache_prebake(std::string const& filename, std::string& error, mesh_cache_options const& options=mesh_cache_options());
+
+
+	/** Zero-copy access to a cached mesh: the arrays point directly to the mapped cache file
+	* (the attributes pointers are nullptr for the attributes that are not stored) */
+	struct mesh_cache_view
+	{
+		mapped_file file;
+		size_t vertex_count = 0;
+		size_t triangle_count = 0;
+
+		vec3 const* position = nullptr;
+		vec3 const* normal = nullptr;
+		vec3 const* color = nullptr;
+		vec2 const* uv = nullptr;
+		uint3 const* connectivity = nullptr;
+	};
+
+	/** Map the cache of a mesh file. Returns false if the cache doesn't exist or is outdated. */
+	bool mesh_cache_open(std::string const& filename, mesh_cache_view& view, mesh_cache_options const& options=mesh_cache_options());
+}
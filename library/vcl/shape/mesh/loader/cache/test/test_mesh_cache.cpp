@@ -0,0 +1,129 @@
+#include "test_mesh_cache.hpp"
+
+#include "vcl/base/base.hpp"
+#include "../mesh_cache.hpp"
+#include "../../obj/obj.hpp"
+#include "../../../primitive/mesh_primitive.hpp"
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+using namespace vcl;
+
+namespace vcl_test
+{
+	static void write_text_file(std::string const& filename, std::string const& content, bool append=false)
+	{
+		std::ofstream stream(filename, append? std::ios::binary|std::ios::app : std::ios::binary);
+		assert_vcl_no_msg(stream.is_open());
+		stream << content;
+	}
+
+	// The arrays are copied in binary: the values are exactly the same
+	template <typename T>
+	static bool same_values(T const* data, buffer<T> const& reference)
+	{
+		if(reference.size()==0)
+			return data==nullptr;
+		return data!=nullptr && std::memcmp(data, reference.data.data(), reference.size()*sizeof(T))==0;
+	}
+	template <typename T>
+	static bool same_values(buffer<T> const& data, buffer<T> const& reference)
+	{
+		return data.size()==reference.size() && (data.size()==0 || same_values(data.data.data(), reference));
+	}
+	static bool same_mesh(mesh const& m, mesh const& reference)
+	{
+		return same_values(m.position, reference.position) && same_values(m.normal, reference.normal) && same_values(m.color, reference.color)
+			&& same_values(m.uv, reference.uv) && same_values(m.connectivity, reference.connectivity);
+	}
+
+	void test_mesh_cache()
+	{
+		std::string const filename = "vcl_test_mesh_cache.obj";
+		mesh_save_file_obj(filename, mesh_primitive_sphere(1.0f, {0,0,0}, 20, 10));
+
+		mesh_cache_options options;
+		std::string const cache_filename = mesh_cache_filename(filename, options);
+		std::remove(cache_filename.c_str());
+
+		// Write/read round trip: same mesh than the obj loader
+		{
+			mesh const reference = mesh_load_file_obj(filename);
+			mesh m;
+			assert_vcl_no_msg(!mesh_cache_read(filename, m, options)); // no cache yet
+
+			mesh const loaded = mesh_load_file_obj_cached(filename, options); // parses the file and writes the cache
+			assert_vcl_no_msg(same_mesh(loaded, reference));
+			assert_vcl_no_msg(mesh_cache_read(filename, m, options));
+			assert_vcl_no_msg(same_mesh(m, reference));
+			assert_vcl_no_msg(same_mesh(mesh_load_file_obj_cached(filename, options), reference));
+
+			std::string error;
+			assert_vcl_no_msg(mesh_cache_prebake(filename, error, options)==mesh_cache_prebake_result::up_to_date);
+		}
+
+		// Mapped view: the pointers refer to the arrays of the file (aligned on 16 bytes)
+		{
+			mesh const reference = mesh_load_file_obj(filename);
+			mesh_cache_view view;
+			assert_vcl_no_msg(mesh_cache_open(filename, view, options));
+			assert_vcl_no_msg(view.vertex_count==reference.position.size() && view.triangle_count==reference.connectivity.size());
+			assert_vcl_no_msg(same_values(view.position, reference.position));
+			assert_vcl_no_msg(same_values(view.normal, reference.normal));
+			assert_vcl_no_msg(same_values(view.color, reference.color));
+			assert_vcl_no_msg(same_values(view.uv, reference.uv));
+			assert_vcl_no_msg(same_values(view.connectivity, reference.connectivity));
+			for(char const* p : {reinterpret_cast<char const*>(view.position), reinterpret_cast<char const*>(view.connectivity)}) {
+				assert_vcl_no_msg(p>=view.file.begin() && p<view.file.end());
+				assert_vcl_no_msg((p-view.file.begin())%16==0);
+			}
+		}
+
+		// Invalidation: other loading options, then modified source
+		{
+			mesh_cache_options options_no_fill = options;
+			options_no_fill.fill_empty_field = false;
+			mesh m;
+			mesh_cache_view view;
+			assert_vcl_no_msg(!mesh_cache_read(filename, m, options_no_fill));
+			assert_vcl_no_msg(!mesh_cache_open(filename, view, options_no_fill));
+
+			write_text_file(filename, "# modified\n", true);
+			assert_vcl_no_msg(!mesh_cache_read(filename, m, options));
+			std::string error;
+			assert_vcl_no_msg(mesh_cache_prebake(filename, error, options)==mesh_cache_prebake_result::baked);
+			assert_vcl_no_msg(mesh_cache_prebake(filename, error, options)==mesh_cache_prebake_result::up_to_date);
+			assert_vcl_no_msg(mesh_cache_read(filename, m, options));
+			assert_vcl_no_msg(same_mesh(m, mesh_load_file_obj(filename)));
+		}
+		std::remove(cache_filename.c_str());
+		std::remove(filename.c_str());
+
+		// Mesh without faces: cached without filling the empty fields, and reported as invalid otherwise (without aborting)
+		{
+			std::string const filename_no_face = "vcl_test_mesh_cache_no_face.obj";
+			write_text_file(filename_no_face, "v 0 0 0\nv 1 0 0\nv 0 1 0\n");
+
+			mesh_cache_options options_no_fill;
+			options_no_fill.fill_empty_field = false;
+			std::string error;
+			assert_vcl_no_msg(mesh_cache_prebake(filename_no_face, error, options_no_fill)==mesh_cache_prebake_result::baked);
+			assert_vcl_no_msg(mesh_cache_prebake(filename_no_face, error, options_no_fill)==mesh_cache_prebake_result::up_to_date);
+			mesh m;
+			assert_vcl_no_msg(mesh_cache_read(filename_no_face, m, options_no_fill));
+			assert_vcl_no_msg(m.connectivity.size()==0);
+			mesh_cache_view view;
+			assert_vcl_no_msg(mesh_cache_open(filename_no_face, view, options_no_fill));
+			assert_vcl_no_msg(view.triangle_count==0 && view.connectivity==nullptr);
+			view.file.close();
+
+			assert_vcl_no_msg(mesh_cache_prebake(filename_no_face, error, options)==mesh_cache_prebake_result::failed);
+			assert_vcl_no_msg(!error.empty());
+
+			std::remove(mesh_cache_filename(filename_no_face, options_no_fill).c_str());
+			std::remove(filename_no_face.c_str());
+		}
+	}
+}
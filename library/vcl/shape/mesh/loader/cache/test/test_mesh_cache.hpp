@@ -0,0 +1,7 @@
+#pragma once
+
+namespace vcl_test
+{
+	/** Check the write/read of the .vclmesh cache against the obj loader, the mapped view, and the invalidation of the cache */
+	void test_mesh_cache();
+}
@@ -1,3 +1,6 @@
 #pragma once
 
-#include "obj/obj.hpp"
\ No newline at end of file
+#include "obj/obj.hpp"
+#include "ply/ply.hpp"
+#include "stl/stl.hpp"
+#include "cache/mesh_cache.hpp"
\ No newline at end of file
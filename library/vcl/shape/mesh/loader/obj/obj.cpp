@@ -6,11 +6,12 @@
 #endif
 
 #include "obj.hpp"
+#include "../../weld/mesh_weld.hpp"
 
 #include "vcl/base/base.hpp"
 #include "vcl/files/files.hpp"
 
-#include <map>
+#include <algorithm>
 
 #include <fstream>
 #include <sstream>
@@ -18,155 +19,223 @@
 namespace vcl
 {
 
+static mesh make_unique_parameter_per_value(loader::obj_data const& data, loader::obj_type const type, obj_vertex_correspondance& correspondance);
 
-// Comparator of triplet of integer for std::map
-struct comparator_int3 {
-    long int N; // number of vertices
 
-    comparator_int3(int N_arg=0) :N(N_arg) {}
-
-    // compute a<b
-    bool operator()(int3 const& a, int3 const& b) const
-    {
-        long int const offset_a = long(a[0]) + N*(long(a[1]) + N*long(a[2]));
-        long int const offset_b = long(b[0]) + N*(long(b[1]) + N*long(b[2]));
-        return offset_a < offset_b;
-    }
-};
+mesh mesh_load_file_obj(const std::string& filename)
+{
+    assert_file_exist(filename);
 
+    mesh m;
+    std::string error;
+    if(!mesh_load_file_obj(filename, m, error))
+        error_vcl(error);
+    return m;
+}
 
-static buffer<buffer_stack<int3,3>> triangulate_faces(buffer<buffer<int3>> faces);
+bool mesh_load_file_obj(const std::string& filename, mesh& m, std::string& error)
+{
+    obj_vertex_correspondance vertex_correspondance;
+    if(!mesh_load_file_obj(filename, m, vertex_correspondance, error))
+        return false;
+
+    // fill_empty_field requires at least one triangle
+    if(m.connectivity.size()==0) {
+        error = "File "+filename+" has 0 faces";
+        m = mesh();
+        return false;
+    }
+    m.fill_empty_field();
+    return true;
+}
 
+mesh mesh_load_file_obj(const std::string& filename, buffer<buffer<int> >& vertex_correspondance)
+{
+    obj_vertex_correspondance correspondance;
+    mesh const m = mesh_load_file_obj(filename, correspondance);
 
-static std::pair<mesh, std::map<int3, int, comparator_int3>>
-    make_unique_parameter_per_value(buffer<vec3> const& positions,
-                                    buffer<vec2> const& texture_uv,
-                                    buffer<vec3> const& normals,
-                                    buffer<buffer_stack<int3,3>> const& faces,
-                                    loader::obj_type const type);
+    size_t const N = correspondance.size();
+    vertex_correspondance.clear();
+    vertex_correspondance.resize(N);
+    for(size_t k=0; k<N; ++k)
+        for(unsigned int i=correspondance.offset[k]; i<correspondance.offset[k+1]; ++i)
+            vertex_correspondance[k].push_back(int(correspondance.vertex[i]));
 
+    return m;
+}
 
-mesh mesh_load_file_obj(const std::string& filename)
+mesh mesh_load_file_obj(const std::string& filename, obj_vertex_correspondance& vertex_correspondance)
 {
-     buffer<buffer<int>> vertex_correspondance;
-     mesh m = mesh_load_file_obj(filename, vertex_correspondance);
-     m.fill_empty_field();
-     return m;
+    assert_file_exist(filename);
+
+    mesh m;
+    std::string error;
+    if(!mesh_load_file_obj(filename, m, vertex_correspondance, error))
+        error_vcl(error);
+    return m;
 }
-mesh mesh_load_file_obj(const std::string& filename, buffer<buffer<int> >& vertex_correspondance)
+
+bool mesh_load_file_obj(const std::string& filename, mesh& m, obj_vertex_correspondance& vertex_correspondance, std::string& error)
 {
-    assert_file_exist(filename);
+    m = mesh();
 
-    // Load parameters
-    buffer<vec3> positions = loader::obj_read_positions(filename);
-    buffer<vec2> texture_uv = loader::obj_read_texture_uv(filename);
-    buffer<vec3> normals = loader::obj_read_normals(filename);
+    // Load all elements from the mapped file (parsed in parallel for large files)
+    mapped_file file;
+    if(!file.open(filename)) {
+        error = "Cannot open file "+filename;
+        return false;
+    }
+    loader::obj_data data;
+    loader::obj_parse_parallel(file.begin(), file.end(), data);
+    file.close();
 
-    assert_vcl(positions.size()>0, str("File ")+filename+" has 0 vertices");
+    if(data.positions.size()==0) {
+        error = "File "+filename+" has 0 vertices";
+        return false;
+    }
 
     // set obj type
     loader::obj_type type = loader::obj_type::vertex;
-    if(texture_uv.size()>0 && normals.size()>0)
+    if(data.texture_uv.size()>0 && data.normals.size()>0)
         type = loader::obj_type::vertex_texture_normal;
-    else if( texture_uv.size()>0 )
+    else if( data.texture_uv.size()>0 )
         type = loader::obj_type::vertex_texture;
-    else if( normals.size()>0 )
+    else if( data.normals.size()>0 )
         type = loader::obj_type::vertex_normal;
 
-    // Load connectivity and triangulate
-    buffer<buffer_stack<int3,3>> faces = triangulate_faces( loader::obj_read_faces(filename, type) );
-
-    // Set unique per-vertex value for texture and normals (duplicate vertices if necessary)
-    mesh m;
-    std::map<int3, int, comparator_int3> connectivity_map;
-    std::tie(m,connectivity_map) = make_unique_parameter_per_value(positions, texture_uv, normals, faces, type);
-
-    // Retrieve correspondance between initial vertices in files and new ones
-    vertex_correspondance.resize(positions.size());
-    for(auto const& it : connectivity_map)
-    {
-        int const vertex_in = it.first[0];
-        int const vertex_out = it.second;
+    // Ignore the indices of the undefined parameters
+    bool const use_texture = (type==loader::obj_type::vertex_texture_normal || type==loader::obj_type::vertex_texture);
+    bool const use_normal = (type==loader::obj_type::vertex_texture_normal || type==loader::obj_type::vertex_normal);
+    for(buffer_stack<int3,3>& tri : data.triangles) {
+        for(int3& index : tri) {
+            if(!use_texture) index[1] = -1;
+            if(!use_normal) index[2] = -1;
+        }
+    }
 
-        vertex_correspondance[vertex_in].push_back(vertex_out);
+    // Check the indices of the faces (an index 0 is read as loader::obj_invalid_index)
+    size_t const N_position = data.positions.size();
+    for(buffer_stack<int3,3> const& tri : data.triangles) {
+        for(int3 const& index : tri) {
+            if(index[0]<0 || index[0]>=int(N_position)) {
+                error = "Incorrect position index in obj file "+filename;
+                return false;
+            }
+            if(index[1]<-1 || index[1]>=int(data.texture_uv.size()) || index[2]<-1 || index[2]>=int(data.normals.size())) {
+                error = "Incorrect texture or normal index in obj file "+filename;
+                return false;
+            }
+        }
     }
 
-    return m;
+    // Set unique per-vertex value for texture and normals (duplicate vertices if necessary)
+    m = make_unique_parameter_per_value(data, type, vertex_correspondance);
+    error.clear();
+    return true;
 }
 
-
-buffer<buffer_stack<int3,3>> triangulate_faces(buffer<buffer<int3>> faces)
+void mesh_save_file_obj(const std::string& filename, mesh const& m)
 {
-    buffer<buffer_stack<int3,3>> faces_triangulation;
-    size_t const N_face = faces.size();
-    for(size_t k_face=0; k_face<N_face; ++k_face)
-    {
-        buffer<int3> const& current_polygon = faces[k_face];
-        int const N_polygon = int(current_polygon.size());
-
-        for(int k=0; k<N_polygon-2; ++k) {
-            // triangulation
-            int3 const& f0 = current_polygon[0];
-            int3 const& f1 = current_polygon[k+1];
-            int3 const& f2 = current_polygon[k+2];
+    size_t const N_vertex = m.position.size();
+    bool const use_texture = m.uv.size()>0;
+    bool const use_normal = m.normal.size()>0;
+    assert_vcl(!use_texture || m.uv.size()==N_vertex, "Incoherent size of per-vertex uv");
+    assert_vcl(!use_normal || m.normal.size()==N_vertex, "Incoherent size of per-vertex normal");
+
+    std::vector<text_writer> chunks(1);
+    chunks[0].write("# ").write_number(N_vertex).write(" vertices, ").write_number(m.connectivity.size()).write(" triangles\n");
+
+    text_write_parallel(chunks, N_vertex, [&m](text_writer& writer, size_t k) {
+        vec3 const& p = m.position.data[k];
+        writer.write("v ").write_number(p.x).write(' ').write_number(p.y).write(' ').write_number(p.z).write('\n');
+    });
+    if(use_texture) {
+        text_write_parallel(chunks, N_vertex, [&m](text_writer& writer, size_t k) {
+            vec2 const& uv = m.uv.data[k];
+            writer.write("vt ").write_number(uv.x).write(' ').write_number(uv.y).write('\n');
+        });
+    }
+    if(use_normal) {
+        text_write_parallel(chunks, N_vertex, [&m](text_writer& writer, size_t k) {
+            vec3 const& n = m.normal.data[k];
+            writer.write("vn ").write_number(n.x).write(' ').write_number(n.y).write(' ').write_number(n.z).write('\n');
+        });
+    }
 
-            faces_triangulation.push_back({f0,f1,f2});
+    // Each vertex has a single index for its position, uv and normal
+    char const* const separator = (use_normal && !use_texture)? "//" : "/";
+    int const repeat = (use_texture && use_normal)? 3 : ((use_texture || use_normal)? 2 : 1);
+    text_write_parallel(chunks, m.connectivity.size(), [&](text_writer& writer, size_t k) {
+        uint3 const& f = m.connectivity.data[k];
+        writer.write('f');
+        for(size_t i=0; i<3; ++i) {
+            assert_vcl(f[i]<N_vertex, "Incorrect index in the connectivity");
+            writer.write(' ').write_number(f[i]+1);
+            for(int r=1; r<repeat; ++r)
+                writer.write(separator).write_number(f[i]+1);
         }
-    }
-    return faces_triangulation;
+        writer.write('\n');
+    });
+
+    bool const written = text_write_file(filename, chunks);
+    assert_vcl(written, "Cannot write file "+str(filename));
 }
 
-std::pair<mesh, std::map<int3, int, comparator_int3>>
-    make_unique_parameter_per_value(buffer<vec3> const& positions,
-                                    buffer<vec2> const& texture_uv,
-                                    buffer<vec3> const& normals,
-                                    buffer<buffer_stack<int3,3>> const& faces,
-                                    loader::obj_type const type)
+size_t obj_vertex_correspondance::size() const
 {
-    mesh m;
-    comparator_int3 comparator(int(positions.size()));
-    std::map<int3, int, comparator_int3> connectivity_map(comparator); // stores map between original face index and final offset
-
-
-    size_t const N_triangle = faces.size();
-    for(size_t k_triangle=0; k_triangle<N_triangle; ++k_triangle)
-    {
-        buffer_stack<int3,3> const& tri = faces[k_triangle];
-        uint3 new_triangle_index;
-        for(int k=0; k<3; ++k)
-        {
-            int3 const& index = tri[k];
-            auto const it = connectivity_map.find( index );
-            if( it==connectivity_map.end() ) {
+    return offset.size()>0? offset.size()-1 : 0;
+}
 
-                size_t const offset = m.position.size();
-                connectivity_map[index] = int(offset);
-                new_triangle_index[k] = int(offset);
 
-                int const idx_position = index[0];
+// Create one vertex per distinct triplet of indices (position, texture, normal) used by the triangles
+//  The vertices are numbered in their order of first use (the indices are checked by the caller)
+mesh make_unique_parameter_per_value(loader::obj_data const& data, loader::obj_type const type, obj_vertex_correspondance& correspondance)
+{
+    size_t const N_corner = 3*data.triangles.size();
+    int3 const* corners = reinterpret_cast<int3 const*>(data.triangles.data.data());
+    static_assert(sizeof(buffer_stack<int3,3>)==3*sizeof(int3), "Triangles are expected to be stored contiguously");
 
-                assert_vcl_no_msg( idx_position<int(positions.size()));
-                m.position.push_back( positions[idx_position] );
+    size_t const N_position = data.positions.size();
 
-                if(type==loader::obj_type::vertex_texture_normal || type==loader::obj_type::vertex_texture) {
-                    int const idx_uv = index[1];
-                    assert_vcl_no_msg( idx_uv<int(texture_uv.size()) );
-                    m.uv.push_back( texture_uv[ idx_uv ] );
-                }
-                if(type==loader::obj_type::vertex_texture_normal || type==loader::obj_type::vertex_normal) {
-                    int const idx_normal = index[2];
-                    assert_vcl_no_msg( idx_normal<int(normals.size()) );
-                    m.normal.push_back( normals[index[2]] );
-                }
+    buffer<unsigned int> vertex_of_corner; // vertex of each corner
+    buffer<unsigned int> vertex_corner;    // first corner of each vertex
+    size_t const N_vertex = weld_unique_triplets(corners, N_corner, vertex_of_corner, vertex_corner);
 
-            }
-            else
-                new_triangle_index[k] = it->second;
-        }
-        m.connectivity.push_back(new_triangle_index);
-    }
+    // Fill the mesh
+    mesh m;
+    bool const use_texture = (type==loader::obj_type::vertex_texture_normal || type==loader::obj_type::vertex_texture);
+    bool const use_normal = (type==loader::obj_type::vertex_texture_normal || type==loader::obj_type::vertex_normal);
+    m.position.resize(N_vertex);
+    if(use_texture) m.uv.resize(N_vertex);
+    if(use_normal) m.normal.resize(N_vertex);
+    parallel_for(N_vertex, [&](size_t v) {
+        int3 const& index = corners[vertex_corner.data[v]];
+        m.position.data[v] = data.positions.data[index[0]];
+        // A corner without texture or normal (while other faces define them) receives a default value
+        if(use_texture) m.uv.data[v] = index[1]>=0? data.texture_uv.data[index[1]] : vec2(0,0);
+        if(use_normal) m.normal.data[v] = index[2]>=0? data.normals.data[index[2]] : vec3(0,0,1);
+    }, 16384);
+
+    m.connectivity.resize(data.triangles.size());
+    parallel_for(data.triangles.size(), [&](size_t t) {
+        m.connectivity.data[t] = { vertex_of_corner.data[3*t], vertex_of_corner.data[3*t+1], vertex_of_corner.data[3*t+2] };
+    }, 16384);
+
+    // Correspondance from the file positions (counting sort of the vertices by position index)
+    correspondance.offset.clear();
+    correspondance.offset.resize(N_position+1);
+    correspondance.offset.fill(0);
+    for(size_t v=0; v<N_vertex; ++v)
+        correspondance.offset.data[corners[vertex_corner.data[v]][0]+1]++;
+    for(size_t k=0; k<N_position; ++k)
+        correspondance.offset.data[k+1] += correspondance.offset.data[k];
+
+    correspondance.vertex.resize(N_vertex);
+    std::vector<unsigned int> fill_count(correspondance.offset.data.begin(), correspondance.offset.data.end()-1);
+    for(size_t v=0; v<N_vertex; ++v)
+        correspondance.vertex.data[ fill_count[corners[vertex_corner.data[v]][0]]++ ] = static_cast<unsigned int>(v);
 
-    return {m, connectivity_map};
+    return m;
 }
 
 
@@ -369,6 +438,343 @@ buffer<buffer<int3>> obj_read_faces(const std::string& filename, obj_type const
 }
 
 
+// Convert an index of the obj file (starting at 1, or negative relative to the last element) to an index starting at 0
+static int obj_resolve_index(int index, size_t N_element)
+{
+    if(index>0)
+        return index-1;
+    if(index<0)
+        return int(N_element)+index;
+    return obj_invalid_index; // reported by the caller
+}
+
+// Read a face corner "v", "v/t", "v//n" or "v/t/n"
+template <typename SINK>
+static bool obj_parse_corner(text_scanner& scanner, SINK const& sink, int3& corner)
+{
+    int index = 0;
+    if(!scanner.read_number(index))
+        return false;
+    corner = {obj_resolve_index(index, sink.position_count()), -1, -1};
+
+    if(scanner.match('/')) {
+        if(!scanner.match('/')) {
+            if(scanner.read_number(index))
+                corner[1] = obj_resolve_index(index, sink.texture_uv_count());
+            if(!scanner.match('/'))
+                return true;
+        }
+        if(scanner.read_number(index))
+            corner[2] = obj_resolve_index(index, sink.normal_count());
+    }
+    return true;
+}
+
+// Parse the lines of [begin,end) and send the elements to the sink
+//  (sink provides add_position/add_texture_uv/add_normal/add_triangle, the number of elements already read for the relative indices,
+//   and full() to stop the parsing at the beginning of a line)
+// Returns the position where the parsing stopped
+template <typename SINK>
+static char const* obj_parse_lines(char const* begin, char const* end, SINK& sink)
+{
+    auto is_blank = [](char c) { return c==' ' || c=='\t'; };
+
+    text_scanner scanner(begin, end);
+    while(!scanner.eof() && !sink.full())
+    {
+        scanner.skip_whitespace();
+        if(scanner.eof())
+            break;
+
+        char const c0 = scanner.current[0];
+        char const c1 = scanner.current+1<scanner.end? scanner.current[1] : '\0';
+        char const c2 = scanner.current+2<scanner.end? scanner.current[2] : '\0';
+
+        if(c0=='v' && is_blank(c1)) {
+            scanner.current += 1;
+            vec3 p = {0,0,0};
+            scanner.read_number(p.x); scanner.read_number(p.y); scanner.read_number(p.z);
+            sink.add_position(p);
+        }
+        else if(c0=='v' && c1=='t' && is_blank(c2)) {
+            scanner.current += 2;
+            vec2 uv = {0,0};
+            scanner.read_number(uv.x); scanner.read_number(uv.y);
+            sink.add_texture_uv(uv);
+        }
+        else if(c0=='v' && c1=='n' && is_blank(c2)) {
+            scanner.current += 2;
+            vec3 n = {0,0,0};
+            scanner.read_number(n.x); scanner.read_number(n.y); scanner.read_number(n.z);
+            sink.add_normal(n);
+        }
+        else if(c0=='f' && is_blank(c1)) {
+            scanner.current += 1;
+
+            // Triangulate the polygon as a fan while reading its corners
+            int3 first, previous, corner;
+            int N_corner = 0;
+            while(true) {
+                scanner.skip_blank();
+                if(scanner.eol() || !obj_parse_corner(scanner, sink, corner))
+                    break;
+                if(N_corner==0)
+                    first = corner;
+                else if(N_corner>=2)
+                    sink.add_triangle({first, previous, corner});
+                previous = corner;
+                N_corner++;
+            }
+        }
+
+        // Ignore the end of the line (and the lines with other elements or comments)
+        scanner.skip_line();
+    }
+    return scanner.current;
+}
+
+// Sink appending the elements to obj_data
+struct obj_sink_append {
+    obj_data& data;
+
+    void add_position(vec3 const& p) { data.positions.push_back(p); }
+    void add_texture_uv(vec2 const& uv) { data.texture_uv.push_back(uv); }
+    void add_normal(vec3 const& n) { data.normals.push_back(n); }
+    void add_triangle(buffer_stack<int3,3> const& tri) { data.triangles.push_back(tri); }
+
+    size_t position_count() const { return data.positions.size(); }
+    size_t texture_uv_count() const { return data.texture_uv.size(); }
+    size_t normal_count() const { return data.normals.size(); }
+    bool full() const { return false; }
+};
+
+void obj_parse(char const* begin, char const* end, obj_data& data)
+{
+    obj_sink_append sink = {data};
+    obj_parse_lines(begin, end, sink);
+}
+
+
+// Sink of a chunk: the attributes are written in place in the global buffers (their offset is known from the counting pass)
+//  and the triangles are stored locally
+struct obj_sink_chunk {
+    obj_data& data;
+    size_t position_offset, texture_uv_offset, normal_offset;
+    size_t N_position, N_texture_uv, N_normal;
+    buffer<buffer_stack<int3,3>> triangles;
+
+    void add_position(vec3 const& p) { data.positions.data[position_offset + N_position++] = p; }
+    void add_texture_uv(vec2 const& uv) { data.texture_uv.data[texture_uv_offset + N_texture_uv++] = uv; }
+    void add_normal(vec3 const& n) { data.normals.data[normal_offset + N_normal++] = n; }
+    void add_triangle(buffer_stack<int3,3> const& tri) { triangles.push_back(tri); }
+
+    size_t position_count() const { return position_offset + N_position; }
+    size_t texture_uv_count() const { return texture_uv_offset + N_texture_uv; }
+    size_t normal_count() const { return normal_offset + N_normal; }
+    bool full() const { return false; }
+};
+
+// Count the position, uv and normal lines of [begin,end)
+static void obj_count_elements(char const* begin, char const* end, size_t& N_position, size_t& N_texture_uv, size_t& N_normal)
+{
+    auto is_blank = [](char c) { return c==' ' || c=='\t'; };
+
+    text_scanner scanner(begin, end);
+    while(!scanner.eof())
+    {
+        scanner.skip_whitespace();
+        if(scanner.eof())
+            break;
+
+        // Same tests than obj_parse_lines
+        char const c0 = scanner.current[0];
+        char const c1 = scanner.current+1<scanner.end? scanner.current[1] : '\0';
+        char const c2 = scanner.current+2<scanner.end? scanner.current[2] : '\0';
+        if(c0=='v' && is_blank(c1)) N_position++;
+        else if(c0=='v' && c1=='t' && is_blank(c2)) N_texture_uv++;
+        else if(c0=='v' && c1=='n' && is_blank(c2)) N_normal++;
+        scanner.skip_line();
+    }
+}
+
+void obj_parse_parallel(char const* begin, char const* end, obj_data& data)
+{
+    size_t const size = size_t(end-begin);
+    size_t const N_chunk = parallel_range_count(size, 4*1024*1024);
+    if(N_chunk<=1) {
+        obj_parse(begin, end, data);
+        return;
+    }
+
+    // Split in chunks starting at the beginning of a line
+    std::vector<char const*> chunk_begin(N_chunk+1, end);
+    chunk_begin[0] = begin;
+    for(size_t k=1; k<N_chunk; ++k) {
+        size_t b=0, e=0;
+        parallel_range_bounds(size, N_chunk, k, b, e);
+        char const* p = std::max(begin+b, chunk_begin[k-1]);
+        text_scanner scanner(p-1, end); // a chunk starting exactly after a '\n' is kept
+        scanner.skip_line();
+        chunk_begin[k] = scanner.current;
+    }
+
+    // Count the elements per chunk, and allocate the attributes
+    std::vector<size_t> N_position(N_chunk,0), N_texture_uv(N_chunk,0), N_normal(N_chunk,0);
+    parallel_for(N_chunk, [&](size_t k){
+        obj_count_elements(chunk_begin[k], chunk_begin[k+1], N_position[k], N_texture_uv[k], N_normal[k]);
+    }, 1);
+
+    std::vector<obj_sink_chunk> chunks;
+    chunks.reserve(N_chunk);
+    size_t position_offset=0, texture_uv_offset=0, normal_offset=0;
+    for(size_t k=0; k<N_chunk; ++k) {
+        chunks.push_back({data, position_offset, texture_uv_offset, normal_offset, 0, 0, 0, {}});
+        position_offset += N_position[k];
+        texture_uv_offset += N_texture_uv[k];
+        normal_offset += N_normal[k];
+    }
+    data.positions.resize(position_offset);
+    data.texture_uv.resize(texture_uv_offset);
+    data.normals.resize(normal_offset);
+
+    // Parse the chunks
+    parallel_for(N_chunk, [&](size_t k){
+        obj_parse_lines(chunk_begin[k], chunk_begin[k+1], chunks[k]);
+    }, 1);
+
+    // Concatenate the triangles
+    std::vector<size_t> triangle_offset(N_chunk+1, 0);
+    for(size_t k=0; k<N_chunk; ++k)
+        triangle_offset[k+1] = triangle_offset[k] + chunks[k].triangles.size();
+    data.triangles.resize(triangle_offset[N_chunk]);
+    parallel_for(N_chunk, [&](size_t k){
+        std::copy(chunks[k].triangles.begin(), chunks[k].triangles.end(), data.triangles.data.begin()+triangle_offset[k]);
+    }, 1);
+}
+
+}
+
+
+// Sink appending the elements to a batch of the stream, the relative indices are resolved with the number of elements of the previous batches
+struct obj_sink_stream {
+    obj_stream_batch& batch;
+    size_t batch_size;
+
+    void add_position(vec3 const& p) { batch.positions.push_back(p); }
+    void add_texture_uv(vec2 const& uv) { batch.texture_uv.push_back(uv); }
+    void add_normal(vec3 const& n) { batch.normals.push_back(n); }
+    void add_triangle(buffer_stack<int3,3> const& tri) {
+        for(int3 const& index : tri)
+            if(index[0]==loader::obj_invalid_index || index[1]==loader::obj_invalid_index || index[2]==loader::obj_invalid_index)
+                error_vcl("Invalid index 0 in obj file");
+        batch.triangles.push_back(tri);
+    }
+
+    size_t position_count() const { return batch.position_offset + batch.positions.size(); }
+    size_t texture_uv_count() const { return batch.texture_uv_offset + batch.texture_uv.size(); }
+    size_t normal_count() const { return batch.normal_offset + batch.normals.size(); }
+    bool full() const { return batch.size()>=batch_size; }
+};
+
+size_t obj_stream_batch::size() const
+{
+    return positions.size() + texture_uv.size() + normals.size() + triangles.size();
+}
+
+obj_stream::obj_stream()
+{}
+
+obj_stream::~obj_stream()
+{
+    close();
+}
+
+bool obj_stream::open(std::string const& filename, obj_stream_options const& options_arg)
+{
+    close();
+    file = std::fopen(filename.c_str(), "rb");
+    if(file==nullptr)
+        return false;
+
+    options = options_arg;
+    options.batch_size = std::max(options.batch_size, size_t(1));
+    content.resize(std::max(options.buffer_size, size_t(64)));
+    return true;
+}
+
+void obj_stream::close()
+{
+    if(file!=nullptr)
+        std::fclose(file);
+    file = nullptr;
+    std::vector<char>().swap(content);
+    content_begin = 0;
+    content_end = 0;
+    end_of_file = false;
+    position_count = 0;
+    texture_uv_count = 0;
+    normal_count = 0;
+    triangle_count = 0;
+}
+
+void obj_stream::read_content()
+{
+    size_t const N_remaining = content_end-content_begin;
+    if(content_begin>0)
+        std::copy(content.begin()+content_begin, content.begin()+content_end, content.begin());
+    content_begin = 0;
+    content_end = N_remaining;
+
+    // The buffer is full with a single line: grow it
+    if(content_end==content.size())
+        content.resize(2*content.size());
+
+    size_t const N_read = std::fread(content.data()+content_end, 1, content.size()-content_end, file);
+    content_end += N_read;
+    if(N_read==0)
+        end_of_file = true;
+}
+
+bool obj_stream::next(obj_stream_batch& batch)
+{
+    batch.positions.clear();
+    batch.texture_uv.clear();
+    batch.normals.clear();
+    batch.triangles.clear();
+    batch.position_offset = position_count;
+    batch.texture_uv_offset = texture_uv_count;
+    batch.normal_offset = normal_count;
+    batch.triangle_offset = triangle_count;
+    if(file==nullptr)
+        return false;
+
+    obj_sink_stream sink = {batch, options.batch_size};
+    while(!sink.full())
+    {
+        // Parse only complete lines, except for the last line of the file
+        char const* const begin = content.data()+content_begin;
+        char const* end = content.data()+content_end;
+        if(!end_of_file) {
+            while(end>begin && end[-1]!='\n')
+                --end;
+        }
+
+        if(end==begin) {
+            if(end_of_file)
+                break;
+            read_content();
+            continue;
+        }
+
+        char const* const stop = loader::obj_parse_lines(begin, end, sink);
+        content_begin = size_t(stop-content.data());
+    }
+
+    position_count += batch.positions.size();
+    texture_uv_count += batch.texture_uv.size();
+    normal_count += batch.normals.size();
+    triangle_count += batch.triangles.size();
+    return batch.size()>0;
 }
 
 }
@@ -2,12 +2,106 @@
 
 #include "../../structure/mesh.hpp"
 
+#include <cstdio>
+#include <limits>
+#include <string>
+#include <vector>
+
 namespace vcl
 {
 
+/** Correspondance between the vertices of the obj file and the vertices of the mesh (a vertex of the file is duplicated for each of its texture/normal values)
+ * Stored as a compressed array: the mesh vertices of the k-th vertex of the file are vertex[offset[k]] ... vertex[offset[k+1]-1] */
+struct obj_vertex_correspondance {
+    buffer<unsigned int> offset;
+    buffer<unsigned int> vertex;
+
+    /** Number of vertices in the file */
+    size_t size() const;
+};
+
 mesh mesh_load_file_obj(const std::string& filename);
+mesh mesh_load_file_obj(const std::string& filename, obj_vertex_correspondance& vertex_correspondance);
 mesh mesh_load_file_obj(const std::string& filename, buffer<buffer<int>>& vertex_correspondance);
 
+/** Same loading than mesh_load_file_obj(filename), returning false with an error message instead of aborting on an invalid file
+ * (cannot be opened, no vertex or no face, incorrect index) */
+bool mesh_load_file_obj(const std::string& filename, mesh& m, std::string& error);
+/** Same loading than mesh_load_file_obj(filename, vertex_correspondance) (the empty fields are not filled), returning false with an error message instead of aborting */
+bool mesh_load_file_obj(const std::string& filename, mesh& m, obj_vertex_correspondance& vertex_correspondance, std::string& error);
+
+/** Save the mesh as an obj file: the positions, texture uv and normals (when they are filled) and the triangles
+ * Numbers are written with the shortest text that is read back exactly. The lines are formatted in parallel and written to the file at once. */
+void mesh_save_file_obj(const std::string& filename, mesh const& m);
+
+
+/** Consecutive elements of an obj file read by obj_stream
+ * Face corners store the indices (position, texture, normal) in the whole file: they start at 0, relative indices are resolved, and are set to -1 for undefined texture and normals.
+ * Corners may refer to elements of previous batches: the k-th position of the batch has the index position_offset+k in the file (same for texture_uv and normals). */
+struct obj_stream_batch {
+    buffer<vec3> positions;
+    buffer<vec2> texture_uv;
+    buffer<vec3> normals;
+    buffer<buffer_stack<int3,3>> triangles; // faces triangulated as fans
+
+    size_t position_offset = 0;
+    size_t texture_uv_offset = 0;
+    size_t normal_offset = 0;
+    size_t triangle_offset = 0;
+
+    /** Number of elements (positions, texture uv, normals and triangles) of the batch */
+    size_t size() const;
+};
+
+struct obj_stream_options {
+    /** Number of elements (positions, texture uv, normals and triangles) after which a batch is ended - the triangles of a polygon are never split between two batches */
+    size_t batch_size = 65536;
+    /** Size in bytes of the part of the file kept in memory (only grows for a line longer than this size) */
+    size_t buffer_size = 1024*1024;
+};
+
+/** Reader of an obj file by batches of bounded size: neither the file nor the mesh is entirely loaded in memory
+ * The memory used is the read buffer and the batch (its buffers are reused from one batch to the next).
+ * ex.
+ *   obj_stream stream;
+ *   stream.open(filename);
+ *   obj_stream_batch batch;
+ *   while(stream.next(batch)) { ... } */
+struct obj_stream {
+    obj_stream();
+    ~obj_stream();
+    obj_stream(obj_stream const&) = delete;
+    obj_stream& operator=(obj_stream const&) = delete;
+
+    /** Open the file, returns false if it cannot be opened */
+    bool open(std::string const& filename, obj_stream_options const& options = obj_stream_options());
+    /** Read the next elements of the file in the batch (its previous content is replaced)
+     * Returns false when the end of the file is reached */
+    bool next(obj_stream_batch& batch);
+    void close();
+
+    obj_stream_options options;
+
+    // Number of elements already read
+    size_t position_count = 0;
+    size_t texture_uv_count = 0;
+    size_t normal_count = 0;
+    size_t triangle_count = 0;
+
+private:
+    std::FILE* file = nullptr;
+    std::vector<char> content;             // part of the file in memory
+    size_t content_begin = 0;              // first character not parsed
+    size_t content_end = 0;                // end of the characters read
+    bool end_of_file = false;
+
+    // Move the characters not parsed to the beginning of the buffer, and read the next part of the file
+    void read_content();
+};
+
+/** Read the obj file by batches, calling callback(obj_stream_batch const&) for each of them in the order of the file */
+template <typename F> void obj_stream_read(std::string const& filename, F const& callback, obj_stream_options const& options = obj_stream_options());
+
 
 namespace loader{
 
@@ -37,7 +131,44 @@ namespace loader{
     */
 
     buffer<buffer<int3>> obj_read_faces(const std::string& filename, obj_type const type);
+
+
+    /** Value of a face index 0 (invalid in an obj file) */
+    int const obj_invalid_index = std::numeric_limits<int>::min();
+
+    /** Content of an obj file
+     * Face indices start at 0 (relative negative indices are resolved), and are set to -1 for undefined texture and normals
+     * An index 0 is set to obj_invalid_index: it is reported by the loaders. */
+    struct obj_data {
+        buffer<vec3> positions;
+        buffer<vec2> texture_uv;
+        buffer<vec3> normals;
+        buffer<buffer_stack<int3,3>> triangles; // faces triangulated as fans
+    };
+
+    /** Read all the elements of the obj content [begin,end) in a single pass (no allocation per line) */
+    void obj_parse(char const* begin, char const* end, obj_data& data);
+    /** Same result than obj_parse, reading the content with several threads
+     * The content is split in chunks of lines: a first pass counts the attributes of each chunk to place them directly in the final buffers,
+     *  then the chunks are parsed in parallel, and their triangles are concatenated. */
+    void obj_parse_parallel(char const* begin, char const* end, obj_data& data);
 }
 
 
 }
+
+
+namespace vcl
+{
+
+template <typename F> void obj_stream_read(std::string const& filename, F const& callback, obj_stream_options const& options)
+{
+    obj_stream stream;
+    bool const is_open = stream.open(filename, options);
+    assert_vcl(is_open, "Cannot open file "+filename);
+    obj_stream_batch batch;
+    while(stream.next(batch))
+        callback(static_cast<obj_stream_batch const&>(batch));
+}
+
+}
@@ -0,0 +1,208 @@
+#include "test_obj.hpp"
+
+#include "vcl/base/base.hpp"
+#include "../obj.hpp"
+#include "vcl/files/files.hpp"
+#include "../../../primitive/mesh_primitive.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+
+using namespace vcl;
+
+namespace vcl_test
+{
+	static void write_text_file(std::string const& filename, std::string const& content)
+	{
+		std::ofstream stream(filename, std::ios::binary);
+		assert_vcl_no_msg(stream.is_open());
+		stream << content;
+	}
+
+	void test_obj_loader()
+	{
+		std::string const filename = "vcl_test_obj_loader.obj";
+
+		// Quad + triangle with texture coordinates, comments, tabulations, CRLF and relative indices
+		write_text_file(filename,
+			"# test file\r\n"
+			"o shape\n"
+			"v 0 0 0\n"
+			"v 1 0 0\r\n"
+			"v\t1 1 0\n"
+			"v 0 1 0 1.0\n"
+			"vt 0 0\nvt 1 0\nvt 1 1\nvt 0 1\n"
+			"\n"
+			"f 1/1 2/2 3/3 4/4\n"
+			"v 2 0 0\n"
+			"f -4/1 -1/1 -3/3 # triangle with relative indices\n");
+
+		buffer<buffer<int>> correspondance;
+		mesh const m = mesh_load_file_obj(filename, correspondance);
+		obj_vertex_correspondance correspondance_compressed;
+		mesh_load_file_obj(filename, correspondance_compressed);
+
+		// Streaming with small batches and a read buffer smaller than a line gives the same elements than the single pass parsing
+		loader::obj_data data;
+		{
+			mapped_file file(filename);
+			loader::obj_parse(file.begin(), file.end(), data);
+		}
+		obj_stream_options stream_options;
+		stream_options.batch_size = 2;
+		stream_options.buffer_size = 8;
+		loader::obj_data data_stream;
+		size_t N_batch = 0;
+		obj_stream_read(filename, [&](obj_stream_batch const& batch) {
+			assert_vcl_no_msg(batch.position_offset==data_stream.positions.size() && batch.triangle_offset==data_stream.triangles.size());
+			for(vec3 const& p : batch.positions) data_stream.positions.push_back(p);
+			for(vec2 const& uv : batch.texture_uv) data_stream.texture_uv.push_back(uv);
+			for(buffer_stack<int3,3> const& tri : batch.triangles) data_stream.triangles.push_back(tri);
+			N_batch++;
+		}, stream_options);
+		std::remove(filename.c_str());
+
+		assert_vcl_no_msg(N_batch>1);
+		assert_vcl_no_msg(is_equal(data.positions, data_stream.positions) && is_equal(data.texture_uv, data_stream.texture_uv));
+		assert_vcl_no_msg(data.triangles.size()==data_stream.triangles.size());
+		for(size_t k=0; k<data.triangles.size(); ++k)
+			for(size_t i=0; i<3; ++i)
+				assert_vcl_no_msg(is_equal(data.triangles[k][i], data_stream.triangles[k][i]));
+
+		assert_vcl_no_msg(m.connectivity.size()==3);
+		assert_vcl_no_msg(m.position.size()==6); // vertex 2 is used with two different uv
+		assert_vcl_no_msg(m.uv.size()==6);
+		assert_vcl_no_msg(is_equal(m.position[m.connectivity[2][1]], vec3(2,0,0)));
+		assert_vcl_no_msg(is_equal(m.uv[m.connectivity[2][1]], vec2(0,0)));
+
+		assert_vcl_no_msg(correspondance.size()==5);
+		assert_vcl_no_msg(correspondance[1].size()==2);
+		for(size_t k=0; k<correspondance.size(); ++k)
+			for(int idx : correspondance[k])
+				assert_vcl_no_msg(is_equal(m.position[idx], m.position[correspondance[k][0]]));
+
+		// Save and load back: the mesh is unchanged
+		mesh_save_file_obj(filename, m);
+		mesh const reloaded = mesh_load_file_obj(filename);
+		std::remove(filename.c_str());
+		assert_vcl_no_msg(reloaded.position.size()==m.position.size() && reloaded.connectivity.size()==m.connectivity.size());
+		for(size_t k=0; k<m.position.size(); ++k)
+			assert_vcl_no_msg(reloaded.position[k].x==m.position[k].x && reloaded.position[k].y==m.position[k].y && reloaded.position[k].z==m.position[k].z);
+		for(size_t k=0; k<m.connectivity.size(); ++k)
+			assert_vcl_no_msg(is_equal(reloaded.connectivity[k], m.connectivity[k]) && is_equal(reloaded.uv[k], m.uv[k]));
+
+		assert_vcl_no_msg(correspondance_compressed.size()==5);
+		assert_vcl_no_msg(correspondance_compressed.vertex.size()==m.position.size());
+		for(size_t k=0; k<correspondance.size(); ++k) {
+			assert_vcl_no_msg(correspondance_compressed.offset[k+1]-correspondance_compressed.offset[k]==correspondance[k].size());
+			for(size_t i=0; i<correspondance[k].size(); ++i)
+				assert_vcl_no_msg(int(correspondance_compressed.vertex[correspondance_compressed.offset[k]+i])==correspondance[k][i]);
+		}
+	}
+
+	void benchmark_obj_loader(std::string const& filename_arg)
+	{
+		using clock = std::chrono::steady_clock;
+		auto seconds = [](clock::time_point t0) { return std::chrono::duration<double>(clock::now()-t0).count(); };
+
+		std::string filename = filename_arg;
+		if(filename.empty())
+		{
+			filename = "vcl_benchmark_obj_loader.obj";
+			mesh const shape = mesh_primitive_sphere(1.0f, {0,0,0}, 1000, 500);
+			FILE* file = std::fopen(filename.c_str(), "w");
+			assert_vcl_no_msg(file!=nullptr);
+			for(vec3 const& p : shape.position) std::fprintf(file, "v %.6f %.6f %.6f\n", p.x, p.y, p.z);
+			for(vec2 const& uv : shape.uv) std::fprintf(file, "vt %.6f %.6f\n", uv.x, uv.y);
+			for(vec3 const& n : shape.normal) std::fprintf(file, "vn %.6f %.6f %.6f\n", n.x, n.y, n.z);
+			for(uint3 const& f : shape.connectivity)
+				std::fprintf(file, "f %u/%u/%u %u/%u/%u %u/%u/%u\n", f[0]+1,f[0]+1,f[0]+1, f[1]+1,f[1]+1,f[1]+1, f[2]+1,f[2]+1,f[2]+1);
+			std::fclose(file);
+		}
+
+		double size_MB = 0;
+		{
+			std::ifstream stream(filename, std::ios::binary | std::ios::ate);
+			size_MB = double(stream.tellg())/(1024.0*1024.0);
+		}
+
+		// Previous approach: one pass per element
+		clock::time_point t0 = clock::now();
+		size_t const N_position = loader::obj_read_positions(filename).size();
+		loader::obj_read_texture_uv(filename);
+		loader::obj_read_normals(filename);
+		loader::obj_read_faces(filename, loader::obj_type::vertex_texture_normal);
+		double const t_multi_pass = seconds(t0);
+
+		t0 = clock::now();
+		loader::obj_data data;
+		{
+			mapped_file file(filename);
+			loader::obj_parse(file.begin(), file.end(), data);
+		}
+		double const t_parse = seconds(t0);
+
+		t0 = clock::now();
+		loader::obj_data data_parallel;
+		{
+			mapped_file file(filename);
+			loader::obj_parse_parallel(file.begin(), file.end(), data_parallel);
+		}
+		double const t_parse_parallel = seconds(t0);
+
+		assert_vcl(is_equal(data.positions, data_parallel.positions) && is_equal(data.texture_uv, data_parallel.texture_uv) && is_equal(data.normals, data_parallel.normals), "Parallel parsing differs from the serial one");
+		assert_vcl_no_msg(data.triangles.size()==data_parallel.triangles.size());
+		for(size_t k=0; k<data.triangles.size(); ++k)
+			for(size_t i=0; i<3; ++i)
+				assert_vcl_no_msg(is_equal(data.triangles[k][i], data_parallel.triangles[k][i]));
+
+		t0 = clock::now();
+		mesh const m = mesh_load_file_obj(filename);
+		double const t_load = seconds(t0);
+
+		t0 = clock::now();
+		size_t N_triangle_stream = 0;
+		obj_stream_read(filename, [&N_triangle_stream](obj_stream_batch const& batch) { N_triangle_stream += batch.triangles.size(); });
+		double const t_stream = seconds(t0);
+		assert_vcl(N_triangle_stream==data.triangles.size(), "Streaming reads a different number of triangles");
+
+		std::cout << "File " << filename << ": " << size_MB << " MB, " << N_position << " vertices, " << m.connectivity.size() << " triangles" << std::endl;
+		std::cout << "  Reading per element (4 passes): " << size_MB/t_multi_pass << " MB/s" << std::endl;
+		std::cout << "  Single pass parsing:            " << size_MB/t_parse << " MB/s" << std::endl;
+		std::cout << "  Parallel parsing (" << parallel_thread_count() << " threads):    " << size_MB/t_parse_parallel << " MB/s" << std::endl;
+		std::cout << "  mesh_load_file_obj:             " << size_MB/t_load << " MB/s" << std::endl;
+		std::cout << "  Streaming (batches of " << obj_stream_options().batch_size << "):   " << size_MB/t_stream << " MB/s" << std::endl;
+
+		// Writing with text_writer against std::ostream
+		std::string const filename_save = "vcl_benchmark_obj_writer.obj";
+		t0 = clock::now();
+		mesh_save_file_obj(filename_save, m);
+		double const t_save = seconds(t0);
+		double size_save_MB = 0;
+		{
+			std::ifstream stream(filename_save, std::ios::binary | std::ios::ate);
+			size_save_MB = double(stream.tellg())/(1024.0*1024.0);
+		}
+
+		t0 = clock::now();
+		{
+			std::ofstream stream(filename_save);
+			stream.precision(9);
+			for(vec3 const& p : m.position) stream << "v " << p.x << " " << p.y << " " << p.z << "\n";
+			for(vec2 const& uv : m.uv) stream << "vt " << uv.x << " " << uv.y << "\n";
+			for(vec3 const& n : m.normal) stream << "vn " << n.x << " " << n.y << " " << n.z << "\n";
+			for(uint3 const& f : m.connectivity)
+				stream << "f " << f[0]+1 << "/" << f[0]+1 << "/" << f[0]+1 << " " << f[1]+1 << "/" << f[1]+1 << "/" << f[1]+1 << " " << f[2]+1 << "/" << f[2]+1 << "/" << f[2]+1 << "\n";
+		}
+		double const t_save_stream = seconds(t0);
+		std::remove(filename_save.c_str());
+
+		std::cout << "  mesh_save_file_obj:             " << size_save_MB/t_save << " MB/s" << std::endl;
+		std::cout << "  Writing with std::ostream:      " << size_save_MB/t_save_stream << " MB/s" << std::endl;
+
+		if(filename_arg.empty())
+			std::remove(filename.c_str());
+	}
+}
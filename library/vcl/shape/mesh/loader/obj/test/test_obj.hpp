@@ -0,0 +1,12 @@
+#pragma once
+
+#include <string>
+
+namespace vcl_test
+{
+	void test_obj_loader();
+
+	/** Measure the loading speed (MB/s) of the obj loader against the previous per-element reading functions
+	* Uses the given file, or generates a large obj file if filename is empty */
+	void benchmark_obj_loader(std::string const& filename="");
+}
@@ -0,0 +1,545 @@
+#include "ply.hpp"
+
+#include "vcl/base/base.hpp"
+#include "vcl/files/files.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <sstream>
+#include <vector>
+
+namespace vcl
+{
+	namespace
+	{
+		enum class ply_format { ascii, binary_little_endian, binary_big_endian };
+		enum class ply_type { none, int8, uint8, int16, uint16, int32, uint32, float32, float64 };
+
+		// Components of the vertex properties read in the mesh
+		enum ply_component { ply_x=0, ply_y, ply_z, ply_nx, ply_ny, ply_nz, ply_red, ply_green, ply_blue, ply_u, ply_v, ply_component_count };
+
+		struct ply_property {
+			std::string name;
+			ply_type type = ply_type::none;       // type of the values
+			ply_type count_type = ply_type::none; // type of the number of values for a list, none for a scalar property
+			size_t offset = 0;                    // offset in a binary record (only used for elements of fixed size)
+		};
+
+		struct ply_element {
+			std::string name;
+			size_t count = 0;
+			std::vector<ply_property> properties;
+			size_t stride = 0; // size of a binary record, 0 if the element contains lists
+		};
+
+		struct ply_header {
+			ply_format format = ply_format::ascii;
+			std::vector<ply_element> elements;
+			size_t size = 0; // number of characters up to the end of the line end_header
+		};
+
+		bool host_is_little_endian()
+		{
+			uint16_t const x = 1;
+			unsigned char c = 0;
+			std::memcpy(&c, &x, 1);
+			return c==1;
+		}
+
+		size_t ply_type_size(ply_type type)
+		{
+			switch(type) {
+			case ply_type::int8: case ply_type::uint8: return 1;
+			case ply_type::int16: case ply_type::uint16: return 2;
+			case ply_type::int32: case ply_type::uint32: case ply_type::float32: return 4;
+			case ply_type::float64: return 8;
+			default: return 0;
+			}
+		}
+
+		ply_type ply_type_from_name(std::string const& name)
+		{
+			if(name=="char" || name=="int8") return ply_type::int8;
+			if(name=="uchar" || name=="uint8") return ply_type::uint8;
+			if(name=="short" || name=="int16") return ply_type::int16;
+			if(name=="ushort" || name=="uint16") return ply_type::uint16;
+			if(name=="int" || name=="int32") return ply_type::int32;
+			if(name=="uint" || name=="uint32") return ply_type::uint32;
+			if(name=="float" || name=="float32") return ply_type::float32;
+			if(name=="double" || name=="float64") return ply_type::float64;
+			return ply_type::none;
+		}
+
+		int ply_vertex_component(std::string const& name)
+		{
+			if(name=="x") return ply_x;
+			if(name=="y") return ply_y;
+			if(name=="z") return ply_z;
+			if(name=="nx") return ply_nx;
+			if(name=="ny") return ply_ny;
+			if(name=="nz") return ply_nz;
+			if(name=="red" || name=="diffuse_red") return ply_red;
+			if(name=="green" || name=="diffuse_green") return ply_green;
+			if(name=="blue" || name=="diffuse_blue") return ply_blue;
+			if(name=="u" || name=="s" || name=="texture_u") return ply_u;
+			if(name=="v" || name=="t" || name=="texture_v") return ply_v;
+			return -1;
+		}
+
+		// Scale applied to a color stored as an integer
+		float ply_color_scale(ply_type type)
+		{
+			if(type==ply_type::uint8) return 1.0f/255.0f;
+			if(type==ply_type::uint16) return 1.0f/65535.0f;
+			return 1.0f;
+		}
+
+		template <typename T> T ply_load(char const* p, bool swap)
+		{
+			T value;
+			if(swap) {
+				char bytes[sizeof(T)];
+				for(size_t k=0; k<sizeof(T); ++k)
+					bytes[k] = p[sizeof(T)-1-k];
+				std::memcpy(&value, bytes, sizeof(T));
+			}
+			else
+				std::memcpy(&value, p, sizeof(T));
+			return value;
+		}
+
+		template <typename T> void ply_store(char* p, T const& value, bool swap)
+		{
+			std::memcpy(p, &value, sizeof(T));
+			if(swap)
+				std::reverse(p, p+sizeof(T));
+		}
+
+		double ply_load_value(char const* p, ply_type type, bool swap)
+		{
+			switch(type) {
+			case ply_type::int8: return double(ply_load<int8_t>(p,swap));
+			case ply_type::uint8: return double(ply_load<uint8_t>(p,swap));
+			case ply_type::int16: return double(ply_load<int16_t>(p,swap));
+			case ply_type::uint16: return double(ply_load<uint16_t>(p,swap));
+			case ply_type::int32: return double(ply_load<int32_t>(p,swap));
+			case ply_type::uint32: return double(ply_load<uint32_t>(p,swap));
+			case ply_type::float32: return double(ply_load<float>(p,swap));
+			case ply_type::float64: return ply_load<double>(p,swap);
+			default: return 0.0;
+			}
+		}
+
+		void ply_read_header(char const* begin, char const* end, std::string const& filename, ply_header& header)
+		{
+			text_scanner scanner(begin, end);
+			bool first_line = true;
+			while(!scanner.eof())
+			{
+				char const* const line_begin = scanner.current;
+				scanner.skip_line();
+				std::istringstream tokens(std::string(line_begin, scanner.current));
+				std::string keyword;
+				tokens >> keyword;
+
+				if(first_line) {
+					assert_vcl(keyword=="ply", "File "+filename+" is not a PLY file");
+					first_line = false;
+				}
+				else if(keyword=="format") {
+					std::string format;
+					tokens >> format;
+					if(format=="ascii") header.format = ply_format::ascii;
+					else if(format=="binary_little_endian") header.format = ply_format::binary_little_endian;
+					else if(format=="binary_big_endian") header.format = ply_format::binary_big_endian;
+					else error_vcl("Unknown format "+format+" in PLY file "+filename);
+				}
+				else if(keyword=="element") {
+					ply_element element;
+					tokens >> element.name >> element.count;
+					assert_vcl(!tokens.fail(), "Invalid element in PLY file "+filename);
+					header.elements.push_back(element);
+				}
+				else if(keyword=="property") {
+					assert_vcl(!header.elements.empty(), "Property without element in PLY file "+filename);
+					ply_property property;
+					std::string type;
+					tokens >> type;
+					if(type=="list") {
+						std::string count_type;
+						tokens >> count_type >> type;
+						property.count_type = ply_type_from_name(count_type);
+						assert_vcl(property.count_type!=ply_type::none, "Unknown type "+count_type+" in PLY file "+filename);
+					}
+					tokens >> property.name;
+					property.type = ply_type_from_name(type);
+					assert_vcl(property.type!=ply_type::none, "Unknown type "+type+" in PLY file "+filename);
+					header.elements.back().properties.push_back(property);
+				}
+				else if(keyword=="end_header") {
+					header.size = size_t(scanner.current-begin);
+					break;
+				}
+				// comment, obj_info and empty lines are ignored
+			}
+			assert_vcl(header.size>0, "Missing end_header in PLY file "+filename);
+
+			// Offsets of the properties in the binary records of fixed size
+			for(ply_element& element : header.elements) {
+				size_t offset = 0;
+				bool fixed_size = true;
+				for(ply_property& property : element.properties) {
+					property.offset = offset;
+					offset += ply_type_size(property.type);
+					fixed_size = fixed_size && property.count_type==ply_type::none;
+				}
+				element.stride = fixed_size? offset : 0;
+			}
+		}
+
+		// Sequential reading of the values of the records (ascii or binary)
+		struct ply_reader {
+			ply_format format;
+			bool swap;
+			text_scanner scanner; // current position and end of the content
+			std::string const& filename;
+
+			double read(ply_type type)
+			{
+				double value = 0.0;
+				if(format==ply_format::ascii) {
+					scanner.skip_whitespace();
+					bool const valid = scanner.read_number(value);
+					assert_vcl(valid, "Missing value in PLY file "+filename);
+				}
+				else {
+					size_t const size = ply_type_size(type);
+					assert_vcl(scanner.current+size<=scanner.end, "Unexpected end of PLY file "+filename);
+					value = ply_load_value(scanner.current, type, swap);
+					scanner.current += size;
+				}
+				return value;
+			}
+
+			// Read a list, calling f(index, value) for each of its values
+			template <typename F> void read_list(ply_property const& property, F const& f)
+			{
+				double const count = read(property.count_type);
+				assert_vcl(count>=0, "Invalid list size in PLY file "+filename);
+				size_t const N = size_t(count);
+				for(size_t k=0; k<N; ++k)
+					f(k, read(property.type));
+			}
+		};
+
+		// Convert the property at the given offset of N binary records of size stride
+		template <typename T, typename OUTPUT>
+		void ply_gather_type(char const* data, size_t stride, size_t offset, size_t N, bool swap, OUTPUT* output, size_t output_stride)
+		{
+			parallel_for(N, [=](size_t k){
+				output[k*output_stride] = static_cast<OUTPUT>(ply_load<T>(data+k*stride+offset, swap));
+			}, 65536);
+		}
+
+		template <typename OUTPUT>
+		void ply_gather(char const* data, size_t stride, size_t offset, size_t N, ply_type type, bool swap, OUTPUT* output, size_t output_stride)
+		{
+			switch(type) {
+			case ply_type::int8: ply_gather_type<int8_t>(data, stride, offset, N, swap, output, output_stride); break;
+			case ply_type::uint8: ply_gather_type<uint8_t>(data, stride, offset, N, swap, output, output_stride); break;
+			case ply_type::int16: ply_gather_type<int16_t>(data, stride, offset, N, swap, output, output_stride); break;
+			case ply_type::uint16: ply_gather_type<uint16_t>(data, stride, offset, N, swap, output, output_stride); break;
+			case ply_type::int32: ply_gather_type<int32_t>(data, stride, offset, N, swap, output, output_stride); break;
+			case ply_type::uint32: ply_gather_type<uint32_t>(data, stride, offset, N, swap, output, output_stride); break;
+			case ply_type::float32: ply_gather_type<float>(data, stride, offset, N, swap, output, output_stride); break;
+			case ply_type::float64: ply_gather_type<double>(data, stride, offset, N, swap, output, output_stride); break;
+			default: break;
+			}
+		}
+
+		// Pointer to the float storing the component c of the vertex k
+		float* ply_component_data(mesh& m, int c, size_t k)
+		{
+			if(c<=ply_z) return &m.position.data[k][c-ply_x];
+			if(c<=ply_nz) return &m.normal.data[k][c-ply_nx];
+			if(c<=ply_blue) return &m.color.data[k][c-ply_red];
+			return &m.uv.data[k][c-ply_u];
+		}
+		size_t ply_component_stride(int c)
+		{
+			return c>=ply_u? 2 : 3;
+		}
+
+		void ply_read_vertices(ply_reader& reader, ply_element const& element, mesh& m)
+		{
+			size_t const N = element.count;
+			std::vector<int> component(element.properties.size(), -1);
+			bool found[ply_component_count] = {};
+			for(size_t p=0; p<element.properties.size(); ++p) {
+				ply_property const& property = element.properties[p];
+				if(property.count_type==ply_type::none) {
+					component[p] = ply_vertex_component(property.name);
+					if(component[p]>=0)
+						found[component[p]] = true;
+				}
+			}
+			assert_vcl(found[ply_x] && found[ply_y] && found[ply_z], "Missing vertex position in PLY file "+reader.filename);
+
+			m.position.resize(N);
+			if(found[ply_nx] && found[ply_ny] && found[ply_nz]) m.normal.resize(N);
+			if(found[ply_red] && found[ply_green] && found[ply_blue]) m.color.resize(N);
+			if(found[ply_u] && found[ply_v]) m.uv.resize(N);
+			if(N==0)
+				return;
+
+			// Components found in the file but not stored (ex. only nx)
+			for(size_t p=0; p<component.size(); ++p) {
+				int const c = component[p];
+				if(c<0) continue;
+				if((c>=ply_nx && c<=ply_nz && m.normal.size()==0) || (c>=ply_red && c<=ply_blue && m.color.size()==0) || (c>=ply_u && m.uv.size()==0))
+					component[p] = -1;
+			}
+
+			if(reader.format!=ply_format::ascii && element.stride>0)
+			{
+				// Fixed size records: convert each property directly from the file
+				assert_vcl(size_t(reader.scanner.end-reader.scanner.current)/element.stride>=N, "Unexpected end of PLY file "+reader.filename);
+				for(size_t p=0; p<component.size(); ++p) {
+					int const c = component[p];
+					if(c>=0)
+						ply_gather(reader.scanner.current, element.stride, element.properties[p].offset, N, element.properties[p].type, reader.swap, ply_component_data(m,c,0), ply_component_stride(c));
+				}
+				reader.scanner.current += N*element.stride;
+			}
+			else
+			{
+				for(size_t k=0; k<N; ++k) {
+					for(size_t p=0; p<component.size(); ++p) {
+						ply_property const& property = element.properties[p];
+						if(property.count_type!=ply_type::none)
+							reader.read_list(property, [](size_t, double){});
+						else {
+							double const value = reader.read(property.type);
+							if(component[p]>=0)
+								*ply_component_data(m,component[p],k) = float(value);
+						}
+					}
+				}
+			}
+
+			// Normalize the integer colors
+			if(m.color.size()>0) {
+				for(size_t p=0; p<component.size(); ++p) {
+					int const c = component[p];
+					float const scale = ply_color_scale(element.properties[p].type);
+					if(c>=ply_red && c<=ply_blue && scale!=1.0f)
+						parallel_for(N, [&](size_t k){ m.color.data[k][c-ply_red] *= scale; }, 65536);
+				}
+			}
+		}
+
+		void ply_read_faces(ply_reader& reader, ply_element const& element, mesh& m)
+		{
+			size_t const N = element.count;
+			int index_property = -1;
+			for(size_t p=0; p<element.properties.size(); ++p) {
+				ply_property const& property = element.properties[p];
+				if(property.count_type!=ply_type::none && (property.name=="vertex_indices" || property.name=="vertex_index"))
+					index_property = int(p);
+			}
+			assert_vcl(index_property>=0, "Missing vertex_indices in the faces of PLY file "+reader.filename);
+			ply_property const& indices = element.properties[index_property];
+
+			// Binary faces containing only triangles (the most common case): the records have a fixed size
+			if(reader.format!=ply_format::ascii && element.properties.size()==1 && N>0)
+			{
+				size_t const count_size = ply_type_size(indices.count_type);
+				size_t const stride = count_size + 3*ply_type_size(indices.type);
+				char const* const data = reader.scanner.current;
+				if(size_t(reader.scanner.end-data)/stride>=N)
+				{
+					std::atomic<bool> only_triangles(true);
+					parallel_for(N, [&](size_t k){
+						if(ply_load_value(data+k*stride, indices.count_type, reader.swap)!=3.0)
+							only_triangles.store(false, std::memory_order_relaxed);
+					}, 65536);
+
+					if(only_triangles.load()) {
+						m.connectivity.resize(N);
+						for(size_t i=0; i<3; ++i)
+							ply_gather(data, stride, count_size+i*ply_type_size(indices.type), N, indices.type, reader.swap, &m.connectivity.data[0][i], 3);
+						reader.scanner.current += N*stride;
+						return;
+					}
+				}
+			}
+
+			// General case: read the records one by one, and triangulate the polygons as fans
+			m.connectivity.data.reserve(N);
+			for(size_t k=0; k<N; ++k) {
+				for(size_t p=0; p<element.properties.size(); ++p) {
+					ply_property const& property = element.properties[p];
+					if(int(p)==index_property) {
+						unsigned int first = 0, previous = 0;
+						reader.read_list(property, [&](size_t i, double value){
+							unsigned int const index = static_cast<unsigned int>(value);
+							if(i==0)
+								first = index;
+							else if(i>=2)
+								m.connectivity.push_back(uint3{first, previous, index});
+							previous = index;
+						});
+					}
+					else if(property.count_type!=ply_type::none)
+						reader.read_list(property, [](size_t, double){});
+					else
+						reader.read(property.type);
+				}
+			}
+		}
+
+		// Skip the records of an element that is not read
+		void ply_skip_element(ply_reader& reader, ply_element const& element)
+		{
+			if(reader.format!=ply_format::ascii && element.stride>0) {
+				assert_vcl(size_t(reader.scanner.end-reader.scanner.current)/element.stride>=element.count, "Unexpected end of PLY file "+reader.filename);
+				reader.scanner.current += element.count*element.stride;
+				return;
+			}
+			for(size_t k=0; k<element.count; ++k) {
+				for(ply_property const& property : element.properties) {
+					if(property.count_type!=ply_type::none)
+						reader.read_list(property, [](size_t, double){});
+					else
+						reader.read(property.type);
+				}
+			}
+		}
+	}
+
+
+	mesh mesh_load_file_ply(std::string const& filename)
+	{
+		assert_file_exist(filename);
+		mapped_file file;
+		bool const is_open = file.open(filename);
+		assert_vcl(is_open, "Cannot open file "+filename);
+
+		ply_header header;
+		ply_read_header(file.begin(), file.end(), filename, header);
+
+		bool const file_little_endian = header.format==ply_format::binary_little_endian;
+		bool const swap = header.format!=ply_format::ascii && file_little_endian!=host_is_little_endian();
+		ply_reader reader = {header.format, swap, text_scanner(file.begin()+header.size, file.end()), filename};
+
+		mesh m;
+		bool vertex_read = false;
+		for(ply_element const& element : header.elements) {
+			if(element.name=="vertex" && !vertex_read) {
+				ply_read_vertices(reader, element, m);
+				vertex_read = true;
+			}
+			else if(element.name=="face" && m.connectivity.size()==0)
+				ply_read_faces(reader, element, m);
+			else
+				ply_skip_element(reader, element);
+		}
+		assert_vcl(vertex_read, "No vertex in PLY file "+filename);
+
+		// Check the indices of the faces
+		size_t const N_vertex = m.position.size();
+		std::atomic<bool> valid(true);
+		parallel_for(m.connectivity.size(), [&](size_t k){
+			uint3 const& f = m.connectivity.data[k];
+			if(f[0]>=N_vertex || f[1]>=N_vertex || f[2]>=N_vertex)
+				valid.store(false, std::memory_order_relaxed);
+		}, 65536);
+		assert_vcl(valid.load(), "Incorrect vertex index in the faces of PLY file "+filename);
+
+		if(m.connectivity.size()>0)
+			m.fill_empty_field();
+		return m;
+	}
+
+	void mesh_save_file_ply(std::string const& filename, mesh const& m, bool binary)
+	{
+		size_t const N_vertex = m.position.size();
+		size_t const N_triangle = m.connectivity.size();
+		bool const use_normal = m.normal.size()>0;
+		bool const use_color = m.color.size()>0;
+		bool const use_uv = m.uv.size()>0;
+		assert_vcl(!use_normal || m.normal.size()==N_vertex, "Incoherent size of per-vertex normal");
+		assert_vcl(!use_color || m.color.size()==N_vertex, "Incoherent size of per-vertex color");
+		assert_vcl(!use_uv || m.uv.size()==N_vertex, "Incoherent size of per-vertex uv");
+
+		std::string header = "ply\n";
+		header += binary? "format binary_little_endian 1.0\n" : "format ascii 1.0\n";
+		header += "comment Generated by VCL\n";
+		header += "element vertex "+str(N_vertex)+"\n";
+		header += "property float x\nproperty float y\nproperty float z\n";
+		if(use_normal) header += "property float nx\nproperty float ny\nproperty float nz\n";
+		if(use_color) header += "property uchar red\nproperty uchar green\nproperty uchar blue\n";
+		if(use_uv) header += "property float u\nproperty float v\n";
+		header += "element face "+str(N_triangle)+"\n";
+		header += "property list uchar int vertex_indices\n";
+		header += "end_header\n";
+
+		auto color_byte = [](float c) { return static_cast<uint8_t>(std::lround(clamp(c,0.0f,1.0f)*255.0f)); };
+
+		std::vector<text_writer> chunks(1);
+		std::string& content = chunks[0].text;
+		content = header;
+		if(binary)
+		{
+			// Records of fixed size written in parallel in the final buffer
+			bool const swap = !host_is_little_endian();
+			size_t const vertex_stride = 12 + (use_normal?12:0) + (use_color?3:0) + (use_uv?8:0);
+			size_t const face_stride = 1 + 3*4;
+			content.resize(header.size() + N_vertex*vertex_stride + N_triangle*face_stride);
+
+			char* const vertex_data = &content[header.size()];
+			parallel_for(N_vertex, [&](size_t k){
+				char* p = vertex_data + k*vertex_stride;
+				for(size_t i=0; i<3; ++i, p+=4) ply_store<float>(p, m.position.data[k][i], swap);
+				if(use_normal) for(size_t i=0; i<3; ++i, p+=4) ply_store<float>(p, m.normal.data[k][i], swap);
+				if(use_color) for(size_t i=0; i<3; ++i, p+=1) ply_store<uint8_t>(p, color_byte(m.color.data[k][i]), swap);
+				if(use_uv) for(size_t i=0; i<2; ++i, p+=4) ply_store<float>(p, m.uv.data[k][i], swap);
+			}, 65536);
+
+			char* const face_data = vertex_data + N_vertex*vertex_stride;
+			parallel_for(N_triangle, [&](size_t k){
+				char* p = face_data + k*face_stride;
+				*p++ = 3;
+				for(size_t i=0; i<3; ++i, p+=4) ply_store<int32_t>(p, int32_t(m.connectivity.data[k][i]), swap);
+			}, 65536);
+		}
+		else
+		{
+			text_write_parallel(chunks, N_vertex, [&](text_writer& writer, size_t k){
+				vec3 const& p = m.position.data[k];
+				writer.write_number(p.x).write(' ').write_number(p.y).write(' ').write_number(p.z);
+				if(use_normal) {
+					vec3 const& n = m.normal.data[k];
+					writer.write(' ').write_number(n.x).write(' ').write_number(n.y).write(' ').write_number(n.z);
+				}
+				if(use_color) {
+					vec3 const& c = m.color.data[k];
+					writer.write(' ').write_number(int(color_byte(c.x))).write(' ').write_number(int(color_byte(c.y))).write(' ').write_number(int(color_byte(c.z)));
+				}
+				if(use_uv)
+					writer.write(' ').write_number(m.uv.data[k].x).write(' ').write_number(m.uv.data[k].y);
+				writer.write('\n');
+			});
+			text_write_parallel(chunks, N_triangle, [&](text_writer& writer, size_t k){
+				uint3 const& f = m.connectivity.data[k];
+				writer.write("3 ").write_number(f[0]).write(' ').write_number(f[1]).write(' ').write_number(f[2]).write('\n');
+			});
+		}
+
+		bool const written = text_write_file(filename, chunks);
+		assert_vcl(written, "Cannot write file "+filename);
+	}
+}
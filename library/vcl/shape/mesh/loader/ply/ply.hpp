@@ -0,0 +1,17 @@
+#pragma once
+
+#include "../../structure/mesh.hpp"
+
+namespace vcl
+{
+	/** Load a PLY file (ascii, binary little endian or binary big endian)
+	* Reads the vertex properties x,y,z - nx,ny,nz - red,green,blue (integer colors are normalized in [0,1]) - u,v (or s,t / texture_u,texture_v),
+	*  and the faces (vertex_indices) triangulated as fans. Other elements and properties are ignored.
+	* Binary properties are converted directly from the mapped file to the mesh buffers.
+	* The empty attributes are filled (mesh::fill_empty_field) if the file contains faces */
+	mesh mesh_load_file_ply(std::string const& filename);
+
+	/** Save the mesh as a PLY file (binary little endian by default)
+	* The non-empty per-vertex attributes are saved (positions, normals, colors as unsigned char, uv) */
+	void mesh_save_file_ply(std::string const& filename, mesh const& m, bool binary=true);
+}
@@ -0,0 +1,98 @@
+#include "test_ply.hpp"
+
+#include "vcl/base/base.hpp"
+#include "../ply.hpp"
+#include "../../../primitive/mesh_primitive.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+using namespace vcl;
+
+namespace vcl_test
+{
+	static void write_file(std::string const& filename, std::string const& content)
+	{
+		std::ofstream stream(filename, std::ios::binary);
+		assert_vcl_no_msg(stream.is_open());
+		stream << content;
+	}
+
+	// Append the bytes of the value in big endian
+	template <typename T> static void append_big_endian(std::string& s, T const& value)
+	{
+		char bytes[sizeof(T)];
+		std::memcpy(bytes, &value, sizeof(T));
+		uint16_t const one = 1;
+		if(*reinterpret_cast<unsigned char const*>(&one)==1)
+			std::reverse(bytes, bytes+sizeof(T));
+		s.append(bytes, sizeof(T));
+	}
+
+	static bool is_equal_mesh(mesh const& a, mesh const& b)
+	{
+		if(a.connectivity.size()!=b.connectivity.size())
+			return false;
+		for(size_t k=0; k<a.connectivity.size(); ++k)
+			if(!is_equal(a.connectivity[k], b.connectivity[k]))
+				return false;
+		return is_equal(a.position, b.position) && is_equal(a.normal, b.normal) && is_equal(a.uv, b.uv) && is_equal(a.color, b.color);
+	}
+
+	void test_ply_loader()
+	{
+		std::string const filename = "vcl_test_ply_loader.ply";
+
+		// Binary and ascii round trip of all the attributes
+		mesh shape = mesh_primitive_grid({0,0,0}, {1,0,0}, {1,1,0}, {0,1,0}, 7, 5);
+		shape.fill_empty_field();
+		for(size_t k=0; k<shape.color.size(); ++k)
+			shape.color[k] = vec3(float(k%256)/255.0f, float(k%2), 1.0f); // exactly represented with 8 bits
+		for(bool binary : {true, false}) {
+			mesh_save_file_ply(filename, shape, binary);
+			mesh const loaded = mesh_load_file_ply(filename);
+			assert_vcl_no_msg(loaded.position.size()==shape.position.size());
+			assert_vcl_no_msg(is_equal_mesh(loaded, shape));
+		}
+
+		// Ascii file with comments, an unknown property, and a quad triangulated as a fan
+		write_file(filename,
+			"ply\r\nformat ascii 1.0\r\ncomment test\r\n"
+			"element vertex 4\nproperty float x\nproperty float y\nproperty float z\nproperty float confidence\n"
+			"element face 1\nproperty list uchar int vertex_indices\n"
+			"end_header\n"
+			"0 0 0 1\n1 0 0 1\n1 1 0 1\n0 1 0 1\n"
+			"4 0 1 2 3\n");
+		mesh const quad = mesh_load_file_ply(filename);
+		assert_vcl_no_msg(quad.position.size()==4 && quad.connectivity.size()==2);
+		assert_vcl_no_msg(is_equal(quad.connectivity[1], uint3(0,2,3)));
+		assert_vcl_no_msg(is_equal(quad.color[0], vec3(1,1,1)));
+
+		// Big endian file with double positions, integer colors and an additional element
+		std::string content =
+			"ply\nformat binary_big_endian 1.0\n"
+			"element vertex 3\nproperty double x\nproperty double y\nproperty double z\nproperty ushort red\nproperty ushort green\nproperty ushort blue\n"
+			"element face 1\nproperty list uchar uint vertex_indices\nproperty uchar flags\n"
+			"element edge 1\nproperty int vertex1\nproperty int vertex2\n"
+			"end_header\n";
+		for(int k=0; k<3; ++k) {
+			append_big_endian<double>(content, double(k)); append_big_endian<double>(content, 2.0*k); append_big_endian<double>(content, -1.0);
+			append_big_endian<uint16_t>(content, 65535); append_big_endian<uint16_t>(content, 0); append_big_endian<uint16_t>(content, uint16_t(k));
+		}
+		append_big_endian<uint8_t>(content, 3);
+		for(uint32_t k=0; k<3; ++k)
+			append_big_endian<uint32_t>(content, k);
+		append_big_endian<uint8_t>(content, 7);
+		append_big_endian<int32_t>(content, 0); append_big_endian<int32_t>(content, 1);
+		write_file(filename, content);
+
+		mesh const triangle = mesh_load_file_ply(filename);
+		std::remove(filename.c_str());
+		assert_vcl_no_msg(triangle.position.size()==3 && triangle.connectivity.size()==1);
+		assert_vcl_no_msg(is_equal(triangle.position[2], vec3(2,4,-1)));
+		assert_vcl_no_msg(is_equal(triangle.color[1], vec3(1,0,1.0f/65535.0f)));
+		assert_vcl_no_msg(is_equal(triangle.connectivity[0], uint3(0,1,2)));
+	}
+}
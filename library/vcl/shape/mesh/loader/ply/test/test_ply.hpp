@@ -0,0 +1,6 @@
+#pragma once
+
+namespace vcl_test
+{
+	void test_ply_loader();
+}
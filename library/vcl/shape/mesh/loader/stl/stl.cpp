@@ -0,0 +1,182 @@
+#include "stl.hpp"
+
+#include "vcl/base/base.hpp"
+#include "vcl/files/files.hpp"
+#include "../../weld/mesh_weld.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+namespace vcl
+{
+	namespace
+	{
+		size_t const stl_header_size = 84;    // 80 characters + number of triangles
+		size_t const stl_triangle_size = 50;  // normal, 3 positions, attribute
+
+		bool host_is_little_endian()
+		{
+			uint16_t const x = 1;
+			unsigned char c = 0;
+			std::memcpy(&c, &x, 1);
+			return c==1;
+		}
+
+		// Binary STL values are little endian
+		template <typename T> T stl_load(char const* p)
+		{
+			T value;
+			std::memcpy(&value, p, sizeof(T));
+			if(!host_is_little_endian()) {
+				char* bytes = reinterpret_cast<char*>(&value);
+				std::reverse(bytes, bytes+sizeof(T));
+			}
+			return value;
+		}
+		template <typename T> void stl_store(char* p, T const& value)
+		{
+			std::memcpy(p, &value, sizeof(T));
+			if(!host_is_little_endian())
+				std::reverse(p, p+sizeof(T));
+		}
+
+		bool stl_is_binary(char const* data, size_t size)
+		{
+			if(size<stl_header_size)
+				return false;
+			// The size of a binary file is given by its number of triangles (ascii files start with "solid", but some binary files too)
+			uint64_t const N_triangle = stl_load<uint32_t>(data+80);
+			return size==stl_header_size+N_triangle*stl_triangle_size;
+		}
+
+		void stl_read_binary(char const* data, buffer<vec3>& corners)
+		{
+			size_t const N_triangle = stl_load<uint32_t>(data+80);
+			corners.resize(3*N_triangle);
+			char const* const triangles = data+stl_header_size;
+			parallel_for(N_triangle, [&](size_t k){
+				char const* p = triangles + k*stl_triangle_size + 12; // skip the normal
+				for(size_t i=0; i<3; ++i)
+					for(size_t c=0; c<3; ++c, p+=4)
+						corners.data[3*k+i][c] = stl_load<float>(p);
+			}, 65536);
+		}
+
+		// Read the values following the keywords "vertex" (the other keywords are ignored)
+		void stl_read_ascii(char const* begin, char const* end, std::string const& filename, buffer<vec3>& corners)
+		{
+			text_scanner scanner(begin, end);
+			while(true) {
+				scanner.skip_whitespace();
+				if(scanner.eof())
+					break;
+				char const* const word = scanner.current;
+				while(!scanner.eof() && *scanner.current!=' ' && *scanner.current!='\t' && *scanner.current!='\n' && *scanner.current!='\r')
+					++scanner.current;
+				if(scanner.current-word==6 && std::memcmp(word, "vertex", 6)==0) {
+					vec3 p;
+					bool const valid = scanner.read_number(p.x) && scanner.read_number(p.y) && scanner.read_number(p.z);
+					assert_vcl(valid, "Invalid vertex in STL file "+filename);
+					corners.push_back(p);
+				}
+				else if(scanner.current-word==5 && std::memcmp(word, "solid", 5)==0)
+					scanner.skip_line(); // name of the solid
+			}
+			assert_vcl(corners.size()%3==0, "Incomplete facet in STL file "+filename);
+		}
+	}
+
+
+	mesh mesh_load_file_stl(std::string const& filename)
+	{
+		assert_file_exist(filename);
+		mapped_file file;
+		bool const is_open = file.open(filename);
+		assert_vcl(is_open, "Cannot open file "+filename);
+
+		buffer<vec3> corners;
+		if(stl_is_binary(file.data, file.size))
+			stl_read_binary(file.data, corners);
+		else
+			stl_read_ascii(file.begin(), file.end(), filename, corners);
+		file.close();
+		assert_vcl(corners.size()>0, "File "+filename+" has 0 triangles");
+
+		// Weld the corners with the same coordinates (compared as bits, -0 and +0 are identified)
+		static_assert(sizeof(vec3)==sizeof(int3), "Positions are compared as triplets of integers");
+		parallel_for(corners.size(), [&](size_t k){
+			vec3& p = corners.data[k];
+			p = {p.x+0.0f, p.y+0.0f, p.z+0.0f};
+		}, 65536);
+		buffer<unsigned int> vertex_of_corner;
+		buffer<unsigned int> first_corner;
+		size_t const N_vertex = weld_unique_triplets(reinterpret_cast<int3 const*>(corners.data.data()), corners.size(), vertex_of_corner, first_corner);
+
+		mesh m;
+		m.position.resize(N_vertex);
+		parallel_for(N_vertex, [&](size_t v){
+			m.position.data[v] = corners.data[first_corner.data[v]];
+		}, 65536);
+		m.connectivity.resize(corners.size()/3);
+		parallel_for(m.connectivity.size(), [&](size_t k){
+			m.connectivity.data[k] = {vertex_of_corner.data[3*k], vertex_of_corner.data[3*k+1], vertex_of_corner.data[3*k+2]};
+		}, 65536);
+
+		m.fill_empty_field();
+		return m;
+	}
+
+	void mesh_save_file_stl(std::string const& filename, mesh const& m, bool binary)
+	{
+		size_t const N_triangle = m.connectivity.size();
+		auto facet_normal = [&m](uint3 const& f) {
+			vec3 const n = cross(m.position[f[1]]-m.position[f[0]], m.position[f[2]]-m.position[f[0]]);
+			float const L = norm(n);
+			return L>1e-20f? n/L : vec3(0,0,0);
+		};
+
+		std::vector<text_writer> chunks(1);
+		if(binary)
+		{
+			assert_vcl(N_triangle<=size_t(UINT32_MAX), "Too many triangles for a STL file");
+			std::string& content = chunks[0].text;
+			content.resize(stl_header_size + N_triangle*stl_triangle_size, '\0');
+			std::string const title = "Binary STL generated by VCL";
+			std::copy(title.begin(), title.end(), content.begin());
+			stl_store<uint32_t>(&content[80], uint32_t(N_triangle));
+
+			char* const triangles = &content[stl_header_size];
+			parallel_for(N_triangle, [&](size_t k){
+				uint3 const& f = m.connectivity[k];
+				char* p = triangles + k*stl_triangle_size;
+				vec3 const n = facet_normal(f);
+				for(size_t c=0; c<3; ++c, p+=4)
+					stl_store<float>(p, n[c]);
+				for(size_t i=0; i<3; ++i)
+					for(size_t c=0; c<3; ++c, p+=4)
+						stl_store<float>(p, m.position[f[i]][c]);
+				stl_store<uint16_t>(p, 0);
+			}, 65536);
+		}
+		else
+		{
+			chunks[0].write("solid vcl\n");
+			text_write_parallel(chunks, N_triangle, [&](text_writer& writer, size_t k){
+				uint3 const& f = m.connectivity[k];
+				vec3 const n = facet_normal(f);
+				writer.write("facet normal ").write_number(n.x).write(' ').write_number(n.y).write(' ').write_number(n.z).write("\n outer loop\n");
+				for(size_t i=0; i<3; ++i) {
+					vec3 const& p = m.position[f[i]];
+					writer.write("  vertex ").write_number(p.x).write(' ').write_number(p.y).write(' ').write_number(p.z).write('\n');
+				}
+				writer.write(" endloop\nendfacet\n");
+			});
+			chunks.resize(chunks.size()+1);
+			chunks.back().write("endsolid vcl\n");
+		}
+
+		bool const written = text_write_file(filename, chunks);
+		assert_vcl(written, "Cannot write file "+filename);
+	}
+}
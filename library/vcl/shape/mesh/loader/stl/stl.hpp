@@ -0,0 +1,14 @@
+#pragma once
+
+#include "../../structure/mesh.hpp"
+
+namespace vcl
+{
+	/** Load a STL file (binary or ascii)
+	* The corners of the triangles sharing exactly the same position are welded into a single vertex (parallel hash of the coordinates),
+	*  the normals are then computed per vertex from the connectivity (the normals stored per facet are ignored) */
+	mesh mesh_load_file_stl(std::string const& filename);
+
+	/** Save the triangles of the mesh as a STL file (binary by default), the facet normals are computed from the positions */
+	void mesh_save_file_stl(std::string const& filename, mesh const& m, bool binary=true);
+}
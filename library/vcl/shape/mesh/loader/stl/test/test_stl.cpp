@@ -0,0 +1,73 @@
+#include "test_stl.hpp"
+
+#include "vcl/base/base.hpp"
+#include "../stl.hpp"
+#include "../../ply/ply.hpp"
+#include "../../../primitive/mesh_primitive.hpp"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <iostream>
+
+using namespace vcl;
+
+namespace vcl_test
+{
+	void test_stl_loader()
+	{
+		std::string const filename = "vcl_test_stl_loader.stl";
+		mesh const shape = mesh_primitive_grid({0,0,0}, {1,0,0}, {1,1,0.5f}, {0,1,0}, 7, 5);
+
+		for(bool binary : {true, false}) {
+			mesh_save_file_stl(filename, shape, binary);
+			mesh const loaded = mesh_load_file_stl(filename);
+
+			// The triangle corners are welded back to the vertices of the grid
+			assert_vcl_no_msg(loaded.position.size()==shape.position.size());
+			assert_vcl_no_msg(loaded.connectivity.size()==shape.connectivity.size());
+			assert_vcl_no_msg(loaded.normal.size()==loaded.position.size());
+			for(size_t k=0; k<shape.connectivity.size(); ++k)
+				for(size_t i=0; i<3; ++i)
+					assert_vcl_no_msg(is_equal(loaded.position[loaded.connectivity[k][i]], shape.position[shape.connectivity[k][i]]));
+		}
+		std::remove(filename.c_str());
+	}
+
+	void benchmark_binary_mesh_loader(size_t N_triangle)
+	{
+		using clock = std::chrono::steady_clock;
+		auto seconds = [](clock::time_point t0) { return std::chrono::duration<double>(clock::now()-t0).count(); };
+
+		int const N = int(std::sqrt(double(N_triangle)/2.0))+1;
+		mesh const shape = mesh_primitive_grid({0,0,0}, {1,0,0}, {1,1,0}, {0,1,0}, N, N);
+		std::cout << "Grid of " << shape.position.size() << " vertices, " << shape.connectivity.size() << " triangles" << std::endl;
+
+		std::string const filename_stl = "vcl_benchmark_mesh_loader.stl";
+		std::string const filename_ply = "vcl_benchmark_mesh_loader.ply";
+
+		clock::time_point t0 = clock::now();
+		mesh_save_file_stl(filename_stl, shape);
+		double const t_save_stl = seconds(t0);
+
+		t0 = clock::now();
+		mesh const stl = mesh_load_file_stl(filename_stl);
+		double const t_load_stl = seconds(t0);
+		assert_vcl_no_msg(stl.position.size()==shape.position.size());
+
+		t0 = clock::now();
+		mesh_save_file_ply(filename_ply, shape);
+		double const t_save_ply = seconds(t0);
+
+		t0 = clock::now();
+		mesh const ply = mesh_load_file_ply(filename_ply);
+		double const t_load_ply = seconds(t0);
+		assert_vcl_no_msg(ply.connectivity.size()==shape.connectivity.size());
+
+		std::cout << "  STL binary: save " << t_save_stl << " s, load (with welding) " << t_load_stl << " s" << std::endl;
+		std::cout << "  PLY binary: save " << t_save_ply << " s, load " << t_load_ply << " s" << std::endl;
+
+		std::remove(filename_stl.c_str());
+		std::remove(filename_ply.c_str());
+	}
+}
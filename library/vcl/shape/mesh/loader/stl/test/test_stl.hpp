@@ -0,0 +1,11 @@
+#pragma once
+
+#include <cstddef>
+
+namespace vcl_test
+{
+	void test_stl_loader();
+
+	/** Measure the loading and saving time of binary STL and PLY files of a grid with about N_triangle triangles */
+	void benchmark_binary_mesh_loader(size_t N_triangle=10000000);
+}
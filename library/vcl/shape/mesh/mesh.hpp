@@ -2,4 +2,7 @@
 
 #include "structure/mesh.hpp"
 #include "primitive/mesh_primitive.hpp"
-#include "loader/loader.hpp"
\ No newline at end of file
+#include "loader/loader.hpp"
+#include "weld/mesh_weld.hpp"
+#include "meshlet/mesh_meshlet.hpp"
+#include "quantization/mesh_quantization.hpp"
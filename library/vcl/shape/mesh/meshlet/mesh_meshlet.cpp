@@ -0,0 +1,285 @@
+#include "mesh_meshlet.hpp"
+
+#include "vcl/base/base.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace vcl
+{
+	static void meshlet_compute_bounds(meshlet& cluster, meshlet_table const& table, mesh const& m);
+
+	meshlet_table mesh_build_meshlets(mesh const& m, meshlet_parameters const& parameters)
+	{
+		assert_vcl(parameters.max_vertex>=3 && parameters.max_vertex<=256, "Meshlet vertex count must be in [3,256] to use 8-bit indices");
+		assert_vcl(parameters.max_triangle>=1, "Meshlet must contain at least one triangle");
+
+		size_t const N_vertex = m.position.size();
+		size_t const N_tri = m.connectivity.size();
+
+		// Vertex to triangle adjacency (CSR storage)
+		std::vector<unsigned int> adjacency_offset(N_vertex+1, 0);
+		for(uint3 const& tri : m.connectivity)
+			for(unsigned int idx : tri) {
+				assert_vcl_no_msg(idx<N_vertex);
+				adjacency_offset[idx+1]++;
+			}
+		for(size_t k=0; k<N_vertex; ++k)
+			adjacency_offset[k+1] += adjacency_offset[k];
+		std::vector<unsigned int> adjacency(adjacency_offset[N_vertex]);
+		{
+			std::vector<unsigned int> fill = adjacency_offset;
+			for(size_t k=0; k<N_tri; ++k)
+				for(unsigned int idx : m.connectivity.data[k])
+					adjacency[fill[idx]++] = static_cast<unsigned int>(k);
+		}
+
+		meshlet_table table;
+		std::vector<char> emitted(N_tri, 0);
+		std::vector<unsigned int> local(N_vertex, ~0u); // local index of a vertex in the current meshlet
+		std::vector<unsigned int> candidates;
+		size_t next_seed = 0;
+
+		meshlet current;
+		auto new_vertex_count = [&](uint3 const& tri) {
+			int count = 0;
+			for(unsigned int idx : tri)
+				count += (local[idx]==~0u);
+			return count;
+		};
+		auto finish_meshlet = [&]() {
+			for(size_t k=0; k<current.vertex_count; ++k)
+				local[table.vertex_index.data[current.vertex_offset+k]] = ~0u;
+			meshlet_compute_bounds(current, table, m);
+			table.meshlets.push_back(current);
+			current = meshlet();
+			current.vertex_offset = static_cast<unsigned int>(table.vertex_index.size());
+			current.triangle_offset = static_cast<unsigned int>(table.local_index.size()/3);
+			candidates.clear();
+		};
+
+		size_t N_emitted = 0;
+		while(N_emitted<N_tri)
+		{
+			// Select the candidate triangle adding the smallest number of new vertices (first found in case of equality)
+			long best = -1;
+			int best_score = 4;
+			size_t write = 0;
+			for(size_t k=0; k<candidates.size(); ++k) {
+				unsigned int const t = candidates[k];
+				if(emitted[t])
+					continue;
+				candidates[write++] = t;
+				int const score = new_vertex_count(m.connectivity.data[t]);
+				if(score<best_score) {
+					best_score = score;
+					best = t;
+				}
+			}
+			candidates.resize(write);
+
+			// No connected candidate: start from the next triangle in the initial order
+			if(best==-1) {
+				while(emitted[next_seed])
+					++next_seed;
+				best = long(next_seed);
+				best_score = new_vertex_count(m.connectivity.data[best]);
+			}
+
+			// Close the current meshlet if the triangle doesn't fit
+			if(current.vertex_count+best_score>parameters.max_vertex || current.triangle_count+1>parameters.max_triangle) {
+				finish_meshlet();
+				continue;
+			}
+
+			uint3 const& tri = m.connectivity.data[best];
+			for(unsigned int idx : tri) {
+				if(local[idx]==~0u) {
+					local[idx] = current.vertex_count++;
+					table.vertex_index.push_back(idx);
+					for(unsigned int a=adjacency_offset[idx]; a<adjacency_offset[idx+1]; ++a)
+						if(!emitted[adjacency[a]])
+							candidates.push_back(adjacency[a]);
+				}
+				table.local_index.push_back(static_cast<unsigned char>(local[idx]));
+			}
+			current.triangle_count++;
+			emitted[best] = 1;
+			N_emitted++;
+		}
+		if(current.triangle_count>0)
+			finish_meshlet();
+
+		return table;
+	}
+
+	uint3 meshlet_triangle(meshlet_table const& table, meshlet const& cluster, size_t k_triangle)
+	{
+		size_t const offset = 3*(size_t(cluster.triangle_offset)+k_triangle);
+		uint3 tri;
+		for(size_t k=0; k<3; ++k)
+			tri[k] = table.vertex_index.data[cluster.vertex_offset + table.local_index.data[offset+k]];
+		return tri;
+	}
+
+	static void meshlet_compute_bounds(meshlet& cluster, meshlet_table const& table, mesh const& m)
+	{
+		// Bounding sphere centered on the bounding box
+		vec3 p_min = m.position.data[table.vertex_index.data[cluster.vertex_offset]];
+		vec3 p_max = p_min;
+		for(size_t k=0; k<cluster.vertex_count; ++k) {
+			vec3 const& p = m.position.data[table.vertex_index.data[cluster.vertex_offset+k]];
+			for(size_t c=0; c<3; ++c) {
+				p_min[c] = std::min(p_min[c], p[c]);
+				p_max[c] = std::max(p_max[c], p[c]);
+			}
+		}
+		cluster.center = (p_min+p_max)/2.0f;
+		cluster.radius = 0.0f;
+		for(size_t k=0; k<cluster.vertex_count; ++k)
+			cluster.radius = std::max(cluster.radius, norm(m.position.data[table.vertex_index.data[cluster.vertex_offset+k]]-cluster.center));
+
+		// Normal cone
+		buffer<vec3> normals;
+		buffer<vec3> corners;
+		vec3 axis = {0,0,0};
+		for(size_t k=0; k<cluster.triangle_count; ++k) {
+			uint3 const tri = meshlet_triangle(table, cluster, k);
+			vec3 const& p0 = m.position.data[tri[0]];
+			vec3 const n = cross(m.position.data[tri[1]]-p0, m.position.data[tri[2]]-p0);
+			float const L = norm(n);
+			if(L>1e-12f) {
+				normals.push_back(n/L);
+				corners.push_back(p0);
+				axis += n/L;
+			}
+		}
+		cluster.cone_apex = cluster.center;
+		cluster.cone_axis = {0,0,1};
+		cluster.cone_cutoff = 1.0f;
+
+		float const L_axis = norm(axis);
+		if(normals.size()==0 || L_axis<1e-6f)
+			return;
+		axis /= L_axis;
+
+		float min_dot = 1.0f;
+		for(vec3 const& n : normals)
+			min_dot = std::min(min_dot, dot(n,axis));
+		if(min_dot<=0.1f) // normals too spread: the cone would never allow culling
+			return;
+
+		// Apex: farthest point along -axis from which all triangle planes are seen from behind
+		float t_max = 0.0f;
+		for(size_t k=0; k<normals.size(); ++k) {
+			float const dn = dot(axis, normals[k]);
+			float const t = dot(cluster.center-corners[k], normals[k])/dn;
+			t_max = std::max(t_max, t);
+		}
+		cluster.cone_axis = axis;
+		cluster.cone_apex = cluster.center - t_max*axis;
+		cluster.cone_cutoff = std::sqrt(1.0f-min_dot*min_dot);
+	}
+
+	buffer_stack<vec4,6> frustum_planes(mat4 const& M)
+	{
+		vec4 const r0 = M[0], r1 = M[1], r2 = M[2], r3 = M[3];
+		buffer_stack<vec4,6> planes;
+		planes[0] = r3+r0; // left
+		planes[1] = r3-r0; // right
+		planes[2] = r3+r1; // bottom
+		planes[3] = r3-r1; // top
+		planes[4] = r3+r2; // near
+		planes[5] = r3-r2; // far
+		for(size_t k=0; k<6; ++k) {
+			float const L = norm(vec3(planes[k].x, planes[k].y, planes[k].z));
+			if(L>0)
+				planes[k] /= L;
+		}
+		return planes;
+	}
+
+	bool meshlet_in_frustum(meshlet const& cluster, buffer_stack<vec4,6> const& planes)
+	{
+		vec3 const& c = cluster.center;
+		for(size_t k=0; k<6; ++k) {
+			vec4 const& P = planes[k];
+			if(P.x*c.x+P.y*c.y+P.z*c.z+P.w < -cluster.radius)
+				return false;
+		}
+		return true;
+	}
+
+	bool meshlet_backfacing(meshlet const& cluster, vec3 const& camera_position)
+	{
+		if(cluster.cone_cutoff>=1.0f)
+			return false;
+		vec3 const d = cluster.cone_apex-camera_position;
+		float const L = norm(d);
+		if(L<1e-8f)
+			return false;
+		return dot(d, cluster.cone_axis) >= cluster.cone_cutoff*L;
+	}
+
+	buffer<unsigned int> meshlet_cull(meshlet_table const& table, mat4 const& projection_view, vec3 const& camera_position, bool frustum_culling, bool backface_culling, meshlet_culling_statistics* statistics)
+	{
+		buffer_stack<vec4,6> const planes = frustum_planes(projection_view);
+		size_t const N = table.meshlets.size();
+
+		// 0: visible, 1: culled by frustum, 2: culled by backface cone
+		std::vector<char> state(N, 0);
+		parallel_for(N, [&](size_t k){
+			meshlet const& cluster = table.meshlets.data[k];
+			if(frustum_culling && !meshlet_in_frustum(cluster, planes))
+				state[k] = 1;
+			else if(backface_culling && meshlet_backfacing(cluster, camera_position))
+				state[k] = 2;
+		}, 2048);
+
+		buffer<unsigned int> visible;
+		meshlet_culling_statistics stats;
+		stats.meshlet_total = N;
+		for(size_t k=0; k<N; ++k) {
+			if(state[k]==0) {
+				visible.push_back(static_cast<unsigned int>(k));
+				stats.triangle_visible += table.meshlets.data[k].triangle_count;
+			}
+			else if(state[k]==1)
+				stats.culled_frustum++;
+			else
+				stats.culled_backface++;
+		}
+
+		if(statistics!=nullptr)
+			*statistics = stats;
+		return visible;
+	}
+
+	void meshlet_connectivity(meshlet_table const& table, buffer<unsigned int> const& meshlet_index, buffer<uint3>& connectivity)
+	{
+		size_t N_tri = 0;
+		for(unsigned int idx : meshlet_index)
+			N_tri += table.meshlets[idx].triangle_count;
+		connectivity.resize(N_tri);
+
+		size_t offset = 0;
+		for(unsigned int idx : meshlet_index) {
+			meshlet const& cluster = table.meshlets.data[idx];
+			for(size_t k=0; k<cluster.triangle_count; ++k)
+				connectivity.data[offset++] = meshlet_triangle(table, cluster, k);
+		}
+	}
+
+	buffer<uint3> meshlet_connectivity(meshlet_table const& table, buffer<unsigned int> const& meshlet_index)
+	{
+		buffer<uint3> connectivity;
+		meshlet_connectivity(table, meshlet_index, connectivity);
+		return connectivity;
+	}
+
+	std::string str(meshlet_table const& table)
+	{
+		size_t N_tri = table.local_index.size()/3;
+		return "meshlet_table[N_meshlet="+str(table.meshlets.size())+"][N_triangle="+str(N_tri)+"][N_vertex_reference="+str(table.vertex_index.size())+"]";
+	}
+}
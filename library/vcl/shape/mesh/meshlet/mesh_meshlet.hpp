@@ -0,0 +1,77 @@
+#pragma once
+
+#include "../structure/mesh.hpp"
+#include "vcl/math/matrix/matrix.hpp"
+
+namespace vcl
+{
+	/** Small cluster of triangles of a mesh (meshlet)
+	* The triangles of the meshlet index a local set of vertices using 8-bit indices. */
+	struct meshlet
+	{
+		unsigned int vertex_offset = 0;   // first element in meshlet_table.vertex_index
+		unsigned int vertex_count = 0;
+		unsigned int triangle_offset = 0; // first triangle in meshlet_table.local_index (3 local indices per triangle)
+		unsigned int triangle_count = 0;
+
+		/** Bounding sphere */
+		vec3 center = {0,0,0};
+		float radius = 0.0f;
+
+		/** Normal cone used for backface culling
+		* The meshlet is entirely backfacing if dot(normalize(cone_apex-camera_position), cone_axis) >= cone_cutoff
+		* cone_cutoff = 1 when the normals are too spread to allow culling */
+		vec3 cone_apex = {0,0,0};
+		vec3 cone_axis = {0,0,1};
+		float cone_cutoff = 1.0f;
+	};
+
+	/** Partition of a mesh into meshlets */
+	struct meshlet_table
+	{
+		buffer<meshlet> meshlets;
+		/** Index of the mesh vertices used by each meshlet (concatenated) */
+		buffer<unsigned int> vertex_index;
+		/** Local index (in [0,meshlet.vertex_count[) of the triangle corners of each meshlet (concatenated) */
+		buffer<unsigned char> local_index;
+	};
+
+	struct meshlet_parameters
+	{
+		size_t max_vertex = 64;    // must be <= 256 to fit 8-bit indices
+		size_t max_triangle = 124;
+	};
+
+	/** Greedily group adjacent triangles of the mesh into meshlets respecting the vertex and triangle limits */
+	meshlet_table mesh_build_meshlets(mesh const& m, meshlet_parameters const& parameters=meshlet_parameters());
+
+	/** Global triangle connectivity of the k-th meshlet */
+	uint3 meshlet_triangle(meshlet_table const& table, meshlet const& cluster, size_t k_triangle);
+
+	/** Extract the 6 planes (a,b,c,d) of the view frustum given the matrix projection*view*model
+	* A point p is inside the frustum if a*p.x+b*p.y+c*p.z+d >= 0 for all planes (planes are normalized). */
+	buffer_stack<vec4,6> frustum_planes(mat4 const& projection_view);
+
+	/** Test if the bounding sphere of the meshlet intersects the frustum */
+	bool meshlet_in_frustum(meshlet const& cluster, buffer_stack<vec4,6> const& planes);
+	/** Test if all the triangles of the meshlet are backfacing with respect to the camera */
+	bool meshlet_backfacing(meshlet const& cluster, vec3 const& camera_position);
+
+	struct meshlet_culling_statistics
+	{
+		size_t meshlet_total = 0;
+		size_t culled_frustum = 0;
+		size_t culled_backface = 0;
+		size_t triangle_visible = 0;
+	};
+
+	/** Return the index of the meshlets that are not culled by the frustum and the backface cone test
+	* projection_view and camera_position must be expressed in the same space than the mesh (include the model matrix if needed) */
+	buffer<unsigned int> meshlet_cull(meshlet_table const& table, mat4 const& projection_view, vec3 const& camera_position, bool frustum_culling=true, bool backface_culling=true, meshlet_culling_statistics* statistics=nullptr);
+
+	/** Triangle connectivity (global vertex indices) of a set of meshlets - ready to be sent as an index buffer */
+	buffer<uint3> meshlet_connectivity(meshlet_table const& table, buffer<unsigned int> const& meshlet_index);
+	void meshlet_connectivity(meshlet_table const& table, buffer<unsigned int> const& meshlet_index, buffer<uint3>& connectivity_to_fill);
+
+	std::string str(meshlet_table const& table);
+}
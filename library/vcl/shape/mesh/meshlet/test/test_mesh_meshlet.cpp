@@ -0,0 +1,114 @@
+#include "test_mesh_meshlet.hpp"
+
+#include "vcl/base/base.hpp"
+#include "../mesh_meshlet.hpp"
+#include "../../primitive/mesh_primitive.hpp"
+#include "vcl/math/projection/projection.hpp"
+
+#include <algorithm>
+#include <array>
+#include <map>
+
+using namespace vcl;
+
+namespace vcl_test
+{
+	// Triangle starting at its smallest index (same orientation)
+	static std::array<unsigned int,3> canonical_triangle(uint3 const& tri)
+	{
+		size_t const k = (tri[0]<tri[1] && tri[0]<tri[2])? 0 : (tri[1]<tri[2]? 1 : 2);
+		return { tri[k], tri[(k+1)%3], tri[(k+2)%3] };
+	}
+
+	static void check_meshlets(mesh const& m, meshlet_parameters const& parameters)
+	{
+		meshlet_table const table = mesh_build_meshlets(m, parameters);
+		assert_vcl_no_msg(table.meshlets.size()>0);
+
+		std::map<std::array<unsigned int,3>, int> triangle_count;
+		for(uint3 const& tri : m.connectivity)
+			triangle_count[canonical_triangle(tri)]++;
+
+		for(meshlet const& cluster : table.meshlets)
+		{
+			// Limits and ranges in the tables
+			assert_vcl_no_msg(cluster.vertex_count>0 && cluster.vertex_count<=parameters.max_vertex);
+			assert_vcl_no_msg(cluster.triangle_count>0 && cluster.triangle_count<=parameters.max_triangle);
+			assert_vcl_no_msg(cluster.vertex_offset+cluster.vertex_count<=table.vertex_index.size());
+			assert_vcl_no_msg(3*(cluster.triangle_offset+cluster.triangle_count)<=table.local_index.size());
+
+			// The local vertices are distinct, and contained in the bounding sphere
+			for(unsigned int i=0; i<cluster.vertex_count; ++i) {
+				unsigned int const v = table.vertex_index[cluster.vertex_offset+i];
+				assert_vcl_no_msg(v<m.position.size());
+				assert_vcl_no_msg(norm(m.position[v]-cluster.center)<=cluster.radius*1.0001f+1e-6f);
+				for(unsigned int j=0; j<i; ++j)
+					assert_vcl_no_msg(table.vertex_index[cluster.vertex_offset+j]!=v);
+			}
+
+			// The local indices give back the triangles of the mesh
+			for(size_t k=0; k<cluster.triangle_count; ++k) {
+				uint3 tri;
+				for(size_t i=0; i<3; ++i) {
+					unsigned char const local = table.local_index[3*(cluster.triangle_offset+k)+i];
+					assert_vcl_no_msg(local<cluster.vertex_count);
+					tri[i] = table.vertex_index[cluster.vertex_offset+local];
+				}
+				assert_vcl_no_msg(is_equal(tri, meshlet_triangle(table, cluster, k)));
+				triangle_count[canonical_triangle(tri)]--;
+			}
+		}
+
+		// Every triangle is in exactly one meshlet
+		for(auto const& count : triangle_count)
+			assert_vcl_no_msg(count.second==0);
+	}
+
+	void test_mesh_meshlet()
+	{
+		// Partition
+		{
+			mesh const sphere = mesh_primitive_sphere(1.0f, {0,0,0}, 40, 20);
+			check_meshlets(sphere, meshlet_parameters());
+			meshlet_parameters small;
+			small.max_vertex = 16;
+			small.max_triangle = 20;
+			check_meshlets(sphere, small);
+			check_meshlets(mesh_primitive_grid({0,0,0}, {1,0,0}, {1,1,0}, {0,1,0}, 30, 30), small);
+		}
+
+		// Culling of a square (single meshlet) in front of the camera at the origin looking toward -z
+		{
+			mat4 const projection = projection_perspective(50.0f*3.14159f/180.0f, 1.0f, 0.1f, 100.0f);
+			vec3 const camera = {0,0,0};
+			auto single_meshlet = [](mesh const& m) {
+				meshlet_table const table = mesh_build_meshlets(m);
+				assert_vcl_no_msg(table.meshlets.size()==1);
+				return table;
+			};
+
+			// Facing the camera: visible
+			meshlet_table const front = single_meshlet(mesh_primitive_grid({-1,-1,-5}, {1,-1,-5}, {1,1,-5}, {-1,1,-5}, 5, 5));
+			meshlet const& visible = front.meshlets[0];
+			assert_vcl_no_msg(meshlet_in_frustum(visible, frustum_planes(projection)));
+			assert_vcl_no_msg(!meshlet_backfacing(visible, camera));
+			meshlet_culling_statistics statistics;
+			assert_vcl_no_msg(meshlet_cull(front, projection, camera, true, true, &statistics).size()==1);
+			assert_vcl_no_msg(statistics.triangle_visible==visible.triangle_count);
+
+			// Behind the camera: culled by the frustum
+			meshlet_table const behind = single_meshlet(mesh_primitive_grid({-1,-1,5}, {1,-1,5}, {1,1,5}, {-1,1,5}, 5, 5));
+			assert_vcl_no_msg(!meshlet_in_frustum(behind.meshlets[0], frustum_planes(projection)));
+			assert_vcl_no_msg(meshlet_cull(behind, projection, camera, true, true, &statistics).size()==0);
+			assert_vcl_no_msg(statistics.culled_frustum==1);
+
+			// In the frustum, but seen from the back: culled by the normal cone
+			meshlet_table const back = single_meshlet(mesh_primitive_grid({-1,-1,-5}, {-1,1,-5}, {1,1,-5}, {1,-1,-5}, 5, 5));
+			assert_vcl_no_msg(meshlet_in_frustum(back.meshlets[0], frustum_planes(projection)));
+			assert_vcl_no_msg(meshlet_backfacing(back.meshlets[0], camera));
+			assert_vcl_no_msg(meshlet_cull(back, projection, camera, true, true, &statistics).size()==0);
+			assert_vcl_no_msg(statistics.culled_backface==1);
+			assert_vcl_no_msg(meshlet_cull(back, projection, camera, true, false).size()==1);
+		}
+	}
+}
@@ -0,0 +1,7 @@
+#pragma once
+
+namespace vcl_test
+{
+	/** Check the partition of a mesh into meshlets (limits, local indices), and the frustum and backface culling of the meshlets */
+	void test_mesh_meshlet();
+}
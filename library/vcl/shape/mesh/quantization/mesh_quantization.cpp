@@ -0,0 +1,152 @@
+#include "mesh_quantization.hpp"
+
+#include "vcl/base/base.hpp"
+#include "vcl/math/quantization/quantization.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace vcl
+{
+	static_assert(sizeof(vertex_quantized)==16, "vertex_quantized is expected to be tightly packed");
+
+	static vertex_quantized vertex_quantize(vec3 const& p, vec3 const& n, vec3 const& c, vec2 const& uv, vec3 const& offset, vec3 const& inv_scale)
+	{
+		vertex_quantized v;
+		for(size_t k=0; k<3; ++k)
+			v.position[k] = quantize_unorm16( (p[k]-offset[k])*inv_scale[k] );
+
+		buffer_stack<int8_t,2> const n_oct = octahedral_encode_snorm8(n);
+		v.normal[0] = n_oct.x;
+		v.normal[1] = n_oct.y;
+
+		for(size_t k=0; k<3; ++k)
+			v.color[k] = quantize_unorm8(c[k]);
+		v.color[3] = 255;
+
+		v.uv[0] = float_to_half(uv.x);
+		v.uv[1] = float_to_half(uv.y);
+		return v;
+	}
+
+	mesh_quantized mesh_quantize(mesh const& m)
+	{
+		size_t const N = m.position.size();
+		assert_vcl(N>0, "Cannot quantize a mesh without vertex");
+
+		mesh_quantized q;
+		q.connectivity = m.connectivity;
+
+		// Bounding box
+		vec3 p_min = m.position[0], p_max = m.position[0];
+		for(vec3 const& p : m.position) {
+			for(size_t k=0; k<3; ++k) {
+				p_min[k] = std::min(p_min[k], p[k]);
+				p_max[k] = std::max(p_max[k], p[k]);
+			}
+		}
+		q.position_offset = p_min;
+		vec3 inv_scale;
+		for(size_t k=0; k<3; ++k) {
+			float const extent = p_max[k]-p_min[k];
+			q.position_scale[k] = extent>0? extent : 1.0f;
+			inv_scale[k] = 1.0f/q.position_scale[k];
+		}
+
+		buffer<vec3> normal_default;
+		if(m.normal.size()!=N && m.connectivity.size()>0)
+			normal_default = normal_per_vertex(m.position, m.connectivity);
+		buffer<vec3> const& normal = m.normal.size()==N? m.normal : normal_default;
+
+		q.vertex.resize(N);
+		parallel_for(N, [&](size_t k){
+			vec3 const n = normal.size()==N? normal.data[k] : vec3{0,0,1};
+			vec3 const c = m.color.size()==N? m.color.data[k] : vec3{1,1,1};
+			vec2 const uv = m.uv.size()==N? m.uv.data[k] : vec2{0,0};
+			q.vertex.data[k] = vertex_quantize(m.position.data[k], n, c, uv, q.position_offset, inv_scale);
+		});
+
+		return q;
+	}
+
+	mesh mesh_dequantize(mesh_quantized const& q)
+	{
+		size_t const N = q.vertex.size();
+		mesh m;
+		m.position.resize(N);
+		m.normal.resize(N);
+		m.color.resize(N);
+		m.uv.resize(N);
+		m.connectivity = q.connectivity;
+
+		parallel_for(N, [&](size_t k){
+			vertex_quantized const& v = q.vertex.data[k];
+			for(size_t c=0; c<3; ++c)
+				m.position.data[k][c] = q.position_offset[c] + q.position_scale[c]*dequantize_unorm16(v.position[c]);
+			m.normal.data[k] = octahedral_decode_snorm8({v.normal[0], v.normal[1]});
+			m.color.data[k] = {dequantize_unorm8(v.color[0]), dequantize_unorm8(v.color[1]), dequantize_unorm8(v.color[2])};
+			m.uv.data[k] = {half_to_float(v.uv[0]), half_to_float(v.uv[1])};
+		});
+
+		return m;
+	}
+
+	static size_t size_in_memory_per_vertex(mesh const& m)
+	{
+		return size_in_memory(m.position)+size_in_memory(m.normal)+size_in_memory(m.color)+size_in_memory(m.uv);
+	}
+
+	mesh_quantization_error mesh_quantization_error_report(mesh const& original, mesh_quantized const& q)
+	{
+		size_t const N = original.position.size();
+		assert_vcl(N==q.vertex.size(), "Quantized mesh doesn't correspond to the original one");
+
+		mesh const m = mesh_dequantize(q);
+		mesh_quantization_error error;
+
+		double position_sum = 0.0;
+		float normal_dot_min = 1.0f;
+		for(size_t k=0; k<N; ++k)
+		{
+			float const d = norm(original.position[k]-m.position[k]);
+			error.position_max = std::max(error.position_max, d);
+			position_sum += d;
+
+			if(original.normal.size()==N && norm(original.normal[k])>1e-6f)
+				normal_dot_min = std::min(normal_dot_min, dot(normalize(original.normal[k]), m.normal[k]));
+			if(original.color.size()==N)
+				for(size_t c=0; c<3; ++c)
+					error.color_max = std::max(error.color_max, std::abs(original.color[k][c]-m.color[k][c]));
+			if(original.uv.size()==N)
+				for(size_t c=0; c<2; ++c)
+					error.uv_max = std::max(error.uv_max, std::abs(original.uv[k][c]-m.uv[k][c]));
+		}
+		error.position_average = N>0? float(position_sum/N) : 0.0f;
+		error.normal_angle_max = std::acos(clamp(normal_dot_min, -1.0f, 1.0f))*180.0f/3.14159265f;
+
+		error.memory_before = size_in_memory_per_vertex(original);
+		error.memory_after = q.vertex.size()*sizeof(vertex_quantized);
+		return error;
+	}
+
+	std::string str(mesh_quantization_error const& error)
+	{
+		std::string s = "mesh_quantization_error";
+		s += "[position max="+str(error.position_max)+", average="+str(error.position_average)+"]";
+		s += "[normal angle max="+str(error.normal_angle_max)+" deg]";
+		s += "[color max="+str(error.color_max)+"]";
+		s += "[uv max="+str(error.uv_max)+"]";
+		s += "[memory "+str(error.memory_before)+" -> "+str(error.memory_after)+" Bytes]";
+		return s;
+	}
+
+	size_t size_in_memory(mesh_quantized const& q)
+	{
+		return q.vertex.size()*sizeof(vertex_quantized) + q.connectivity.size()*sizeof(uint3);
+	}
+
+	std::string str(mesh_quantized const& q)
+	{
+		return "mesh_quantized[N_vertex="+str(q.vertex.size())+"][N_triangle="+str(q.connectivity.size())+"]";
+	}
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include "../structure/mesh.hpp"
+
+#include <cstdint>
+
+namespace vcl
+{
+	/** Compressed vertex (16 Bytes) used by mesh_quantized
+	* - position: unorm16 coordinates within the bounding box of the mesh
+	* - normal: octahedral encoding stored as two snorm8
+	* - color: unorm8 rgba (alpha is set to 1)
+	* - uv: half float */
+	struct vertex_quantized
+	{
+		uint16_t position[3];
+		int8_t normal[2];
+		uint8_t color[4];
+		uint16_t uv[2];
+	};
+
+	/** Mesh with quantized per-vertex attributes
+	* The position is retrieved as p = position_offset + position_scale * (q/65535) */
+	struct mesh_quantized
+	{
+		buffer<vertex_quantized> vertex;
+		buffer<uint3> connectivity;
+
+		vec3 position_offset = {0,0,0};
+		vec3 position_scale = {1,1,1};
+	};
+
+	/** Quantize the per-vertex attributes of the mesh
+	* Empty attribute buffers are filled with default values (normal computed from the connectivity, white color, 0 uv) */
+	mesh_quantized mesh_quantize(mesh const& m);
+	/** Convert back the quantized mesh to a standard mesh with float attributes */
+	mesh mesh_dequantize(mesh_quantized const& q);
+
+	/** Quantization error between a mesh and its quantized version */
+	struct mesh_quantization_error
+	{
+		float position_max = 0.0f;      // absolute distance
+		float position_average = 0.0f;  // absolute distance
+		float normal_angle_max = 0.0f;  // in degrees
+		float color_max = 0.0f;         // per component
+		float uv_max = 0.0f;            // per component
+		size_t memory_before = 0;       // in Bytes (per-vertex attributes only)
+		size_t memory_after = 0;        // in Bytes (per-vertex attributes only)
+	};
+	mesh_quantization_error mesh_quantization_error_report(mesh const& original, mesh_quantized const& q);
+	std::string str(mesh_quantization_error const& error);
+
+	size_t size_in_memory(mesh_quantized const& q);
+	std::string str(mesh_quantized const& q);
+}
@@ -0,0 +1,361 @@
+#include "mesh_weld.hpp"
+
+#include "vcl/base/base.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+
+namespace vcl
+{
+	// Integer coordinates of the cell containing a vertex
+	struct weld_cell {
+		int64_t x, y, z;
+	};
+
+	static bool operator==(weld_cell const& a, weld_cell const& b)
+	{
+		return a.x==b.x && a.y==b.y && a.z==b.z;
+	}
+	static bool operator<(weld_cell const& a, weld_cell const& b)
+	{
+		if(a.x!=b.x) return a.x<b.x;
+		if(a.y!=b.y) return a.y<b.y;
+		return a.z<b.z;
+	}
+
+	static int64_t weld_cell_coordinate(float x, float tolerance)
+	{
+		// Positions are only filtered by cells, the exact distance is always checked afterward:
+		//  clamping (or merging non-finite values) in the same cell never leads to an incorrect weld
+		if(std::isfinite(x)==false)
+			return 0;
+		if(tolerance<=0.0f) {
+			if(x==0.0f) // +0 and -0 share the same cell
+				return 0;
+			int32_t bits = 0; // exact welding: one cell per float value
+			std::memcpy(&bits, &x, sizeof(float));
+			return bits;
+		}
+		double const c = std::floor(double(x)/double(tolerance));
+		double const c_max = 4.0e18;
+		return int64_t(clamp(c, -c_max, c_max));
+	}
+
+	static uint64_t weld_cell_hash(weld_cell const& c)
+	{
+		uint64_t h = uint64_t(c.x)*0x9E3779B97F4A7C15ull;
+		h ^= uint64_t(c.y)*0xC2B2AE3D27D4EB4Full + (h<<6) + (h>>2);
+		h ^= uint64_t(c.z)*0x165667B19E3779F9ull + (h<<6) + (h>>2);
+		return h ^ (h>>29);
+	}
+
+	static bool weld_close(vec3 const& a, vec3 const& b, float tolerance)
+	{
+		return std::abs(a.x-b.x)<=tolerance && std::abs(a.y-b.y)<=tolerance && std::abs(a.z-b.z)<=tolerance;
+	}
+	static bool weld_close(vec2 const& a, vec2 const& b, float tolerance)
+	{
+		return std::abs(a.x-b.x)<=tolerance && std::abs(a.y-b.y)<=tolerance;
+	}
+
+	// Test if the vertices i and j can be merged
+	static bool weld_match(mesh const& m, mesh_weld_parameters const& parameters, bool use_normal, bool use_color, bool use_uv, size_t i, size_t j)
+	{
+		if(!weld_close(m.position.data[i], m.position.data[j], std::max(parameters.tolerance,0.0f)))
+			return false;
+		float const eps = parameters.attribute_tolerance;
+		if(use_normal && !weld_close(m.normal.data[i], m.normal.data[j], eps))
+			return false;
+		if(use_color && !weld_close(m.color.data[i], m.color.data[j], eps))
+			return false;
+		if(use_uv && !weld_close(m.uv.data[i], m.uv.data[j], eps))
+			return false;
+		return true;
+	}
+
+	buffer<unsigned int> mesh_weld_index(mesh const& m, mesh_weld_parameters const& parameters, size_t* vertex_count)
+	{
+		size_t const N = m.position.size();
+		float const tolerance = parameters.tolerance;
+
+		assert_vcl(m.normal.size()==0 || m.normal.size()==N, "Incoherent size of per-vertex normal");
+		assert_vcl(m.color.size()==0 || m.color.size()==N, "Incoherent size of per-vertex color");
+		assert_vcl(m.uv.size()==0 || m.uv.size()==N, "Incoherent size of per-vertex uv");
+
+		bool const use_normal = parameters.compare_normal && m.normal.size()==N;
+		bool const use_color = parameters.compare_color && m.color.size()==N;
+		bool const use_uv = parameters.compare_uv && m.uv.size()==N;
+
+		// Only the cell of the vertex is searched for exact welding, otherwise the 27 neighboring cells
+		int const neighbor = tolerance>0.0f? 1 : 0;
+
+		mesh_weld_method method = parameters.method;
+		if(method==mesh_weld_method::automatic)
+			method = tolerance>0.0f? mesh_weld_method::hash : mesh_weld_method::sort;
+
+		buffer<weld_cell> cells(N);
+		parallel_for(N, [&](size_t k){
+			vec3 const& p = m.position.data[k];
+			cells.data[k] = {weld_cell_coordinate(p.x,tolerance), weld_cell_coordinate(p.y,tolerance), weld_cell_coordinate(p.z,tolerance)};
+		});
+
+		// representative[k] = smallest index j<=k of a vertex that can be merged with k
+		buffer<unsigned int> representative(N);
+
+		if(method==mesh_weld_method::hash)
+		{
+			// Open addressing table storing for each cell the first vertex of a linked list of vertices
+			size_t capacity = 16;
+			while(capacity<2*N)
+				capacity *= 2;
+			size_t const mask = capacity-1;
+			unsigned int const empty = ~0u;
+			std::vector<unsigned int> table(capacity, empty);
+			std::vector<unsigned int> next(N, empty);
+
+			auto find_slot = [&](weld_cell const& c) {
+				size_t slot = weld_cell_hash(c) & mask;
+				while(table[slot]!=empty && !(cells.data[table[slot]]==c))
+					slot = (slot+1) & mask;
+				return slot;
+			};
+
+			// Insert in reverse order such that each list is sorted by increasing index
+			for(size_t k=N; k>0; --k) {
+				unsigned int const idx = static_cast<unsigned int>(k-1);
+				size_t const slot = find_slot(cells.data[idx]);
+				next[idx] = table[slot];
+				table[slot] = idx;
+			}
+
+			parallel_for(N, [&](size_t k){
+				weld_cell const& c = cells.data[k];
+				unsigned int best = static_cast<unsigned int>(k);
+				for(int dz=-neighbor; dz<=neighbor; ++dz)
+					for(int dy=-neighbor; dy<=neighbor; ++dy)
+						for(int dx=-neighbor; dx<=neighbor; ++dx) {
+							size_t const slot = find_slot({c.x+dx, c.y+dy, c.z+dz});
+							for(unsigned int j=table[slot]; j!=empty && j<best; j=next[j])
+								if(weld_match(m, parameters, use_normal, use_color, use_uv, k, j))
+									best = j;
+						}
+				representative.data[k] = best;
+			}, 4096);
+		}
+		else
+		{
+			// Sort the vertices by cell (then by index), and search neighboring cells by binary search
+			std::vector<unsigned int> order(N);
+			for(size_t k=0; k<N; ++k)
+				order[k] = static_cast<unsigned int>(k);
+			std::sort(order.begin(), order.end(), [&cells](unsigned int a, unsigned int b){
+				if(cells.data[a]==cells.data[b])
+					return a<b;
+				return cells.data[a]<cells.data[b];
+			});
+
+			parallel_for(N, [&](size_t k){
+				weld_cell const& c = cells.data[k];
+				unsigned int best = static_cast<unsigned int>(k);
+				for(int dx=-neighbor; dx<=neighbor; ++dx)
+					for(int dy=-neighbor; dy<=neighbor; ++dy)
+						for(int dz=-neighbor; dz<=neighbor; ++dz) {
+							weld_cell const target = {c.x+dx, c.y+dy, c.z+dz};
+							auto it = std::lower_bound(order.begin(), order.end(), target, [&cells](unsigned int a, weld_cell const& b){ return cells.data[a]<b; });
+							for(; it!=order.end() && *it<best && cells.data[*it]==target; ++it)
+								if(weld_match(m, parameters, use_normal, use_color, use_uv, k, *it))
+									best = *it;
+						}
+				representative.data[k] = best;
+			}, 4096);
+		}
+
+		// Number the new vertices by order of first appearance.
+		//  representative[k]<=k, therefore index[representative[k]] is always already known
+		buffer<unsigned int> index(N);
+		unsigned int counter = 0;
+		for(size_t k=0; k<N; ++k) {
+			unsigned int const r = representative.data[k];
+			if(r==k)
+				index.data[k] = counter++;
+			else
+				index.data[k] = index.data[r];
+		}
+
+		if(vertex_count!=nullptr)
+			*vertex_count = counter;
+		return index;
+	}
+
+	template <typename T>
+	static void weld_gather(buffer<T>& data, buffer<unsigned int> const& index, size_t N_new)
+	{
+		size_t const N = index.size();
+		if(data.size()!=N)
+			return;
+		buffer<T> welded(N_new);
+		// The first vertex of each group (representative) stores its attributes
+		std::vector<char> filled(N_new, 0);
+		for(size_t k=0; k<N; ++k) {
+			unsigned int const idx = index.data[k];
+			if(filled[idx]==0) {
+				welded.data[idx] = data.data[k];
+				filled[idx] = 1;
+			}
+		}
+		data = std::move(welded);
+	}
+
+	static size_t mesh_size_in_memory(mesh const& m)
+	{
+		return size_in_memory(m.position) + size_in_memory(m.normal) + size_in_memory(m.color) + size_in_memory(m.uv) + size_in_memory(m.connectivity);
+	}
+
+	mesh_weld_report mesh_weld(mesh& m, mesh_weld_parameters const& parameters, buffer<unsigned int>* remap)
+	{
+		mesh_weld_report report;
+		report.vertex_before = m.position.size();
+		report.triangle_before = m.connectivity.size();
+		report.memory_before = mesh_size_in_memory(m);
+
+		size_t N_new = 0;
+		buffer<unsigned int> const index = mesh_weld_index(m, parameters, &N_new);
+
+		weld_gather(m.position, index, N_new);
+		weld_gather(m.normal, index, N_new);
+		weld_gather(m.color, index, N_new);
+		weld_gather(m.uv, index, N_new);
+
+		// Remap the connectivity
+		size_t const N_tri = m.connectivity.size();
+		parallel_for(N_tri, [&](size_t k){
+			uint3& tri = m.connectivity.data[k];
+			for(unsigned int& idx : tri) {
+				assert_vcl_no_msg(idx<index.size());
+				idx = index.data[idx];
+			}
+		}, 16384);
+
+		if(parameters.remove_degenerate_triangle) {
+			size_t counter = 0;
+			for(size_t k=0; k<N_tri; ++k) {
+				uint3 const& tri = m.connectivity.data[k];
+				if(tri.x!=tri.y && tri.y!=tri.z && tri.x!=tri.z)
+					m.connectivity.data[counter++] = tri;
+			}
+			m.connectivity.resize(counter);
+		}
+
+		report.vertex_after = m.position.size();
+		report.triangle_after = m.connectivity.size();
+		report.memory_after = mesh_size_in_memory(m);
+
+		if(remap!=nullptr)
+			*remap = index;
+		return report;
+	}
+
+	static uint64_t weld_triplet_hash(int3 const& c)
+	{
+		return weld_cell_hash({int64_t(uint32_t(c[0])), int64_t(uint32_t(c[1])), int64_t(uint32_t(c[2]))});
+	}
+	static bool weld_triplet_equal(int3 const& a, int3 const& b)
+	{
+		return a[0]==b[0] && a[1]==b[1] && a[2]==b[2];
+	}
+
+	// The classes are found with a lock-free hash table: each slot stores the first triplet (smallest index) of its class.
+	//  The numbering in order of first appearance is then a prefix sum over ranges of triplets, such that the result doesn't depend on the number of threads.
+	size_t weld_unique_triplets(int3 const* triplets, size_t N, buffer<unsigned int>& index, buffer<unsigned int>& first)
+	{
+		assert_vcl(N<(size_t(1)<<31), "Too many elements to weld");
+
+		// Linear probing (slot value = triplet index + 1, 0 for an empty slot)
+		size_t capacity = 16;
+		while(capacity<2*N)
+			capacity *= 2;
+		size_t const mask = capacity-1;
+		std::unique_ptr<std::atomic<unsigned int>[]> slots(new std::atomic<unsigned int>[capacity]);
+		parallel_for(capacity, [&slots](size_t k){ slots[k].store(0, std::memory_order_relaxed); }, 1<<16);
+
+		// The slot of the class of each triplet is stored in representative, then replaced by the first triplet of the class
+		std::vector<unsigned int> representative(N);
+		parallel_for(N, [&](size_t k) {
+			unsigned int const candidate = static_cast<unsigned int>(k+1);
+			int3 const& c = triplets[k];
+			size_t s = weld_triplet_hash(c) & mask;
+			while(true) {
+				unsigned int value = slots[s].load(std::memory_order_relaxed);
+				if(value==0) {
+					if(slots[s].compare_exchange_strong(value, candidate, std::memory_order_relaxed))
+						break;
+					// another triplet took the slot: value contains it, check it below
+				}
+				if(weld_triplet_equal(triplets[value-1], c)) {
+					// Keep the first triplet
+					while(candidate<value && !slots[s].compare_exchange_weak(value, candidate, std::memory_order_relaxed)) {}
+					break;
+				}
+				s = (s+1) & mask;
+			}
+			representative[k] = static_cast<unsigned int>(s);
+		}, 16384);
+
+		parallel_for(N, [&](size_t k) {
+			representative[k] = slots[representative[k]].load(std::memory_order_relaxed)-1;
+		}, 16384);
+		slots.reset();
+
+		// Number the classes by order of first appearance
+		size_t const N_range = parallel_range_count(N, 16384);
+		std::vector<size_t> range_offset(N_range+1, 0);
+		parallel_for(N_range, [&](size_t r) {
+			size_t k_begin=0, k_end=0;
+			parallel_range_bounds(N, N_range, r, k_begin, k_end);
+			for(size_t k=k_begin; k<k_end; ++k)
+				range_offset[r+1] += (representative[k]==k);
+		}, 1);
+		for(size_t r=0; r<N_range; ++r)
+			range_offset[r+1] += range_offset[r];
+		size_t const N_class = range_offset[N_range];
+
+		index.resize(N);
+		first.resize(N_class);
+		parallel_for(N_range, [&](size_t r) {
+			size_t k_begin=0, k_end=0;
+			parallel_range_bounds(N, N_range, r, k_begin, k_end);
+			unsigned int v = static_cast<unsigned int>(range_offset[r]);
+			for(size_t k=k_begin; k<k_end; ++k) {
+				if(representative[k]==k) {
+					index.data[k] = v;
+					first.data[v] = static_cast<unsigned int>(k);
+					v++;
+				}
+			}
+		}, 1);
+		parallel_for(N, [&](size_t k) {
+			if(representative[k]!=k)
+				index.data[k] = index.data[representative[k]];
+		}, 16384);
+
+		return N_class;
+	}
+
+	size_t mesh_weld_report::memory_saved() const
+	{
+		return memory_before>memory_after? memory_before-memory_after : 0;
+	}
+
+	std::string str(mesh_weld_report const& report)
+	{
+		std::string s;
+		s += "mesh_weld[vertex: "+str(report.vertex_before)+" -> "+str(report.vertex_after)+"]";
+		s += "[triangle: "+str(report.triangle_before)+" -> "+str(report.triangle_after)+"]";
+		s += "[memory saved: "+str(report.memory_saved())+" Bytes]";
+		return s;
+	}
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include "../structure/mesh.hpp"
+
+namespace vcl
+{
+	/** Method used to find the coincident vertices */
+	enum class mesh_weld_method {
+		automatic, // hash, or sort for exact welding (tolerance equal to 0)
+		hash,      // spatial hash of cells of size equal to the tolerance
+		sort       // sort the vertices by cell, and binary search of the neighboring cells (no hash table)
+	};
+
+	struct mesh_weld_parameters
+	{
+		/** Vertices closer than this distance (per coordinate) are merged */
+		float tolerance = 1e-5f;
+
+		/** Only merge vertices with similar attributes (when the attribute buffer is filled) */
+		bool compare_normal = false;
+		bool compare_color  = false;
+		bool compare_uv     = false;
+		/** Maximal difference per component for the compared attributes */
+		float attribute_tolerance = 1e-3f;
+
+		/** Remove the triangles having two identical indices after welding */
+		bool remove_degenerate_triangle = true;
+
+		mesh_weld_method method = mesh_weld_method::automatic;
+	};
+
+	/** Summary of a weld pass */
+	struct mesh_weld_report
+	{
+		size_t vertex_before = 0;
+		size_t vertex_after = 0;
+		size_t triangle_before = 0;
+		size_t triangle_after = 0;
+		size_t memory_before = 0; // in Bytes (all per-vertex buffers and connectivity)
+		size_t memory_after = 0;  // in Bytes
+
+		size_t memory_saved() const;
+	};
+	std::string str(mesh_weld_report const& report);
+
+	/** Compute for every vertex the index of the vertex it is merged with in the welded mesh
+	* The returned buffer has the size of the input positions, and the new vertices are numbered in their order of first appearance.
+	* @vertex_count: (optional) filled with the number of vertices after welding */
+	buffer<unsigned int> mesh_weld_index(mesh const& m, mesh_weld_parameters const& parameters=mesh_weld_parameters(), size_t* vertex_count=nullptr);
+
+	/** Merge the coincident vertices of the mesh and remap its connectivity
+	* @remap: (optional) filled with the new index of each initial vertex */
+	mesh_weld_report mesh_weld(mesh& m, mesh_weld_parameters const& parameters=mesh_weld_parameters(), buffer<unsigned int>* remap=nullptr);
+
+	/** Identify the identical triplets of integers (ex. the indices of the corners of an obj face, or the bits of exactly coincident positions) using a hash table filled in parallel
+	* @index: filled for each triplet with the number of its class, the classes are numbered in their order of first appearance
+	* @first: filled for each class with the index of its first triplet
+	* Returns the number of classes */
+	size_t weld_unique_triplets(int3 const* triplets, size_t N, buffer<unsigned int>& index, buffer<unsigned int>& first);
+}
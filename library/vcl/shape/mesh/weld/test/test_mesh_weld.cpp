@@ -0,0 +1,76 @@
+#include "test_mesh_weld.hpp"
+
+#include "vcl/base/base.hpp"
+#include "../mesh_weld.hpp"
+#include "../../primitive/mesh_primitive.hpp"
+
+using namespace vcl;
+
+namespace vcl_test
+{
+	void test_mesh_weld()
+	{
+		// Two triangles sharing an edge given with duplicated vertices
+		{
+			mesh m;
+			m.position = { {0,0,0}, {1,0,0}, {1,1,0},  {0,0,0}, {1,1,0}, {0,1,0} };
+			m.connectivity = { {0,1,2}, {3,4,5} };
+
+			for(auto method : {mesh_weld_method::hash, mesh_weld_method::sort}) {
+				mesh m_weld = m;
+				mesh_weld_parameters parameters;
+				parameters.method = method;
+				buffer<unsigned int> remap;
+				mesh_weld_report const report = mesh_weld(m_weld, parameters, &remap);
+
+				assert_vcl_no_msg(report.vertex_after==4);
+				assert_vcl_no_msg(m_weld.position.size()==4);
+				assert_vcl_no_msg(is_equal(remap, buffer<unsigned int>{0,1,2,0,2,3}));
+				assert_vcl_no_msg(is_equal(m_weld.connectivity[1], uint3(0,2,3)));
+				assert_vcl_no_msg(report.memory_saved()>0);
+			}
+		}
+
+		// Tolerance and degenerate triangles
+		{
+			mesh m;
+			m.position = { {0,0,0}, {1,0,0}, {1e-7f,0,0}, {0,1,0} };
+			m.connectivity = { {0,1,2}, {0,1,3} };
+			mesh_weld_report const report = mesh_weld(m);
+			assert_vcl_no_msg(report.vertex_after==3);
+			assert_vcl_no_msg(report.triangle_after==1);
+			assert_vcl_no_msg(is_equal(m.connectivity[0], uint3(0,1,2)));
+		}
+
+		// Vertices with different attributes are kept when asked
+		{
+			mesh m;
+			m.position = { {0,0,0}, {1,0,0}, {0,1,0}, {0,0,0} };
+			m.uv = { {0,0}, {1,0}, {0,1}, {0.5f,0.5f} };
+			m.connectivity = { {0,1,2}, {3,1,2} };
+
+			mesh_weld_parameters parameters;
+			parameters.compare_uv = true;
+			mesh m_uv = m;
+			assert_vcl_no_msg(mesh_weld(m_uv, parameters).vertex_after==4);
+			parameters.compare_uv = false;
+			assert_vcl_no_msg(mesh_weld(m, parameters).vertex_after==3);
+		}
+
+		// Closed cylinder: discs are merged with the border of the tube, both methods agree
+		{
+			mesh const cylinder = mesh_primitive_cylinder(0.2f, {0,0,0}, {0,0,1}, 10, 20, true);
+			mesh_weld_parameters parameters;
+			parameters.method = mesh_weld_method::hash;
+			size_t N_hash = 0;
+			buffer<unsigned int> const index_hash = mesh_weld_index(cylinder, parameters, &N_hash);
+			parameters.method = mesh_weld_method::sort;
+			size_t N_sort = 0;
+			buffer<unsigned int> const index_sort = mesh_weld_index(cylinder, parameters, &N_sort);
+
+			assert_vcl_no_msg(N_hash<cylinder.position.size());
+			assert_vcl_no_msg(N_hash==N_sort);
+			assert_vcl_no_msg(is_equal(index_hash, index_sort));
+		}
+	}
+}
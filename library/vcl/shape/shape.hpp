@@ -4,3 +4,5 @@
 #include "curve/curve.hpp"
 #include "noise/noise.hpp"
 #include "intersection/intersection.hpp"
+#include "bvh/bvh.hpp"
+#include "marching_cubes/marching_cubes.hpp"
@@ -122,9 +122,12 @@ void mouse_move_callback(GLFWwindow* window, double xpos, double ypos)
 
 void opengl_uniform(GLuint shader, scene_environment const& current_scene)
 {
-	opengl_uniform(shader, "projection", current_scene.projection);
-	opengl_uniform(shader, "view", scene.camera.matrix_view());
-	opengl_uniform(shader, "light", scene.light, false);
+	static opengl_uniform_name const projection("projection");
+	static opengl_uniform_name const view("view");
+	static opengl_uniform_name const light("light");
+	opengl_uniform(shader, projection, current_scene.projection);
+	opengl_uniform(shader, view, scene.camera.matrix_view());
+	opengl_uniform(shader, light, scene.light, false);
 }
 
 
@@ -0,0 +1,82 @@
+// Command line tool generating the binary cache (.vclmesh) of all the obj files of a directory
+//  Usage: mesh_prebake <directory> [--recursive] [--cache-directory <path>] [--no-fill-empty-field]
+//  The cache files are generated in parallel, and only for the files whose cache is missing or outdated.
+
+#include "vcl/base/base.hpp"
+#include "vcl/files/files.hpp"
+#include "vcl/shape/mesh/loader/loader.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <mutex>
+#include <string>
+
+static void print_usage()
+{
+	std::cout << "Usage: mesh_prebake <directory> [--recursive] [--cache-directory <path>] [--no-fill-empty-field]" << std::endl;
+}
+
+int main(int argc, char** argv)
+{
+	std::string directory;
+	bool recursive = false;
+	vcl::mesh_cache_options options;
+
+	for(int k=1; k<argc; ++k) {
+		std::string const arg = argv[k];
+		if(arg=="--recursive")
+			recursive = true;
+		else if(arg=="--cache-directory" && k+1<argc)
+			options.directory = argv[++k];
+		else if(arg=="--no-fill-empty-field")
+			options.fill_empty_field = false;
+		else if(arg=="--help" || arg=="-h") {
+			print_usage();
+			return 0;
+		}
+		else if(directory.empty() && arg[0]!='-')
+			directory = arg;
+		else {
+			std::cerr << "Unknown argument " << arg << std::endl;
+			print_usage();
+			return 1;
+		}
+	}
+	if(directory.empty()) {
+		print_usage();
+		return 1;
+	}
+
+	vcl::buffer<std::string> const files = vcl::directory_files(directory, ".obj", recursive);
+	std::cout << files.size() << " obj files found in " << directory << std::endl;
+
+	auto const t0 = std::chrono::steady_clock::now();
+	std::atomic<size_t> N_generated(0);
+	std::atomic<size_t> N_failed(0);
+	std::mutex output_mutex;
+	vcl::parallel_for(files.size(), [&](size_t k) {
+		std::string error;
+		vcl::mesh_cache_prebake_result const result = vcl::mesh_cache_prebake(files[k], error, options);
+		if(result==vcl::mesh_cache_prebake_result::baked)
+			N_generated++;
+		if(result==vcl::mesh_cache_prebake_result::failed)
+			N_failed++;
+
+		std::lock_guard<std::mutex> lock(output_mutex);
+		if(result==vcl::mesh_cache_prebake_result::baked)
+			std::cout << "  [baked]      " << files[k] << std::endl;
+		else if(result==vcl::mesh_cache_prebake_result::up_to_date)
+			std::cout << "  [up to date] " << files[k] << std::endl;
+		else
+			std::cerr << "  [failed]     " << files[k] << " (" << error << ")" << std::endl;
+	}, 1);
+	double const duration = std::chrono::duration<double>(std::chrono::steady_clock::now()-t0).count();
+
+	std::cout << N_generated << " cache files generated in " << duration << "s" << std::endl;
+	if(N_failed>0) {
+		std::cerr << N_failed << " cache files could not be generated" << std::endl;
+		return 1;
+	}
+	return 0;
+}